@@ -57,16 +57,16 @@ namespace OpenMS
   {
 
 public:
-    /// Applies the <i>given</i> transformations to peak maps
+    /// Applies the <i>given</i> transformations to peak maps (the maps are processed in parallel)
     static void transformPeakMaps(std::vector<MSExperiment<> > & maps, const std::vector<TransformationDescription> & given_trafos);
 
-    /// Applies the <i>given</i> transformations to feature maps
+    /// Applies the <i>given</i> transformations to feature maps (the maps are processed in parallel)
     static void transformFeatureMaps(std::vector<FeatureMap<> > & maps, const std::vector<TransformationDescription> & given_trafos);
 
-    /// Applies the <i>given</i> transformations to consensus maps
+    /// Applies the <i>given</i> transformations to consensus maps (the maps are processed in parallel)
     static void transformConsensusMaps(std::vector<ConsensusMap> & maps, const std::vector<TransformationDescription> & given_trafos);
 
-    /// Applies the <i>given</i> transformations to peptide identifications
+    /// Applies the <i>given</i> transformations to peptide identifications (the maps are processed in parallel)
     static void transformPeptideIdentifications(std::vector<std::vector<PeptideIdentification> > & maps, const std::vector<TransformationDescription> & given_trafos);
 
 
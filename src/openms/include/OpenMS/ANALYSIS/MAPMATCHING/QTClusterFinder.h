@@ -45,6 +45,8 @@
 
 #include <boost/unordered_map.hpp>
 
+#include <queue>
+
 namespace OpenMS
 {
 
@@ -70,8 +72,11 @@ namespace OpenMS
 
      This algorithm includes a number of optimizations to reduce run-time:
      @li two-dimensional hashing of features,
-     @li a look-up table for feature distances,
-     @li a variant of QT clustering that requires only one round of clustering.
+     @li a variant of QT clustering that requires only one round of clustering,
+     @li a priority queue of cluster qualities, so that the best cluster is found without scanning all clusters,
+     @li parallel computation (OpenMP) of the initial clusters and of the cluster updates after each extraction.
+
+     The result does not depend on the number of threads.
 
      @see FeatureGroupingAlgorithmQT
 
@@ -85,11 +90,14 @@ namespace OpenMS
   {
 private:
 
-    /// Distances between pairs of grid features
-    typedef OpenMSBoost::unordered_map<std::pair<GridFeature *, GridFeature *>, double> PairDistances;
-
     typedef HashGrid<GridFeature *> Grid;
 
+    /// Indices of the clusters that contain a grid feature as a potential element
+    typedef OpenMSBoost::unordered_map<GridFeature *, std::vector<Size> > ElementMapping;
+
+    /// Cluster qualities with the negated cluster index (best cluster on top, earlier cluster first on ties)
+    typedef std::priority_queue<std::pair<double, SignedSize> > ClusterQueue;
+
     /// Number of input maps
     Size num_maps_;
 
@@ -105,20 +113,6 @@ private:
     /// Feature distance functor
     FeatureDistance feature_distance_;
 
-    /**
-         @brief Distance map.
-
-         To compute it only once, the distance between two features is accessible by searching for a pair where the first position is the smaller pointer value.
-     */
-    PairDistances distances_;
-
-    /**
-         @brief Calculates the distance between two grid features.
-
-         The distance is looked up in the distance map and only computed (and stored) if it's not already available.
-     */
-    double getDistance_(GridFeature * left, GridFeature * right);
-
     /**
          @brief Checks whether the peptide IDs of a cluster and a neighboring feature are compatible.
 
@@ -129,13 +123,21 @@ private:
     /// Sets algorithm parameters
     void setParameters_(double max_intensity, double max_mz);
 
-    /// Generates a consensus feature from the best cluster and updates the clustering
-    void makeConsensusFeature_(std::list<QTCluster> & clustering,
-           ConsensusFeature & feature, OpenMSBoost::unordered_map<GridFeature *,
-             std::vector< QTCluster * > > & element_mapping);
+    /**
+         @brief Generates a consensus feature from the best cluster and updates the clustering
+
+         @returns False if there is no valid cluster left (@p feature is not set in this case)
+    */
+    bool makeConsensusFeature_(std::vector<QTCluster> & clustering,
+           ClusterQueue & queue, ConsensusFeature & feature,
+           const ElementMapping & element_mapping);
+
+    /**
+         @brief Computes an initial QT clustering of the points in the hash grid
 
-    /// Computes an initial QT clustering of the points in the hash grid
-    void computeClustering_(Grid & grid, std::list<QTCluster> & clustering);
+         There is one cluster per grid feature, in the order of iteration over the grid.
+    */
+    void computeClustering_(Grid & grid, std::vector<QTCluster> & clustering);
 
     /// Runs the algorithm on feature maps or consensus maps
     template <typename MapType>
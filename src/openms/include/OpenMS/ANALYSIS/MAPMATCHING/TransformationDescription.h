@@ -38,6 +38,9 @@
 #include <OpenMS/DATASTRUCTURES/Param.h>
 #include <OpenMS/ANALYSIS/MAPMATCHING/TransformationModel.h>
 
+#include <algorithm>
+#include <vector>
+
 namespace OpenMS
 {
   /**
@@ -51,6 +54,8 @@ namespace OpenMS
   - @p linear (TransformationModelLinear): \f$ f(x) = slope * x + intercept \f$
   - @p interpolated (TransformationModelInterpolated): Smoothing cubic B-spline.
 
+  To transform many coordinates at once (e.g. all retention times of a map), use the overload of @p apply that takes arrays. For models that are expensive to evaluate (e.g. @p interpolated), a lookup table can be precomputed over the range of interest with @p buildLookupTable; coordinates inside that range are then linearly interpolated from the table.
+
   @remark TransformationDescription stores data points, TransformationModel stores parameters. That way, data can be modeled using different models/parameters, and models can still keep a representation of the data in the format they need (if at all).
 
   @ingroup MapAlignment
@@ -89,6 +94,30 @@ public:
     */
     double apply(double value) const;
 
+    /**
+         @brief Applies the transformation to @p size values.
+
+         Writes the transformed @p values to @p results (which must have room for @p size values). Large arrays are processed in parallel.
+    */
+    void apply(const double * values, double * results, Size size) const;
+
+    /**
+         @brief Precomputes a lookup table for the range [@p min_value, @p max_value].
+
+         The model is sampled on a regular grid that is refined until linear interpolation between grid points deviates from the model by at most @p max_error (checked at the midpoints between grid points), or until @p max_size grid points are reached. Afterwards, @p apply uses the table for values within the range and evaluates the model for values outside of it.
+
+         The table is removed when the model or the data points change.
+
+         @exception Exception::IllegalArgument is thrown if the range is empty or @p max_error is not positive.
+    */
+    void buildLookupTable(double min_value, double max_value, double max_error = 1e-4, Size max_size = 1 << 20);
+
+    /// Removes the lookup table (if any)
+    void clearLookupTable();
+
+    /// Returns whether a lookup table was precomputed
+    bool hasLookupTable() const;
+
     /// Gets the type of the fitted model
     const String & getModelType() const;
 
@@ -118,6 +147,23 @@ protected:
     String model_type_;
     /// Pointer to model
     TransformationModel * model_;
+    /// Model values on a regular grid (empty if there is no lookup table)
+    std::vector<double> lookup_table_;
+    /// Range covered by the lookup table
+    double lookup_min_, lookup_max_;
+    /// Inverse of the grid spacing of the lookup table
+    double lookup_scale_;
+
+    /// Applies the transformation to a chunk of values (using the lookup table, if present)
+    void applyChunk_(const double * values, double * results, Size size) const;
+
+    /// Interpolates @p value from the lookup table (which must cover it)
+    double lookup_(double value) const
+    {
+      double pos = (value - lookup_min_) * lookup_scale_;
+      Size index = std::min(Size(pos), lookup_table_.size() - 2);
+      return lookup_table_[index] + (pos - index) * (lookup_table_[index + 1] - lookup_table_[index]);
+    }
   };
 
 } // end of namespace OpenMS
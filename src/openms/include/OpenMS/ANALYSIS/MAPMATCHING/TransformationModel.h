@@ -73,6 +73,19 @@ public:
       return value;
     }
 
+    /**
+         @brief Evaluates the model at @p size values
+
+         Gives the same results as calling evaluate() for every value, but derived classes can avoid the per-value overhead. @p results must have room for @p size values.
+    */
+    virtual void evaluate(const double * values, double * results, Size size) const
+    {
+      for (Size i = 0; i < size; ++i)
+      {
+        results[i] = evaluate(values[i]);
+      }
+    }
+
     /// Gets the (actual) parameters
     const Param & getParameters() const
     {
@@ -117,6 +130,9 @@ public:
     /// Evaluates the model at the given value
     virtual double evaluate(const double value) const;
 
+    /// Evaluates the model at @p size values
+    virtual void evaluate(const double * values, double * results, Size size) const;
+
     using TransformationModel::getParameters;
 
     /// Gets the "real" parameters
@@ -169,6 +185,9 @@ public:
     /// Evaluates the model at the given value
     double evaluate(const double value) const;
 
+    /// Evaluates the model at @p size values
+    void evaluate(const double * values, double * results, Size size) const;
+
     /// Gets the default parameters
     static void getDefaultParameters(Param & params);
 
@@ -55,6 +55,11 @@ namespace OpenMS
    * In the case of MS2 extraction, the map is assumed to originate from a SWATH
    * (data-independent acquisition or DIA) experiment.
    *
+   * All coordinates are extracted from a spectrum in a single sweep over its
+   * m/z array. Coordinates whose RT window does not contain the current
+   * spectrum are never visited (the spectra are indexed by RT once before
+   * extraction).
+   *
   */
   class OPENMS_DLLAPI ChromatogramExtractorAlgorithm :
     public ProgressLogger
@@ -95,7 +100,8 @@ public:
      * dimension in Th or ppm (e.g. a window of 50 ppm means an extraction of
      * 25 ppm on either side)
      * @param ppm Whether mz_extraction_window is in ppm or in Th
-     * @param filter Which function to apply in m/z space (currently "tophat" only)
+     * @param filter Which function to apply in m/z space ("tophat",
+     * "bartlett" or "gaussian")
      *
     */
     void extractChromatograms(const OpenSwath::SpectrumAccessPtr input, 
@@ -123,10 +129,51 @@ public:
                               const std::vector<double>::const_iterator& mz_end, std::vector<double>::const_iterator& int_it,
                               const double& mz, double& integrated_intensity, const double& mz_extraction_window, bool ppm);
 
+    /**
+     * @brief Extract all coordinates from a single spectrum.
+     *
+     * Computes the integrated intensity around each of the provided
+     * coordinates in one pass over the m/z array. The RT of the coordinates is
+     * ignored.
+     *
+     * Peaks within mz +/- mz_extraction_window / 2.0 are weighted according
+     * to the filter: "tophat" weighs all peaks equally, "bartlett" weighs a
+     * peak by 1 - |d| / (mz_extraction_window / 2.0) and "gaussian" weighs a
+     * peak by a Gaussian centered on mz with a standard deviation of
+     * mz_extraction_window / 4.0 (d being the distance to mz).
+     *
+     * @param mz_arr The m/z values of the spectrum (sorted ascending)
+     * @param int_arr The intensity values of the spectrum
+     * @param extraction_coordinates The coordinates to extract (sorted by m/z)
+     * @param integrated_intensities Output: the integrated intensity for each coordinate
+     * @param mz_extraction_window Extracts a window of this size in m/z
+     * dimension in Th or ppm
+     * @param ppm Whether mz_extraction_window is in ppm or in Th
+     * @param filter Which function to apply in m/z space ("tophat", "bartlett" or "gaussian")
+     *
+     * @throw Exception::IllegalArgument if the arrays differ in size or the coordinates are not sorted by m/z
+    */
+    void extractValues(const std::vector<double>& mz_arr, const std::vector<double>& int_arr,
+                       const std::vector<ExtractionCoordinates>& extraction_coordinates,
+                       std::vector<double>& integrated_intensities, double mz_extraction_window,
+                       bool ppm, String filter);
+
 private:
 
     int getFilterNr_(String filter);
 
+    /**
+     * @brief Sweeps once over a spectrum and extracts the windows of the given coordinates
+     *
+     * The windows [left, right] of all (active) coordinates have to be sorted
+     * by their left boundary, which is the case for coordinates sorted by m/z.
+     * The result for active[i] is written to integrated_intensities[i].
+    */
+    static void extractWindows_(const double* mz, const double* intensity, Size nr_peaks,
+                                const std::vector<Size>& active, const std::vector<double>& center,
+                                const std::vector<double>& left, const std::vector<double>& right,
+                                int filter, std::vector<double>& integrated_intensities);
+
   };
 
 }
@@ -56,7 +56,7 @@ namespace OpenMS
     @note This implementation is @a not thread-safe since it keeps internally a
     single file access pointer which it moves when accessing a specific
     data item. The caller is responsible to ensure that access is performed
-    atomically.
+    atomically. For concurrent access use SpectrumAccessOpenMSCachedMmap.
 
   */
   class OPENMS_DLLAPI SpectrumAccessOpenMSCached :
@@ -118,6 +118,9 @@ private:
     /// Indices
     std::vector<std::streampos> spectra_index_;
     std::vector<std::streampos> chrom_index_;
+
+    /// Version of the cached file format (see CachedmzML::getFormatVersion)
+    int format_version_;
   };
 
 } //end namespace
@@ -0,0 +1,257 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2013.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: Hannes Roest $
+// $Authors: Hannes Roest $
+// --------------------------------------------------------------------------
+
+#ifndef OPENMS_ANALYSIS_OPENSWATH_DATAACCESS_SPECTRUMACCESSOPENMSCACHEDMMAP_H
+#define OPENMS_ANALYSIS_OPENSWATH_DATAACCESS_SPECTRUMACCESSOPENMSCACHEDMMAP_H
+
+#include <OpenMS/KERNEL/MSSpectrum.h>
+#include <OpenMS/KERNEL/MSChromatogram.h>
+#include <OpenMS/KERNEL/MSExperiment.h>
+#include <OpenMS/FORMAT/CachedMzML.h>
+
+#include <OpenMS/ANALYSIS/OPENSWATH/OPENSWATHALGO/DATAACCESS/ISpectrumAccess.h>
+
+#include <boost/shared_ptr.hpp>
+
+#include <cstring>
+
+namespace boost
+{
+  namespace interprocess
+  {
+    class file_mapping;
+    class mapped_region;
+  }
+}
+
+namespace OpenMS
+{
+
+  /**
+    @brief An implementation of the Spectrum Access interface using a memory mapped cached mzML file
+
+    This class implements the OpenSWATH Spectrum Access interface
+    (ISpectrumAccess) on top of the binary format written by CachedmzML (and
+    MSDataCachedConsumer), both format versions 1 and 2 are supported. For
+    version 2 files the index is read from the footer of the file. In contrast to SpectrumAccessOpenMSCached, the
+    cached file is mapped into memory once and all data access is a read from
+    the mapping, leaving caching and read-ahead to the operating system.
+
+    Since there is no shared file pointer and the mapping is never modified
+    after construction, this implementation is thread-safe: getSpectrumById
+    and getChromatogramById may be called concurrently from multiple threads.
+
+    In addition to the ISpectrumAccess interface, getSpectrumViewById and
+    getChromatogramViewById hand out zero-copy views directly into the mapped
+    file.
+
+    @note The complete cached file is mapped into the address space of the
+    process, on 32 bit systems this limits the size of the cached file.
+
+  */
+  class OPENMS_DLLAPI SpectrumAccessOpenMSCachedMmap :
+    public OpenSwath::ISpectrumAccess
+  {
+
+public:
+    typedef OpenMS::MSExperiment<Peak1D> MSExperimentType;
+    typedef OpenMS::MSSpectrum<Peak1D> MSSpectrumType;
+
+    /**
+      @brief Zero-copy view on the data of a single spectrum or chromatogram
+
+      The view points directly into the mapped cache file and remains valid
+      as long as the SpectrumAccessOpenMSCachedMmap object it was obtained
+      from is alive. For spectra, the first array holds m/z values, for
+      chromatograms it holds retention times; the second array always holds
+      intensities.
+
+      The cached format does not guarantee that the arrays are aligned in
+      memory, therefore single values are accessed through getFirst() and
+      getSecond() which are safe for unaligned data. Random access to single
+      values is only possible for arrays stored as ENCODING_FLOAT64 or
+      ENCODING_FLOAT32, numpress compressed arrays have to be decoded with
+      copyTo().
+    */
+    struct DataView
+    {
+      /// Number of data points
+      Size size;
+      /// MS level (spectra only, -1 for chromatograms)
+      int ms_level;
+      /// Retention time (spectra only, -1 for chromatograms)
+      double rt;
+      /// Start of the first data array (m/z or RT) inside the mapped file
+      const char* first;
+      /// Start of the second data array (intensity) inside the mapped file
+      const char* second;
+      /// Size of the first and second data array in bytes
+      Size bytes_first;
+      Size bytes_second;
+      /// Encoding of the first and second data array
+      CachedmzML::BinaryDataEncoding encoding_first;
+      CachedmzML::BinaryDataEncoding encoding_second;
+
+      DataView() :
+        size(0),
+        ms_level(-1),
+        rt(-1.0),
+        first(0),
+        second(0),
+        bytes_first(0),
+        bytes_second(0),
+        encoding_first(CachedmzML::ENCODING_FLOAT64),
+        encoding_second(CachedmzML::ENCODING_FLOAT64)
+      {
+      }
+
+      /// Value of the first array (m/z or RT) at position @p i
+      inline double getFirst(Size i) const
+      {
+        return getValue_(first, encoding_first, i);
+      }
+
+      /// Value of the second array (intensity) at position @p i
+      inline double getSecond(Size i) const
+      {
+        return getValue_(second, encoding_second, i);
+      }
+
+      /// Copy (and decode) both arrays of the view into the provided containers
+      void copyTo(std::vector<double>& first_data, std::vector<double>& second_data) const
+      {
+        CachedmzML::decodeBinaryData(first, bytes_first, size, encoding_first, first_data);
+        CachedmzML::decodeBinaryData(second, bytes_second, size, encoding_second, second_data);
+      }
+
+  private:
+      static inline double getValue_(const char* data, CachedmzML::BinaryDataEncoding encoding, Size i)
+      {
+        OPENMS_PRECONDITION(encoding == CachedmzML::ENCODING_FLOAT64 || encoding == CachedmzML::ENCODING_FLOAT32,
+            "Random access is only possible for uncompressed data arrays");
+        if (encoding == CachedmzML::ENCODING_FLOAT32)
+        {
+          float value;
+          std::memcpy(&value, data + i * sizeof(float), sizeof(float));
+          return value;
+        }
+        double value;
+        std::memcpy(&value, data + i * sizeof(double), sizeof(double));
+        return value;
+      }
+    };
+
+    /**
+      @brief Constructor, maps the cached file into memory
+
+      @param filename The filename of the .mzML file (it is assumed a second
+      file .mzML.cached exists).
+
+      @throws Exception::FileNotFound is thrown if the file is not found
+      @throws Exception::ParseError is thrown if the file cannot be parsed
+    */
+    explicit SpectrumAccessOpenMSCachedMmap(String filename);
+
+    /**
+      @brief Destructor, unmaps the cached file
+    */
+    ~SpectrumAccessOpenMSCachedMmap();
+
+    OpenSwath::SpectrumPtr getSpectrumById(int id);
+
+    OpenSwath::SpectrumMeta getSpectrumMetaById(int id) const;
+
+    std::vector<std::size_t> getSpectraByRT(double RT, double deltaRT) const;
+
+    size_t getNrSpectra() const;
+
+    SpectrumSettings getSpectraMetaInfo(int id) const;
+
+    OpenSwath::ChromatogramPtr getChromatogramById(int id);
+
+    size_t getNrChromatograms() const;
+
+    ChromatogramSettings getChromatogramMetaInfo(int id) const;
+
+    std::string getChromatogramNativeID(int id) const;
+
+    /// Zero-copy access to the data of the spectrum at the given id
+    DataView getSpectrumViewById(int id) const;
+
+    /// Zero-copy access to the data of the chromatogram at the given id
+    DataView getChromatogramViewById(int id) const;
+
+private:
+
+    /// Copy constructor and assignment are not allowed (the mapping is owned by this object)
+    SpectrumAccessOpenMSCachedMmap(const SpectrumAccessOpenMSCachedMmap&);
+    SpectrumAccessOpenMSCachedMmap& operator=(const SpectrumAccessOpenMSCachedMmap&);
+
+    /// Walk the mapped file once (version 1) or read its index (version 2) and record the offset of each spectrum and chromatogram
+    void createIndex_();
+
+    /// Read the header of a data item at @p offset and check that it lies within the mapping
+    DataView readView_(Size offset, bool is_spectrum) const;
+
+    /// Read the header of a data item at @p offset of a version 2 file and check that it lies within the mapping
+    DataView readViewV2_(Size offset, bool is_spectrum) const;
+
+    /// Meta data
+    MSExperimentType meta_ms_experiment_;
+
+    /// Name of the mzML file
+    String filename_;
+
+    /// Name of the cached mzML file
+    String filename_cached_;
+
+    /// The file mapping and the mapped region (owned)
+    boost::shared_ptr<boost::interprocess::file_mapping> file_mapping_;
+    boost::shared_ptr<boost::interprocess::mapped_region> region_;
+
+    /// Start and size of the mapped data
+    const char* data_;
+    Size data_size_;
+
+    /// Version of the cached file format
+    int format_version_;
+
+    /// Byte offsets of all spectra and chromatograms inside the mapped file
+    std::vector<Size> spectra_offsets_;
+    std::vector<Size> chrom_offsets_;
+  };
+
+} //end namespace
+
+#endif
@@ -46,6 +46,13 @@ namespace OpenMS
   /**
       @brief Generates theoretical spectra with various options
 
+      If neither isotope peaks nor neutral losses are requested, the ion
+      series are computed from cumulative residue masses of the peptide in a
+      single pass (instead of a sum formula for every prefix and suffix).
+      Ion names are only generated if @p add_metainfo is set.
+
+      Spectra of many peptides can be generated in parallel using getSpectra().
+
   @htmlinclude OpenMS_TheoreticalSpectrumGenerator.parameters
 
       @ingroup Chemistry
@@ -77,6 +84,19 @@ public:
     /// returns a spectrum with b and y peaks
     virtual void getSpectrum(RichPeakSpectrum & spec, const AASequence & peptide, Int charge = 1);
 
+    /**
+      @brief Generates the spectra of several peptides (in parallel, if OpenMP is enabled)
+
+      The result is the same as calling getSpectrum() for each peptide, except
+      that copies of this generator are used (i.e. methods of derived classes
+      are not called).
+
+      @param spectra The spectra (same order as @p peptides; previous contents are removed)
+      @param peptides The peptides
+      @param charge Maximum charge of the ions
+    */
+    void getSpectra(std::vector<RichPeakSpectrum> & spectra, const std::vector<AASequence> & peptides, Int charge = 1) const;
+
     /// adds peaks to a spectrum of the given ion-type, peptide, charge, and intensity
     virtual void addPeaks(RichPeakSpectrum & spectrum, const AASequence & peptide, Residue::ResidueType res_type, Int charge = 1);
 
@@ -89,6 +109,38 @@ public:
 
 protected:
     RichPeak1D p_;
+
+    void updateMembers_();
+
+    /// adds the peaks of an ion series from cumulative residue masses (no isotopes or losses)
+    void addPeaksFast_(RichPeakSpectrum & spectrum, const AASequence & peptide, Residue::ResidueType res_type, Int charge, double intensity, char ion_letter);
+
+    /// @name Parameters (cached from param_ for speed)
+    //@{
+    bool add_b_ions_;
+    bool add_y_ions_;
+    bool add_a_ions_;
+    bool add_c_ions_;
+    bool add_x_ions_;
+    bool add_z_ions_;
+    bool add_first_prefix_ion_;
+    bool add_losses_;
+    bool add_metainfo_;
+    bool add_isotopes_;
+    bool add_precursor_peaks_;
+    bool add_abundant_immonium_ions_;
+    Int max_isotope_;
+    double a_intensity_;
+    double b_intensity_;
+    double c_intensity_;
+    double x_intensity_;
+    double y_intensity_;
+    double z_intensity_;
+    double rel_loss_intensity_;
+    double pre_int_;
+    double pre_int_H2O_;
+    double pre_int_NH3_;
+    //@}
   };
 }
 
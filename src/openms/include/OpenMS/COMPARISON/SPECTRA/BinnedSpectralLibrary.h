@@ -0,0 +1,168 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2013.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: David Wojnar $
+// $Authors: David Wojnar $
+// --------------------------------------------------------------------------
+
+#ifndef OPENMS_COMPARISON_SPECTRA_BINNEDSPECTRALLIBRARY_H
+#define OPENMS_COMPARISON_SPECTRA_BINNEDSPECTRALLIBRARY_H
+
+#include <OpenMS/KERNEL/StandardTypes.h>
+#include <OpenMS/DATASTRUCTURES/String.h>
+
+#include <utility>
+#include <vector>
+
+namespace OpenMS
+{
+
+  /**
+      @brief Library of binned, normalized spectra for fast SpectraST scoring
+
+      Each library spectrum is binned and normalized once when it is added,
+      exactly like SpectraSTSimilarityScore::transform() does it (bin size 1,
+      spread 1, unit length). Only the filled bins are kept, all spectra share
+      contiguous arrays of bin numbers and values (one row per spectrum).
+      After sortByPrecursorMZ(), the rows are ordered by precursor m/z, so all
+      candidates of a precursor window form one range (see findRange()).
+
+      A query is binned once into a dense vector (transformQuery()). Scoring a
+      candidate then is a single pass over its filled bins, which gathers the
+      matching query bins. The results are the same as
+      SpectraSTSimilarityScore::operator()() and
+      SpectraSTSimilarityScore::dot_bias() on the transformed spectra. All
+      const member functions may be called concurrently.
+
+      The library can be stored to and loaded from a binary file, together
+      with a signature string, e.g. describing the settings used to build it.
+
+      @ingroup SpectraComparison
+  */
+  class OPENMS_DLLAPI BinnedSpectralLibrary
+  {
+public:
+
+    /// default constructor (empty library)
+    BinnedSpectralLibrary();
+
+    /// destructor
+    virtual ~BinnedSpectralLibrary();
+
+    /// removes all spectra and the signature
+    void clear();
+
+    /**
+        @brief bins and normalizes @p spec and adds it with precursor @p precursor_mz
+
+        The spectrum can later be identified by getSpectrumIndex(), which
+        counts the added spectra starting with 0. Spectra without peaks are
+        added without bins.
+    */
+    void addSpectrum(const PeakSpectrum& spec, double precursor_mz);
+
+    /// sorts the spectra by precursor m/z (spectra with the same precursor keep their order)
+    void sortByPrecursorMZ();
+
+    /// number of spectra
+    Size size() const;
+
+    /// precursor m/z of the spectrum at position @p entry
+    double getPrecursorMZ(Size entry) const;
+
+    /// number of the spectrum at position @p entry in the order it was added
+    Size getSpectrumIndex(Size entry) const;
+
+    /// range [first, second) of positions with precursors in [@p min_mz, @p max_mz] (requires sortByPrecursorMZ())
+    std::pair<Size, Size> findRange(double min_mz, double max_mz) const;
+
+    /// bins and normalizes @p spec like addSpectrum() into the dense vector @p query (one value per bin, empty if @p spec has no peaks)
+    static void transformQuery(const PeakSpectrum& spec, std::vector<float>& query);
+
+    /// dot product of the spectrum at position @p entry and @p query
+    double dotProduct(Size entry, const std::vector<float>& query) const;
+
+    /// dot bias of the spectrum at position @p entry and @p query, see SpectraSTSimilarityScore::dot_bias()
+    double dotBias(Size entry, const std::vector<float>& query, double dot_product) const;
+
+    /**
+        @brief scores @p query against the spectra at positions [@p first, @p last) in parallel
+
+        @p dot_products and @p dot_biases are resized to the number of spectra.
+    */
+    void score(const std::vector<float>& query, Size first, Size last, std::vector<double>& dot_products, std::vector<double>& dot_biases) const;
+
+    /// sets the signature stored with the library
+    void setSignature(const String& signature);
+
+    /// returns the signature stored with the library
+    const String& getSignature() const;
+
+    /**
+        @brief stores the library in the binary file @p filename
+
+        @exception Exception::UnableToCreateFile is thrown if the file cannot be written
+    */
+    void store(const String& filename) const;
+
+    /**
+        @brief loads the library from the binary file @p filename
+
+        @exception Exception::FileNotFound is thrown if the file does not exist
+        @exception Exception::ParseError is thrown if the file is not a valid library
+    */
+    void load(const String& filename);
+
+    /// equality operator
+    bool operator==(const BinnedSpectralLibrary& rhs) const;
+
+protected:
+
+    /// precursor m/z of each spectrum
+    std::vector<double> precursor_mz_;
+
+    /// number of each spectrum in the order it was added
+    std::vector<UInt64> spectrum_index_;
+
+    /// start of the bins of each spectrum in @p bins_ and @p values_ (one more entry than spectra)
+    std::vector<UInt64> offsets_;
+
+    /// filled bins of all spectra (ascending for each spectrum)
+    std::vector<UInt> bins_;
+
+    /// normalized values of the filled bins
+    std::vector<float> values_;
+
+    /// signature stored with the library
+    String signature_;
+  };
+
+}
+#endif // OPENMS_COMPARISON_SPECTRA_BINNEDSPECTRALLIBRARY_H
@@ -41,6 +41,7 @@
 #include <OpenMS/CONCEPT/Exception.h>
 
 #include <cmath>
+#include <vector>
 
 namespace OpenMS
 {
@@ -72,6 +73,16 @@ private:
     float bin_size_;
     SparseVector<float> bins_;
 
+    /// positions of the filled bins (ascending), compact copy of @p bins_ for comparisons
+    mutable std::vector<UInt> filled_bins_;
+    /// intensities of the filled bins
+    mutable std::vector<float> filled_intensities_;
+    /// false if @p bins_ might have been modified after @p filled_bins_ was built
+    mutable bool filled_bins_valid_;
+
+    /// rebuilds the filled bins from @p bins_
+    void updateFilledBins_() const;
+
 public:
 
     /**
@@ -110,6 +121,9 @@ public:
         setBinSize(source.getBinSize());
         setBinSpread(source.getBinSpread());
         bins_ = source.getBins();
+        filled_bins_ = source.filled_bins_;
+        filled_intensities_ = source.filled_intensities_;
+        filled_bins_valid_ = source.filled_bins_valid_;
         MSSpectrum<>::operator=(source);
       }
       return *this;
@@ -194,6 +208,8 @@ public:
 
     /** mutable access to the Bincontainer
 
+            Modified bins are picked up by getFilledBins() and getFilledIntensities() on their next call.
+
             @throw NoSpectrumIntegrated is thrown if no spectrum was integrated
     */
     inline SparseVector<float> & getBins()
@@ -209,9 +225,48 @@ public:
           throw BinnedSpectrum::NoSpectrumIntegrated(__FILE__, __LINE__, __PRETTY_FUNCTION__);
         }
       }
+      filled_bins_valid_ = false;
       return bins_;
     }
 
+    /** positions of the filled bins in ascending order
+
+            This is an immutable, compact copy of the filled bins of getBins(), which the comparison
+            functors walk instead of the map. It is rebuilt on the first call after the bins were
+            modified, so do not call it concurrently on a spectrum whose bins were just modified.
+
+            @throw NoSpectrumIntegrated is thrown if no spectrum was integrated
+    */
+    inline const std::vector<UInt> & getFilledBins() const
+    {
+      if (bins_.empty())
+      {
+        throw BinnedSpectrum::NoSpectrumIntegrated(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+      }
+      if (!filled_bins_valid_)
+      {
+        updateFilledBins_();
+      }
+      return filled_bins_;
+    }
+
+    /** intensities of the filled bins, in the order of getFilledBins()
+
+            @throw NoSpectrumIntegrated is thrown if no spectrum was integrated
+    */
+    inline const std::vector<float> & getFilledIntensities() const
+    {
+      if (bins_.empty())
+      {
+        throw BinnedSpectrum::NoSpectrumIntegrated(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+      }
+      if (!filled_bins_valid_)
+      {
+        updateFilledBins_();
+      }
+      return filled_intensities_;
+    }
+
     /// returns the const begin iterator of the container
     inline const_bin_iterator begin() const
     {
@@ -227,12 +282,14 @@ public:
     /// returns the begin iterator of the container
     inline bin_iterator begin()
     {
+      filled_bins_valid_ = false;
       return bins_.begin();
     }
 
     /// returns the end iterator of the container
     inline bin_iterator end()
     {
+      filled_bins_valid_ = false;
       return bins_.end();
     }
 
@@ -185,7 +185,7 @@ public:
 
     inline bool isInvalid() {return !valid_;}
 
-    NeighborMap getNeighbors() {return neighbors_;}
+    const NeighborMap & getNeighbors() const {return neighbors_;}
 
   };
 }
@@ -36,6 +36,7 @@
 #define OPENMS_DATASTRUCTURES_SPARSEVECTOR_H
 
 #include <map>
+#include <vector>
 #include <algorithm>
 #include <stdexcept>
 #include <cassert>
@@ -182,6 +183,26 @@ public:
       return size_;
     }
 
+    /**
+        @brief copies the non-sparse elements into two sorted arrays
+
+        After the call, @p positions holds the positions of all non-sparse elements in ascending order and
+        @p values their values. These arrays can be walked much faster than the map, e.g. for merging two vectors.
+    */
+    template <typename PositionType>
+    void getNonSparseElements(std::vector<PositionType> & positions, std::vector<Value> & values) const
+    {
+      positions.clear();
+      values.clear();
+      positions.reserve(values_.size());
+      values.reserve(values_.size());
+      for (map_const_iterator it = values_.begin(); it != values_.end(); ++it)
+      {
+        positions.push_back((PositionType)it->first);
+        values.push_back(it->second);
+      }
+    }
+
     /// true if the container is empty
     bool empty() const
     {
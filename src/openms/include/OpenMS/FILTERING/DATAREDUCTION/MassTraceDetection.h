@@ -51,6 +51,14 @@ namespace OpenMS
   peaks. The extension phase ends when the frequency of gathered peaks drops below a
   threshold (min_sample_rate, see @ref MassTraceDetection parameters).
 
+  The peaks are kept in a compact table (one m/z and intensity array for all
+  spectra plus an offset per spectrum) and the apices in an array sorted by
+  intensity. Apices are extended in parallel in blocks: every extension is
+  computed against the peaks used by the previous blocks and then accepted
+  in order of decreasing apex intensity. An extension which gathered a peak
+  that was used by a more intense trace of the same block is recomputed, the
+  result is thus identical to a serial extension.
+
   @htmlinclude OpenMS_MassTraceDetection.parameters
 
   @ingroup Quantitation
@@ -71,7 +79,7 @@ public:
     /** @name Helper methods
         */
     /// Allows the iterative computation of the intensity-weighted mean of a mass trace's centroid m/z.
-    void updateIterativeWeightedMeanMZ(const double &, const double &, double &, double &, double &);
+    void updateIterativeWeightedMeanMZ(const double &, const double &, double &, double &, double &) const;
 
     /// Computes a rough estimate of the average peak width of the experiment (median) and an estimate of a lower and upper bound for the peak width (+/-2*MAD, median of absolute deviancies).
     // void filterByPeakWidth(std::vector<MassTrace>&, std::vector<MassTrace>&);
@@ -88,6 +96,14 @@ protected:
     virtual void updateMembers_();
 
 private:
+    /// the MS1 peaks above the noise threshold (defined in the .cpp)
+    struct PeakTable_;
+    /// the result of extending a single apex (defined in the .cpp)
+    struct TraceCandidate_;
+
+    /// extends the apex (global index in the peak table) in both directions of RT, ignoring peaks that were already used
+    void extendTrace_(const PeakTable_ & peaks, Size apex_scan_idx, Size apex_idx, TraceCandidate_ & candidate) const;
+
     // parameter stuff
     double mass_error_ppm_;
     double noise_threshold_int_;
@@ -42,7 +42,9 @@
 
 #include <vector>
 #include <cmath>
-#include <map>
+#include <algorithm>
+#include <functional>
+#include <iterator>
 
 namespace OpenMS
 {
@@ -51,6 +53,10 @@ namespace OpenMS
 
     A signal to noise estimator should provide the signal to noise ratio of all raw data points
     in a given interval [first_,last_).
+
+    The estimates are stored in a vector aligned with the interval, i.e. the estimate of the i-th
+    data point after @p first_ is at index i. Lookups by iterator (or by a peak of the container
+    itself) take constant time for containers with contiguous storage (like MSSpectrum).
   */
 
   template <typename Container = MSSpectrum<> >
@@ -134,9 +140,11 @@ public:
         init(first_, last_);
       }
 
-      return stn_estimates_[*data_point];
+      return getSignalToNoiseAt(std::distance(first_, data_point));
     }
 
+    /// Return to signal/noise estimate for data point @p data_point
+    /// @note Peaks that are not part of the container are looked up by position (binary search)
     virtual double getSignalToNoise(const PeakType & data_point)
     {
       if (!is_result_valid_)
@@ -145,7 +153,31 @@ public:
         init(first_, last_);
       }
 
-      return stn_estimates_[data_point];
+      return getSignalToNoiseAt(findIndex_(data_point));
+    }
+
+    /// Return to signal/noise estimate for the data point with index @p index in the interval given to init() (0 if out of range)
+    double getSignalToNoiseAt(Size index)
+    {
+      if (!is_result_valid_)
+      {
+        // recompute ...
+        init(first_, last_);
+      }
+
+      return index < stn_estimates_.size() ? stn_estimates_[index] : 0.0;
+    }
+
+    /// Return all signal/noise estimates, aligned with the interval given to init()
+    const std::vector<double> & getSignalToNoiseEstimates()
+    {
+      if (!is_result_valid_)
+      {
+        // recompute ...
+        init(first_, last_);
+      }
+
+      return stn_estimates_;
     }
 
 protected:
@@ -202,10 +234,42 @@ protected:
       return value;
     }
 
+    /// returns the index of @p data_point in the interval (or an index out of range if it is not found)
+    Size findIndex_(const PeakType & data_point) const
+    {
+      if (stn_estimates_.empty())
+      {
+        return 0;
+      }
+
+      // most callers pass a peak of the container itself
+      const PeakType * begin = &(*first_);
+      std::less<const PeakType *> less;
+      if (!less(&data_point, begin) && less(&data_point, begin + stn_estimates_.size()))
+      {
+        Size index = &data_point - begin;
+        PeakIterator it = first_;
+        std::advance(it, index);
+        if (&(*it) == &data_point)
+        {
+          return index;
+        }
+      }
+
+      // otherwise, look for a peak at the same position
+      typename PeakType::PositionLess position_less;
+      PeakIterator it = std::lower_bound(first_, last_, data_point, position_less);
+      if (it != last_ && !position_less(data_point, *it))
+      {
+        return std::distance(first_, it);
+      }
+      return stn_estimates_.size();
+    }
+
     //MEMBERS:
 
-    /// stores the noise estimate for each peak
-    std::map<PeakType, double, typename PeakType::PositionLess> stn_estimates_;
+    /// stores the noise estimate for each peak (same order as the peaks)
+    std::vector<double> stn_estimates_;
 
     /// points to the first raw data point in the interval
     PeakIterator first_;
@@ -371,7 +371,7 @@ protected:
         }
 
         // store result
-        stn_estimates_[*window_pos_center] = (*window_pos_center).getIntensity() / noise;
+        stn_estimates_.push_back((*window_pos_center).getIntensity() / noise);
 
 
 
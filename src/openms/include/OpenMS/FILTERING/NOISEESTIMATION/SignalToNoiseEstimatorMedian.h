@@ -60,6 +60,11 @@ namespace OpenMS
 
     Changing any of the parameters will invalidate the S/N values (which will invoke a recomputation on the next request).
 
+    The histogram bins of all data points are determined in one pass, and the bin of the median is
+    tracked while the window slides (instead of being searched from the first bin for every window).
+    The buffers are kept between calls of init(), so estimating many spectra with one object does not
+    reallocate them.
+
     @note If more than 20 percent of windows have less than <i>min_required_elements</i> of elements, a warning is issued to <i>stderr</i> and noise estimates in those windows are set to the constant <i>noise_for_empty_window</i>.
     @note If more than 1 percent of median estimations had to rely on the last(=rightmost) bin (which gives an unreliable result), a warning is issued to <i>stderr</i>.
 
@@ -255,29 +260,39 @@ protected:
         return;
       }
 
-      PeakIterator window_pos_center  = scan_first_;
-      PeakIterator window_pos_borderleft = scan_first_;
-      PeakIterator window_pos_borderright = scan_first_;
-
       double window_half_size = win_len_ / 2;
       double bin_size = std::max(1.0, max_intensity_ / bin_count_); // at least size of 1 for intensity bins
       int bin_count_minus_1 = bin_count_ - 1;
 
-      std::vector<int> histogram(bin_count_, 0);
-      std::vector<double> bin_value(bin_count_, 0);
+      histogram_.assign(bin_count_, 0);
+      bin_value_.resize(bin_count_);
       // calculate average intensity that is represented by a bin
       for (int bin = 0; bin < bin_count_; bin++)
       {
-        histogram[bin] = 0;
-        bin_value[bin] = (bin + 0.5) * bin_size;
+        bin_value_[bin] = (bin + 0.5) * bin_size;
       }
-      // bin in which a datapoint would fall
-      int to_bin = 0;
+
+      // bin in which each datapoint falls, and its m/z
+      bins_.clear();
+      mzs_.clear();
+      for (PeakIterator run = scan_first_; run != scan_last_; ++run)
+      {
+        bins_.push_back(std::max(std::min<int>((int)((*run).getIntensity() / bin_size), bin_count_minus_1), 0));
+        mzs_.push_back((*run).getMZ());
+      }
+
+      // number of windows (one per datapoint)
+      int windows_overall = (int)bins_.size();
+      stn_estimates_.reserve(windows_overall);
+
+      // window borders (indices): [window_borderleft, window_borderright)
+      int window_borderleft = 0;
+      int window_borderright = 0;
 
       // index of bin where the median is located
       int median_bin = 0;
-      // additive number of elements from left to x in histogram
-      int element_inc_count = 0;
+      // number of elements in the bins left of median_bin
+      int elements_below_median_bin = 0;
 
       // tracks elements in current window, which may vary because of unevenly spaced data
       int elements_in_window = 0;
@@ -289,38 +304,31 @@ protected:
 
       double noise;    // noise value of a datapoint
 
-      // determine how many elements we need to estimate (for progress estimation)
-      int windows_overall = 0;
-      PeakIterator run = scan_first_;
-      while (run != scan_last_)
-      {
-        ++windows_overall;
-        ++run;
-      }
       SignalToNoiseEstimator<Container>::startProgress(0, windows_overall, "noise estimation of data");
 
       // MAIN LOOP
-      while (window_pos_center != scan_last_)
+      PeakIterator window_pos_center = scan_first_;
+      for (int center = 0; center < windows_overall; ++center, ++window_pos_center)
       {
-
         // erase all elements from histogram that will leave the window on the LEFT side
-        while ((*window_pos_borderleft).getMZ() <  (*window_pos_center).getMZ() - window_half_size)
+        while (mzs_[window_borderleft] <  mzs_[center] - window_half_size)
         {
-          to_bin = std::max(std::min<int>((int)((*window_pos_borderleft).getIntensity() / bin_size), bin_count_minus_1), 0);
-          --histogram[to_bin];
+          int to_bin = bins_[window_borderleft];
+          --histogram_[to_bin];
+          if (to_bin < median_bin) --elements_below_median_bin;
           --elements_in_window;
-          ++window_pos_borderleft;
+          ++window_borderleft;
         }
 
         // add all elements to histogram that will enter the window on the RIGHT side
-        while ((window_pos_borderright != scan_last_)
-              && ((*window_pos_borderright).getMZ() <= (*window_pos_center).getMZ() + window_half_size))
+        while ((window_borderright != windows_overall)
+              && (mzs_[window_borderright] <= mzs_[center] + window_half_size))
         {
-          //std::cerr << (*window_pos_borderright).getIntensity() << " " << bin_size << " " << bin_count_minus_1 << std::endl;
-          to_bin = std::max(std::min<int>((int)((*window_pos_borderright).getIntensity() / bin_size), bin_count_minus_1), 0);
-          ++histogram[to_bin];
+          int to_bin = bins_[window_borderright];
+          ++histogram_[to_bin];
+          if (to_bin < median_bin) ++elements_below_median_bin;
           ++elements_in_window;
-          ++window_pos_borderright;
+          ++window_borderright;
         }
 
         if (elements_in_window < min_required_elements_)
@@ -330,34 +338,36 @@ protected:
         }
         else
         {
-          // find bin i where ceil[elements_in_window/2] <= sum_c(0..i){ histogram[c] }
-          median_bin = -1;
-          element_inc_count = 0;
+          // find the first bin i where ceil[elements_in_window/2] <= sum_c(0..i){ histogram[c] }
+          // (or the last bin), starting from the median bin of the previous window
           element_in_window_half = (elements_in_window + 1) / 2;
-          while (median_bin < bin_count_minus_1 && element_inc_count < element_in_window_half)
+          while (median_bin > 0 && elements_below_median_bin >= element_in_window_half)
           {
+            --median_bin;
+            elements_below_median_bin -= histogram_[median_bin];
+          }
+          while (median_bin < bin_count_minus_1 && elements_below_median_bin + histogram_[median_bin] < element_in_window_half)
+          {
+            elements_below_median_bin += histogram_[median_bin];
             ++median_bin;
-            element_inc_count += histogram[median_bin];
           }
 
           // increase the error count
           if (median_bin == bin_count_minus_1) {++histogram_oob_percent; }
 
           // just avoid division by 0
-          noise = std::max(1.0, bin_value[median_bin]);
+          noise = std::max(1.0, bin_value_[median_bin]);
         }
 
         // store result
-        stn_estimates_[*window_pos_center] = (*window_pos_center).getIntensity() / noise;
-
+        stn_estimates_.push_back((*window_pos_center).getIntensity() / noise);
 
         // advance the window center by one datapoint
-        ++window_pos_center;
         ++window_count;
         // update progress
         SignalToNoiseEstimator<Container>::setProgress(window_count);
 
-      } // end while
+      } // end for
 
       SignalToNoiseEstimator<Container>::endProgress();
 
@@ -417,6 +427,15 @@ protected:
     /// use a very high value if you want to get a low S/N result
     double noise_for_empty_window_;
 
+    /// histogram of the current window (buffer, kept between calls)
+    std::vector<int> histogram_;
+    /// average intensity that is represented by a bin (buffer, kept between calls)
+    std::vector<double> bin_value_;
+    /// histogram bin of each data point (buffer, kept between calls)
+    std::vector<int> bins_;
+    /// m/z of each data point (buffer, kept between calls)
+    std::vector<double> mzs_;
+
 
 
   };
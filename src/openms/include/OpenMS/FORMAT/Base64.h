@@ -49,6 +49,7 @@
 #include <algorithm>
 #include <iterator>
 #include <cmath>
+#include <cstring>
 #include <vector>
 
 #include <QByteArray>
@@ -167,6 +168,29 @@ private:
 
     static const char encoder_[];
     static const char decoder_[];
+
+    /// Upper bound of the number of bytes encoded in @p in_size Base64 characters
+    static inline Size maxDecodedSize_(Size in_size)
+    {
+      return (in_size / 4) * 3 + 3;
+    }
+
+    /**
+      @brief Decodes Base64 characters into raw bytes
+
+      Characters outside of the Base64 alphabet (e.g. whitespace) are skipped,
+      decoding stops at the first padding character.
+
+      @param in The Base64 encoded data
+      @param in_size Number of characters in @p in
+      @param out Output buffer, has to hold at least maxDecodedSize_(in_size) bytes
+
+      @return The number of decoded bytes
+    */
+    static Size decodeBase64Raw_(const char * in, Size in_size, unsigned char * out);
+
+    /// Reverses the byte order of @p count elements of @p element_size (4 or 8) bytes in place
+    static void swapByteOrder_(unsigned char * data, Size count, Size element_size);
     /// Decodes a Base64 string to a vector of floating point numbers
     template <typename ToType>
     void decodeUncompressed_(const String & in, ByteOrder from_byte_order, std::vector<ToType> & out);
@@ -350,98 +374,64 @@ private:
     if (in == "")
       return;
 
-    void * byte_buffer;
-    Size buffer_size;
-    std::vector<unsigned char> binary;
     const Size element_size = sizeof(ToType);
 
-    String decompressed;
+    // decode Base64 into a local buffer holding the zlib stream (Base64 objects
+    // are shared between threads, e.g. by MzXMLHandler, so no member is used)
+    std::vector<unsigned char> buffer(maxDecodedSize_(in.size()));
+    Size compressed_size = decodeBase64Raw_(in.c_str(), in.size(), &buffer[0]);
 
-    QByteArray qt_byte_array = QByteArray::fromRawData(in.c_str(), (int) in.size());
-    QByteArray bazip = QByteArray::fromBase64(qt_byte_array);
-    QByteArray czip;
-    czip.resize(4);
-    czip[0] = (bazip.size() & 0xff000000) >> 24;
-    czip[1] = (bazip.size() & 0x00ff0000) >> 16;
-    czip[2] = (bazip.size() & 0x0000ff00) >> 8;
-    czip[3] = (bazip.size() & 0x000000ff);
-    czip += bazip;
-    QByteArray base64_uncompressed = qUncompress(czip);
-
-    if (base64_uncompressed.isEmpty())
+    // inflate directly into the storage of the output vector, which is grown
+    // as needed (the compression ratio is not known in advance)
+    z_stream stream;
+    std::memset(&stream, 0, sizeof(stream));
+    if (inflateInit(&stream) != Z_OK)
     {
       throw Exception::ConversionError(__FILE__, __LINE__, __PRETTY_FUNCTION__, "Decompression error?");
     }
-    decompressed.resize(base64_uncompressed.size());
-
-    std::copy(base64_uncompressed.begin(), base64_uncompressed.end(), decompressed.begin());
-
-    byte_buffer = reinterpret_cast<void *>(&decompressed[0]);
-    buffer_size = decompressed.size();
+    stream.next_in = reinterpret_cast<Bytef *>(&buffer[0]);
+    stream.avail_in = (uInt) compressed_size;
 
-    //change endianness if necessary
-    if ((OPENMS_IS_BIG_ENDIAN && from_byte_order == Base64::BYTEORDER_LITTLEENDIAN) || (!OPENMS_IS_BIG_ENDIAN && from_byte_order == Base64::BYTEORDER_BIGENDIAN))
+    out.resize(std::max<Size>(4 * compressed_size / element_size, 16));
+    int zlib_error = Z_OK;
+    while (zlib_error != Z_STREAM_END)
     {
-      if (element_size == 4)
+      if (stream.total_out == out.size() * element_size)
       {
-        const float * float_buffer = reinterpret_cast<const float *>(byte_buffer);
-        if (buffer_size % element_size != 0)
-          throw Exception::ConversionError(__FILE__, __LINE__, __PRETTY_FUNCTION__, "Bad BufferCount?");
-        Size float_count = buffer_size / element_size;
-        Int32 * p = reinterpret_cast<Int32 *>(byte_buffer);
-        std::transform(p, p + float_count, p, endianize32);
-        out.assign(float_buffer, float_buffer + float_count);
+        out.resize(2 * out.size());
       }
-      else
-      {
-        const double * float_buffer = reinterpret_cast<const double *>(byte_buffer);
-
-        if (buffer_size % element_size != 0)
-          throw Exception::ConversionError(__FILE__, __LINE__, __PRETTY_FUNCTION__, "Bad BufferCount?");
-
-        Size float_count = buffer_size / element_size;
+      stream.next_out = reinterpret_cast<Bytef *>(&out[0]) + stream.total_out;
+      stream.avail_out = (uInt)(out.size() * element_size - stream.total_out);
 
-        Int64 * p = reinterpret_cast<Int64 *>(byte_buffer);
-        std::transform(p, p + float_count, p, endianize64);
-
-        out.resize(float_count);
-        // do NOT use assign here, as it will give a lot of type conversion warnings on VS compiler
-        for (Size i = 0; i < float_count; ++i)
-        {
-          out[i] = (ToType) * float_buffer;
-          ++float_buffer;
-        }
-      }
-    }
-    else
-    {
-      if (element_size == 4)
+      zlib_error = inflate(&stream, Z_NO_FLUSH);
+      if ((zlib_error != Z_OK && zlib_error != Z_STREAM_END) || (zlib_error == Z_OK && stream.avail_in == 0 && stream.avail_out != 0))
       {
-        const float * float_buffer = reinterpret_cast<const float *>(byte_buffer);
-        if (buffer_size % element_size != 0)
-          throw Exception::ConversionError(__FILE__, __LINE__, __PRETTY_FUNCTION__, "Bad BufferCount while decoding?");
-
-        Size float_count = buffer_size / element_size;
-        out.assign(float_buffer, float_buffer + float_count);
+        // corrupt or truncated stream
+        inflateEnd(&stream);
+        out.clear();
+        throw Exception::ConversionError(__FILE__, __LINE__, __PRETTY_FUNCTION__, "Decompression error?");
       }
-      else
-      {
-        const double * float_buffer = reinterpret_cast<const double *>(byte_buffer);
-
-        if (buffer_size % element_size != 0)
-          throw Exception::ConversionError(__FILE__, __LINE__, __PRETTY_FUNCTION__, "Bad BufferCount while decoding?");
+    }
+    Size buffer_size = stream.total_out;
+    inflateEnd(&stream);
 
-        Size float_count = buffer_size / element_size;
-        out.resize(float_count);
-        // do NOT use assign here, as it will give a lot of type conversion warnings on VS compiler
-        for (Size i = 0; i < float_count; ++i)
-        {
-          out[i] = (ToType) * float_buffer;
-          ++float_buffer;
-        }
-      }
+    if (buffer_size == 0)
+    {
+      out.clear();
+      throw Exception::ConversionError(__FILE__, __LINE__, __PRETTY_FUNCTION__, "Decompression error?");
+    }
+    if (buffer_size % element_size != 0)
+    {
+      out.clear();
+      throw Exception::ConversionError(__FILE__, __LINE__, __PRETTY_FUNCTION__, "Bad BufferCount while decoding?");
     }
+    out.resize(buffer_size / element_size);
 
+    //change endianness if necessary
+    if ((OPENMS_IS_BIG_ENDIAN && from_byte_order == Base64::BYTEORDER_LITTLEENDIAN) || (!OPENMS_IS_BIG_ENDIAN && from_byte_order == Base64::BYTEORDER_BIGENDIAN))
+    {
+      swapByteOrder_(reinterpret_cast<unsigned char *>(&out[0]), out.size(), element_size);
+    }
   }
 
   template <typename ToType>
@@ -451,89 +441,18 @@ private:
     if (in == "")
       return;
 
-    Size src_size = in.size();
-    // last one or two '=' are skipped if contained
-    int padding = 0;
-    if (in[src_size - 1] == '=')
-      padding++;
-    if (in[src_size - 2] == '=')
-      padding++;
-
-    src_size -= padding;
-
-    register UInt a;
-    register UInt b;
-
-    UInt offset = 0;
-    int inc = 1;
-    UInt written = 0;
-
     const Size element_size = sizeof(ToType);
 
-    // enough for either float or double
-    char element[8] = "\x00\x00\x00\x00\x00\x00\x00";
-
-    if ((OPENMS_IS_BIG_ENDIAN && from_byte_order == Base64::BYTEORDER_LITTLEENDIAN) || (!OPENMS_IS_BIG_ENDIAN && from_byte_order == Base64::BYTEORDER_BIGENDIAN))
-    {
-      offset = (element_size - 1);              // other endian
-      inc = -1;
-    }
-    else
-    {
-      offset = 0;
-      inc = 1;
-    }
-
-    //reserve enough space in the output vector
-    out.reserve((UInt)(std::ceil((4.0 * src_size) / 3.0) + 6.0));
+    // decode directly into the storage of the output vector, incomplete
+    // trailing elements are discarded
+    out.resize(maxDecodedSize_(in.size()) / element_size + 1);
+    Size buffer_size = decodeBase64Raw_(in.c_str(), in.size(), reinterpret_cast<unsigned char *>(&out[0]));
+    out.resize(buffer_size / element_size);
 
-    // sort all read bytes correctly into a char[4] (double) or
-    // char[8] (float) and push_back when necessary.
-    for (Size i = 0; i < src_size; i += 4)
+    //change endianness if necessary
+    if (!out.empty() && ((OPENMS_IS_BIG_ENDIAN && from_byte_order == Base64::BYTEORDER_LITTLEENDIAN) || (!OPENMS_IS_BIG_ENDIAN && from_byte_order == Base64::BYTEORDER_BIGENDIAN)))
     {
-      // decode 4 Base64-Chars to 3 Byte
-      a = decoder_[(int)in[i] - 43] - 62;
-      b = decoder_[(int)in[i + 1] - 43] - 62;
-      if (i + 1 >= src_size)
-        b = 0;
-      element[offset] = (unsigned char) ((a << 2) | (b >> 4));
-      written++;
-      offset = (offset + inc) % element_size;
-
-      if (written % element_size == 0)
-      {
-        ToType * to_type = reinterpret_cast<ToType *>(&element[0]);
-        out.push_back((*to_type));
-        strcpy(element, "");
-      }
-
-      a = decoder_[(int)in[i + 2] - 43] - 62;
-      if (i + 2 >= src_size)
-        a = 0;
-      element[offset] = (unsigned char) (((b & 15) << 4) | (a >> 2));
-      written++;
-      offset = (offset + inc) % element_size;
-
-      if (written % element_size == 0)
-      {
-        ToType * to_type = reinterpret_cast<ToType *>(&element[0]);
-        out.push_back((*to_type));
-        strcpy(element, "");
-      }
-
-      b = decoder_[(int)in[i + 3] - 43] - 62;
-      if (i + 3 >= src_size)
-        b = 0;
-      element[offset] = (unsigned char) (((a & 3) << 6) | b);
-      written++;
-      offset = (offset + inc) % element_size;
-
-      if (written % element_size == 0)
-      {
-        ToType * to_type = reinterpret_cast<ToType *>(&element[0]);
-        out.push_back((*to_type));
-        strcpy(element, "");
-      }
+      swapByteOrder_(reinterpret_cast<unsigned char *>(&out[0]), out.size(), element_size);
     }
   }
 
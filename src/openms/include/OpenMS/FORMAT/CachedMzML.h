@@ -46,6 +46,7 @@
 #include <fstream>
 
 #define CACHED_MZML_FILE_IDENTIFIER 8093
+#define CACHED_MZML_FILE_IDENTIFIER_V2 8094
 
 namespace OpenMS
 {
@@ -58,6 +59,22 @@ namespace OpenMS
     be very fast and done in random order (once the in-memory index is built
     for the file).
 
+    Two versions of the binary format exist:
+
+    - Version 1 (identifier CACHED_MZML_FILE_IDENTIFIER) stores both data
+      arrays of each item as 8 byte doubles. The number of spectra and
+      chromatograms is stored at the end of the file, the index has to be
+      built by walking through the complete file.
+    - Version 2 (identifier CACHED_MZML_FILE_IDENTIFIER_V2) stores each data
+      array with a configurable BinaryDataEncoding (e.g. intensities as 4
+      byte floats or numpress compressed) and appends an index with the
+      offset, retention time and MS level of every item, such that opening a
+      file only requires reading its footer. All arrays are padded to 8 bytes,
+      arrays stored as ENCODING_FLOAT64 are therefore 8 byte aligned.
+
+    Both versions can be read, the version used for writing is set with
+    setFormatVersion() (default is version 1).
+
   */
   class OPENMS_DLLAPI CachedmzML :
     public ProgressLogger
@@ -76,6 +93,58 @@ public:
 
     typedef std::vector<DatumSingleton> Datavector;
 
+    /// Encoding of a single binary data array (format version 2 only)
+    enum BinaryDataEncoding
+    {
+      ENCODING_FLOAT64,         ///< 8 byte IEEE floating point numbers (lossless)
+      ENCODING_FLOAT32,         ///< 4 byte IEEE floating point numbers
+      ENCODING_NUMPRESS_LINEAR, ///< MS-Numpress linear prediction compression (suitable for m/z and RT)
+      ENCODING_NUMPRESS_SLOF,   ///< MS-Numpress short logged float compression (suitable for intensities)
+      ENCODING_NUMPRESS_PIC,    ///< MS-Numpress positive integer compression (suitable for intensities)
+      SIZE_OF_BINARYDATAENCODING
+    };
+
+    /// Names of the binary data encodings
+    static const std::string NamesOfBinaryDataEncoding[SIZE_OF_BINARYDATAENCODING];
+
+    /**
+      @brief Header of a single spectrum or chromatogram (format version 2)
+
+      Each data item starts with this header, followed by the first (m/z or
+      RT) and the second (intensity) data array, each padded to a multiple of
+      8 bytes.
+    */
+    struct OPENMS_DLLAPI RecordHeader
+    {
+      UInt64 size;          ///< number of data points
+      UInt64 bytes_first;   ///< size of the encoded first array in bytes (without padding)
+      UInt64 bytes_second;  ///< size of the encoded second array in bytes (without padding)
+      double rt;            ///< retention time (-1 for chromatograms)
+      Int32 ms_level;       ///< MS level (-1 for chromatograms)
+      Byte encoding_first;  ///< BinaryDataEncoding of the first array
+      Byte encoding_second; ///< BinaryDataEncoding of the second array
+      Byte reserved[2];
+    };
+
+    /// Entry of the index stored at the end of a version 2 file (one per spectrum and chromatogram)
+    struct OPENMS_DLLAPI IndexEntry
+    {
+      UInt64 offset;        ///< position of the RecordHeader in the file
+      double rt;            ///< retention time (-1 for chromatograms)
+      Int32 ms_level;       ///< MS level (-1 for chromatograms)
+      Int32 reserved;
+    };
+
+    /// Trailer at the very end of a version 2 file
+    struct OPENMS_DLLAPI Trailer
+    {
+      UInt64 index_offset;     ///< position of the first IndexEntry in the file
+      UInt64 nr_spectra;       ///< number of spectra
+      UInt64 nr_chromatograms; ///< number of chromatograms
+      Int32 identifier;        ///< CACHED_MZML_FILE_IDENTIFIER_V2 (to detect truncated files)
+      Int32 reserved;
+    };
+
     /** @name Constructors and Destructor
     */
     //@{
@@ -89,6 +158,37 @@ public:
     CachedmzML& operator=(const CachedmzML& rhs);
     //@}
 
+    /** @name Format options for writing
+    */
+    //@{
+    /**
+      @brief Set the version of the binary format used for writing (1 or 2)
+
+      @throws Exception::InvalidValue if the version is not supported
+    */
+    void setFormatVersion(int version);
+
+    /// Version of the binary format used for writing (after createMemdumpIndex: version of the indexed file)
+    int getFormatVersion() const;
+
+    /**
+      @brief Set the encoding of the data arrays used for writing format version 2
+
+      @param first_encoding Encoding of the m/z (spectra) and retention time (chromatograms) arrays
+      @param intensity_encoding Encoding of the intensity arrays
+
+      If an array cannot be represented with the requested numpress encoding
+      it is stored as ENCODING_FLOAT64 instead.
+    */
+    void setDataEncoding(BinaryDataEncoding first_encoding, BinaryDataEncoding intensity_encoding);
+
+    /// Encoding of the m/z and retention time arrays used for writing
+    BinaryDataEncoding getFirstDataEncoding() const;
+
+    /// Encoding of the intensity arrays used for writing
+    BinaryDataEncoding getIntensityDataEncoding() const;
+    //@}
+
     /** @name Read / Write a complete mass spectrometric experiment (or its meta data)
     */
     //@{
@@ -106,7 +206,12 @@ public:
     /** @name Access and creation of the binary indices
     */
     //@{
-    /// Create an index on the location of all the spectra and chromatograms
+    /**
+      @brief Create an index on the location of all the spectra and chromatograms
+
+      For format version 2, the index is read from the end of the file.
+      Otherwise the complete file is traversed.
+    */
     void createMemdumpIndex(String filename);
 
     /// Access to a constant copy of the binary spectra index
@@ -114,6 +219,12 @@ public:
 
     /// Access to a constant copy of the binary chromatogram index
     const std::vector<std::streampos>& getChromatogramIndex() const;
+
+    /// Retention times of all spectra (available after createMemdumpIndex)
+    const std::vector<double>& getSpectraRT() const;
+
+    /// MS levels of all spectra (available after createMemdumpIndex)
+    const std::vector<int>& getSpectraMSLevel() const;
     //@}
 
     /** @name Direct access to a single Spectrum or Chromatogram
@@ -123,12 +234,20 @@ public:
     /**
       @brief fast access to a spectrum (a direct copy of the data into the provided arrays)
 
+      @param format_version The version of the file the stream belongs to (see getFormatVersion)
+
       @throws Exception::ParseError is thrown if the spectrum size cannot be read
     */
     static inline void readSpectrumFast(OpenSwath::BinaryDataArrayPtr data1,
                                         OpenSwath::BinaryDataArrayPtr data2, std::ifstream& ifs, int& ms_level,
-                                        double& rt)
+                                        double& rt, int format_version = 1)
     {
+      if (format_version == 2)
+      {
+        readRecordV2_(data1->data, data2->data, ifs, ms_level, rt, "spectrum");
+        return;
+      }
+
       Size spec_size = -1;
       ifs.read((char*) &spec_size, sizeof(spec_size));
       ifs.read((char*) &ms_level, sizeof(ms_level));
@@ -153,11 +272,22 @@ public:
     /**
       @brief fast access to a chromatogram (a direct copy of the data into the provided arrays)
 
+      @param format_version The version of the file the stream belongs to (see getFormatVersion)
+
       @throws Exception::ParseError is thrown if the chromatogram size cannot be read
     */
     static inline void readChromatogramFast(OpenSwath::BinaryDataArrayPtr data1,
-                                            OpenSwath::BinaryDataArrayPtr data2, std::ifstream& ifs)
+                                            OpenSwath::BinaryDataArrayPtr data2, std::ifstream& ifs,
+                                            int format_version = 1)
     {
+      if (format_version == 2)
+      {
+        int ms_level;
+        double rt;
+        readRecordV2_(data1->data, data2->data, ifs, ms_level, rt, "chromatogram");
+        return;
+      }
+
       Size spec_size = -1;
       ifs.read((char*) &spec_size, sizeof(spec_size));
 
@@ -174,6 +304,38 @@ public:
     }
     //@}
 
+    /** @name Encoding and decoding of single data arrays (format version 2)
+    */
+    //@{
+    /**
+      @brief Encode a data array
+
+      @param in The data to encode
+      @param encoding The requested encoding, set to ENCODING_FLOAT64 if the data cannot be numpress encoded
+      @param out The encoded bytes
+    */
+    static void encodeBinaryData(const Datavector& in, BinaryDataEncoding& encoding, std::vector<char>& out);
+
+    /**
+      @brief Decode a data array
+
+      @param in Start of the encoded data
+      @param in_bytes Size of the encoded data in bytes
+      @param size Number of data points encoded in @p in
+      @param encoding The encoding of the data
+      @param out The decoded data
+
+      @throws Exception::ParseError if the data cannot be decoded
+    */
+    static void decodeBinaryData(const char* in, Size in_bytes, Size size, BinaryDataEncoding encoding, Datavector& out);
+
+    /// Number of bytes an encoded array of @p bytes occupies on disk (including padding)
+    static inline Size paddedSize(Size bytes)
+    {
+      return (bytes + 7) & ~static_cast<Size>(7);
+    }
+    //@}
+
 protected:
 
     /// read a single spectrum directly into a datavector (assuming file is already at the correct position)
@@ -183,10 +345,22 @@ protected:
     void readChromatogram_(Datavector& data1, Datavector& data2, std::ifstream& ifs) const;
 
     /// read a single spectrum directly into an OpenMS MSSpectrum (assuming file is already at the correct position)
-    void readSpectrum_(SpectrumType& spectrum, std::ifstream& ifs) const;
+    void readSpectrum_(SpectrumType& spectrum, std::ifstream& ifs, int format_version) const;
 
     /// read a single chromatogram directly into an OpenMS MSChromatograms (assuming file is already at the correct position)
-    void readChromatogram_(ChromatogramType& chromatogram, std::ifstream& ifs) const;
+    void readChromatogram_(ChromatogramType& chromatogram, std::ifstream& ifs, int format_version) const;
+
+    /// Whether an encoded array of @p bytes is plausible for @p size values and fits into the @p remaining_bytes of the file
+    static bool fitsArray_(UInt64 bytes, UInt64 size, UInt64 remaining_bytes);
+
+    /// read a single version 2 data item (header and both arrays) at the current position of the stream
+    static void readRecordV2_(Datavector& data1, Datavector& data2, std::ifstream& ifs, int& ms_level, double& rt, const char* item_name);
+
+    /// write the file header (identifier of the format version)
+    void writeHeader_(std::ofstream& ofs);
+
+    /// write the file footer (number of items for version 1, index and trailer for version 2)
+    void writeFooter_(std::ofstream& ofs, Size nr_spectra, Size nr_chromatograms);
 
     /// write a single spectrum to filestream
     void writeSpectrum_(const SpectrumType& spectrum, std::ofstream& ofs);
@@ -194,9 +368,24 @@ protected:
     /// write a single chromatogram to filestream
     void writeChromatogram_(const ChromatogramType& chromatogram, std::ofstream& ofs);
 
+    /// write a single version 2 data item and record it in the index to be written
+    void writeRecordV2_(const Datavector& data1, const Datavector& data2, double rt, int ms_level,
+                        std::ofstream& ofs, std::vector<IndexEntry>& index);
+
     /// Members
     std::vector<std::streampos> spectra_index_;
     std::vector<std::streampos> chrom_index_;
+    std::vector<double> spectra_rt_;
+    std::vector<int> spectra_ms_level_;
+
+    /// Format options
+    int format_version_;
+    BinaryDataEncoding first_encoding_;
+    BinaryDataEncoding intensity_encoding_;
+
+    /// Index of the items written so far (version 2)
+    std::vector<IndexEntry> written_spectra_index_;
+    std::vector<IndexEntry> written_chrom_index_;
 
   };
 }
@@ -62,15 +62,21 @@ namespace OpenMS
         @brief Constructor
   
         Opens the output file and writes the header.
+
+        @param filename The output file
+        @param clearData Whether to clear the data of spectra and chromatograms after writing them
+        @param format_version The version of the cached file format to write
+          (1 or 2). For version 2, the data encoding can be set with
+          setDataEncoding() before the first spectrum is consumed.
       */
-      MSDataCachedConsumer(String filename, bool clearData=true) :
+      MSDataCachedConsumer(String filename, bool clearData=true, int format_version=1) :
         ofs_(filename.c_str(), std::ios::binary),
         clearData_(clearData),
         spectra_written_(0),
         chromatograms_written_(0)
       {
-        int file_identifier = CACHED_MZML_FILE_IDENTIFIER;
-        ofs_.write((char*)&file_identifier, sizeof(file_identifier));
+        setFormatVersion(format_version);
+        writeHeader_(ofs_);
       }
 
       /**
@@ -80,9 +86,8 @@ namespace OpenMS
       */
       ~MSDataCachedConsumer()
       {
-        // Write size of file (to the end of the file)
-        ofs_.write((char*)&spectra_written_, sizeof(spectra_written_));
-        ofs_.write((char*)&chromatograms_written_, sizeof(chromatograms_written_));
+        // Write size of file or the index (to the end of the file)
+        writeFooter_(ofs_, spectra_written_, chromatograms_written_);
 
         // Close file stream: close() _should_ call flush() but it might not in
         // all cases. To be sure call flush() first.
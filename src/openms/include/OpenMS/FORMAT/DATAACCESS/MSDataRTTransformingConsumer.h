@@ -0,0 +1,101 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2013.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: Hannes Roest $
+// $Authors: Hannes Roest $
+// --------------------------------------------------------------------------
+
+#ifndef OPENMS_FORMAT_DATAACCESS_MSDATARTTRANSFORMINGCONSUMER_H
+#define OPENMS_FORMAT_DATAACCESS_MSDATARTTRANSFORMINGCONSUMER_H
+
+#include <OpenMS/FORMAT/DATAACCESS/MSDataTransformingConsumer.h>
+#include <OpenMS/ANALYSIS/MAPMATCHING/TransformationDescription.h>
+
+#include <vector>
+
+namespace OpenMS
+{
+
+    /**
+      @brief Transforming consumer that applies a retention time transformation
+
+      Applies a TransformationDescription to the retention times of all
+      spectra and chromatograms while they are read (e.g. using
+      MzMLFile::transform) and hands them on to a second consumer, if one is
+      given. Together with a PlainMSDataWritingConsumer, this aligns a map
+      without loading it into memory:
+
+      @code
+      PlainMSDataWritingConsumer writer(out_file);
+      MSDataRTTransformingConsumer consumer(trafo, &writer);
+      MzMLFile().transform(in_file, &consumer);
+      @endcode
+
+      The processing functions of MSDataTransformingConsumer are applied
+      after the retention times were transformed.
+    */
+    class OPENMS_DLLAPI MSDataRTTransformingConsumer :
+      public MSDataTransformingConsumer
+    {
+
+    public:
+
+      /**
+        @brief Constructor
+
+        @param trafo The transformation to apply (a copy is stored)
+        @param next_consumer Consumer to pass the transformed data on to (not owned, may be 0)
+      */
+      explicit MSDataRTTransformingConsumer(const TransformationDescription & trafo,
+          Interfaces::IMSDataConsumer<> * next_consumer = 0);
+
+      /// Default destructor
+      virtual ~MSDataRTTransformingConsumer();
+
+      virtual void setExpectedSize(Size expectedSpectra, Size expectedChromatograms);
+
+      virtual void setExperimentalSettings(const ExperimentalSettings & exp);
+
+      virtual void consumeSpectrum(SpectrumType & s);
+
+      virtual void consumeChromatogram(ChromatogramType & c);
+
+    protected:
+      /// The transformation to apply
+      TransformationDescription trafo_;
+      /// Consumer receiving the transformed data (not owned, may be 0)
+      Interfaces::IMSDataConsumer<> * next_consumer_;
+      /// Retention times of the current chromatogram
+      std::vector<double> rts_;
+    };
+
+} //end namespace OpenMS
+
+#endif // OPENMS_FORMAT_DATAACCESS_MSDATARTTRANSFORMINGCONSUMER_H
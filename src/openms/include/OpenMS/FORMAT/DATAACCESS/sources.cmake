@@ -5,6 +5,7 @@ set(directory include/OpenMS/FORMAT/DATAACCESS)
 set(sources_list_h
 MSDataWritingConsumer.h
 MSDataTransformingConsumer.h
+MSDataRTTransformingConsumer.h
 MSDataCachedConsumer.h
 NoopMSDataConsumer.h
 SwathFileConsumer.h
@@ -38,12 +38,18 @@
 #include <OpenMS/CONCEPT/Exception.h>
 #include <OpenMS/DATASTRUCTURES/String.h>
 
+#include <fstream>
 #include <vector>
 
 namespace OpenMS
 {
   /**
     @brief This class serves for reading in FASTA files
+
+    The whole database can be read at once using load(). For large databases,
+    the entries can also be streamed: call readStart() once and then fetch
+    single entries with readNext() or blocks of entries with readNextChunk()
+    until they return false. Both ways yield identical entries.
   */
   class OPENMS_DLLAPI FASTAFile
   {
@@ -87,9 +93,15 @@ public:
 
     };
 
-    /// Copy constructor
+    /// Default constructor
     FASTAFile();
 
+    /// Copy constructor (a file opened by readStart() is not shared; the copy starts unopened)
+    FASTAFile(const FASTAFile& source);
+
+    /// Assignment operator (closes a file opened by readStart(); nothing else is copied)
+    FASTAFile& operator=(const FASTAFile& source);
+
     /// Destructor
     virtual ~FASTAFile();
 
@@ -101,6 +113,39 @@ public:
     */
     void load(const String& filename, std::vector<FASTAEntry>& data);
 
+    /**
+      @brief prepares streaming of the FASTA file given by 'filename'
+
+      Any file opened by a previous call is closed.
+
+      @exception Exception::FileNotFound is thrown if the file does not exists.
+      @exception Exception::FileNotReadable is thrown if the file is not readable.
+    */
+    void readStart(const String& filename);
+
+    /**
+      @brief reads the next entry of the file opened by readStart() into 'protein'
+
+      @return false if there are no more entries (the file is closed then)
+
+      @exception Exception::ParseError is thrown if the entry does not suit to the standard.
+    */
+    bool readNext(FASTAEntry& protein);
+
+    /**
+      @brief reads up to 'max_entries' entries of the file opened by readStart() into 'chunk'
+
+      The content of 'chunk' is replaced. Memory is bounded by the chunk size, independent of the size of the database.
+
+      @return false if no entry was read (i.e. the end of the file was reached before)
+
+      @exception Exception::ParseError is thrown if an entry does not suit to the standard.
+    */
+    bool readNextChunk(std::vector<FASTAEntry>& chunk, Size max_entries);
+
+    /// number of entries read since the last call to readStart()
+    Size entriesRead() const;
+
     /**
       @brief stores the data given by 'data' at the file 'filename'
 
@@ -108,6 +153,28 @@ public:
     */
     void store(const String& filename, const std::vector<FASTAEntry>& data) const;
 
+protected:
+    /// closes the file opened by readStart() and releases the reader
+    void readEnd_();
+
+    /// the file opened by readStart()
+    std::fstream infile_;
+
+    /// name of the file opened by readStart() (for error messages)
+    String filename_;
+
+    /// the record reader for @p infile_ (a seqan type, which is hidden from this header)
+    void* reader_;
+
+    /// number of entries read since readStart()
+    Size entries_read_;
+
+    /// identifier of the last entry read (for error messages)
+    String last_identifier_;
+
+    /// sum of the sequence lengths read since readStart()
+    Size size_read_;
+
   };
 
 } // namespace OpenMS
@@ -262,8 +262,16 @@ protected:
 
       void writeChromatogram_(std::ostream& os, const ChromatogramType& chromatogram, Size c, Internal::MzMLValidator& validator);
 
+      /// Writes the spectrum element, without recording its offset (safe to call concurrently for different spectra)
+      void writeSpectrumElement_(std::ostream& os, const SpectrumType& spec, Size s,
+              Internal::MzMLValidator& validator, bool renew_native_ids,
+              std::vector<std::vector<DataProcessing> > & dps) const;
+
+      /// Writes the chromatogram element, without recording its offset (safe to call concurrently for different chromatograms)
+      void writeChromatogramElement_(std::ostream& os, const ChromatogramType& chromatogram, Size c, Internal::MzMLValidator& validator) const;
+
       template <typename ContainerT>
-      void writeContainerData(std::ostream& os, const PeakFileOptions& pf_options_, const ContainerT& container, String array_type)
+      void writeContainerData(std::ostream& os, const PeakFileOptions& pf_options_, const ContainerT& container, String array_type) const
       {
       
         bool is32Bit = ( (array_type == "intensity" && pf_options_.getIntensity32Bit()) || pf_options_.getMz32Bit());
@@ -314,57 +322,62 @@ protected:
 
           Will populate all spectra on the current work stack with data (using
           multiple threads if available) and append them to the result. 
+
+          The raw data of each spectrum is released as soon as it has been
+          decoded and each spectrum is released once it has been handed on,
+          such that at most one work stack (see
+          PeakFileOptions::setMaxDataPoolSize) is held in memory.
       */
       void populateSpectraWithData()
       {
-
         // Whether spectrum should be populated with data
         if (options_.getFillData())
         {
           size_t errCount = 0;
 #ifdef _OPENMP
-#pragma omp parallel for
+#pragma omp parallel for schedule(dynamic, 1)
 #endif
           for (SignedSize i = 0; i < (SignedSize)spectrum_data_.size(); i++)
           {
             // parallel exception catching and re-throwing business
-            if (!errCount) // no need to parse further if already an error was encountered
+            try 
             {
-              try 
-              {
-                populateSpectraWithData_(spectrum_data_[i].data ,
-                        spectrum_data_[i].default_array_length, options_,
-                        spectrum_data_[i].spectrum);
-              }
-              catch (...)
-              {
-                #pragma omp critical(HandleException)
-                ++errCount;
-              }
+              populateSpectraWithData_(spectrum_data_[i].data ,
+                      spectrum_data_[i].default_array_length, options_,
+                      spectrum_data_[i].spectrum);
+            }
+            catch (...)
+            {
+#ifdef _OPENMP
+#pragma omp critical(HandleException)
+#endif
+              ++errCount;
             }
+            // the raw data is not needed any more
+            std::vector<BinaryData>().swap(spectrum_data_[i].data);
           }
           if (errCount != 0)
           {
+            spectrum_data_.clear();
             throw Exception::ParseError(__FILE__, __LINE__, __PRETTY_FUNCTION__, file_, "Error during parsing of binary data.");
           }
         }
 
-        // Append all spectra to experiment / consumer
-        for (Size i = 0; i < spectrum_data_.size(); i++)
+        // Append all spectra to experiment / consumer (in file order, outside of
+        // the parallel region such that exceptions of the consumer reach the caller)
+        try
         {
-          if (consumer_ != NULL)
-          {
-            consumer_->consumeSpectrum(spectrum_data_[i].spectrum);
-            if (options_.getAlwaysAppendData())
-            {
-              exp_->addSpectrum(spectrum_data_[i].spectrum);
-            }
-          }
-          else
+          for (Size i = 0; i < spectrum_data_.size(); i++)
           {
-            exp_->addSpectrum(spectrum_data_[i].spectrum);
+            appendSpectrum_(spectrum_data_[i].spectrum);
+            spectrum_data_[i].spectrum = SpectrumType();
           }
         }
+        catch (...)
+        {
+          spectrum_data_.clear();
+          throw;
+        }
 
         // Delete batch
         spectrum_data_.clear();
@@ -375,6 +388,9 @@ protected:
 
           Will populate all chromatograms on the current work stack with data (using
           multiple threads if available) and append them to the result. 
+
+          Memory is released in the same way as for spectra (see
+          populateSpectraWithData).
       */
       void populateChromatogramsWithData()
       {
@@ -383,7 +399,7 @@ protected:
         {
           size_t errCount = 0;
 #ifdef _OPENMP
-#pragma omp parallel for
+#pragma omp parallel for schedule(dynamic, 1)
 #endif
           for (SignedSize i = 0; i < (SignedSize)chromatogram_data_.size(); i++)
           {
@@ -395,36 +411,76 @@ protected:
                       chromatogram_data_[i].chromatogram);
             }
             catch (...)
-            {++errCount;}
+            {
+#ifdef _OPENMP
+#pragma omp critical(HandleException)
+#endif
+              ++errCount;
+            }
+            // the raw data is not needed any more
+            std::vector<BinaryData>().swap(chromatogram_data_[i].data);
           }
           if (errCount != 0)
           {
+            chromatogram_data_.clear();
             throw Exception::ParseError(__FILE__, __LINE__, __PRETTY_FUNCTION__, file_, "Error during parsing of binary data.");
           }
-
         }
 
-        // Append all chromatograms to experiment / consumer
-        for (Size i = 0; i < chromatogram_data_.size(); i++)
+        // Append all chromatograms to experiment / consumer (in file order, outside of
+        // the parallel region such that exceptions of the consumer reach the caller)
+        try
         {
-          if (consumer_ != NULL)
+          for (Size i = 0; i < chromatogram_data_.size(); i++)
           {
-            consumer_->consumeChromatogram(chromatogram_data_[i].chromatogram);
-            if (options_.getAlwaysAppendData())
-            {
-              exp_->addChromatogram(chromatogram_data_[i].chromatogram);
-            }
-          }
-          else
-          {
-            exp_->addChromatogram(chromatogram_data_[i].chromatogram);
+            appendChromatogram_(chromatogram_data_[i].chromatogram);
+            chromatogram_data_[i].chromatogram = ChromatogramType();
           }
         }
+        catch (...)
+        {
+          chromatogram_data_.clear();
+          throw;
+        }
 
         // Delete batch
         chromatogram_data_.clear();
       }
 
+      /// Hand a single spectrum to the consumer and/or append it to the experiment
+      void appendSpectrum_(SpectrumType& spectrum)
+      {
+        if (consumer_ != NULL)
+        {
+          consumer_->consumeSpectrum(spectrum);
+          if (options_.getAlwaysAppendData())
+          {
+            exp_->addSpectrum(spectrum);
+          }
+        }
+        else
+        {
+          exp_->addSpectrum(spectrum);
+        }
+      }
+
+      /// Hand a single chromatogram to the consumer and/or append it to the experiment
+      void appendChromatogram_(ChromatogramType& chromatogram)
+      {
+        if (consumer_ != NULL)
+        {
+          consumer_->consumeChromatogram(chromatogram);
+          if (options_.getAlwaysAppendData())
+          {
+            exp_->addChromatogram(chromatogram);
+          }
+        }
+        else
+        {
+          exp_->addChromatogram(chromatogram);
+        }
+      }
+
       /**
           @brief Fill a single spectrum with data from input 
 
@@ -764,7 +820,7 @@ protected:
       }
 
       template <typename DataType>
-      void writeBinaryDataArray(std::ostream& os, const PeakFileOptions& pf_options_, std::vector<DataType> data_to_encode, bool is32bit, String array_type)
+      void writeBinaryDataArray(std::ostream& os, const PeakFileOptions& pf_options_, std::vector<DataType> data_to_encode, bool is32bit, String array_type) const
       {
         String encoded_string;
         bool no_numpress = true;
@@ -818,7 +874,7 @@ protected:
         if (is32bit && no_numpress)
         {
           compression_term = compression_term_no_np; // select the no-numpress term
-          decoder_.encode(data_to_encode, Base64::BYTEORDER_LITTLEENDIAN, encoded_string, pf_options_.getCompression());
+          Base64().encode(data_to_encode, Base64::BYTEORDER_LITTLEENDIAN, encoded_string, pf_options_.getCompression());
           os << "\t\t\t\t\t<binaryDataArray encodedLength=\"" << encoded_string.size() << "\">\n";
           os << cv_term_type;
           os << "\t\t\t\t\t\t<cvParam cvRef=\"MS\" accession=\"MS:1000521\" name=\"32-bit float\" />\n";
@@ -826,7 +882,7 @@ protected:
         else if (!is32bit && no_numpress)
         {
           compression_term = compression_term_no_np; // select the no-numpress term
-          decoder_.encode(data_to_encode, Base64::BYTEORDER_LITTLEENDIAN, encoded_string, pf_options_.getCompression());
+          Base64().encode(data_to_encode, Base64::BYTEORDER_LITTLEENDIAN, encoded_string, pf_options_.getCompression());
           os << "\t\t\t\t\t<binaryDataArray encodedLength=\"" << encoded_string.size() << "\">\n";
           os << cv_term_type;
           os << "\t\t\t\t\t\t<cvParam cvRef=\"MS\" accession=\"MS:1000523\" name=\"64-bit float\" />\n";
@@ -976,10 +1032,10 @@ protected:
       void writeDataProcessing_(std::ostream& os, const String& id, const std::vector<DataProcessing>& dps, Internal::MzMLValidator& validator);
 
       /// Helper method that write precursor information from spectra and chromatograms
-      void writePrecursor_(std::ostream& os, const Precursor& precursor, Internal::MzMLValidator& validator);
+      void writePrecursor_(std::ostream& os, const Precursor& precursor, Internal::MzMLValidator& validator) const;
 
       /// Helper method that write precursor information from spectra and chromatograms
-      void writeProduct_(std::ostream& os, const Product& product, Internal::MzMLValidator& validator);
+      void writeProduct_(std::ostream& os, const Product& product, Internal::MzMLValidator& validator) const;
 
       /// Helper method to write an CV based on a meta value
       String writeCV_(const ControlledVocabulary::CVTerm& c, const DataValue& metaValue) const;
@@ -1475,7 +1531,8 @@ protected:
           spectrum_data_.back().spectrum = spec_;
           if (options_.getFillData()) 
           {
-            spectrum_data_.back().data = data_;
+            // the raw data is not needed any more by the parser, avoid copying it
+            spectrum_data_.back().data.swap(data_);
           }
         }
 
@@ -1501,7 +1558,8 @@ protected:
           chromatogram_data_.back().chromatogram = chromatogram_;
           if (options_.getFillData()) 
           {
-            chromatogram_data_.back().data = data_;
+            // the raw data is not needed any more by the parser, avoid copying it
+            chromatogram_data_.back().data.swap(data_);
           }
         }
 
@@ -3748,7 +3806,7 @@ protected:
     }
 
     template <typename MapType>
-    void MzMLHandler<MapType>::writePrecursor_(std::ostream& os, const Precursor& precursor, Internal::MzMLValidator& validator)
+    void MzMLHandler<MapType>::writePrecursor_(std::ostream& os, const Precursor& precursor, Internal::MzMLValidator& validator) const
     {
       os << "\t\t\t\t\t<precursor>\n";
       //--------------------------------------------------------------------------------------------
@@ -3852,7 +3910,7 @@ protected:
     }
 
     template <typename MapType>
-    void MzMLHandler<MapType>::writeProduct_(std::ostream& os, const Product& product, Internal::MzMLValidator& validator)
+    void MzMLHandler<MapType>::writeProduct_(std::ostream& os, const Product& product, Internal::MzMLValidator& validator) const
     {
       os << "\t\t\t\t\t<product>\n";
       os << "\t\t\t\t\t\t<isolationWindow>\n";
@@ -3873,6 +3931,8 @@ protected:
       Internal::MzMLValidator validator(mapping_, cv_);
 
       std::vector<std::vector<DataProcessing> > dps;
+      // number of spectra/chromatograms that are encoded in parallel before they are written
+      const Size pool_size = std::max<Size>(1, options_.getMaxDataPoolSize());
       //--------------------------------------------------------------------------------------------
       //header
       //--------------------------------------------------------------------------------------------
@@ -3906,11 +3966,55 @@ protected:
         }
 
         //write actual data
-        for (Size s = 0; s < exp.size(); ++s)
-        {
-          logger_.setProgress(progress++);
-          const SpectrumType& spec = exp[s];
-          writeSpectrum_(os, spec, s, validator, renew_native_ids, dps);
+        // the spectra of a data pool are encoded in parallel, then written in order
+        std::vector<std::string> pool;
+        for (Size pool_start = 0; pool_start < exp.size(); pool_start += pool_size)
+        {
+          Size pool_end = std::min(exp.size(), pool_start + pool_size);
+          pool.resize(pool_end - pool_start);
+          // each thread only marks its own slots
+          std::vector<char> failed(pool.size(), false);
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 1) if (pool.size() > 1)
+#endif
+          for (SignedSize s = pool_start; s < (SignedSize)pool_end; ++s)
+          {
+            try
+            {
+              std::ostringstream spec_os;
+              spec_os.copyfmt(os);
+              writeSpectrumElement_(spec_os, exp[s], s, validator, renew_native_ids, dps);
+              pool[s - pool_start] = spec_os.str();
+            }
+            catch (...)
+            {
+              failed[s - pool_start] = true;
+            }
+          }
+          // encode failed spectrums again serially (outside of the parallel region),
+          // such that an exception reaches the caller and no spectrum is left out
+          for (Size s = pool_start; s < pool_end; ++s)
+          {
+            if (failed[s - pool_start])
+            {
+              std::ostringstream spec_os;
+              spec_os.copyfmt(os);
+              writeSpectrumElement_(spec_os, exp[s], s, validator, renew_native_ids, dps);
+              pool[s - pool_start] = spec_os.str();
+            }
+          }
+
+          for (Size s = pool_start; s < pool_end; ++s)
+          {
+            logger_.setProgress(progress++);
+            String native_id = exp[s].getNativeID();
+            if (renew_native_ids)
+              native_id = String("spectrum=") + s;
+            // the offset has to point to the start of the <spectrum tag
+            long offset = os.tellp();
+            spectra_offsets.push_back(make_pair(native_id, offset+3));
+            os.write(pool[s - pool_start].data(), pool[s - pool_start].size());
+          }
         }
         os << "\t\t</spectrumList>\n";
       }
@@ -3925,11 +4029,52 @@ protected:
         // meta information needs to be stored here but the actual data is
         // stored somewhere else).
         os << "\t\t<chromatogramList count=\"" << exp.getChromatograms().size() << "\" defaultDataProcessingRef=\"dp_sp_0\">\n";
-        for (Size c = 0; c != exp.getChromatograms().size(); ++c)
-        {
-          logger_.setProgress(progress++);
-          const ChromatogramType& chromatogram = exp.getChromatograms()[c];
-          writeChromatogram_(os, chromatogram, c, validator);
+        const std::vector<ChromatogramType>& chromatograms = exp.getChromatograms();
+        std::vector<std::string> pool;
+        for (Size pool_start = 0; pool_start < chromatograms.size(); pool_start += pool_size)
+        {
+          Size pool_end = std::min(chromatograms.size(), pool_start + pool_size);
+          pool.resize(pool_end - pool_start);
+          // each thread only marks its own slots
+          std::vector<char> failed(pool.size(), false);
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 1) if (pool.size() > 1)
+#endif
+          for (SignedSize c = pool_start; c < (SignedSize)pool_end; ++c)
+          {
+            try
+            {
+              std::ostringstream chrom_os;
+              chrom_os.copyfmt(os);
+              writeChromatogramElement_(chrom_os, chromatograms[c], c, validator);
+              pool[c - pool_start] = chrom_os.str();
+            }
+            catch (...)
+            {
+              failed[c - pool_start] = true;
+            }
+          }
+          // encode failed chromatograms again serially (outside of the parallel region),
+          // such that an exception reaches the caller and no chromatogram is left out
+          for (Size c = pool_start; c < pool_end; ++c)
+          {
+            if (failed[c - pool_start])
+            {
+              std::ostringstream chrom_os;
+              chrom_os.copyfmt(os);
+              writeChromatogramElement_(chrom_os, chromatograms[c], c, validator);
+              pool[c - pool_start] = chrom_os.str();
+            }
+          }
+
+          for (Size c = pool_start; c < pool_end; ++c)
+          {
+            logger_.setProgress(progress++);
+            // the offset has to point to the start of the <chromatogram tag
+            long offset = os.tellp();
+            chromatograms_offsets.push_back(make_pair(chromatograms[c].getNativeID(), offset+6));
+            os.write(pool[c - pool_start].data(), pool[c - pool_start].size());
+          }
         }
         os << "\t\t</chromatogramList>" << "\n";
       }
@@ -4854,6 +4999,20 @@ protected:
         long offset = os.tellp();
         spectra_offsets.push_back(make_pair(native_id, offset+3));
 
+        writeSpectrumElement_(os, spec, s, validator, renew_native_ids, dps);
+    }
+
+    template <typename MapType>
+    void MzMLHandler<MapType>::writeSpectrumElement_(std::ostream& os,
+            const SpectrumType& spec, Size s,
+            Internal::MzMLValidator& validator, bool renew_native_ids,
+            std::vector<std::vector<DataProcessing> > & dps) const
+    {
+        //native id
+        String native_id = spec.getNativeID();
+        if (renew_native_ids)
+          native_id = String("spectrum=") + s;
+
         // IMPORTANT make sure the offset (above) corresponds to the start of the <spectrum tag
         os << "\t\t\t<spectrum id=\"" << native_id << "\" index=\"" << s << "\" defaultArrayLength=\"" << spec.size() << "\"";
         if (spec.getSourceFile() != SourceFile())
@@ -5092,7 +5251,7 @@ protected:
             for (Size p = 0; p < array.size(); ++p)
               data64_to_encode[p] = array[p];
             // TODO also encode float data arrays using numpress? 
-            decoder_.encode(data64_to_encode, Base64::BYTEORDER_LITTLEENDIAN, encoded_string, options_.getCompression());
+            Base64().encode(data64_to_encode, Base64::BYTEORDER_LITTLEENDIAN, encoded_string, options_.getCompression());
             String data_processing_ref_string = "";
             if (array.getDataProcessing().size() != 0)
             {
@@ -5121,7 +5280,7 @@ protected:
             std::vector<Int64> data64_to_encode(array.size());
             for (Size p = 0; p < array.size(); ++p)
               data64_to_encode[p] = array[p];
-            decoder_.encodeIntegers(data64_to_encode, Base64::BYTEORDER_LITTLEENDIAN, encoded_string, options_.getCompression());
+            Base64().encodeIntegers(data64_to_encode, Base64::BYTEORDER_LITTLEENDIAN, encoded_string, options_.getCompression());
             String data_processing_ref_string = "";
             if (array.getDataProcessing().size() != 0)
             {
@@ -5151,7 +5310,7 @@ protected:
             data_to_encode.resize(array.size());
             for (Size p = 0; p < array.size(); ++p)
               data_to_encode[p] = array[p];
-            decoder_.encodeStrings(data_to_encode, encoded_string, options_.getCompression());
+            Base64().encodeStrings(data_to_encode, encoded_string, options_.getCompression());
             String data_processing_ref_string = "";
             if (array.getDataProcessing().size() != 0)
             {
@@ -5178,6 +5337,13 @@ protected:
         long offset = os.tellp();
         chromatograms_offsets.push_back(make_pair(chromatogram.getNativeID(), offset+6));
 
+        writeChromatogramElement_(os, chromatogram, c, validator);
+    }
+
+    template <typename MapType>
+    void MzMLHandler<MapType>::writeChromatogramElement_(std::ostream& os,
+            const ChromatogramType& chromatogram, Size c, Internal::MzMLValidator& validator) const
+    {
         // TODO native id with chromatogram=?? prefix?
         // IMPORTANT make sure the offset (above) corresponds to the start of the <chromatogram tag
         os << "      <chromatogram id=\"" << chromatogram.getNativeID() << "\" index=\"" << c << "\" defaultArrayLength=\"" << chromatogram.size() << "\">" << "\n";
@@ -5245,7 +5411,7 @@ protected:
           for (Size p = 0; p < array.size(); ++p)
             data64_to_encode[p] = array[p];
           // TODO also encode float data arrays using numpress? 
-          decoder_.encode(data64_to_encode, Base64::BYTEORDER_LITTLEENDIAN, encoded_string, options_.getCompression());
+          Base64().encode(data64_to_encode, Base64::BYTEORDER_LITTLEENDIAN, encoded_string, options_.getCompression());
           String data_processing_ref_string = "";
           if (array.getDataProcessing().size() != 0)
           {
@@ -5274,7 +5440,7 @@ protected:
           std::vector<Int64> data64_to_encode(array.size());
           for (Size p = 0; p < array.size(); ++p)
             data64_to_encode[p] = array[p];
-          decoder_.encodeIntegers(data64_to_encode, Base64::BYTEORDER_LITTLEENDIAN, encoded_string, options_.getCompression());
+          Base64().encodeIntegers(data64_to_encode, Base64::BYTEORDER_LITTLEENDIAN, encoded_string, options_.getCompression());
           String data_processing_ref_string = "";
           if (array.getDataProcessing().size() != 0)
           {
@@ -5304,7 +5470,7 @@ protected:
           data_to_encode.resize(array.size());
           for (Size p = 0; p < array.size(); ++p)
             data_to_encode[p] = array[p];
-          decoder_.encodeStrings(data_to_encode, encoded_string, options_.getCompression());
+          Base64().encodeStrings(data_to_encode, encoded_string, options_.getCompression());
           String data_processing_ref_string = "";
           if (array.getDataProcessing().size() != 0)
           {
@@ -61,10 +61,12 @@ namespace OpenMS
     extracting all the offsets of the <chromatogram> and <spectrum> tags. These
     offsets are stored as members of this class as well as the offset to the <indexList> element
 
-    @note This implementation is @a not thread-safe since it keeps internally a
-    single file access pointer which it moves when accessing a specific
-    data item. The caller is responsible to ensure that access is performed
-    atomically.
+    getSpectrumById and getChromatogramById are thread-safe and may be
+    called concurrently: only reading the raw text of a data item from the
+    single internal file stream is serialized (a short sequential read),
+    parsing the XML and decoding the binary data arrays runs in parallel.
+
+    @note openFile() must not be called concurrently with any other method.
 
   */
   class OPENMS_DLLAPI IndexedMzMLFile
@@ -92,6 +94,14 @@ namespace OpenMS
     */
     void parseFooter_(String filename);
 
+    /**
+      @brief Read the raw text between the two offsets from the file
+
+      Access to the file stream is serialized, this function can be called
+      from multiple threads concurrently.
+    */
+    void readText_(std::streampos startidx, std::streampos endidx, std::string& text);
+
     public:
 
     /**
@@ -139,6 +149,8 @@ namespace OpenMS
     /**
       @brief Retrieve the raw data for the spectrum at position "id"
 
+      @note This function is thread-safe.
+
       @throw Exception if getParsingSuccess() returns false
       @throw Exception if id is not within [0, getNrSpectra()-1]
 
@@ -149,6 +161,8 @@ namespace OpenMS
     /**
       @brief Retrieve the raw data for the chromatogram at position "id"
 
+      @note This function is thread-safe.
+
       @throw Exception if getParsingSuccess() returns false
       @throw Exception if id is not within [0, getNrChromatograms()-1]
 
@@ -0,0 +1,181 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2013.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: Chris Bielow $
+// $Authors: Chris Bielow $
+// --------------------------------------------------------------------------
+
+#ifndef OPENMS_FORMAT_PROTEININDEXFILE_H
+#define OPENMS_FORMAT_PROTEININDEXFILE_H
+
+#include <OpenMS/CONCEPT/Exception.h>
+#include <OpenMS/DATASTRUCTURES/String.h>
+
+#include <boost/shared_ptr.hpp>
+
+namespace boost
+{
+  namespace interprocess
+  {
+    class file_mapping;
+    class mapped_region;
+  }
+}
+
+namespace OpenMS
+{
+  /**
+    @brief A prebuilt, memory mapped index of the proteins of a FASTA file
+
+    The index stores the accessions and the sequences (with '*' removed) of
+    all proteins of a FASTA database in a binary file. Opening the index maps
+    the file read-only into memory, which takes constant time independent of
+    the size of the database. Concurrent processes which open the same index
+    share its pages through the page cache of the operating system.
+
+    The index remembers size and modification time of the FASTA file it was
+    built from, see isUpToDate(). A flag, e.g. whether I/L were treated as
+    equivalent, can be stored along with the index by the application, to
+    decide whether data derived from the index (such as a suffix tree written
+    next to it) can be reused.
+
+    File layout (native byte order): a header of 64 bytes (identifier,
+    version, flag, FASTA size and modification time, number of proteins and
+    the positions of the following blocks), the concatenated sequences, the
+    concatenated accessions and finally two tables of 64 bit offsets into the
+    sequence and accession blocks (number of proteins + 1 entries each).
+
+    @note The complete index is mapped into the address space of the
+    process, on 32 bit systems this limits the size of the database.
+  */
+  class OPENMS_DLLAPI ProteinIndexFile
+  {
+public:
+
+    /// Default constructor (no index loaded)
+    ProteinIndexFile();
+
+    /// Destructor, unmaps the index
+    ~ProteinIndexFile();
+
+    /**
+      @brief Builds the index @p filename from the FASTA file @p fasta_file
+
+      The FASTA file is streamed, only the accessions are kept in memory while
+      building. The index is written to a temporary file first and then
+      renamed, so concurrent readers never see an incomplete index.
+
+      @exception Exception::FileNotFound is thrown if the FASTA file does not exist
+      @exception Exception::ParseError is thrown if the FASTA file cannot be parsed
+      @exception Exception::UnableToCreateFile is thrown if the index cannot be written
+    */
+    static void store(const String& filename, const String& fasta_file, UInt flag = 0);
+
+    /**
+      @brief Maps the index @p filename into memory
+
+      @exception Exception::FileNotFound is thrown if the file cannot be mapped
+      @exception Exception::ParseError is thrown if the file is not a valid index (no index is loaded then)
+    */
+    void load(const String& filename);
+
+    /// Returns if the loaded index was built from @p fasta_file in its current state (size and modification time) with flag @p flag
+    bool isUpToDate(const String& fasta_file, UInt flag = 0) const;
+
+    /**
+      @brief Identifies the FASTA file state (size and modification time) and the flag the loaded index was built from
+
+      Files derived from the index can be named with the stamp, so they never get mixed up with another index.
+      Returns an empty string if no index is loaded.
+    */
+    String getStamp() const;
+
+    /// Number of proteins in the index
+    Size size() const;
+
+    /// Flag stored with the index
+    UInt getFlag() const;
+
+    /// Accession of protein @p index
+    String getAccession(Size index) const;
+
+    /// Sequence of protein @p index
+    String getSequence(Size index) const;
+
+    /// Zero-copy access to the sequence of protein @p index, which consists of @p length characters (not null-terminated) inside the mapping
+    const char* getSequence(Size index, Size& length) const;
+
+private:
+
+    /// Copy constructor and assignment are not allowed (the mapping is owned by this object)
+    ProteinIndexFile(const ProteinIndexFile&);
+    ProteinIndexFile& operator=(const ProteinIndexFile&);
+
+    /// Header at the beginning of the index
+    struct Header
+    {
+      char identifier[8];
+      UInt version;
+      UInt flag;
+      UInt64 fasta_size;
+      Int64 fasta_time;
+      UInt64 protein_count;
+      UInt64 sequence_pos;
+      UInt64 accession_pos;
+      UInt64 offset_pos;
+    };
+
+    /// Unmaps the index (if any)
+    void unload_();
+
+    /// Size and modification time of @p fasta_file
+    static void fingerprint_(const String& fasta_file, UInt64& size, Int64& time);
+
+    /// Offset @p index of the table starting at @p table_pos
+    UInt64 offset_(UInt64 table_pos, Size index) const;
+
+    /// Name of the index
+    String filename_;
+
+    /// The file mapping and the mapped region (owned)
+    boost::shared_ptr<boost::interprocess::file_mapping> file_mapping_;
+    boost::shared_ptr<boost::interprocess::mapped_region> region_;
+
+    /// Start and size of the mapped data
+    const char* data_;
+    Size data_size_;
+
+    /// Copy of the header of the mapped index
+    Header header_;
+  };
+
+} // namespace OpenMS
+
+#endif // OPENMS_FORMAT_PROTEININDEXFILE_H
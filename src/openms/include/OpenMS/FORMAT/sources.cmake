@@ -71,6 +71,7 @@ PepNovoInfile.h
 PepNovoOutfile.h
 PepXMLFile.h
 PepXMLFileMascot.h
+ProteinIndexFile.h
 ProtXMLFile.h
 SequestInfile.h
 SequestOutfile.h
@@ -57,10 +57,12 @@ namespace OpenMS
 
     @ingroup Kernel
 
-    @note This implementation is @a not thread-safe since it keeps internally a
-    single file access pointer which it moves when accessing a specific
-    data item. The caller is responsible to ensure that access is performed
-    atomically.
+    Access to spectra and chromatograms (getSpectrum, getSpectrumById,
+    getChromatogram, getChromatogramById) is thread-safe, such that the data
+    can be processed out-of-core by multiple threads (see
+    IndexedMzMLFile).
+
+    @note openFile() must not be called concurrently with any other method.
 
   */
   template <typename PeakT = Peak1D, typename ChromatogramPeakT = ChromatogramPeak>
@@ -168,6 +170,17 @@ public:
       return boost::static_pointer_cast<const ExperimentalSettings>(meta_ms_experiment_);
     }
 
+    /**
+      @brief returns the meta data of all spectra and chromatograms (without peak data)
+
+      This allows to access e.g. MS level or retention time of a spectrum
+      without reading it from disk.
+    */
+    boost::shared_ptr<const MSExperiment<> > getMetaData() const
+    {
+      return meta_ms_experiment_;
+    }
+
     /// alias for getSpectrum
     inline MSSpectrum<PeakT> operator[] (Size n)
     {
@@ -62,6 +62,12 @@ namespace OpenMS
       MetaInfoInterface, instead of simply adding MetaInfo as member. MetaInfoInterface implements
       a full interface to a MetaInfo member.
 
+      The values are stored in a single vector sorted by index, since most
+      objects only carry a handful of meta values.
+
+      @note References returned by getValue() are invalidated by setValue(),
+      removeValue() and clear().
+
       @ingroup Metadata
   */
   class OPENMS_DLLAPI MetaInfo
@@ -122,8 +128,8 @@ public:
 private:
     /// static MetaInfoRegistry
     static MetaInfoRegistry registry_;
-    /// the actual mapping of index to the DataValue
-    std::map<UInt, DataValue> index_to_value_;
+    /// the actual mapping of index to the DataValue (sorted by index)
+    std::vector<std::pair<UInt, DataValue> > index_to_value_;
 
   };
 
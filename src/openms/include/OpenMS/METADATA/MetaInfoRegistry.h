@@ -37,6 +37,9 @@
 
 #include <map>
 #include <string>
+#include <vector>
+
+#include <boost/unordered_map.hpp>
 
 #include <OpenMS/CONCEPT/Exception.h>
 #include <OpenMS/CONCEPT/Types.h>
@@ -69,6 +72,10 @@ namespace OpenMS
       12 - low_quality<BR>
       13 - charge<BR>
 
+      All accesses are serialized, but looking up the index of a name
+      (getIndex) or the name of an index (getName) only holds the lock for a
+      hash map lookup or an access to an append-only table, respectively.
+
       @ingroup Metadata
   */
   class OPENMS_DLLAPI MetaInfoRegistry
@@ -163,12 +170,21 @@ public:
     String getUnit(const String & name) const;
 
 private:
+    typedef boost::unordered_map<String, UInt> NameMap_;
+
+    /// inserts a new name (caller holds the lock)
+    UInt insertName_(const String & name, UInt index, const String & description, const String & unit) const;
+    /// rebuilds index_to_name_ from name_to_index_ (caller holds the lock)
+    void rebuildIndexToName_() const;
+    /// returns the name of a registered index or 0 (caller holds the lock)
+    const String * findName_(UInt index) const;
+
     /// internal counter, that stores the next index to assign
     mutable UInt next_index_;
-    /// map from name to index
-    mutable std::map<String, UInt> name_to_index_;
-    /// map from index to name
-    mutable std::map<UInt, String> index_to_name_;
+    /// map from name to index (entries never move when inserting)
+    mutable NameMap_ name_to_index_;
+    /// append-only table from index to (name of) the entry in name_to_index_, 0 for unused indices
+    mutable std::vector<const String *> index_to_name_;
     /// map from index to description
     mutable std::map<UInt, String> index_to_description_;
     /// map from index to unit
@@ -324,13 +324,18 @@ public:
       if (debug_) log_ << "Precalculating intensity thresholds ..." << std::endl;
       //new scope to make local variables disappear
       {
-        ff_->startProgress(0, intensity_bins_ * intensity_bins_, "Precalculating intensity scores");
+        ff_->startProgress(0, intensity_bins_ + map_.size(), "Precalculating intensity scores");
+        Size progress = 0;
         double rt_start = map_.getMinRT();
         double mz_start = map_.getMinMZ();
         intensity_rt_step_ = (map_.getMaxRT() - rt_start) / (double)intensity_bins_;
         intensity_mz_step_ = (map_.getMaxMZ() - mz_start) / (double)intensity_bins_;
         intensity_thresholds_.resize(intensity_bins_);
-        for (Size rt = 0; rt < intensity_bins_; ++rt)
+        //the RT bins are independent of each other
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic)
+#endif
+        for (SignedSize rt = 0; rt < (SignedSize)intensity_bins_; ++rt)
         {
           intensity_thresholds_[rt].resize(intensity_bins_);
           double min_rt = rt_start + rt * intensity_rt_step_;
@@ -338,7 +343,6 @@ public:
           std::vector<double> tmp;
           for (Size mz = 0; mz < intensity_bins_; ++mz)
           {
-            ff_->setProgress(rt * intensity_bins_ + mz);
             double min_mz = mz_start + mz * intensity_mz_step_;
             double max_mz = mz_start + (mz + 1) * intensity_mz_step_;
             //std::cout << "rt range: " << min_rt << " - " << max_rt << std::endl;
@@ -361,15 +365,27 @@ public:
               }
             }
           }
+#ifdef _OPENMP
+#pragma omp critical (FeatureFinderAlgorithmPicked_PROGRESS)
+#endif
+          ff_->setProgress(++progress);
         }
 
-        //store intensity score in PeakInfo
-        for (Size s = 0; s < map_.size(); ++s)
+        //store intensity score in PeakInfo (each spectrum only writes its own scores)
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic)
+#endif
+        for (SignedSize s = 0; s < (SignedSize)map_.size(); ++s)
         {
+          std::vector<float>& intensity_scores = map_[s].getFloatDataArrays()[1];
           for (Size p = 0; p < map_[s].size(); ++p)
           {
-            map_[s].getFloatDataArrays()[1][p] = intensityScore_(s, p);
+            intensity_scores[p] = intensityScore_(s, p);
           }
+#ifdef _OPENMP
+#pragma omp critical (FeatureFinderAlgorithmPicked_PROGRESS)
+#endif
+          ff_->setProgress(++progress);
         }
         ff_->endProgress();
       }
@@ -382,16 +398,23 @@ public:
       {
         Size end_iteration = map_.size() - std::min((Size) min_spectra_, map_.size());
         ff_->startProgress(min_spectra_, end_iteration, "Precalculating mass trace scores");
+        Size progress = min_spectra_;
         // skip first and last scans since we cannot extend the mass traces there
-        for (Size s = min_spectra_; s < end_iteration; ++s)
+        // (the spectra only read the peaks of their neighbours and write their own scores)
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic)
+#endif
+        for (SignedSize s = min_spectra_; s < (SignedSize)end_iteration; ++s)
         {
-          ff_->setProgress(s);
           const SpectrumType& spectrum = map_[s];
+          std::vector<float>& trace_scores = map_[s].getFloatDataArrays()[0];
+          std::vector<float>& local_max = map_[s].getFloatDataArrays()[2];
+          std::vector<double> scores;
+          scores.reserve(2 * min_spectra_);
           //iterate over all peaks of the scan
           for (Size p = 0; p < spectrum.size(); ++p)
           {
-            std::vector<double> scores;
-            scores.reserve(2 * min_spectra_);
+            scores.clear();
 
             double pos = spectrum[p].getMZ();
             float inte = spectrum[p].getIntensity();
@@ -430,9 +453,13 @@ public:
             double trace_score = std::accumulate(scores.begin(), scores.end(), 0.0) / scores.size();
 
             //store final score for later use
-            map_[s].getFloatDataArrays()[0][p] = trace_score;
-            map_[s].getFloatDataArrays()[2][p] = is_max_peak;
+            trace_scores[p] = trace_score;
+            local_max[p] = is_max_peak;
           }
+#ifdef _OPENMP
+#pragma omp critical (FeatureFinderAlgorithmPicked_PROGRESS)
+#endif
+          ff_->setProgress(++progress);
         }
         ff_->endProgress();
       }
@@ -528,42 +555,64 @@ public:
         //-----------------------------------------------------------
         //Step 3.1: Precalculate IsotopePattern score
         //-----------------------------------------------------------
-        ff_->startProgress(0, map_.size(), String("Calculating isotope pattern scores for charge ") + String(c));
-        for (Size s = 0; s < map_.size(); ++s)
+        // The spectra are processed in tiles of consecutive spectra in
+        // parallel. Isotope patterns reach into the adjacent spectra (a halo
+        // of one spectrum on each side), so neighbouring tiles are never
+        // processed at the same time: first the even, then the odd tiles.
+        // As only the maximum score is kept for each peak, the result does
+        // not depend on the processing order. In debug mode, the log is
+        // written serially.
+        const Size tile_size = 16;
+        Size tile_count = (map_.size() + tile_size - 1) / tile_size;
+        Size progress = 0;
+        ff_->startProgress(0, tile_count, String("Calculating isotope pattern scores for charge ") + String(c));
+        for (Size parity = 0; parity < 2; ++parity)
         {
-          ff_->setProgress(s);
-          const SpectrumType& spectrum = map_[s];
-          for (Size p = 0; p < spectrum.size(); ++p)
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic) if (!debug_)
+#endif
+          for (SignedSize tile = parity; tile < (SignedSize)tile_count; tile += 2)
           {
-            double mz = spectrum[p].getMZ();
+            for (Size s = (Size)tile * tile_size; s < std::min(((Size)tile + 1) * tile_size, map_.size()); ++s)
+            {
+              const SpectrumType& spectrum = map_[s];
+              for (Size p = 0; p < spectrum.size(); ++p)
+              {
+                double mz = spectrum[p].getMZ();
 
-            //get isotope distribution for this mass
-            const TheoreticalIsotopePattern& isotopes = getIsotopeDistribution_(mz * c);
-            //determine highest peak in isotope distribution
-            Size max_isotope = std::max_element(isotopes.intensity.begin(), isotopes.intensity.end()) - isotopes.intensity.begin();
-            //Look up expected isotopic peaks (in the current spectrum or adjacent spectra)
-            Size peak_index = spectrum.findNearest(mz - ((double)(isotopes.size() + 1) / c));
-            IsotopePattern pattern(isotopes.size());
+                //get isotope distribution for this mass
+                const TheoreticalIsotopePattern& isotopes = getIsotopeDistribution_(mz * c);
+                //determine highest peak in isotope distribution
+                Size max_isotope = std::max_element(isotopes.intensity.begin(), isotopes.intensity.end()) - isotopes.intensity.begin();
+                //Look up expected isotopic peaks (in the current spectrum or adjacent spectra)
+                Size peak_index = spectrum.findNearest(mz - ((double)(isotopes.size() + 1) / c));
+                IsotopePattern pattern(isotopes.size());
 
-            for (Size i = 0; i < isotopes.size(); ++i)
-            {
-              double isotope_pos = mz + ((double)i - max_isotope) / c;
-              findIsotope_(isotope_pos, s, pattern, i, peak_index);
-            }
+                for (Size i = 0; i < isotopes.size(); ++i)
+                {
+                  double isotope_pos = mz + ((double)i - max_isotope) / c;
+                  findIsotope_(isotope_pos, s, pattern, i, peak_index);
+                }
 
-            double pattern_score = isotopeScore_(isotopes, pattern, true);
+                double pattern_score = isotopeScore_(isotopes, pattern, true);
 
-            //update pattern scores of all contained peaks (if necessary)
-            if (pattern_score > 0.0)
-            {
-              for (Size i = 0; i < pattern.peak.size(); ++i)
-              {
-                if (pattern.peak[i] >= 0 && pattern_score > map_[pattern.spectrum[i]].getFloatDataArrays()[meta_index_isotope][pattern.peak[i]])
+                //update pattern scores of all contained peaks (if necessary)
+                if (pattern_score > 0.0)
                 {
-                  map_[pattern.spectrum[i]].getFloatDataArrays()[meta_index_isotope][pattern.peak[i]] = pattern_score;
+                  for (Size i = 0; i < pattern.peak.size(); ++i)
+                  {
+                    if (pattern.peak[i] >= 0 && pattern_score > map_[pattern.spectrum[i]].getFloatDataArrays()[meta_index_isotope][pattern.peak[i]])
+                    {
+                      map_[pattern.spectrum[i]].getFloatDataArrays()[meta_index_isotope][pattern.peak[i]] = pattern_score;
+                    }
+                  }
                 }
               }
             }
+#ifdef _OPENMP
+#pragma omp critical (FeatureFinderAlgorithmPicked_PROGRESS)
+#endif
+            ff_->setProgress(++progress);
           }
         }
         ff_->endProgress();
@@ -661,20 +710,32 @@ public:
         //------------------------------------------------------------------
 
         // We do not want to store features whose seeds lie within other
-        // features with higher intensity. We thus store this information in
-        // the map seeds_in_features which contains for each seed i a vector
-        // of other seeds that are contained in the corresponding feature i.
+        // features with higher intensity. We thus store for each feature
+        // the (less intense) seeds that are contained in it.
         //
-        // The features are stored in an temporary feature map until it is
+        // Each thread stores its features in a buffer of its own until it is
         // decided whether they are contained within a seed of higher
-        // intensity.
-        std::map<Size, std::vector<Size> > seeds_in_features;
-        typedef std::map<Size, FeatureType> FeatureMapType;
-        FeatureMapType tmp_feature_map;
+        // intensity. The buffers are merged in the order of the seeds, so the
+        // result does not depend on the number of threads.
+
+        // seed positions sorted by m/z, to find the seeds inside a feature
+        std::vector<std::pair<double, Size> > seed_index;
+        seed_index.reserve(seeds.size());
+        for (Size i = 0; i < seeds.size(); ++i)
+        {
+          seed_index.push_back(std::make_pair(map_[seeds[i].spectrum][seeds[i].peak].getMZ(), i));
+        }
+        std::sort(seed_index.begin(), seed_index.end());
+
+#ifdef _OPENMP
+        std::vector<std::vector<SeedFeature_> > thread_features(omp_get_max_threads());
+#else
+        std::vector<std::vector<SeedFeature_> > thread_features(1);
+#endif
         gl_progress = 0;
         ff_->startProgress(0, seeds.size(), String("Extending seeds for charge ") + String(c));
 #ifdef _OPENMP
-#pragma omp parallel for
+#pragma omp parallel for schedule(dynamic)
 #endif
         for (SignedSize i = 0; i < (SignedSize)seeds.size(); ++i)
         {
@@ -733,14 +794,8 @@ public:
               //Step 3.3.2:
               //Gauss/EGH fit (first fit to find the feature boundaries)
               //------------------------------------------------------------------
-              Int plot_nr = -1;
-
-#ifdef _OPENMP
-#pragma omp critical (FeatureFinderAlgorithmPicked_PLOTNR)
-#endif
-              {
-                plot_nr = ++plot_nr_global;
-              }
+              // numbered by seed, independent of the processing order
+              Int plot_nr = plot_nr_global + 1 + (Int)i;
 
               //------------------------------------------------------------------
 
@@ -882,61 +937,64 @@ public:
                 }
 
 #ifdef _OPENMP
-#pragma omp critical (FeatureFinderAlgorithmPicked_TMPFEATUREMAP)
+                const int current_thread = omp_get_thread_num();
+#else
+                const int current_thread(0);
 #endif
-                {
-                  tmp_feature_map[i] = f;
-                }
+                thread_features[current_thread].push_back(SeedFeature_());
+                SeedFeature_& seed_feature = thread_features[current_thread].back();
+                seed_feature.seed = i;
+                seed_feature.feature = f;
 
                 //----------------------------------------------------------------
-                //Remember all seeds that lie inside the convex hull of the new feature
+                //Remember all (less intense) seeds that lie inside the convex hull of the new feature
                 DBoundingBox<2> bb = f.getConvexHull().getBoundingBox();
-                for (Size j = i + 1; j < seeds.size(); ++j)
+                std::vector<std::pair<double, Size> >::const_iterator it = std::lower_bound(seed_index.begin(), seed_index.end(), std::make_pair(bb.minY(), (Size)0));
+                for (; it != seed_index.end() && it->first <= bb.maxY(); ++it)
                 {
+                  Size j = it->second;
+                  if (j <= (Size)i) continue;
                   double rt = map_[seeds[j].spectrum].getRT();
-                  double mz = map_[seeds[j].spectrum][seeds[j].peak].getMZ();
+                  double mz = it->first;
                   if (bb.encloses(rt, mz) && f.encloses(rt, mz))
                   {
-#ifdef _OPENMP
-#pragma omp critical (FeatureFinderAlgorithmPicked_SEEDSINFEATURES)
-#endif
-                    {
-                      seeds_in_features[i].push_back(j);
-                    }
+                    seed_feature.contained_seeds.push_back(j);
                   }
                 }
               }
             }
           } // three if/else statements instead of continue (disallowed in OpenMP)
         } // end of OPENMP over seeds
+        plot_nr_global += (Int)seeds.size();
+
+        // merge the features of all threads
+        std::vector<SeedFeature_> seed_features;
+        for (Size t = 0; t < thread_features.size(); ++t)
+        {
+          seed_features.insert(seed_features.end(), thread_features[t].begin(), thread_features[t].end());
+        }
 
         // Here we have to evaluate which seeds are already contained in
         // features of seeds with higher intensities. Only if the seed is not
         // used in any feature with higher intensity, we can add it to the
         // features_ list.
-        std::vector<Size> seeds_contained;
-        for (typename std::map<Size, FeatureType>::iterator iter = tmp_feature_map.begin(); iter != tmp_feature_map.end(); ++iter)
+        std::sort(seed_features.begin(), seed_features.end());
+        std::vector<bool> seeds_contained(seeds.size(), false);
+        for (Size k = 0; k < seed_features.size(); ++k)
         {
-          Size seed_nr = iter->first;
-          bool is_used = false;
-          for (Size i = 0; i < seeds_contained.size(); ++i)
-          {
-            if (seed_nr == seeds_contained[i]) { is_used = true; break; }
-          }
-          if (!is_used)
+          if (!seeds_contained[seed_features[k].seed])
           {
             ++feature_candidates;
 
             //re-set label
-            iter->second.setMetaValue(3, feature_nr_global);
+            seed_features[k].feature.setMetaValue(3, feature_nr_global);
             ++feature_nr_global;
-            features_->push_back(iter->second);
+            features_->push_back(seed_features[k].feature);
 
-            std::vector<Size> curr_seed = seeds_in_features[seed_nr];
-            for (Size k = 0; k < curr_seed.size(); ++k)
+            const std::vector<Size>& curr_seed = seed_features[k].contained_seeds;
+            for (Size l = 0; l < curr_seed.size(); ++l)
             {
-              seeds_contained.push_back(curr_seed[k]);
-
+              seeds_contained[curr_seed[l]] = true;
             }
           }
         }
@@ -950,13 +1008,15 @@ public:
       //Step 4:
       //Resolve contradicting and overlapping features
       //------------------------------------------------------------------
-      ff_->startProgress(0, features_->size() * features_->size(), "Resolving overlapping features");
+      ff_->startProgress(0, features_->size(), "Resolving overlapping features");
       if (debug_) log_ << "Resolving intersecting features (" << features_->size() << " candidates)" << std::endl;
       //sort features according to m/z in order to speed up the resolution
       features_->sortByMZ();
       //precalculate BBs and maximum mz span
       std::vector<DBoundingBox<2> > bbs(features_->size());
       double max_mz_span = 0.0;
+      double mean_rt_span = 0.0;
+      double mean_mz_span = 0.0;
 
       for (Size i = 0; i < features_->size(); ++i)
       {
@@ -965,16 +1025,36 @@ public:
         {
           max_mz_span = bbs[i].height();
         }
+        mean_rt_span += bbs[i].width();
+        mean_mz_span += bbs[i].height();
+      }
+
+      //spatial index: each BB is registered in all cells of an RT/m/z grid
+      //it covers (cell size: mean BB size), only features sharing a cell
+      //can intersect
+      if (!features_->empty())
+      {
+        mean_rt_span /= features_->size();
+        mean_mz_span /= features_->size();
+      }
+      FeatureGrid_ grid(mean_rt_span, mean_mz_span);
+      for (Size i = 0; i < bbs.size(); ++i)
+      {
+        grid.insert(bbs[i], i);
       }
 
       Size removed(0);
+      std::vector<Size> candidates;
       //intersect
       for (Size i = 0; i < features_->size(); ++i)
       {
+        ff_->setProgress(i);
         Feature& f1((*features_)[i]);
-        for (Size j = i + 1; j < features_->size(); ++j)
+        //candidates in ascending order (features are processed in m/z order)
+        grid.query(bbs[i], i, candidates);
+        for (Size k = 0; k < candidates.size(); ++k)
         {
-          ff_->setProgress(i * features_->size() + j);
+          Size j = candidates[k];
           Feature& f2((*features_)[j]);
           //features that are more than 2 times the maximum m/z span apart do not overlap => abort
           if (f2.getMZ() - f1.getMZ() > 2.0 * max_mz_span) break;
@@ -1145,6 +1225,96 @@ protected:
     ///Vector of precalculated isotope distributions for several mass windows
     std::vector<TheoreticalIsotopePattern> isotope_distributions_;
 
+    /**
+      @brief Regular grid over RT and m/z for finding intersecting bounding boxes
+
+      Each bounding box is registered in all grid cells it covers.
+    */
+    class FeatureGrid_
+    {
+public:
+      /// Constructor with the cell sizes (non-positive sizes are replaced by 1)
+      FeatureGrid_(double rt_cell_size, double mz_cell_size) :
+        rt_cell_size_(rt_cell_size > 0.0 ? rt_cell_size : 1.0),
+        mz_cell_size_(mz_cell_size > 0.0 ? mz_cell_size : 1.0)
+      {
+      }
+
+      /// Registers the bounding box @p bb with index @p index
+      void insert(const DBoundingBox<2>& bb, Size index)
+      {
+        if (!isValid_(bb)) return;
+        for (SignedSize rt = cellRT_(bb.minX()); rt <= cellRT_(bb.maxX()); ++rt)
+        {
+          for (SignedSize mz = cellMZ_(bb.minY()); mz <= cellMZ_(bb.maxY()); ++mz)
+          {
+            cells_[std::make_pair(rt, mz)].push_back(index);
+          }
+        }
+      }
+
+      /// Returns the indices (sorted, unique) larger than @p min_index of all boxes that share a cell with @p bb
+      void query(const DBoundingBox<2>& bb, Size min_index, std::vector<Size>& result) const
+      {
+        result.clear();
+        if (!isValid_(bb)) return;
+        for (SignedSize rt = cellRT_(bb.minX()); rt <= cellRT_(bb.maxX()); ++rt)
+        {
+          for (SignedSize mz = cellMZ_(bb.minY()); mz <= cellMZ_(bb.maxY()); ++mz)
+          {
+            typename CellMap::const_iterator cell = cells_.find(std::make_pair(rt, mz));
+            if (cell == cells_.end()) continue;
+            for (Size k = 0; k < cell->second.size(); ++k)
+            {
+              if (cell->second[k] > min_index) result.push_back(cell->second[k]);
+            }
+          }
+        }
+        std::sort(result.begin(), result.end());
+        result.erase(std::unique(result.begin(), result.end()), result.end());
+      }
+
+protected:
+      typedef std::map<std::pair<SignedSize, SignedSize>, std::vector<Size> > CellMap;
+
+      /// boxes without any points (e.g. of empty convex hulls) intersect nothing
+      static bool isValid_(const DBoundingBox<2>& bb)
+      {
+        return bb.minX() <= bb.maxX() && bb.minY() <= bb.maxY();
+      }
+
+      SignedSize cellRT_(double rt) const
+      {
+        return (SignedSize)std::floor(rt / rt_cell_size_);
+      }
+
+      SignedSize cellMZ_(double mz) const
+      {
+        return (SignedSize)std::floor(mz / mz_cell_size_);
+      }
+
+      double rt_cell_size_;
+      double mz_cell_size_;
+      CellMap cells_;
+    };
+
+    /// Feature created from a seed, with the (less intense) seeds lying inside of it
+    struct SeedFeature_
+    {
+      /// Index of the seed the feature was created from
+      Size seed;
+      /// The feature
+      Feature feature;
+      /// Indices of the seeds inside the feature
+      std::vector<Size> contained_seeds;
+
+      /// Comparison by seed index
+      bool operator<(const SeedFeature_& rhs) const
+      {
+        return seed < rhs.seed;
+      }
+    };
+
     // Docu in base class
     virtual void updateMembers_()
     {
@@ -1169,9 +1339,14 @@ protected:
     /// Writes the abort reason to the log file and counts occurrences for each reason
     void abort_(const Seed& seed, const String& reason)
     {
-      if (debug_) log_ << "Abort: " << reason << std::endl;
-      aborts_[reason]++;
-      if (debug_) abort_reasons_[seed] = reason;
+#ifdef _OPENMP
+#pragma omp critical (FeatureFinderAlgorithmPicked_ABORT)
+#endif
+      {
+        if (debug_) log_ << "Abort: " << reason << std::endl;
+        aborts_[reason]++;
+        if (debug_) abort_reasons_[seed] = reason;
+      }
     }
 
     /**
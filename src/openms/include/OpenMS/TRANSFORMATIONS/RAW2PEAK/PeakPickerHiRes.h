@@ -43,6 +43,10 @@
 
 #include <OpenMS/FILTERING/NOISEESTIMATION/SignalToNoiseEstimatorMedian.h>
 
+#include <algorithm>
+#include <functional>
+#include <vector>
+
 
 #define DEBUG_PEAK_PICKING
 #undef DEBUG_PEAK_PICKING
@@ -117,234 +121,29 @@ public:
     template <typename PeakType>
     void pick(const MSSpectrum<PeakType> & input, MSSpectrum<PeakType> & output, std::vector<PeakBoundary> & boundaries) const
     {
-      // copy meta data of the input spectrum
-      output.clear(true);
-      output.SpectrumSettings::operator=(input);
-      output.MetaInfoInterface::operator=(input);
-      output.setRT(input.getRT());
-      output.setMSLevel(input.getMSLevel());
-      output.setName(input.getName());
-      output.setType(SpectrumSettings::PEAKS);
-
-      // don't pick a spectrum with less than 5 data points
-      if (input.size() < 5) return;
-
-      // signal-to-noise estimation
-      SignalToNoiseEstimatorMedian<MSSpectrum<PeakType> > snt;
-      snt.setParameters(param_.copy("SignalToNoise:", true));
-
-      if (signal_to_noise_ > 0.0)
-      {
-        snt.init(input);
-      }
-
-      // find local maxima in raw data
-      for (Size i = 2; i < input.size() - 2; ++i)
-      {
-        double central_peak_mz = input[i].getMZ(), central_peak_int = input[i].getIntensity();
-        double left_neighbor_mz = input[i - 1].getMZ(), left_neighbor_int = input[i - 1].getIntensity();
-        double right_neighbor_mz = input[i + 1].getMZ(), right_neighbor_int = input[i + 1].getIntensity();
-
-        //do not interpolate when the left or right support is a zero-data-point
-        if(std::fabs(left_neighbor_int) < std::numeric_limits<double>::epsilon() )
-          continue;
-        if(std::fabs(right_neighbor_int) < std::numeric_limits<double>::epsilon() )
-          continue;
-
-        // MZ spacing sanity checks
-        double left_to_central = std::fabs(central_peak_mz - left_neighbor_mz);
-        double central_to_right = std::fabs(right_neighbor_mz - central_peak_mz);
-        double min_spacing = (left_to_central < central_to_right) ? left_to_central : central_to_right;
-
-        double act_snt = 0.0, act_snt_l1 = 0.0, act_snt_r1 = 0.0;
-
-        if (signal_to_noise_ > 0.0)
-        {
-          act_snt = snt.getSignalToNoise(input[i]);
-          act_snt_l1 = snt.getSignalToNoise(input[i - 1]);
-          act_snt_r1 = snt.getSignalToNoise(input[i + 1]);
-        }
-
-        // look for peak cores meeting MZ and intensity/SNT criteria
-        if (act_snt >= signal_to_noise_
-           && left_to_central < spacing_difference_ * min_spacing
-           && central_peak_int > left_neighbor_int
-           && act_snt_l1 >= signal_to_noise_
-           && central_to_right < spacing_difference_ * min_spacing
-           && central_peak_int > right_neighbor_int
-           && act_snt_r1 >= signal_to_noise_)
-        {
-          // special case: if a peak core is surrounded by more intense
-          // satellite peaks (indicates oscillation rather than
-          // real peaks) -> remove
-
-          double act_snt_l2 = 0.0, act_snt_r2 = 0.0;
-
-          if (signal_to_noise_ > 0.0)
-          {
-            act_snt_l2 = snt.getSignalToNoise(input[i - 2]);
-            act_snt_r2 = snt.getSignalToNoise(input[i + 2]);
-          }
-
-          //checking signal-to-noise?
-          if (std::fabs(left_neighbor_mz - input[i - 2].getMZ()) < spacing_difference_ * min_spacing
-              && left_neighbor_int < input[i - 2].getIntensity()
-              && act_snt_l2 >= signal_to_noise_
-              && (i + 2) < input.size()
-              && std::fabs(input[i + 2].getMZ() - right_neighbor_mz) < spacing_difference_ * min_spacing
-              && right_neighbor_int < input[i + 2].getIntensity()
-              && act_snt_r2 >= signal_to_noise_)
-          {
-            ++i;
-            continue;
-          }
-
-          std::map<double, double> peak_raw_data;
-
-          peak_raw_data[central_peak_mz] = central_peak_int;
-          peak_raw_data[left_neighbor_mz] = left_neighbor_int;
-          peak_raw_data[right_neighbor_mz] = right_neighbor_int;
-
-          // peak core found, now extend it
-          // to the left
-          Size k = 2;
-
-          bool previous_zero_left(false);    // no need to extend peak if previous intensity was zero
-          Size missing_left(0);
-          Size left_boundary(i-1);    // index of the left boundary for the spline interpolation
-
-          while ( k <= i    //prevent underflow
-                && (i - k + 1) > 0
-                && (missing_left < 2)
-                && !previous_zero_left
-                && input[i - k].getIntensity() <= peak_raw_data.begin()->second)
-          {
-
-            double act_snt_lk = 0.0;
-
-            if (signal_to_noise_ > 0.0)
-            {
-              act_snt_lk = snt.getSignalToNoise(input[i - k]);
-            }
-
-
-            if (act_snt_lk >= signal_to_noise_ && std::fabs(input[i - k].getMZ() - peak_raw_data.begin()->first) < spacing_difference_ * min_spacing)
-            {
-              peak_raw_data[input[i - k].getMZ()] = input[i - k].getIntensity();
-            }
-            else
-            {
-              peak_raw_data[input[i - k].getMZ()] = input[i - k].getIntensity();
-              ++missing_left;
-            }
-
-            previous_zero_left = (input[i - k].getIntensity() == 0);
-
-            left_boundary = i - k;
-            ++k;
-
-          }
-
-          // to the right
-          k = 2;
-          
-          bool previous_zero_right(false);    // no need to extend peak if previous intensity was zero
-          Size missing_right(0);
-          Size right_boundary(i+1);    // index of the right boundary for the spline interpolation
-          
-          while ((i + k) < input.size()
-                && (missing_right < 2)
-                && !previous_zero_right
-                && input[i + k].getIntensity() <= peak_raw_data.rbegin()->second)
-          {
-
-            double act_snt_rk = 0.0;
-
-            if (signal_to_noise_ > 0.0)
-            {
-              act_snt_rk = snt.getSignalToNoise(input[i + k]);
-            }
-
-            if (act_snt_rk >= signal_to_noise_ && std::fabs(input[i + k].getMZ() - peak_raw_data.rbegin()->first) < spacing_difference_ * min_spacing)
-            {
-              peak_raw_data[input[i + k].getMZ()] = input[i + k].getIntensity();
-            }
-            else
-            {
-              peak_raw_data[input[i + k].getMZ()] = input[i + k].getIntensity();
-              ++missing_right;
-            }
-
-            previous_zero_right = (input[i + k].getIntensity() == 0);
-
-            right_boundary = i + k;
-            ++k;
-          }
-
-          //skip if the minimal number of 3 points for fitting is not reached
-          if(peak_raw_data.size() < 4)
-            continue;
-
-          CubicSpline2d peak_spline (peak_raw_data);
-
-          // calculate maximum by evaluating the spline's 1st derivative
-          // (bisection method)
-          double max_peak_mz = central_peak_mz;
-          double max_peak_int = central_peak_int;
-          double threshold = 0.000001;
-          double lefthand = left_neighbor_mz;
-          double righthand = right_neighbor_mz;
-
-          bool lefthand_sign = 1;
-          double eps = std::numeric_limits<double>::epsilon();
-
-          // bisection
-          do
-          {
-            double mid = (lefthand + righthand) / 2;
-            double midpoint_deriv_val = peak_spline.derivatives(mid, 1);
-
-            // if deriv nearly zero then maximum already found
-            if (!(std::fabs(midpoint_deriv_val) > eps))
-            {
-              break;
-            }
-
-            bool midpoint_sign = (midpoint_deriv_val < 0.0) ? 0 : 1;
-
-            if (lefthand_sign ^ midpoint_sign)
-            {
-              righthand = mid;
-            }
-            else
-            {
-              lefthand = mid;
-            }
-          }
-          while (std::fabs(lefthand - righthand) > threshold);
-
-          // sanity check?
-          max_peak_mz = (lefthand + righthand) / 2;
-          max_peak_int = peak_spline.eval( max_peak_mz );
-
-          // save picked pick into output spectrum
-          PeakType peak;
-          PeakBoundary peak_boundary;
-          peak.setMZ(max_peak_mz);
-          peak.setIntensity(max_peak_int);
-          peak_boundary.mz_min = input[left_boundary].getMZ();
-          peak_boundary.mz_max = input[right_boundary].getMZ();
-          output.push_back(peak);
-          boundaries.push_back(peak_boundary);
-
-          // jump over raw data points that have been considered already
-          i = i + k - 1;
-        }
-      }
-
-      return;
+      PickBuffers_ buffers;
+      pick_(input, output, boundaries, buffers);
     }
 
+    /**
+     * @brief Applies the peak-picking algorithm to raw data arrays (e.g. the
+     * binary data arrays of OpenMS::Interfaces::Spectrum as returned by
+     * OnDiscMSExperiment::getSpectrumById()). The m/z and intensity values of
+     * the picked peaks are written to separate output arrays.
+     *
+     * All other pick() methods are implemented using this method, the
+     * results are identical.
+     *
+     * @param mz_array  m/z values of the input in profile mode (sorted ascending)
+     * @param int_array  intensities of the input (same size as @p mz_array)
+     * @param mz_out  m/z values of the picked peaks
+     * @param int_out  intensities of the picked peaks
+     * @param boundaries  boundaries of the picked peaks
+     *
+     * @exception Exception::IllegalArgument is thrown if the arrays differ in size
+     */
+    void pick(const std::vector<double> & mz_array, const std::vector<double> & int_array, std::vector<double> & mz_out, std::vector<double> & int_out, std::vector<PeakBoundary> & boundaries) const;
+
      /**
      * @brief Applies the peak-picking algorithm to a single chromatogram
      * (MSChromatogram). The resulting picked peaks are written to the output chromatogram.
@@ -370,24 +169,8 @@ public:
     template <typename PeakType>
     void pick(const MSChromatogram<PeakType> & input, MSChromatogram<PeakType> & output, std::vector<PeakBoundary> & boundaries) const
     {
-      // copy meta data of the input chromatogram
-      output.clear(true);
-      output.ChromatogramSettings::operator=(input);
-      output.MetaInfoInterface::operator=(input);
-      output.setName(input.getName());
-
-      MSSpectrum<PeakType> input_spectrum;
-      MSSpectrum<PeakType> output_spectrum;
-      for (typename MSChromatogram<PeakType>::const_iterator it = input.begin(); it != input.end(); ++it)
-      {
-        input_spectrum.push_back(*it);
-      }
-      pick(input_spectrum, output_spectrum, boundaries);
-      for (typename MSSpectrum<PeakType>::const_iterator it = output_spectrum.begin(); it != output_spectrum.end(); ++it)
-      {
-        output.push_back(*it);
-      }
-
+      PickBuffers_ buffers;
+      pick_(input, output, boundaries, buffers);
     }
 
     /**
@@ -431,6 +214,8 @@ public:
       bool ms1_only = param_.getValue("ms1_only").toBool();
       Size progress = 0;
 
+      PickBuffers_ buffers;    // scratch buffers, reused for all spectra and chromatograms
+
       startProgress(0, input.size() + input.getChromatograms().size(), "picking peaks");
       for (Size scan_idx = 0; scan_idx != input.size(); ++scan_idx)
       {
@@ -441,7 +226,7 @@ public:
         else
         {
           std::vector<PeakBoundary> boundaries_s;    // peak boundaries of a single spectrum
-          pick(input[scan_idx], output[scan_idx], boundaries_s);
+          pick_(input[scan_idx], output[scan_idx], boundaries_s, buffers);
           boundaries_spec.push_back(boundaries_s);
         }
         setProgress(++progress);
@@ -450,7 +235,7 @@ public:
       {
         MSChromatogram<ChromatogramPeakT> chromatogram;
         std::vector<PeakBoundary> boundaries_c;    // peak boundaries of a single chromatogram
-        pick(input.getChromatograms()[i], chromatogram, boundaries_c);
+        pick_(input.getChromatograms()[i], chromatogram, boundaries_c, buffers);
         output.addChromatogram(chromatogram);
         boundaries_chrom.push_back(boundaries_c);
         setProgress(++progress);
@@ -462,9 +247,12 @@ public:
     }
 
     /**
-      @brief Applies the peak-picking algorithm to a map (MSExperiment). This
-      method picks peaks for each scan in the map consecutively. The resulting
-      picked peaks are written to the output map.
+      @brief Applies the peak-picking algorithm to a map (OnDiscMSExperiment).
+      The resulting picked peaks are written to the output map.
+
+      Spectra and chromatograms are read from disk and picked in parallel
+      (if OpenMP is available), only the data currently processed by each
+      thread is held in memory in profile mode.
 
       Currently we have to give up const-correctness but we know that everything on disc is constant
     */
@@ -479,32 +267,73 @@ public:
 
       // resize output with respect to input
       output.resize(input.size());
+      std::vector<MSChromatogram<ChromatogramPeakT> > chromatograms(input.getNrChromatograms());
 
       bool ms1_only = param_.getValue("ms1_only").toBool();
+      boost::shared_ptr<const MSExperiment<> > meta_data = input.getMetaData();
       Size progress = 0;
 
       startProgress(0, input.size() + input.getNrChromatograms(), "picking peaks");
-      for (Size scan_idx = 0; scan_idx != input.size(); ++scan_idx)
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
       {
-        if (ms1_only && (input[scan_idx].getMSLevel() != 1))
+        PickBuffers_ buffers;    // scratch buffers of this thread
+        std::vector<PeakBoundary> boundaries;
+
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic)
+#endif
+        for (SignedSize scan_idx = 0; scan_idx < (SignedSize)input.size(); ++scan_idx)
         {
-          output[scan_idx] = input[scan_idx];
+          // the MS level is known from the meta data, no need to read the spectrum for it
+          if (ms1_only && ((*meta_data)[scan_idx].getMSLevel() != 1))
+          {
+            output[scan_idx] = input[scan_idx];
+          }
+          else
+          {
+            boundaries.clear();
+            OpenMS::Interfaces::SpectrumPtr sptr = input.getSpectrumById(scan_idx);
+            const std::vector<double> & mz_array = sptr->getMZArray()->data;
+            if (std::adjacent_find(mz_array.begin(), mz_array.end(), std::greater<double>()) == mz_array.end())
+            {
+              // sorted data is picked directly on the arrays read from disk
+              copyMetaData_((*meta_data)[scan_idx], output[scan_idx]);
+              pickArrays_(mz_array, sptr->getIntensityArray()->data, buffers.mz_out, buffers.int_out, boundaries, buffers);
+              appendPeaks_(buffers.mz_out, buffers.int_out, output[scan_idx]);
+            }
+            else
+            {
+              MSSpectrum<PeakType> s = input[scan_idx];
+              s.sortByPosition();
+              pick_(s, output[scan_idx], boundaries, buffers);
+            }
+          }
+#ifdef _OPENMP
+#pragma omp critical (PeakPickerHiRes_PickExperiment)
+#endif
+          {
+            setProgress(++progress);
+          }
         }
-        else
+
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic)
+#endif
+        for (SignedSize i = 0; i < (SignedSize)chromatograms.size(); ++i)
         {
-          MSSpectrum<PeakType> s = input[scan_idx];
-          s.sortByPosition();
-          pick(s, output[scan_idx]);
+          boundaries.clear();
+          pick_(input.getChromatogram(i), chromatograms[i], boundaries, buffers);
+#ifdef _OPENMP
+#pragma omp critical (PeakPickerHiRes_PickExperiment)
+#endif
+          {
+            setProgress(++progress);
+          }
         }
-        setProgress(++progress);
-      }
-      for (Size i = 0; i < input.getNrChromatograms(); ++i)
-      {
-        MSChromatogram<ChromatogramPeakT> chromatogram;
-        pick(input.getChromatogram(i), chromatogram);
-        output.addChromatogram(chromatogram);
-        setProgress(++progress);
       }
+      output.setChromatograms(chromatograms);
 
       endProgress();
 
@@ -512,12 +341,143 @@ public:
     }
 
 protected:
+    /// scratch buffers of the picking kernel, reused between spectra (one instance per thread)
+    struct PickBuffers_
+    {
+      /// positions and intensities of the input data
+      std::vector<double> mz, intensity;
+      /// positions and intensities of the picked peaks
+      std::vector<double> mz_out, int_out;
+      /// flags for the local maxima of the input data
+      std::vector<unsigned char> is_max;
+      /// data points of the current peak, left of the maximum (in descending order) and right of it
+      std::vector<double> left_mz, left_int, right_mz, right_int;
+      /// data points of the current peak used for the spline interpolation
+      std::vector<double> peak_mz, peak_int;
+      /// input for the signal-to-noise estimator, which works on peak containers
+      MSSpectrum<Peak1D> snt_spectrum;
+    };
+
+    /// copies the meta data of a spectrum to the picked spectrum
+    template <typename InputPeakType, typename PeakType>
+    void copyMetaData_(const MSSpectrum<InputPeakType> & input, MSSpectrum<PeakType> & output) const
+    {
+      output.clear(true);
+      output.SpectrumSettings::operator=(input);
+      output.MetaInfoInterface::operator=(input);
+      output.setRT(input.getRT());
+      output.setMSLevel(input.getMSLevel());
+      output.setName(input.getName());
+      output.setType(SpectrumSettings::PEAKS);
+    }
+
+    /// appends the picked peaks given as arrays to a spectrum or chromatogram
+    template <typename ContainerType>
+    void appendPeaks_(const std::vector<double> & mz_out, const std::vector<double> & int_out, ContainerType & output) const
+    {
+      output.reserve(output.size() + mz_out.size());
+      for (Size i = 0; i < mz_out.size(); ++i)
+      {
+        typename ContainerType::PeakType peak;
+        peak.setMZ(mz_out[i]);
+        peak.setIntensity(int_out[i]);
+        output.push_back(peak);
+      }
+    }
+
+    /// pick() for spectra, using the given scratch buffers
+    template <typename PeakType>
+    void pick_(const MSSpectrum<PeakType> & input, MSSpectrum<PeakType> & output, std::vector<PeakBoundary> & boundaries, PickBuffers_ & buffers) const
+    {
+      copyMetaData_(input, output);
+
+      // don't pick a spectrum with less than 5 data points
+      if (input.size() < 5) return;
+
+      // signal-to-noise estimation
+      SignalToNoiseEstimatorMedian<MSSpectrum<PeakType> > snt;
+      const double * snt_values = 0;
+      if (signal_to_noise_ > 0.0)
+      {
+        snt.setParameters(snt_param_);
+        snt.init(input);
+        // no estimates (e.g. no positive intensities) means S/N = 0 everywhere, so nothing is picked
+        if (snt.getSignalToNoiseEstimates().size() != input.size()) return;
+        snt_values = &snt.getSignalToNoiseEstimates()[0];
+      }
+
+      buffers.mz.resize(input.size());
+      buffers.intensity.resize(input.size());
+      for (Size i = 0; i < input.size(); ++i)
+      {
+        buffers.mz[i] = input[i].getMZ();
+        buffers.intensity[i] = input[i].getIntensity();
+      }
+
+      buffers.mz_out.clear();
+      buffers.int_out.clear();
+      pickKernel_(&buffers.mz[0], &buffers.intensity[0], snt_values, input.size(), buffers.mz_out, buffers.int_out, boundaries, buffers);
+      appendPeaks_(buffers.mz_out, buffers.int_out, output);
+    }
+
+    /// pick() for chromatograms, using the given scratch buffers
+    template <typename PeakType>
+    void pick_(const MSChromatogram<PeakType> & input, MSChromatogram<PeakType> & output, std::vector<PeakBoundary> & boundaries, PickBuffers_ & buffers) const
+    {
+      // copy meta data of the input chromatogram
+      output.clear(true);
+      output.ChromatogramSettings::operator=(input);
+      output.MetaInfoInterface::operator=(input);
+      output.setName(input.getName());
+
+      buffers.mz.resize(input.size());
+      buffers.intensity.resize(input.size());
+      for (Size i = 0; i < input.size(); ++i)
+      {
+        buffers.mz[i] = input[i].getRT();
+        buffers.intensity[i] = input[i].getIntensity();
+      }
+
+      // the kernel does not use the input buffers, they can be passed as arrays
+      pickArrays_(buffers.mz, buffers.intensity, buffers.mz_out, buffers.int_out, boundaries, buffers);
+      appendPeaks_(buffers.mz_out, buffers.int_out, output);
+    }
+
+    /**
+      @brief pick() for raw data arrays, using the given scratch buffers
+
+      The picked peaks are written to @p mz_out and @p int_out (which are cleared first), boundaries are appended to @p boundaries.
+      @p mz_array and @p int_array may be members of @p buffers, except for @p buffers.snt_spectrum.
+    */
+    void pickArrays_(const std::vector<double> & mz_array, const std::vector<double> & int_array, std::vector<double> & mz_out, std::vector<double> & int_out, std::vector<PeakBoundary> & boundaries, PickBuffers_ & buffers) const;
+
+    /**
+      @brief The peak-picking kernel, working on contiguous arrays of size @p size
+
+      First, the local maxima with non-zero neighbours are flagged in a single
+      pass without branches. The remaining checks, the extension of the peaks
+      and the spline interpolation are only done for the flagged positions.
+
+      @param mz  positions of the data points (sorted ascending)
+      @param intensity  intensities of the data points
+      @param snt  signal-to-noise estimates of the data points (null if not estimated)
+      @param size  number of data points
+      @param mz_out  positions of the picked peaks are appended here
+      @param int_out  intensities of the picked peaks are appended here
+      @param boundaries  boundaries of the picked peaks are appended here
+      @param buffers  scratch buffers (the output and input arrays are not used)
+    */
+    void pickKernel_(const double * mz, const double * intensity, const double * snt, Size size, std::vector<double> & mz_out, std::vector<double> & int_out, std::vector<PeakBoundary> & boundaries, PickBuffers_ & buffers) const;
+
     // signal-to-noise parameter
     double signal_to_noise_;
 
     // maximal spacing difference
     double spacing_difference_;
 
+    // parameters of the signal-to-noise estimator
+    Param snt_param_;
+
     // docu in base class
     void updateMembers_();
 
@@ -35,11 +35,50 @@
 #include <OpenMS/ANALYSIS/ID/IDMapper.h>
 #include <OpenMS/DATASTRUCTURES/ListUtils.h>
 
+#include <algorithm>
+
 using namespace std;
 
 namespace OpenMS
 {
 
+  namespace
+  {
+    /// position of a consensus feature (or of one of its sub-features) in the m/z index
+    struct MZIndexEntry
+    {
+      MZIndexEntry(double mz_, double rt_, Int charge_, Size feature_index_) :
+        mz(mz_), rt(rt_), charge(charge_), feature_index(feature_index_)
+      {
+      }
+
+      double mz;
+      double rt;
+      Int charge;
+      /// index of the consensus feature in the map
+      Size feature_index;
+    };
+
+    /// orders index entries (and m/z values) by m/z
+    struct MZIndexEntryLess
+    {
+      bool operator()(const MZIndexEntry& a, const MZIndexEntry& b) const
+      {
+        return a.mz < b.mz;
+      }
+
+      bool operator()(const MZIndexEntry& a, double mz) const
+      {
+        return a.mz < mz;
+      }
+
+      bool operator()(double mz, const MZIndexEntry& b) const
+      {
+        return mz < b.mz;
+      }
+    };
+  }
+
   IDMapper::IDMapper() :
     DefaultParamHandler("IDMapper"),
     rt_tolerance_(5.0),
@@ -103,94 +142,96 @@ namespace OpenMS
     //append protein identifications to Map
     map.getProteinIdentifications().insert(map.getProteinIdentifications().end(), protein_ids.begin(), protein_ids.end());
 
-    //keep track of assigned/unassigned peptide identifications
-    std::map<Size, Size> assigned;
-
-    // store which peptides fit which feature (and avoid double entries)
-    // consensusMap -> {peptide_index}
-    std::vector<std::set<size_t> > mapping(map.size());
+    // index the positions to match against (consensus features or their
+    // sub-features) by m/z, so every ID only looks at nearby candidates
+    std::vector<MZIndexEntry> mz_index;
+    for (Size cm_index = 0; cm_index < map.size(); ++cm_index)
+    {
+      if (!measure_from_subelements)
+      {
+        mz_index.push_back(MZIndexEntry(map[cm_index].getMZ(), map[cm_index].getRT(), map[cm_index].getCharge(), cm_index));
+      }
+      else
+      {
+        for (ConsensusFeature::HandleSetType::const_iterator it_handle = map[cm_index].getFeatures().begin();
+             it_handle != map[cm_index].getFeatures().end();
+             ++it_handle)
+        {
+          mz_index.push_back(MZIndexEntry(it_handle->getMZ(), it_handle->getRT(), it_handle->getCharge(), cm_index));
+        }
+      }
+    }
+    std::sort(mz_index.begin(), mz_index.end(), MZIndexEntryLess());
 
-    DoubleList mz_values;
-    double rt_pep;
-    IntList charges;
+    // indices of the consensus features matched by each peptide ID (sorted, unique)
+    std::vector<std::vector<Size> > matches(ids.size());
 
     //iterate over the peptide IDs
-    for (Size i = 0; i < ids.size(); ++i)
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 100)
+#endif
+    for (SignedSize i = 0; i < (SignedSize)ids.size(); ++i)
     {
       if (ids[i].getHits().empty())
         continue;
 
+      DoubleList mz_values;
+      double rt_pep;
+      IntList charges;
       getIDDetails_(ids[i], rt_pep, mz_values, charges);
 
-      //iterate over the features
-      for (Size cm_index = 0; cm_index < map.size(); ++cm_index)
+      std::vector<Size>& matched = matches[i];
+
+      // iterate over m/z values of pepIds
+      for (Size i_mz = 0; i_mz < mz_values.size(); ++i_mz)
       {
-        // if set to TRUE, we leave the i_mz-loop as we added the whole ID with all hits
-        bool was_added = false; // was current pep-m/z matched?!
+        double mz_pep = mz_values[i_mz];
 
-        // iterate over m/z values of pepIds
-        for (Size i_mz = 0; i_mz < mz_values.size(); ++i_mz)
+        // charge states to use for checking:
+        IntList current_charges;
+        if (!ignore_charge_)
         {
-          double mz_pep = mz_values[i_mz];
-
-          // charge states to use for checking:
-          IntList current_charges;
-          if (!ignore_charge_)
+          // if "mz_ref." is "precursor", we have only one m/z value to check,
+          // but still one charge state per peptide hit that could match:
+          if (mz_values.size() == 1)
           {
-            // if "mz_ref." is "precursor", we have only one m/z value to check,
-            // but still one charge state per peptide hit that could match:
-            if (mz_values.size() == 1)
-            {
-              current_charges = charges;
-            }
-            else
-            {
-              current_charges.push_back(charges[i_mz]);
-            }
-            current_charges.push_back(0); // "not specified" always matches
-          }
-
-          //check if we compare distance from centroid or subelements
-          if (!measure_from_subelements)
-          {
-            if (isMatch_(rt_pep - map[cm_index].getRT(), mz_pep, map[cm_index].getMZ()) && (ignore_charge_ || ListUtils::contains(current_charges, map[cm_index].getCharge())))
-            {
-              was_added = true;
-              map[cm_index].getPeptideIdentifications().push_back(ids[i]);
-              ++assigned[i];
-            }
+            current_charges = charges;
           }
           else
           {
-            for (ConsensusFeature::HandleSetType::const_iterator it_handle = map[cm_index].getFeatures().begin();
-                 it_handle != map[cm_index].getFeatures().end();
-                 ++it_handle)
-            {
-              if (isMatch_(rt_pep - it_handle->getRT(), mz_pep, it_handle->getMZ())  && (ignore_charge_ || ListUtils::contains(current_charges, it_handle->getCharge())))
-              {
-                was_added = true;
-                if (mapping[cm_index].count(i) == 0)
-                {
-                  map[cm_index].getPeptideIdentifications().push_back(ids[i]);
-                  ++assigned[i];
-                  mapping[cm_index].insert(i);
-                }
-                break; // we added this peptide already.. no need to check other handles
-              }
-            }
-            // continue to here
+            current_charges.push_back(charges[i_mz]);
           }
+          current_charges.push_back(0); // "not specified" always matches
+        }
 
-          if (was_added)
-            break;
-
-        } // m/z values to check
-
-        // break to here
+        // candidates within the (slightly widened) m/z tolerance; isMatch_()
+        // has the final say, so rounding cannot change the result
+        double mz_window = fabs(getAbsoluteMZTolerance_(mz_pep)) * 1.01;
+        std::vector<MZIndexEntry>::const_iterator it_begin = mz_index.begin(), it_end = mz_index.end();
+        it_begin = std::lower_bound(it_begin, it_end, mz_pep - mz_window, MZIndexEntryLess());
+        it_end = std::upper_bound(it_begin, it_end, mz_pep + mz_window, MZIndexEntryLess());
+        for (std::vector<MZIndexEntry>::const_iterator it = it_begin; it != it_end; ++it)
+        {
+          if (isMatch_(rt_pep - it->rt, mz_pep, it->mz) && (ignore_charge_ || ListUtils::contains(current_charges, it->charge)))
+          {
+            matched.push_back(it->feature_index);
+          }
+        }
+      } // m/z values to check
 
-      } // features
+      // every consensus feature receives the ID at most once
+      std::sort(matched.begin(), matched.end());
+      matched.erase(std::unique(matched.begin(), matched.end()), matched.end());
     } // Identifications
 
+    // annotate serially, so every feature receives its IDs in input order
+    for (Size i = 0; i < ids.size(); ++i)
+    {
+      for (Size j = 0; j < matches[i].size(); ++j)
+      {
+        map[matches[i][j]].getPeptideIdentifications().push_back(ids[i]);
+      }
+    }
 
     Size matches_none(0);
     Size matches_single(0);
@@ -199,16 +240,16 @@ namespace OpenMS
     //append unassigned peptide identifications
     for (Size i = 0; i < ids.size(); ++i)
     {
-      if (assigned[i] == 0)
+      if (matches[i].empty())
       {
         map.getUnassignedPeptideIdentifications().push_back(ids[i]);
         ++matches_none;
       }
-      else if (assigned[i] == 1)
+      else if (matches[i].size() == 1)
       {
         ++matches_single;
       }
-      else if (assigned[i] > 1)
+      else
       {
         ++matches_multi;
       }
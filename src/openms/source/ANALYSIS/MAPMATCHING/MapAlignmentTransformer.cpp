@@ -48,9 +48,6 @@ namespace OpenMS
   void MapAlignmentTransformer::transformPeakMaps(vector<MSExperiment<> >& maps,
                                                   const vector<TransformationDescription>& given_trafos)
   {
-    typedef vector<MSExperiment<> >::iterator TMapIterator;
-    typedef vector<TransformationDescription>::const_iterator TTrafoIterator;
-
     if (given_trafos.size() != maps.size())
     {
       throw Exception::IllegalArgument(__FILE__,
@@ -63,14 +60,13 @@ namespace OpenMS
                                        + "), these numbers are not equal");
     }
 
-    TMapIterator mapIter = maps.begin();
-    TTrafoIterator trafoIter = given_trafos.begin();
-
-    for (; mapIter != maps.end() && trafoIter != given_trafos.end();
-         ++mapIter,
-         ++trafoIter)
+    // maps are independent of each other
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 1)
+#endif
+    for (SignedSize i = 0; i < (SignedSize)maps.size(); ++i)
     {
-      transformSinglePeakMap(*mapIter, *trafoIter);
+      transformSinglePeakMap(maps[i], given_trafos[i]);
     }
   }
 
@@ -80,24 +76,38 @@ namespace OpenMS
     msexp.clearRanges();
 
     // Transform spectra
-    for (MSExperiment<>::iterator mse_iter = msexp.begin(); mse_iter != msexp.end(); ++mse_iter)
+    std::vector<double> rts(msexp.size());
+    for (Size i = 0; i < msexp.size(); ++i)
     {
-      double rt = mse_iter->getRT();
-      mse_iter->setRT(trafo.apply(rt));
+      rts[i] = msexp[i].getRT();
+    }
+    if (!rts.empty())
+    {
+      trafo.apply(&rts[0], &rts[0], rts.size());
+    }
+    for (Size i = 0; i < msexp.size(); ++i)
+    {
+      msexp[i].setRT(rts[i]);
     }
 
     // Also transform chromatograms
-    double rt;
-    std::vector<MSChromatogram<ChromatogramPeak> > chromatograms;
-    for (Size i = 0; i < msexp.getChromatograms().size(); i++)
+    std::vector<MSChromatogram<ChromatogramPeak> > chromatograms(msexp.getChromatograms());
+    for (Size i = 0; i < chromatograms.size(); i++)
     {
-      MSChromatogram<ChromatogramPeak> chromatogram = msexp.getChromatograms()[i];
+      MSChromatogram<ChromatogramPeak>& chromatogram = chromatograms[i];
+      rts.resize(chromatogram.size());
       for (Size j = 0; j < chromatogram.size(); j++)
       {
-        rt = chromatogram[j].getRT();
-        chromatogram[j].setRT(trafo.apply(rt));
+        rts[j] = chromatogram[j].getRT();
+      }
+      if (!rts.empty())
+      {
+        trafo.apply(&rts[0], &rts[0], rts.size());
+      }
+      for (Size j = 0; j < chromatogram.size(); j++)
+      {
+        chromatogram[j].setRT(rts[j]);
       }
-      chromatograms.push_back(chromatogram);
     }
     msexp.setChromatograms(chromatograms);
 
@@ -107,9 +117,6 @@ namespace OpenMS
   void MapAlignmentTransformer::transformFeatureMaps(vector<FeatureMap<> >& maps,
                                                      const vector<TransformationDescription>& given_trafos)
   {
-    typedef vector<FeatureMap<> >::iterator TFeatureMapsIterator;
-    typedef vector<TransformationDescription>::const_iterator TTrafoIterator;
-
     if (given_trafos.size() != maps.size())
     {
       throw Exception::IllegalArgument(__FILE__,
@@ -122,14 +129,13 @@ namespace OpenMS
                                        + "), these numbers are not equal");
     }
 
-    TFeatureMapsIterator fmapIter = maps.begin();
-    TTrafoIterator trafoIter = given_trafos.begin();
-
-    for (; fmapIter != maps.end() && trafoIter != given_trafos.end();
-         ++fmapIter,
-         ++trafoIter)
+    // maps are independent of each other
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 1)
+#endif
+    for (SignedSize i = 0; i < (SignedSize)maps.size(); ++i)
     {
-      transformSingleFeatureMap(*fmapIter, *trafoIter);
+      transformSingleFeatureMap(maps[i], given_trafos[i]);
     }
   }
 
@@ -200,9 +206,6 @@ namespace OpenMS
   void MapAlignmentTransformer::transformConsensusMaps(vector<ConsensusMap>& maps,
                                                        const vector<TransformationDescription>& given_trafos)
   {
-    typedef vector<ConsensusMap>::iterator TMapIterator;
-    typedef vector<TransformationDescription>::const_iterator TTrafoIterator;
-
     if (given_trafos.size() != maps.size())
     {
       throw Exception::IllegalArgument(__FILE__,
@@ -215,14 +218,13 @@ namespace OpenMS
                                        + "), these numbers are not equal");
     }
 
-    TMapIterator mapIter = maps.begin();
-    TTrafoIterator trafoIter = given_trafos.begin();
-
-    for (; mapIter != maps.end() && trafoIter != given_trafos.end();
-         ++mapIter,
-         ++trafoIter)
+    // maps are independent of each other
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 1)
+#endif
+    for (SignedSize i = 0; i < (SignedSize)maps.size(); ++i)
     {
-      transformSingleConsensusMap(*mapIter, *trafoIter);
+      transformSingleConsensusMap(maps[i], given_trafos[i]);
     }
   }
 
@@ -246,9 +248,6 @@ namespace OpenMS
   void MapAlignmentTransformer::transformPeptideIdentifications(vector<vector<PeptideIdentification> >& maps,
                                                                 const vector<TransformationDescription>& given_trafos)
   {
-    typedef vector<vector<PeptideIdentification> >::iterator TPeptideIdentificationsIterator;
-    typedef vector<TransformationDescription>::const_iterator TTrafoIterator;
-
     if (given_trafos.size() != maps.size())
     {
       throw Exception::IllegalArgument(__FILE__,
@@ -261,14 +260,13 @@ namespace OpenMS
                                        + "), these numbers are not equal");
     }
 
-    TPeptideIdentificationsIterator pepIdentIter = maps.begin();
-    TTrafoIterator trafoIter = given_trafos.begin();
-
-    for (; pepIdentIter != maps.end() && trafoIter != given_trafos.end();
-         ++pepIdentIter,
-         ++trafoIter)
+    // maps are independent of each other
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 1)
+#endif
+    for (SignedSize i = 0; i < (SignedSize)maps.size(); ++i)
     {
-      transformSinglePeptideIdentification(*pepIdentIter, *trafoIter);
+      transformSinglePeptideIdentification(maps[i], given_trafos[i]);
     }
   }
 
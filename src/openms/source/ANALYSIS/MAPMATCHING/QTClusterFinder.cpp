@@ -37,6 +37,8 @@
 #include <OpenMS/CONCEPT/Exception.h>
 #include <OpenMS/DATASTRUCTURES/ListUtils.h>
 
+#include <algorithm>
+
 using namespace std;
 
 namespace OpenMS
@@ -127,81 +129,86 @@ namespace OpenMS
 
     // compute QT clustering:
     //cout << "Clustering..." << endl;
-    list<QTCluster> clustering;
+    vector<QTCluster> clustering;
     computeClustering_(grid, clustering);
     // number of clusters == number of data points:
     Size size = clustering.size();
 
     // Create a temporary map where we store which GridFeatures are next to which Clusters
-    OpenMSBoost::unordered_map<GridFeature *, std::vector< QTCluster * > > element_mapping;
-    for (list<QTCluster>::iterator it = clustering.begin(); it != clustering.end(); ++it)
+    ElementMapping element_mapping;
+    typedef std::multimap<double, GridFeature *> InnerNeighborMap;
+    typedef OpenMSBoost::unordered_map<Size, InnerNeighborMap> NeighborMap;
+    for (Size cluster_index = 0; cluster_index < size; ++cluster_index)
     {
-      OpenMSBoost::unordered_map<Size, GridFeature *> elements;
-      typedef std::multimap<double, GridFeature *> InnerNeighborMap;
-      typedef OpenMSBoost::unordered_map<Size, InnerNeighborMap > NeighborMap;
-      NeighborMap neigh = it->getNeighbors();
-      for (NeighborMap::iterator n_it = neigh.begin(); n_it != neigh.end(); ++n_it)
+      const NeighborMap & neigh = clustering[cluster_index].getNeighbors();
+      for (NeighborMap::const_iterator n_it = neigh.begin(); n_it != neigh.end(); ++n_it)
       {
-        for (InnerNeighborMap::iterator i_it = n_it->second.begin(); i_it != n_it->second.end(); ++i_it)
+        for (InnerNeighborMap::const_iterator i_it = n_it->second.begin(); i_it != n_it->second.end(); ++i_it)
         {
-          element_mapping[i_it->second].push_back( &(*it) );
+          element_mapping[i_it->second].push_back(cluster_index);
         }
       }
     }
 
+    // queue all clusters by quality:
+    ClusterQueue queue;
+    for (Size cluster_index = 0; cluster_index < size; ++cluster_index)
+    {
+      queue.push(make_pair(clustering[cluster_index].getQuality(), -SignedSize(cluster_index)));
+    }
+
     ProgressLogger logger;
     logger.setLogType(ProgressLogger::CMD);
     logger.startProgress(0, size, "linking features");
     Size progress = 0;
     result_map.clear(false);
 
-    while (!clustering.empty())
+    ConsensusFeature consensus_feature;
+    while (makeConsensusFeature_(clustering, queue, consensus_feature, element_mapping))
     {
-      // cout << "Clusters: " << clustering.size() << endl;
-      ConsensusFeature consensus_feature;
-      makeConsensusFeature_(clustering, consensus_feature, element_mapping);
-      if (!clustering.empty())
-      {
-        result_map.push_back(consensus_feature);
-      }
+      result_map.push_back(consensus_feature);
+      consensus_feature = ConsensusFeature();
       logger.setProgress(progress++);
     }
 
     logger.endProgress();
   }
 
-  void QTClusterFinder::makeConsensusFeature_(list<QTCluster> & clustering,
-           ConsensusFeature & feature, OpenMSBoost::unordered_map<GridFeature *,
-             std::vector< QTCluster * > > & element_mapping)
+  bool QTClusterFinder::makeConsensusFeature_(vector<QTCluster> & clustering,
+           ClusterQueue & queue, ConsensusFeature & feature,
+           const ElementMapping & element_mapping)
   {
-    // find the best cluster (a valid cluster with the highest score)
-    list<QTCluster>::iterator best = clustering.begin();
-    while (best != clustering.end() && best->isInvalid()) {++best;}
-    for (list<QTCluster>::iterator it = best;
-         it != clustering.end(); ++it)
+    // find the best cluster (a valid cluster with the highest score, the
+    // earliest one if several have the same score); queue entries of invalid
+    // clusters and outdated qualities are discarded on the way
+    Size best_index = 0;
+    bool found = false;
+    while (!queue.empty())
     {
-      if (!it->isInvalid())
+      Size index = Size(-queue.top().second);
+      double quality = queue.top().first;
+      queue.pop();
+      if (!clustering[index].isInvalid() && (clustering[index].getQuality() == quality))
       {
-        if (it->getQuality() > best->getQuality())
-        {
-          best = it;
-        }
+        best_index = index;
+        found = true;
+        break;
       }
     }
 
-    // no more clusters to process -> clear clustering and return
-    if (best == clustering.end())
+    // no more clusters to process
+    if (!found)
     {
-      clustering.clear();
-      return;
+      return false;
     }
 
+    QTCluster & best = clustering[best_index];
     OpenMSBoost::unordered_map<Size, GridFeature *> elements;
-    best->getElements(elements);
-    // cout << "Elements: " << elements.size() << " with best " << best->getQuality() << " invalid " << best->isInvalid() << endl;
+    best.getElements(elements);
+    // cout << "Elements: " << elements.size() << " with best " << best.getQuality() << " invalid " << best.isInvalid() << endl;
 
     // create consensus feature from best cluster:
-    feature.setQuality(best->getQuality());
+    feature.setQuality(best.getQuality());
     for (OpenMSBoost::unordered_map<Size, GridFeature *>::const_iterator it = elements.begin();
          it != elements.end(); ++it)
     {
@@ -209,31 +216,63 @@ namespace OpenMS
     }
     feature.computeConsensus();
 
-
- 
     // update the clustering:
     // 1. remove current "best" cluster
     // 2. update all clusters accordingly and invalidate elements whose central
     //    element is removed
-    best->setInvalid();
+    best.setInvalid();
+
+    // collect the affected clusters (each one only once); we do not want to
+    // update invalid features (saves time and does not recompute the quality)
+    vector<Size> affected;
     for (OpenMSBoost::unordered_map<Size, GridFeature *>::const_iterator it = elements.begin();
          it != elements.end(); ++it)
     {
-      for (std::vector< QTCluster* >::iterator 
-            cluster  = element_mapping[&(*it->second)].begin();
-            cluster != element_mapping[&(*it->second)].end(); ++cluster)
+      ElementMapping::const_iterator pos = element_mapping.find(it->second);
+      if (pos == element_mapping.end())
+        continue;
+      affected.insert(affected.end(), pos->second.begin(), pos->second.end());
+    }
+    sort(affected.begin(), affected.end());
+    affected.erase(unique(affected.begin(), affected.end()), affected.end());
+
+    vector<double> old_quality(affected.size());
+    for (Size i = 0; i < affected.size(); ++i)
+    {
+      old_quality[i] = clustering[affected[i]].getQuality();
+    }
+
+    // the clusters are independent of each other, so they can be updated (and
+    // their qualities recomputed) concurrently if there are enough of them:
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic) if (affected.size() > 64)
+#endif
+    for (SignedSize i = 0; i < (SignedSize)affected.size(); ++i)
+    {
+      QTCluster & cluster = clustering[affected[i]];
+      if (!cluster.isInvalid())
       {
-        // we do not want to update invalid features (saves time and does not
-        // recompute the quality)
-        if (!(*cluster)->isInvalid())
+        if (!cluster.update(elements))       // cluster is invalid (center point removed):
         {
-          if (!(*cluster)->update(elements))       // cluster is invalid (center point removed):
-          {
-            (*cluster)->setInvalid();
-          }
+          cluster.setInvalid();
+        }
+        else
+        {
+          cluster.getQuality();
         }
       }
     }
+
+    // re-queue the clusters whose quality has changed:
+    for (Size i = 0; i < affected.size(); ++i)
+    {
+      QTCluster & cluster = clustering[affected[i]];
+      if (!cluster.isInvalid() && (cluster.getQuality() != old_quality[i]))
+      {
+        queue.push(make_pair(cluster.getQuality(), -SignedSize(affected[i])));
+      }
+    }
+    return true;
   }
 
   void QTClusterFinder::run(const vector<ConsensusMap> & input_maps,
@@ -249,78 +288,91 @@ namespace OpenMS
   }
 
   void QTClusterFinder::computeClustering_(Grid & grid,
-                                           list<QTCluster> & clustering)
+                                           vector<QTCluster> & clustering)
   {
     clustering.clear();
-    distances_.clear();
     // FeatureDistance produces normalized distances (between 0 and 1):
     const double max_distance = 1.0;
 
-    // iterate over all grid cells:
+    // collect the grid features in the order of iteration over the grid:
+    vector<pair<Grid::CellIndex, GridFeature *> > centers;
+    OpenMSBoost::unordered_map<const GridFeature *, Size> ranks;
     for (Grid::iterator it = grid.begin(); it != grid.end(); ++it)
     {
-      const Grid::CellIndex & act_coords = it.index();
-      const Int x = act_coords[0], y = act_coords[1];
-      //cout << x << " " << y << endl;
+      ranks[it->second] = centers.size();
+      centers.push_back(make_pair(it.index(), it->second));
+      clustering.push_back(QTCluster(it->second, num_maps_, max_distance, use_IDs_));
+    }
 
-      GridFeature * center_feature = it->second;
-      QTCluster cluster(center_feature, num_maps_, max_distance, use_IDs_);
+    const Grid & const_grid = grid;
 
-      // iterate over neighboring grid cells (1st dimension):
-      for (int i = x - 1; i <= x + 1; ++i)
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+    {
+      // the distance functor is not thread-safe, so every thread uses its own
+      FeatureDistance feature_distance(feature_distance_);
+
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic, 100)
+#endif
+      for (SignedSize center_index = 0; center_index < (SignedSize)centers.size(); ++center_index)
       {
-        // iterate over neighboring grid cells (2nd dimension):
-        for (int j = y - 1; j <= y + 1; ++j)
+        const Grid::CellIndex & act_coords = centers[center_index].first;
+        const Int x = act_coords[0], y = act_coords[1];
+        //cout << x << " " << y << endl;
+
+        GridFeature * center_feature = centers[center_index].second;
+        QTCluster & cluster = clustering[center_index];
+
+        // iterate over neighboring grid cells (1st dimension):
+        for (int i = x - 1; i <= x + 1; ++i)
         {
-          try
+          // iterate over neighboring grid cells (2nd dimension):
+          for (int j = y - 1; j <= y + 1; ++j)
           {
-            const Grid::CellContent & act_pos = grid.grid_at(Grid::CellIndex(i, j));
-
-            for (Grid::const_cell_iterator it_cell = act_pos.begin(); it_cell != act_pos.end(); ++it_cell)
+            try
             {
-              GridFeature * neighbor_feature = it_cell->second;
-              // consider only "real" neighbors, not the element itself:
-              if (center_feature != neighbor_feature)
+              const Grid::CellContent & act_pos = const_grid.grid_at(Grid::CellIndex(i, j));
+
+              for (Grid::const_cell_iterator it_cell = act_pos.begin(); it_cell != act_pos.end(); ++it_cell)
               {
-                double dist = getDistance_(center_feature,
-                                               neighbor_feature);
-                if (dist == FeatureDistance::infinity)
-                {
-                  continue;                   // conditions not satisfied
-                }
-                // if neighbor point is a possible cluster point, add it:
-                if (!use_IDs_ || compatibleIDs_(cluster, neighbor_feature))
+                GridFeature * neighbor_feature = it_cell->second;
+                // consider only "real" neighbors, not the element itself:
+                if (center_feature != neighbor_feature)
                 {
-                  cluster.add(neighbor_feature, dist);
+                  // the distance of a pair is always computed with the feature
+                  // that comes first in the grid on the left (the distance is
+                  // not necessarily symmetric):
+                  double dist;
+                  if ((Size)center_index < ranks.find(neighbor_feature)->second)
+                  {
+                    dist = feature_distance(center_feature->getFeature(), neighbor_feature->getFeature()).second;
+                  }
+                  else
+                  {
+                    dist = feature_distance(neighbor_feature->getFeature(), center_feature->getFeature()).second;
+                  }
+                  if (dist == FeatureDistance::infinity)
+                  {
+                    continue;                   // conditions not satisfied
+                  }
+                  // if neighbor point is a possible cluster point, add it:
+                  if (!use_IDs_ || compatibleIDs_(cluster, neighbor_feature))
+                  {
+                    cluster.add(neighbor_feature, dist);
+                  }
                 }
               }
             }
-          }
-          catch (std::out_of_range &)
-          {
+            catch (std::out_of_range &)
+            {
+            }
           }
         }
+        // compute the initial quality now that the cluster is complete:
+        cluster.getQuality();
       }
-      clustering.push_back(cluster);
-    }
-  }
-
-  double QTClusterFinder::getDistance_(GridFeature * left,
-                                           GridFeature * right)
-  {
-    // look-up in the distance map:
-    const pair<GridFeature *, GridFeature *> key = make_pair(min(left, right),
-                                                       max(left, right));
-    PairDistances::const_iterator pos = distances_.find(key);
-    if (pos != distances_.end())     // distance computed before
-    {
-      return pos->second;
-    }
-    else     // compute distance now and store it for later
-    {
-      double dist = feature_distance_(left->getFeature(), right->getFeature()).second;
-      distances_[key] = dist;
-      return dist;
     }
   }
 
@@ -36,19 +36,23 @@
 #include <OpenMS/CONCEPT/LogStream.h>
 #include <OpenMS/DATASTRUCTURES/ListUtils.h>
 
+#include <cmath>
+
 using namespace std;
 
 namespace OpenMS
 {
   TransformationDescription::TransformationDescription() :
     data_(TransformationDescription::DataPoints()), model_type_("none"),
-    model_(new TransformationModel())
+    model_(new TransformationModel()), lookup_table_(), lookup_min_(0),
+    lookup_max_(0), lookup_scale_(0)
   {
   }
 
   TransformationDescription::TransformationDescription(
     const TransformationDescription::DataPoints & data) :
-    data_(data), model_type_("none"), model_(new TransformationModel())
+    data_(data), model_type_("none"), model_(new TransformationModel()),
+    lookup_table_(), lookup_min_(0), lookup_max_(0), lookup_scale_(0)
   {
   }
 
@@ -65,6 +69,11 @@ namespace OpenMS
     model_ = 0;     // initialize this before the "delete" call in "fitModel"!
     Param params = rhs.getModelParameters();
     fitModel(rhs.model_type_, params);
+    // same model, so the lookup table is still valid
+    lookup_table_ = rhs.lookup_table_;
+    lookup_min_ = rhs.lookup_min_;
+    lookup_max_ = rhs.lookup_max_;
+    lookup_scale_ = rhs.lookup_scale_;
   }
 
   TransformationDescription & TransformationDescription::operator=(
@@ -77,6 +86,10 @@ namespace OpenMS
     model_type_ = "none";
     Param params = rhs.getModelParameters();
     fitModel(rhs.model_type_, params);
+    lookup_table_ = rhs.lookup_table_;
+    lookup_min_ = rhs.lookup_min_;
+    lookup_max_ = rhs.lookup_max_;
+    lookup_scale_ = rhs.lookup_scale_;
 
     return *this;
   }
@@ -88,6 +101,7 @@ namespace OpenMS
     if (model_type_ == "identity")
       return;
 
+    clearLookupTable();
     delete model_;
     model_ = 0;     // avoid segmentation fault in case of exception
     if ((model_type == "none") || (model_type == "identity"))
@@ -116,9 +130,125 @@ namespace OpenMS
 
   double TransformationDescription::apply(double value) const
   {
+    if (!lookup_table_.empty() && (value >= lookup_min_) && (value <= lookup_max_))
+    {
+      return lookup_(value);
+    }
     return model_->evaluate(value);
   }
 
+  void TransformationDescription::apply(const double * values, double * results, Size size) const
+  {
+    const Size chunk_size = 4096;
+    SignedSize chunks = SignedSize((size + chunk_size - 1) / chunk_size);
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic) if (chunks > 1)
+#endif
+    for (SignedSize chunk = 0; chunk < chunks; ++chunk)
+    {
+      Size begin = chunk * chunk_size;
+      applyChunk_(values + begin, results + begin, std::min(chunk_size, size - begin));
+    }
+  }
+
+  void TransformationDescription::applyChunk_(const double * values, double * results, Size size) const
+  {
+    if (lookup_table_.empty())
+    {
+      model_->evaluate(values, results, size);
+      return;
+    }
+    for (Size i = 0; i < size; ++i)
+    {
+      const double value = values[i];
+      if ((value >= lookup_min_) && (value <= lookup_max_))
+      {
+        results[i] = lookup_(value);
+      }
+      else
+      {
+        results[i] = model_->evaluate(value);
+      }
+    }
+  }
+
+  void TransformationDescription::buildLookupTable(double min_value, double max_value, double max_error, Size max_size)
+  {
+    if (!(min_value < max_value))
+    {
+      throw Exception::IllegalArgument(__FILE__, __LINE__, __PRETTY_FUNCTION__, "range of the lookup table is empty");
+    }
+    if (!(max_error > 0))
+    {
+      throw Exception::IllegalArgument(__FILE__, __LINE__, __PRETTY_FUNCTION__, "maximal error of the lookup table must be positive");
+    }
+    clearLookupTable();
+
+    // start with a coarse grid and halve the spacing until the model is
+    // approximated well enough; the midpoints that were checked become the
+    // new grid points, so every model value is computed only once
+    Size segments = 16;
+    vector<double> positions(segments + 1), table(segments + 1), midpoints, mid_values;
+    for (Size i = 0; i <= segments; ++i)
+    {
+      positions[i] = min_value + (max_value - min_value) * i / segments;
+    }
+    positions.back() = max_value;
+    model_->evaluate(&positions[0], &table[0], table.size());
+
+    while (true)
+    {
+      midpoints.resize(segments);
+      mid_values.resize(segments);
+      for (Size i = 0; i < segments; ++i)
+      {
+        midpoints[i] = min_value + (max_value - min_value) * (2 * i + 1) / (2 * segments);
+      }
+      model_->evaluate(&midpoints[0], &mid_values[0], segments);
+
+      double error = 0;
+      for (Size i = 0; i < segments; ++i)
+      {
+        error = std::max(error, fabs(mid_values[i] - (table[i] + table[i + 1]) / 2));
+      }
+      if (error <= max_error)
+      {
+        break;
+      }
+      if (2 * segments + 1 > max_size)
+      {
+        LOG_WARN << "TransformationDescription: lookup table reached its maximal size of " << max_size << " values with an error of " << error << " (requested: " << max_error << ")" << endl;
+        break;
+      }
+
+      vector<double> refined(2 * segments + 1);
+      for (Size i = 0; i < segments; ++i)
+      {
+        refined[2 * i] = table[i];
+        refined[2 * i + 1] = mid_values[i];
+      }
+      refined.back() = table.back();
+      table.swap(refined);
+      segments *= 2;
+    }
+
+    lookup_table_.swap(table);
+    lookup_min_ = min_value;
+    lookup_max_ = max_value;
+    lookup_scale_ = segments / (max_value - min_value);
+  }
+
+  void TransformationDescription::clearLookupTable()
+  {
+    lookup_table_.clear();
+    lookup_min_ = lookup_max_ = lookup_scale_ = 0;
+  }
+
+  bool TransformationDescription::hasLookupTable() const
+  {
+    return !lookup_table_.empty();
+  }
+
   const String & TransformationDescription::getModelType() const
   {
     return model_type_;
@@ -134,6 +264,7 @@ namespace OpenMS
   {
     data_ = data;
     model_type_ = "none";     // reset the model even if it was "identity"
+    clearLookupTable();
     delete model_;
     model_ = new TransformationModel();
   }
@@ -162,6 +293,7 @@ namespace OpenMS
       TransformationModelLinear * lm =
         dynamic_cast<TransformationModelLinear *>(model_);
       lm->invert();
+      clearLookupTable();
     }
     else
     {
@@ -100,6 +100,14 @@ namespace OpenMS
     return slope_ * value + intercept_;
   }
 
+  void TransformationModelLinear::evaluate(const double* values, double* results, Size size) const
+  {
+    for (Size i = 0; i < size; ++i)
+    {
+      results[i] = slope_ * values[i] + intercept_;
+    }
+  }
+
   void TransformationModelLinear::invert()
   {
     if (slope_ == 0)
@@ -188,6 +196,25 @@ namespace OpenMS
     return interp_->eval(value);
   }
 
+  void TransformationModelInterpolated::evaluate(const double* values, double* results, Size size) const
+  {
+    double slope, intercept;
+    lm_->getParameters(slope, intercept);
+    const double x_min = x_.front(), x_max = x_.back();
+    for (Size i = 0; i < size; ++i)
+    {
+      const double value = values[i];
+      if ((value < x_min) || (value > x_max)) // extrapolate
+      {
+        results[i] = slope * value + intercept;
+      }
+      else // interpolate
+      {
+        results[i] = interp_->eval(value);
+      }
+    }
+  }
+
   void TransformationModelInterpolated::getDefaultParameters(Param& params)
   {
     params.clear();
@@ -36,9 +36,48 @@
 
 #include <OpenMS/CONCEPT/Exception.h>
 
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <iterator>
+
 namespace OpenMS
 {
 
+  namespace
+  {
+    // extraction window [left, right] around mz (window is the full width in Th or ppm)
+    void computeWindow(double mz, double mz_extraction_window, bool ppm, double& left, double& right)
+    {
+      double half_window = ppm ? mz * mz_extraction_window / 2.0 * 1.0e-6 : mz_extraction_window / 2.0;
+      left  = mz - half_window;
+      right = mz + half_window;
+    }
+
+    // coordinates with rt_end - rt_start <= 0 are extracted over the whole RT range
+    bool hasRTWindow(const ChromatogramExtractorAlgorithm::ExtractionCoordinates& coord)
+    {
+      return coord.rt_end - coord.rt_start > 0;
+    }
+
+    // compares two coordinate indices by a per-coordinate key
+    struct IndexLess
+    {
+      explicit IndexLess(const std::vector<Size>& key) : key_(key) {}
+      bool operator()(Size a, Size b) const { return key_[a] < key_[b]; }
+      const std::vector<Size>& key_;
+    };
+
+    // true for coordinates whose last spectrum lies before the current one
+    struct EndsBefore
+    {
+      EndsBefore(const std::vector<Size>& last_scan, Size scan_idx) : last_scan_(last_scan), scan_idx_(scan_idx) {}
+      bool operator()(Size k) const { return last_scan_[k] <= scan_idx_; }
+      const std::vector<Size>& last_scan_;
+      Size scan_idx_;
+    };
+  }
+
   void ChromatogramExtractorAlgorithm::extract_value_tophat(
       const std::vector<double>::const_iterator& mz_start, 
             std::vector<double>::const_iterator& mz_it,
@@ -147,56 +186,213 @@ namespace OpenMS
         "Input to extractChromatogram needs to be sorted by m/z");
     }
 
+    // compute the m/z windows once (sorted by m/z, thus also by left boundary)
+    Size nr_coordinates = extraction_coordinates.size();
+    std::vector<double> center(nr_coordinates), left(nr_coordinates), right(nr_coordinates);
+    for (Size k = 0; k < nr_coordinates; ++k)
+    {
+      center[k] = extraction_coordinates[k].mz;
+      computeWindow(center[k], mz_extraction_window, ppm, left[k], right[k]);
+    }
+
+    // RT index: if the spectra are sorted by RT, each coordinate is only
+    // active for a contiguous range of spectra [first_scan, last_scan)
+    std::vector<double> spectrum_rt(input_size);
+    for (Size scan_idx = 0; scan_idx < input_size; ++scan_idx)
+    {
+      spectrum_rt[scan_idx] = input->getSpectrumMetaById(scan_idx).RT;
+    }
+    bool rt_sorted = (std::adjacent_find(spectrum_rt.begin(), spectrum_rt.end(),
+                                         std::greater<double>()) == spectrum_rt.end());
+
+    std::vector<Size> first_scan(nr_coordinates, 0), last_scan(nr_coordinates, input_size);
+    for (Size k = 0; k < nr_coordinates; ++k)
+    {
+      if (rt_sorted && hasRTWindow(extraction_coordinates[k]))
+      {
+        first_scan[k] = std::lower_bound(spectrum_rt.begin(), spectrum_rt.end(), extraction_coordinates[k].rt_start) - spectrum_rt.begin();
+        last_scan[k] = std::upper_bound(spectrum_rt.begin(), spectrum_rt.end(), extraction_coordinates[k].rt_end) - spectrum_rt.begin();
+        if (last_scan[k] < first_scan[k])
+        {
+          last_scan[k] = first_scan[k];
+        }
+      }
+      output[k]->binaryDataArrayPtrs[0]->data.reserve(last_scan[k] - first_scan[k]);
+      output[k]->binaryDataArrayPtrs[1]->data.reserve(last_scan[k] - first_scan[k]);
+    }
+
+    // coordinates ordered by the scan at which they become active (ties keep their m/z order);
+    // coordinates whose RT window contains no spectrum (e.g. it lies between two spectra) are never active
+    std::vector<Size> by_first_scan;
+    by_first_scan.reserve(nr_coordinates);
+    for (Size k = 0; k < nr_coordinates; ++k)
+    {
+      if (first_scan[k] < last_scan[k])
+      {
+        by_first_scan.push_back(k);
+      }
+    }
+    std::stable_sort(by_first_scan.begin(), by_first_scan.end(), IndexLess(first_scan));
+    std::vector<Size>::const_iterator next_start = by_first_scan.begin();
+
+    std::vector<Size> active, tmp_active;
+    std::vector<double> integrated_intensities;
+
     //go through all spectra
     startProgress(0, input_size, "Extracting chromatograms");
     for (Size scan_idx = 0; scan_idx < input_size; ++scan_idx)
     {
       setProgress(scan_idx);
+      double current_rt = spectrum_rt[scan_idx];
 
-      OpenSwath::SpectrumPtr sptr = input->getSpectrumById(scan_idx);
-      OpenSwath::SpectrumMeta s_meta = input->getSpectrumMetaById(scan_idx);
+      // update the set of coordinates to extract from this spectrum (kept in m/z order)
+      if (rt_sorted)
+      {
+        active.erase(std::remove_if(active.begin(), active.end(), EndsBefore(last_scan, scan_idx)), active.end());
+        std::vector<Size>::const_iterator starts_end = next_start;
+        while (starts_end != by_first_scan.end() && first_scan[*starts_end] == scan_idx)
+        {
+          ++starts_end;
+        }
+        if (starts_end != next_start)
+        {
+          tmp_active.clear();
+          std::merge(active.begin(), active.end(), next_start, starts_end, std::back_inserter(tmp_active));
+          active.swap(tmp_active);
+          next_start = starts_end;
+        }
+      }
+      else
+      {
+        active.clear();
+        for (Size k = 0; k < nr_coordinates; ++k)
+        {
+          if (!hasRTWindow(extraction_coordinates[k]) ||
+              (current_rt >= extraction_coordinates[k].rt_start && current_rt <= extraction_coordinates[k].rt_end))
+          {
+            active.push_back(k);
+          }
+        }
+      }
+
+      if (active.empty())
+      {
+        continue;
+      }
 
+      OpenSwath::SpectrumPtr sptr = input->getSpectrumById(scan_idx);
       OpenSwath::BinaryDataArrayPtr mz_arr = sptr->getMZArray();
       OpenSwath::BinaryDataArrayPtr int_arr = sptr->getIntensityArray();
-      std::vector<double>::const_iterator mz_start = mz_arr->data.begin();
-      std::vector<double>::const_iterator mz_end = mz_arr->data.end();
-      std::vector<double>::const_iterator mz_it = mz_arr->data.begin();
-      std::vector<double>::const_iterator int_it = int_arr->data.begin();
 
-      if (sptr->getMZArray()->data.size() == 0)
+      if (mz_arr->data.empty())
+      {
         continue;
+      }
+
+      // go through all active transitions / chromatograms which are sorted
+      // by ProductMZ and step through the spectrum at the same time
+      extractWindows_(&mz_arr->data[0], &int_arr->data[0], mz_arr->data.size(),
+                      active, center, left, right, used_filter, integrated_intensities);
+
+      for (Size i = 0; i < active.size(); ++i)
+      {
+        // Time is first, intensity is second
+        output[active[i]]->binaryDataArrayPtrs[0]->data.push_back(current_rt);
+        output[active[i]]->binaryDataArrayPtrs[1]->data.push_back(integrated_intensities[i]);
+      }
+    }
+    endProgress();
+  }
+
+  void ChromatogramExtractorAlgorithm::extractValues(const std::vector<double>& mz_arr, const std::vector<double>& int_arr,
+                                                     const std::vector<ExtractionCoordinates>& extraction_coordinates,
+                                                     std::vector<double>& integrated_intensities, double mz_extraction_window,
+                                                     bool ppm, String filter)
+  {
+    int used_filter = getFilterNr_(filter);
+    if (mz_arr.size() != int_arr.size())
+    {
+      throw Exception::IllegalArgument(__FILE__, __LINE__, __PRETTY_FUNCTION__,
+        "m/z and intensity array need to have the same size");
+    }
+    if (std::adjacent_find(extraction_coordinates.begin(), extraction_coordinates.end(), 
+          ExtractionCoordinates::SortExtractionCoordinatesReverseByMZ) != extraction_coordinates.end())
+    {
+      throw Exception::IllegalArgument(__FILE__, __LINE__, __PRETTY_FUNCTION__,
+        "Input to extractValues needs to be sorted by m/z");
+    }
+
+    Size nr_coordinates = extraction_coordinates.size();
+    std::vector<double> center(nr_coordinates), left(nr_coordinates), right(nr_coordinates);
+    std::vector<Size> active(nr_coordinates);
+    for (Size k = 0; k < nr_coordinates; ++k)
+    {
+      center[k] = extraction_coordinates[k].mz;
+      computeWindow(center[k], mz_extraction_window, ppm, left[k], right[k]);
+      active[k] = k;
+    }
+
+    if (mz_arr.empty())
+    {
+      integrated_intensities.assign(nr_coordinates, 0.0);
+      return;
+    }
+    extractWindows_(&mz_arr[0], &int_arr[0], mz_arr.size(), active, center, left, right,
+                    used_filter, integrated_intensities);
+  }
+
+  void ChromatogramExtractorAlgorithm::extractWindows_(const double* mz, const double* intensity, Size nr_peaks,
+                                                       const std::vector<Size>& active, const std::vector<double>& center,
+                                                       const std::vector<double>& left, const std::vector<double>& right,
+                                                       int filter, std::vector<double>& integrated_intensities)
+  {
+    integrated_intensities.resize(active.size());
+
+    // first peak inside the current window, only ever moves to the right
+    Size window_start = 0;
+    for (Size i = 0; i < active.size(); ++i)
+    {
+      const Size k = active[i];
+      while (window_start < nr_peaks && mz[window_start] <= left[k])
+      {
+        ++window_start;
+      }
+      Size window_end = window_start;
+      while (window_end < nr_peaks && mz[window_end] < right[k])
+      {
+        ++window_end;
+      }
 
-      // go through all transitions / chromatograms which are sorted by
-      // ProductMZ. We can use this to step through the spectrum and at the
-      // same time step through the transitions. We increase the peak counter
-      // until we hit the next transition and then extract the signal.
-      for (Size k = 0; k < extraction_coordinates.size(); ++k)
+      // the peaks of the window are contiguous, which allows the compiler to
+      // vectorize the summation
+      double integrated_intensity = 0;
+      if (filter == 1)
       {
-        double integrated_intensity = 0;
-        double current_rt = s_meta.RT;
-        if (extraction_coordinates[k].rt_end - extraction_coordinates[k].rt_start > 0 && 
-             (current_rt < extraction_coordinates[k].rt_start || 
-              current_rt > extraction_coordinates[k].rt_end) )
+        for (Size j = window_start; j < window_end; ++j)
         {
-          continue;
+          integrated_intensity += intensity[j];
         }
-
-        if (used_filter == 1)
+      }
+      else if (filter == 2)
+      {
+        const double half_window_size = right[k] - center[k];
+        for (Size j = window_start; j < window_end; ++j)
         {
-          extract_value_tophat( mz_start, mz_it, mz_end, int_it,
-                  extraction_coordinates[k].mz, integrated_intensity, mz_extraction_window, ppm);
+          integrated_intensity += intensity[j] * (1.0 - std::fabs(mz[j] - center[k]) / half_window_size);
         }
-        else if (used_filter == 2)
+      }
+      else if (filter == 3)
+      {
+        const double sigma = (right[k] - center[k]) / 2.0;
+        const double factor = -0.5 / (sigma * sigma);
+        for (Size j = window_start; j < window_end; ++j)
         {
-          throw Exception::NotImplemented(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+          const double diff = mz[j] - center[k];
+          integrated_intensity += intensity[j] * std::exp(factor * diff * diff);
         }
-
-        // Time is first, intensity is second
-        output[k]->binaryDataArrayPtrs[0]->data.push_back(current_rt);
-        output[k]->binaryDataArrayPtrs[1]->data.push_back(integrated_intensity);
       }
+      integrated_intensities[i] = integrated_intensity;
     }
-    endProgress();
   }
 
   int ChromatogramExtractorAlgorithm::getFilterNr_(String filter)
@@ -209,10 +405,14 @@ namespace OpenMS
     {
       return 2;
     }
+    else if (filter == "gaussian")
+    {
+      return 3;
+    }
     else
     {
       throw Exception::IllegalArgument(__FILE__, __LINE__, __PRETTY_FUNCTION__,
-                                       "Filter either needs to be tophat or bartlett");
+                                       "Filter needs to be tophat, bartlett or gaussian");
     }
   }
 
@@ -35,6 +35,7 @@
 #include <OpenMS/ANALYSIS/OPENSWATH/DATAACCESS/SimpleOpenMSSpectraAccessFactory.h>
 #include <OpenMS/ANALYSIS/OPENSWATH/DATAACCESS/SpectrumAccessOpenMS.h>
 #include <OpenMS/ANALYSIS/OPENSWATH/DATAACCESS/SpectrumAccessOpenMSCached.h>
+#include <OpenMS/ANALYSIS/OPENSWATH/DATAACCESS/SpectrumAccessOpenMSCachedMmap.h>
 
 namespace OpenMS
 {
@@ -72,7 +73,13 @@ namespace OpenMS
     bool is_cached = SimpleOpenMSSpectraFactory::isExperimentCached(exp);
     if (is_cached)
     {
+#ifdef OPENMS_64BIT_ARCHITECTURE
+      // memory mapped access is thread-safe and avoids copying through a
+      // single file stream, but needs enough address space for the whole file
+      OpenSwath::SpectrumAccessPtr experiment(new OpenMS::SpectrumAccessOpenMSCachedMmap(exp->getLoadedFilePath()));
+#else
       OpenSwath::SpectrumAccessPtr experiment(new OpenMS::SpectrumAccessOpenMSCached(exp->getLoadedFilePath()));
+#endif
       return experiment;
     }
     else
@@ -48,7 +48,8 @@ namespace OpenMS
     CachedmzML cache;
     cache.createMemdumpIndex(filename_cached_);
     spectra_index_ = cache.getSpectraIndex();
-    chrom_index_ = cache.getChromatogramIndex();;
+    chrom_index_ = cache.getChromatogramIndex();
+    format_version_ = cache.getFormatVersion();
 
     // open the filestream
     ifs_.open(filename_cached_.c_str(), std::ios::binary);
@@ -77,7 +78,7 @@ namespace OpenMS
         "Error while changing position of input stream pointer.", filename_cached_);
     }
 
-    CachedmzML::readSpectrumFast(mz_array, intensity_array, ifs_, ms_level, rt);
+    CachedmzML::readSpectrumFast(mz_array, intensity_array, ifs_, ms_level, rt, format_version_);
 
     OpenSwath::SpectrumPtr sptr(new OpenSwath::Spectrum);
     sptr->setMZArray(mz_array);
@@ -106,7 +107,7 @@ namespace OpenMS
         "Error while changing position of input stream pointer.", filename_cached_);
     }
 
-    CachedmzML::readChromatogramFast(rt_array, intensity_array, ifs_);
+    CachedmzML::readChromatogramFast(rt_array, intensity_array, ifs_, format_version_);
 
     OpenSwath::ChromatogramPtr cptr(new OpenSwath::Chromatogram);
     cptr->setTimeArray(rt_array);
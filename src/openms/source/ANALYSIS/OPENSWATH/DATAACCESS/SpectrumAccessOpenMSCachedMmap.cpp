@@ -0,0 +1,348 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2013.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: Hannes Roest $
+// $Authors: Hannes Roest $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/ANALYSIS/OPENSWATH/DATAACCESS/SpectrumAccessOpenMSCachedMmap.h>
+
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+namespace OpenMS
+{
+
+  SpectrumAccessOpenMSCachedMmap::SpectrumAccessOpenMSCachedMmap(String filename) :
+    data_(0),
+    data_size_(0),
+    format_version_(1)
+  {
+    filename_cached_ = filename + ".cached";
+    filename_ = filename;
+
+    // map the complete cached file read-only into memory
+    try
+    {
+      file_mapping_ = boost::shared_ptr<boost::interprocess::file_mapping>(
+        new boost::interprocess::file_mapping(filename_cached_.c_str(), boost::interprocess::read_only));
+      region_ = boost::shared_ptr<boost::interprocess::mapped_region>(
+        new boost::interprocess::mapped_region(*file_mapping_, boost::interprocess::read_only));
+    }
+    catch (boost::interprocess::interprocess_exception& /* e */)
+    {
+      throw Exception::FileNotFound(__FILE__, __LINE__, __PRETTY_FUNCTION__, filename_cached_);
+    }
+    data_ = static_cast<const char*>(region_->get_address());
+    data_size_ = region_->get_size();
+
+    // we expect mostly random access, read-ahead of the OS is not helpful
+    region_->advise(boost::interprocess::mapped_region::advice_random);
+
+    // Create the index from the mapped file
+    createIndex_();
+
+    // load the meta data from disk
+    MzMLFile().load(filename, meta_ms_experiment_);
+  }
+
+  SpectrumAccessOpenMSCachedMmap::~SpectrumAccessOpenMSCachedMmap()
+  {
+    // the region needs to be unmapped before the file mapping is closed
+    region_.reset();
+    file_mapping_.reset();
+  }
+
+  void SpectrumAccessOpenMSCachedMmap::createIndex_()
+  {
+    Size exp_size, chrom_size;
+    int file_identifier;
+    const Size footer_size = sizeof(exp_size) + sizeof(chrom_size);
+
+    if (data_size_ < sizeof(file_identifier) + footer_size)
+    {
+      throw Exception::ParseError(__FILE__, __LINE__, __PRETTY_FUNCTION__,
+          "File is too small to be a cached mzML file. Aborting!", filename_cached_);
+    }
+
+    spectra_offsets_.clear();
+    chrom_offsets_.clear();
+
+    std::memcpy(&file_identifier, data_, sizeof(file_identifier));
+    if (file_identifier == CACHED_MZML_FILE_IDENTIFIER_V2)
+    {
+      // Version 2 files carry their index in the footer, no need to walk the file
+      format_version_ = 2;
+      CachedmzML::Trailer trailer;
+      if (data_size_ < 2 * sizeof(file_identifier) + sizeof(trailer))
+      {
+        throw Exception::ParseError(__FILE__, __LINE__, __PRETTY_FUNCTION__,
+            "File is too small to be a cached mzML file. Aborting!", filename_cached_);
+      }
+      std::memcpy(&trailer, data_ + data_size_ - sizeof(trailer), sizeof(trailer));
+
+      Size index_end = data_size_ - sizeof(trailer);
+      if (trailer.identifier != CACHED_MZML_FILE_IDENTIFIER_V2 || trailer.index_offset > index_end ||
+          trailer.nr_spectra + trailer.nr_chromatograms != (index_end - trailer.index_offset) / sizeof(CachedmzML::IndexEntry))
+      {
+        throw Exception::ParseError(__FILE__, __LINE__, __PRETTY_FUNCTION__,
+            "Cached mzML file has no valid index (file might be truncated). Aborting!", filename_cached_);
+      }
+
+      spectra_offsets_.reserve(trailer.nr_spectra);
+      chrom_offsets_.reserve(trailer.nr_chromatograms);
+      const char* pos = data_ + trailer.index_offset;
+      for (Size i = 0; i < trailer.nr_spectra + trailer.nr_chromatograms; i++)
+      {
+        CachedmzML::IndexEntry entry;
+        std::memcpy(&entry, pos + i * sizeof(entry), sizeof(entry));
+        if (i < trailer.nr_spectra)
+        {
+          spectra_offsets_.push_back(entry.offset);
+        }
+        else
+        {
+          chrom_offsets_.push_back(entry.offset);
+        }
+      }
+      return;
+    }
+
+    if (file_identifier != CACHED_MZML_FILE_IDENTIFIER)
+    {
+      throw Exception::ParseError(__FILE__, __LINE__, __PRETTY_FUNCTION__,
+          "File might not be a cached mzML file (wrong file magic number). Aborting!", filename_cached_);
+    }
+
+    // the number of spectra and chromatograms is stored at the end of the file
+    std::memcpy(&exp_size, data_ + data_size_ - footer_size, sizeof(exp_size));
+    std::memcpy(&chrom_size, data_ + data_size_ - footer_size + sizeof(exp_size), sizeof(chrom_size));
+
+    // For spectra and chromatograms go through the mapped file, read the size
+    // of the spectrum/chromatogram and record the starting offset of the
+    // element, then skip ahead to the next spectrum/chromatogram. readView_
+    // ensures that we never leave the mapped region.
+    format_version_ = 1;
+    spectra_offsets_.reserve(exp_size);
+    chrom_offsets_.reserve(chrom_size);
+
+    Size offset = sizeof(file_identifier);
+    for (Size i = 0; i < exp_size; i++)
+    {
+      spectra_offsets_.push_back(offset);
+      DataView view = readView_(offset, true);
+      offset = (view.second - data_) + view.size * sizeof(double);
+    }
+    for (Size i = 0; i < chrom_size; i++)
+    {
+      chrom_offsets_.push_back(offset);
+      DataView view = readView_(offset, false);
+      offset = (view.second - data_) + view.size * sizeof(double);
+    }
+  }
+
+  SpectrumAccessOpenMSCachedMmap::DataView SpectrumAccessOpenMSCachedMmap::readView_(Size offset, bool is_spectrum) const
+  {
+    if (format_version_ == 2)
+    {
+      return readViewV2_(offset, is_spectrum);
+    }
+
+    DataView view;
+    Size header_size = sizeof(view.size);
+    if (is_spectrum)
+    {
+      header_size += sizeof(view.ms_level) + sizeof(view.rt);
+    }
+
+    if (offset + header_size > data_size_)
+    {
+      throw Exception::ParseError(__FILE__, __LINE__, __PRETTY_FUNCTION__,
+        "Read an invalid data offset, something is wrong here. Aborting.", filename_cached_);
+    }
+
+    const char* pos = data_ + offset;
+    std::memcpy(&view.size, pos, sizeof(view.size));
+    pos += sizeof(view.size);
+    if (is_spectrum)
+    {
+      std::memcpy(&view.ms_level, pos, sizeof(view.ms_level));
+      pos += sizeof(view.ms_level);
+      std::memcpy(&view.rt, pos, sizeof(view.rt));
+      pos += sizeof(view.rt);
+    }
+
+    // check that both data arrays are fully contained in the mapping (written
+    // such that a corrupted size cannot overflow)
+    Size remaining = data_size_ - offset - header_size;
+    if (view.size > remaining / (2 * sizeof(double)))
+    {
+      throw Exception::ParseError(__FILE__, __LINE__, __PRETTY_FUNCTION__,
+        String("Read an invalid ") + (is_spectrum ? "spectrum" : "chromatogram") +
+        " length, something is wrong here. Aborting.", filename_cached_);
+    }
+
+    view.first = pos;
+    view.second = pos + view.size * sizeof(double);
+    view.bytes_first = view.size * sizeof(double);
+    view.bytes_second = view.size * sizeof(double);
+    return view;
+  }
+
+  SpectrumAccessOpenMSCachedMmap::DataView SpectrumAccessOpenMSCachedMmap::readViewV2_(Size offset, bool is_spectrum) const
+  {
+    CachedmzML::RecordHeader header;
+    if (offset > data_size_ || data_size_ - offset < sizeof(header))
+    {
+      throw Exception::ParseError(__FILE__, __LINE__, __PRETTY_FUNCTION__,
+        "Read an invalid data offset, something is wrong here. Aborting.", filename_cached_);
+    }
+    std::memcpy(&header, data_ + offset, sizeof(header));
+
+    // check the header and that both data arrays are fully contained in the
+    // mapping (written such that a corrupted size cannot overflow)
+    Size remaining = data_size_ - offset - sizeof(header);
+    if (header.encoding_first >= CachedmzML::SIZE_OF_BINARYDATAENCODING ||
+        header.encoding_second >= CachedmzML::SIZE_OF_BINARYDATAENCODING ||
+        header.bytes_first > remaining || header.bytes_second > remaining ||
+        CachedmzML::paddedSize(header.bytes_first) + header.bytes_second > remaining)
+    {
+      throw Exception::ParseError(__FILE__, __LINE__, __PRETTY_FUNCTION__,
+        String("Read an invalid ") + (is_spectrum ? "spectrum" : "chromatogram") +
+        " length, something is wrong here. Aborting.", filename_cached_);
+    }
+
+    DataView view;
+    view.size = header.size;
+    if (is_spectrum)
+    {
+      view.ms_level = header.ms_level;
+      view.rt = header.rt;
+    }
+    view.first = data_ + offset + sizeof(header);
+    view.second = view.first + CachedmzML::paddedSize(header.bytes_first);
+    view.bytes_first = header.bytes_first;
+    view.bytes_second = header.bytes_second;
+    view.encoding_first = static_cast<CachedmzML::BinaryDataEncoding>(header.encoding_first);
+    view.encoding_second = static_cast<CachedmzML::BinaryDataEncoding>(header.encoding_second);
+    return view;
+  }
+
+  SpectrumAccessOpenMSCachedMmap::DataView SpectrumAccessOpenMSCachedMmap::getSpectrumViewById(int id) const
+  {
+    OPENMS_PRECONDITION(id >= 0 && id < (int)spectra_offsets_.size(), "Spectrum id needs to be within the range of the cached file");
+    return readView_(spectra_offsets_[id], true);
+  }
+
+  SpectrumAccessOpenMSCachedMmap::DataView SpectrumAccessOpenMSCachedMmap::getChromatogramViewById(int id) const
+  {
+    OPENMS_PRECONDITION(id >= 0 && id < (int)chrom_offsets_.size(), "Chromatogram id needs to be within the range of the cached file");
+    return readView_(chrom_offsets_[id], false);
+  }
+
+  OpenSwath::SpectrumPtr SpectrumAccessOpenMSCachedMmap::getSpectrumById(int id)
+  {
+    OpenSwath::BinaryDataArrayPtr mz_array(new OpenSwath::BinaryDataArray);
+    OpenSwath::BinaryDataArrayPtr intensity_array(new OpenSwath::BinaryDataArray);
+    getSpectrumViewById(id).copyTo(mz_array->data, intensity_array->data);
+
+    OpenSwath::SpectrumPtr sptr(new OpenSwath::Spectrum);
+    sptr->setMZArray(mz_array);
+    sptr->setIntensityArray(intensity_array);
+    return sptr;
+  }
+
+  OpenSwath::SpectrumMeta SpectrumAccessOpenMSCachedMmap::getSpectrumMetaById(int id) const
+  {
+    OpenSwath::SpectrumMeta meta;
+    meta.RT = meta_ms_experiment_[id].getRT();
+    meta.ms_level = meta_ms_experiment_[id].getMSLevel();
+    return meta;
+  }
+
+  OpenSwath::ChromatogramPtr SpectrumAccessOpenMSCachedMmap::getChromatogramById(int id)
+  {
+    OpenSwath::BinaryDataArrayPtr rt_array(new OpenSwath::BinaryDataArray);
+    OpenSwath::BinaryDataArrayPtr intensity_array(new OpenSwath::BinaryDataArray);
+    getChromatogramViewById(id).copyTo(rt_array->data, intensity_array->data);
+
+    OpenSwath::ChromatogramPtr cptr(new OpenSwath::Chromatogram);
+    cptr->setTimeArray(rt_array);
+    cptr->setIntensityArray(intensity_array);
+    return cptr;
+  }
+
+  std::vector<std::size_t> SpectrumAccessOpenMSCachedMmap::getSpectraByRT(double RT, double deltaRT) const
+  {
+    OPENMS_PRECONDITION(deltaRT >= 0, "Delta RT needs to be a positive number");
+
+    // we first perform a search for the spectrum that is past the
+    // beginning of the RT domain. Then we add this spectrum and try to add
+    // further spectra as long as they are below RT + deltaRT.
+    std::vector<std::size_t> result;
+    MSExperimentType::ConstIterator spectrum = meta_ms_experiment_.RTBegin(RT - deltaRT);
+    if (spectrum == meta_ms_experiment_.end()) return result;
+
+    result.push_back(std::distance(meta_ms_experiment_.begin(), spectrum));
+    spectrum++;
+    while (spectrum != meta_ms_experiment_.end() && spectrum->getRT() < RT + deltaRT)
+    {
+      result.push_back(spectrum - meta_ms_experiment_.begin());
+      spectrum++;
+    }
+    return result;
+  }
+
+  size_t SpectrumAccessOpenMSCachedMmap::getNrSpectra() const
+  {
+    return meta_ms_experiment_.size();
+  }
+
+  SpectrumSettings SpectrumAccessOpenMSCachedMmap::getSpectraMetaInfo(int id) const
+  {
+    return meta_ms_experiment_[id];
+  }
+
+  size_t SpectrumAccessOpenMSCachedMmap::getNrChromatograms() const
+  {
+    return meta_ms_experiment_.getChromatograms().size();
+  }
+
+  ChromatogramSettings SpectrumAccessOpenMSCachedMmap::getChromatogramMetaInfo(int id) const
+  {
+    return meta_ms_experiment_.getChromatograms()[id];
+  }
+
+  std::string SpectrumAccessOpenMSCachedMmap::getChromatogramNativeID(int id) const
+  {
+    return meta_ms_experiment_.getChromatograms()[id].getNativeID();
+  }
+
+} //end namespace OpenMS
@@ -6,6 +6,7 @@ set(sources_list
 MRMFeatureAccessOpenMS.cpp
 SpectrumAccessOpenMS.cpp
 SpectrumAccessOpenMSCached.cpp
+SpectrumAccessOpenMSCachedMmap.cpp
 DataAccessHelper.cpp
 SimpleOpenMSSpectraAccessFactory.cpp
 )
@@ -103,6 +103,7 @@ namespace OpenMS
     defaults_.setValue("precursor_NH3_intensity", 1.0, "Intensity of the NH3 loss peak of the precursor");
 
     defaultsToParam_();
+    updateMembers_();
 
     // just in case someone wants the ion names;
     p_.metaRegistry().registerName("IonName", "Name of the ion");
@@ -111,6 +112,7 @@ namespace OpenMS
   TheoreticalSpectrumGenerator::TheoreticalSpectrumGenerator(const TheoreticalSpectrumGenerator & rhs) :
     DefaultParamHandler(rhs)
   {
+    updateMembers_();
   }
 
   TheoreticalSpectrumGenerator & TheoreticalSpectrumGenerator::operator=(const TheoreticalSpectrumGenerator & rhs)
@@ -118,6 +120,7 @@ namespace OpenMS
     if (this != &rhs)
     {
       DefaultParamHandler::operator=(rhs);
+      updateMembers_();
     }
     return *this;
   }
@@ -128,37 +131,28 @@ namespace OpenMS
 
   void TheoreticalSpectrumGenerator::getSpectrum(RichPeakSpectrum & spec, const AASequence & peptide, Int charge)
   {
-    bool add_b_ions(param_.getValue("add_b_ions").toBool());
-    bool add_y_ions(param_.getValue("add_y_ions").toBool());
-    bool add_a_ions(param_.getValue("add_a_ions").toBool());
-    bool add_c_ions(param_.getValue("add_c_ions").toBool());
-    bool add_x_ions(param_.getValue("add_x_ions").toBool());
-    bool add_z_ions(param_.getValue("add_z_ions").toBool());
-
     for (Int z = 1; z <= charge; ++z)
     {
-      if (add_b_ions)
+      if (add_b_ions_)
         addPeaks(spec, peptide, Residue::BIon, z);
-      if (add_y_ions)
+      if (add_y_ions_)
         addPeaks(spec, peptide, Residue::YIon, z);
-      if (add_a_ions)
+      if (add_a_ions_)
         addPeaks(spec, peptide, Residue::AIon, z);
-      if (add_c_ions)
+      if (add_c_ions_)
         addPeaks(spec, peptide, Residue::CIon, z);
-      if (add_x_ions)
+      if (add_x_ions_)
         addPeaks(spec, peptide, Residue::XIon, z);
-      if (add_z_ions)
+      if (add_z_ions_)
         addPeaks(spec, peptide, Residue::ZIon, z);
     }
 
-    bool add_precursor_peaks(param_.getValue("add_precursor_peaks").toBool());
-    if (add_precursor_peaks)
+    if (add_precursor_peaks_)
     {
       addPrecursorPeaks(spec, peptide, charge);
     }
 
-    bool add_abundant_immonium_ions(param_.getValue("add_abundant_immonium_ions").toBool());
-    if (add_abundant_immonium_ions)
+    if (add_abundant_immonium_ions_)
     {
       addAbundantImmoniumIons(spec);
     }
@@ -166,9 +160,31 @@ namespace OpenMS
     return;
   }
 
+  void TheoreticalSpectrumGenerator::getSpectra(vector<RichPeakSpectrum> & spectra, const vector<AASequence> & peptides, Int charge) const
+  {
+    spectra.clear();
+    spectra.resize(peptides.size());
+
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+    {
+      // the generator uses a scratch peak, so every thread needs its own
+      TheoreticalSpectrumGenerator generator(*this);
+
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic, 100)
+#endif
+      for (SignedSize i = 0; i < (SignedSize)peptides.size(); ++i)
+      {
+        generator.getSpectrum(spectra[i], peptides[i], charge);
+      }
+    }
+  }
+
   void TheoreticalSpectrumGenerator::addAbundantImmoniumIons(RichPeakSpectrum & spec)
   {
-    bool add_metainfo(param_.getValue("add_metainfo").toBool());
+    bool add_metainfo(add_metainfo_);
     // Histidin immonium ion
     p_.setMZ(110.0718);
     p_.setIntensity(1.0);
@@ -229,11 +245,59 @@ namespace OpenMS
       return;
     }
 
+    if (!add_isotopes_ && !add_losses_)
+    {
+      // tags (residues without one letter code) are weighted differently,
+      // so they have to take the regular route:
+      bool has_tags(false);
+      for (AASequence::ConstIterator it = peptide.begin(); it != peptide.end(); ++it)
+      {
+        if (it->getOneLetterCode().empty())
+        {
+          has_tags = true;
+          break;
+        }
+      }
+
+      if (!has_tags)
+      {
+        switch (res_type)
+        {
+        case Residue::AIon:
+          addPeaksFast_(spectrum, peptide, res_type, charge, a_intensity_, 'a');
+          return;
+
+        case Residue::BIon:
+          addPeaksFast_(spectrum, peptide, res_type, charge, b_intensity_, 'b');
+          return;
+
+        case Residue::CIon:
+          addPeaksFast_(spectrum, peptide, res_type, charge, c_intensity_, 'c');
+          return;
+
+        case Residue::XIon:
+          addPeaksFast_(spectrum, peptide, res_type, charge, x_intensity_, 'x');
+          return;
+
+        case Residue::YIon:
+          addPeaksFast_(spectrum, peptide, res_type, charge, y_intensity_, 'y');
+          return;
+
+        case Residue::ZIon:
+          addPeaksFast_(spectrum, peptide, res_type, charge, z_intensity_, 'z');
+          return;
+
+        default:
+          break;
+        }
+      }
+    }
+
     Map<double, AASequence> ions;
     Map<double, String> names;
     AASequence ion;
     double intensity(0);
-    bool add_first_prefix_ion(param_.getValue("add_first_prefix_ion").toBool());
+    bool add_first_prefix_ion(add_first_prefix_ion_);
 
     // generate the ion peaks
     switch (res_type)
@@ -252,7 +316,7 @@ namespace OpenMS
         ions[pos] = ion;
         names[pos] = "a" + String(i) + String(charge, '+');
       }
-      intensity = (double)param_.getValue("a_intensity");
+      intensity = a_intensity_;
       break;
     }
 
@@ -270,7 +334,7 @@ namespace OpenMS
         ions[pos] = ion;
         names[pos] = "b" + String(i) + String(charge, '+');
       }
-      intensity = (double)param_.getValue("b_intensity");
+      intensity = b_intensity_;
       break;
     }
 
@@ -288,7 +352,7 @@ namespace OpenMS
         ions[pos] = ion;
         names[pos] = "c" + String(i) + String(charge, '+');
       }
-      intensity = (double)param_.getValue("c_intensity");
+      intensity = c_intensity_;
       break;
     }
 
@@ -301,7 +365,7 @@ namespace OpenMS
         ions[pos] = ion;
         names[pos] = "x" + String(i) + String(charge, '+');
       }
-      intensity = (double)param_.getValue("x_intensity");
+      intensity = x_intensity_;
       break;
     }
 
@@ -314,7 +378,7 @@ namespace OpenMS
         ions[pos] = ion;
         names[pos] = "y" + String(i) + String(charge, '+');
       }
-      intensity = (double)param_.getValue("y_intensity");
+      intensity = y_intensity_;
       break;
     }
 
@@ -327,7 +391,7 @@ namespace OpenMS
         ions[pos] = ion;
         names[pos] = "z" + String(i) + String(charge, '+');
       }
-      intensity = (double)param_.getValue("z_intensity");
+      intensity = z_intensity_;
       break;
     }
 
@@ -336,11 +400,11 @@ namespace OpenMS
     }
 
     // get the params
-    bool add_losses(param_.getValue("add_losses").toBool());
-    bool add_metainfo(param_.getValue("add_metainfo").toBool());
-    bool add_isotopes(param_.getValue("add_isotopes").toBool());
-    Int max_isotope((Int)param_.getValue("max_isotope"));
-    double rel_loss_intensity((double)param_.getValue("relative_loss_intensity"));
+    bool add_losses(add_losses_);
+    bool add_metainfo(add_metainfo_);
+    bool add_isotopes(add_isotopes_);
+    Int max_isotope(max_isotope_);
+    double rel_loss_intensity(rel_loss_intensity_);
 
     for (Map<double, AASequence>::ConstIterator cit = ions.begin(); cit != ions.end(); ++cit)
     {
@@ -453,14 +517,75 @@ namespace OpenMS
     return;
   }
 
+  void TheoreticalSpectrumGenerator::addPeaksFast_(RichPeakSpectrum & spectrum, const AASequence & peptide, Residue::ResidueType res_type, Int charge, double intensity, char ion_letter)
+  {
+    Size n = peptide.size();
+    if (n < 2)
+    {
+      return;
+    }
+
+    bool prefix_ions = (res_type == Residue::AIon || res_type == Residue::BIon || res_type == Residue::CIon);
+
+    // cumulative masses of the residues: prefix_masses[i] is the mass of the
+    // first i residues (from the sum formulas, like AASequence::getMonoWeight)
+    vector<double> prefix_masses(n + 1, 0.0);
+    for (Size i = 0; i < n; ++i)
+    {
+      prefix_masses[i + 1] = prefix_masses[i] + peptide[i].getFormula(Residue::Internal).getMonoWeight();
+    }
+
+    // the terminal groups (incl. terminal modifications and protons) are the
+    // same for all ions of a series:
+    double terminal_mass = peptide.getMonoWeight(res_type, charge) - prefix_masses[n];
+
+    Size first = 1;
+    if (prefix_ions && !add_first_prefix_ion_)
+    {
+      first = 2;
+    }
+
+    spectrum.reserve(spectrum.size() + n - first);
+    p_.setIntensity(intensity);
+    for (Size i = first; i < n; ++i)
+    {
+      double pos;
+      if (i == 1)
+      {
+        // a single residue is weighted differently (see AASequence::getFormula)
+        AASequence ion = prefix_ions ? peptide.getPrefix(1) : peptide.getSuffix(1);
+        pos = ion.getMonoWeight(res_type, charge) / (double)charge;
+      }
+      else
+      {
+        double residue_mass = prefix_ions ? prefix_masses[i] : prefix_masses[n] - prefix_masses[n - i];
+        pos = (residue_mass + terminal_mass) / (double)charge;
+      }
+
+      p_.setMZ(pos);
+      if (add_metainfo_)
+      {
+        p_.setMetaValue("IonName", String(ion_letter) + String(i) + String(charge, '+'));
+      }
+      spectrum.push_back(p_);
+    }
+
+    if (add_metainfo_)
+    {
+      p_.setMetaValue("IonName", String(""));
+    }
+
+    spectrum.sortByPosition();
+  }
+
   void TheoreticalSpectrumGenerator::addPrecursorPeaks(RichPeakSpectrum & spec, const AASequence & peptide, Int charge)
   {
-    bool add_metainfo(param_.getValue("add_metainfo").toBool());
-    double pre_int((double)param_.getValue("precursor_intensity"));
-    double pre_int_H2O((double)param_.getValue("precursor_H2O_intensity"));
-    double pre_int_NH3((double)param_.getValue("precursor_NH3_intensity"));
-    bool add_isotopes(param_.getValue("add_isotopes").toBool());
-    int max_isotope((int)param_.getValue("max_isotope"));
+    bool add_metainfo(add_metainfo_);
+    double pre_int(pre_int_);
+    double pre_int_H2O(pre_int_H2O_);
+    double pre_int_NH3(pre_int_NH3_);
+    bool add_isotopes(add_isotopes_);
+    int max_isotope(max_isotope_);
 
     // precursor peak
     double mono_pos = peptide.getMonoWeight(Residue::Full, charge) / double(charge);
@@ -582,4 +707,31 @@ namespace OpenMS
     spec.sortByPosition();
   }
 
+  void TheoreticalSpectrumGenerator::updateMembers_()
+  {
+    add_b_ions_ = param_.getValue("add_b_ions").toBool();
+    add_y_ions_ = param_.getValue("add_y_ions").toBool();
+    add_a_ions_ = param_.getValue("add_a_ions").toBool();
+    add_c_ions_ = param_.getValue("add_c_ions").toBool();
+    add_x_ions_ = param_.getValue("add_x_ions").toBool();
+    add_z_ions_ = param_.getValue("add_z_ions").toBool();
+    add_first_prefix_ion_ = param_.getValue("add_first_prefix_ion").toBool();
+    add_losses_ = param_.getValue("add_losses").toBool();
+    add_metainfo_ = param_.getValue("add_metainfo").toBool();
+    add_isotopes_ = param_.getValue("add_isotopes").toBool();
+    add_precursor_peaks_ = param_.getValue("add_precursor_peaks").toBool();
+    add_abundant_immonium_ions_ = param_.getValue("add_abundant_immonium_ions").toBool();
+    max_isotope_ = (Int)param_.getValue("max_isotope");
+    a_intensity_ = (double)param_.getValue("a_intensity");
+    b_intensity_ = (double)param_.getValue("b_intensity");
+    c_intensity_ = (double)param_.getValue("c_intensity");
+    x_intensity_ = (double)param_.getValue("x_intensity");
+    y_intensity_ = (double)param_.getValue("y_intensity");
+    z_intensity_ = (double)param_.getValue("z_intensity");
+    rel_loss_intensity_ = (double)param_.getValue("relative_loss_intensity");
+    pre_int_ = (double)param_.getValue("precursor_intensity");
+    pre_int_H2O_ = (double)param_.getValue("precursor_H2O_intensity");
+    pre_int_NH3_ = (double)param_.getValue("precursor_NH3_intensity");
+  }
+
 }
@@ -95,11 +95,30 @@ namespace OpenMS
     UInt denominator(max(spec1.getFilledBinNumber(), spec2.getFilledBinNumber())), shared_Bins(min(spec1.getBinNumber(), spec2.getBinNumber()));
 
     // all bins at equal position that have both intensity > 0 contribute positively to score
-    for (Size i = 0; i < shared_Bins; ++i)
+    // (merge of the filled bins, which are all below the respective bin number)
+    const vector<UInt>& bins1 = spec1.getFilledBins();
+    const vector<UInt>& bins2 = spec2.getFilledBins();
+    const vector<float>& intensities1 = spec1.getFilledIntensities();
+    const vector<float>& intensities2 = spec2.getFilledIntensities();
+    Size i = 0, j = 0;
+    while (i < bins1.size() && j < bins2.size() && bins1[i] < shared_Bins && bins2[j] < shared_Bins)
     {
-      if (spec1.getBins()[i] > 0 && spec2.getBins()[i] > 0)
+      if (bins1[i] < bins2[j])
       {
-        sum++;
+        ++i;
+      }
+      else if (bins2[j] < bins1[i])
+      {
+        ++j;
+      }
+      else
+      {
+        if (intensities1[i] > 0 && intensities2[j] > 0)
+        {
+          sum++;
+        }
+        ++i;
+        ++j;
       }
     }
 
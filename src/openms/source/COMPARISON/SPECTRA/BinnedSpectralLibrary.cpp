@@ -0,0 +1,406 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2013.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: David Wojnar $
+// $Authors: David Wojnar $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/COMPARISON/SPECTRA/BinnedSpectralLibrary.h>
+#include <OpenMS/COMPARISON/SPECTRA/SpectraSTSimilarityScore.h>
+#include <OpenMS/CONCEPT/Exception.h>
+#include <OpenMS/SYSTEM/File.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+using namespace std;
+
+namespace OpenMS
+{
+  namespace
+  {
+    const char BINNED_LIBRARY_IDENTIFIER[8] = {'O', 'M', 'S', 'B', 'L', 'I', 'B', '\0'};
+    const UInt BINNED_LIBRARY_VERSION = 1;
+
+    /// orders positions by the precursor m/z they refer to
+    struct PrecursorLess
+    {
+      explicit PrecursorLess(const vector<double>& mz) :
+        mz_(mz)
+      {
+      }
+
+      bool operator()(Size a, Size b) const
+      {
+        return mz_[a] < mz_[b];
+      }
+
+      const vector<double>& mz_;
+    };
+
+    template <typename T>
+    void writeVector(ofstream& out, const vector<T>& v)
+    {
+      UInt64 size = v.size();
+      out.write(reinterpret_cast<const char*>(&size), sizeof(size));
+      if (size > 0)
+      {
+        out.write(reinterpret_cast<const char*>(&v[0]), size * sizeof(T));
+      }
+    }
+
+    template <typename T>
+    bool readVector(ifstream& in, vector<T>& v)
+    {
+      UInt64 size = 0;
+      in.read(reinterpret_cast<char*>(&size), sizeof(size));
+      if (!in)
+      {
+        return false;
+      }
+      v.clear();
+      // never trust the size without checking it against the data actually present
+      const streampos start = in.tellg();
+      in.seekg(0, ios::end);
+      const UInt64 available = in.tellg() - start;
+      in.seekg(start);
+      if (size > available / sizeof(T))
+      {
+        return false;
+      }
+      v.resize(size);
+      if (size > 0)
+      {
+        in.read(reinterpret_cast<char*>(&v[0]), size * sizeof(T));
+      }
+      return (bool)in;
+    }
+  }
+
+  BinnedSpectralLibrary::BinnedSpectralLibrary() :
+    precursor_mz_(),
+    spectrum_index_(),
+    offsets_(1, 0),
+    bins_(),
+    values_(),
+    signature_()
+  {
+  }
+
+  BinnedSpectralLibrary::~BinnedSpectralLibrary()
+  {
+  }
+
+  void BinnedSpectralLibrary::clear()
+  {
+    precursor_mz_.clear();
+    spectrum_index_.clear();
+    offsets_.assign(1, 0);
+    bins_.clear();
+    values_.clear();
+    signature_.clear();
+  }
+
+  void BinnedSpectralLibrary::addSpectrum(const PeakSpectrum& spec, double precursor_mz)
+  {
+    if (!spec.empty())
+    {
+      SpectraSTSimilarityScore sp;
+      const BinnedSpectrum binned = sp.transform(spec);
+      const vector<UInt>& bins = binned.getFilledBins();
+      const vector<float>& intensities = binned.getFilledIntensities();
+      for (Size b = 0; b < bins.size(); ++b)
+      {
+        if (intensities[b] > 0)
+        {
+          bins_.push_back(bins[b]);
+          values_.push_back(intensities[b]);
+        }
+      }
+    }
+    spectrum_index_.push_back(precursor_mz_.size());
+    precursor_mz_.push_back(precursor_mz);
+    offsets_.push_back(bins_.size());
+  }
+
+  void BinnedSpectralLibrary::sortByPrecursorMZ()
+  {
+    vector<Size> order(size());
+    for (Size i = 0; i < order.size(); ++i)
+    {
+      order[i] = i;
+    }
+    stable_sort(order.begin(), order.end(), PrecursorLess(precursor_mz_));
+
+    vector<double> precursor_mz(order.size());
+    vector<UInt64> spectrum_index(order.size());
+    vector<UInt64> offsets(1, 0);
+    offsets.reserve(offsets_.size());
+    vector<UInt> bins;
+    bins.reserve(bins_.size());
+    vector<float> values;
+    values.reserve(values_.size());
+    for (Size i = 0; i < order.size(); ++i)
+    {
+      const Size e = order[i];
+      precursor_mz[i] = precursor_mz_[e];
+      spectrum_index[i] = spectrum_index_[e];
+      bins.insert(bins.end(), bins_.begin() + offsets_[e], bins_.begin() + offsets_[e + 1]);
+      values.insert(values.end(), values_.begin() + offsets_[e], values_.begin() + offsets_[e + 1]);
+      offsets.push_back(bins.size());
+    }
+    precursor_mz_.swap(precursor_mz);
+    spectrum_index_.swap(spectrum_index);
+    offsets_.swap(offsets);
+    bins_.swap(bins);
+    values_.swap(values);
+  }
+
+  Size BinnedSpectralLibrary::size() const
+  {
+    return precursor_mz_.size();
+  }
+
+  double BinnedSpectralLibrary::getPrecursorMZ(Size entry) const
+  {
+    if (entry >= size())
+    {
+      throw Exception::IndexOverflow(__FILE__, __LINE__, __PRETTY_FUNCTION__, entry, size());
+    }
+    return precursor_mz_[entry];
+  }
+
+  Size BinnedSpectralLibrary::getSpectrumIndex(Size entry) const
+  {
+    if (entry >= size())
+    {
+      throw Exception::IndexOverflow(__FILE__, __LINE__, __PRETTY_FUNCTION__, entry, size());
+    }
+    return (Size)spectrum_index_[entry];
+  }
+
+  pair<Size, Size> BinnedSpectralLibrary::findRange(double min_mz, double max_mz) const
+  {
+    vector<double>::const_iterator first = lower_bound(precursor_mz_.begin(), precursor_mz_.end(), min_mz);
+    vector<double>::const_iterator last = upper_bound(first, precursor_mz_.end(), max_mz);
+    return make_pair((Size)(first - precursor_mz_.begin()), (Size)(last - precursor_mz_.begin()));
+  }
+
+  void BinnedSpectralLibrary::transformQuery(const PeakSpectrum& spec, vector<float>& query)
+  {
+    query.clear();
+    if (spec.empty())
+    {
+      return;
+    }
+    SpectraSTSimilarityScore sp;
+    const BinnedSpectrum binned = sp.transform(spec);
+    const vector<UInt>& bins = binned.getFilledBins();
+    const vector<float>& intensities = binned.getFilledIntensities();
+    query.resize(binned.getBinNumber(), 0.0f);
+    for (Size b = 0; b < bins.size(); ++b)
+    {
+      if (intensities[b] > 0)
+      {
+        query[bins[b]] = intensities[b];
+      }
+    }
+  }
+
+  double BinnedSpectralLibrary::dotProduct(Size entry, const vector<float>& query) const
+  {
+    // same summation order as SpectraSTSimilarityScore (ascending bins), so the scores are identical
+    double score(0);
+    const UInt* bin = bins_.empty() ? 0 : &bins_[0];
+    const float* value = values_.empty() ? 0 : &values_[0];
+    const Size query_size = query.size();
+    for (UInt64 i = offsets_[entry]; i < offsets_[entry + 1]; ++i)
+    {
+      if (bin[i] >= query_size)
+      {
+        break;
+      }
+      const float q = query[bin[i]];
+      if (q > 0)
+      {
+        score += (double)value[i] * (double)q;
+      }
+    }
+    return score;
+  }
+
+  double BinnedSpectralLibrary::dotBias(Size entry, const vector<float>& query, double dot_product) const
+  {
+    double numerator(0);
+    const Size query_size = query.size();
+    for (UInt64 i = offsets_[entry]; i < offsets_[entry + 1]; ++i)
+    {
+      if (bins_[i] >= query_size)
+      {
+        break;
+      }
+      const float q = query[bins_[i]];
+      if (q > 0)
+      {
+        numerator += (pow(values_[i], 2) * pow(q, 2));
+      }
+    }
+    numerator = sqrt(numerator);
+
+    if (dot_product)
+    {
+      return numerator / dot_product;
+    }
+    else
+    {
+      return numerator / dotProduct(entry, query);
+    }
+  }
+
+  void BinnedSpectralLibrary::score(const vector<float>& query, Size first, Size last, vector<double>& dot_products, vector<double>& dot_biases) const
+  {
+    if (last > size() || first > last)
+    {
+      throw Exception::IndexOverflow(__FILE__, __LINE__, __PRETTY_FUNCTION__, last, size());
+    }
+    dot_products.assign(last - first, 0.0);
+    dot_biases.assign(last - first, 0.0);
+
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 64)
+#endif
+    for (SignedSize i = 0; i < (SignedSize)(last - first); ++i)
+    {
+      const Size entry = first + i;
+      dot_products[i] = dotProduct(entry, query);
+      dot_biases[i] = dotBias(entry, query, dot_products[i]);
+    }
+  }
+
+  void BinnedSpectralLibrary::setSignature(const String& signature)
+  {
+    signature_ = signature;
+  }
+
+  const String& BinnedSpectralLibrary::getSignature() const
+  {
+    return signature_;
+  }
+
+  void BinnedSpectralLibrary::store(const String& filename) const
+  {
+    ofstream out(filename.c_str(), ios::out | ios::binary | ios::trunc);
+    if (!out)
+    {
+      throw Exception::UnableToCreateFile(__FILE__, __LINE__, __PRETTY_FUNCTION__, filename);
+    }
+    out.write(BINNED_LIBRARY_IDENTIFIER, sizeof(BINNED_LIBRARY_IDENTIFIER));
+    out.write(reinterpret_cast<const char*>(&BINNED_LIBRARY_VERSION), sizeof(BINNED_LIBRARY_VERSION));
+    UInt64 signature_size = signature_.size();
+    out.write(reinterpret_cast<const char*>(&signature_size), sizeof(signature_size));
+    out.write(signature_.c_str(), signature_size);
+    writeVector(out, precursor_mz_);
+    writeVector(out, spectrum_index_);
+    writeVector(out, offsets_);
+    writeVector(out, bins_);
+    writeVector(out, values_);
+    out.close();
+    if (!out)
+    {
+      throw Exception::UnableToCreateFile(__FILE__, __LINE__, __PRETTY_FUNCTION__, filename);
+    }
+  }
+
+  void BinnedSpectralLibrary::load(const String& filename)
+  {
+    if (!File::exists(filename))
+    {
+      throw Exception::FileNotFound(__FILE__, __LINE__, __PRETTY_FUNCTION__, filename);
+    }
+    ifstream in(filename.c_str(), ios::in | ios::binary);
+    if (!in)
+    {
+      throw Exception::FileNotReadable(__FILE__, __LINE__, __PRETTY_FUNCTION__, filename);
+    }
+
+    char identifier[sizeof(BINNED_LIBRARY_IDENTIFIER)];
+    UInt version = 0;
+    in.read(identifier, sizeof(identifier));
+    in.read(reinterpret_cast<char*>(&version), sizeof(version));
+    if (!in || memcmp(identifier, BINNED_LIBRARY_IDENTIFIER, sizeof(identifier)) != 0)
+    {
+      throw Exception::ParseError(__FILE__, __LINE__, __PRETTY_FUNCTION__, filename, "not a binned spectral library");
+    }
+    if (version != BINNED_LIBRARY_VERSION)
+    {
+      throw Exception::ParseError(__FILE__, __LINE__, __PRETTY_FUNCTION__, filename, String("unsupported version ") + version);
+    }
+
+    BinnedSpectralLibrary lib;
+    vector<char> signature;
+    if (!readVector(in, signature) || !readVector(in, lib.precursor_mz_) || !readVector(in, lib.spectrum_index_) ||
+        !readVector(in, lib.offsets_) || !readVector(in, lib.bins_) || !readVector(in, lib.values_))
+    {
+      throw Exception::ParseError(__FILE__, __LINE__, __PRETTY_FUNCTION__, filename, "truncated binned spectral library");
+    }
+    if (lib.spectrum_index_.size() != lib.precursor_mz_.size() || lib.offsets_.size() != lib.precursor_mz_.size() + 1 ||
+        lib.bins_.size() != lib.values_.size() || lib.offsets_.front() != 0 || lib.offsets_.back() != lib.bins_.size())
+    {
+      throw Exception::ParseError(__FILE__, __LINE__, __PRETTY_FUNCTION__, filename, "inconsistent binned spectral library");
+    }
+    for (Size i = 1; i < lib.offsets_.size(); ++i)
+    {
+      if (lib.offsets_[i] < lib.offsets_[i - 1])
+      {
+        throw Exception::ParseError(__FILE__, __LINE__, __PRETTY_FUNCTION__, filename, "inconsistent binned spectral library");
+      }
+    }
+    lib.signature_ = signature.empty() ? String() : String(&signature[0], &signature[0] + signature.size());
+
+    *this = lib;
+  }
+
+  bool BinnedSpectralLibrary::operator==(const BinnedSpectralLibrary& rhs) const
+  {
+    return precursor_mz_ == rhs.precursor_mz_ &&
+           spectrum_index_ == rhs.spectrum_index_ &&
+           offsets_ == rhs.offsets_ &&
+           bins_ == rhs.bins_ &&
+           values_ == rhs.values_ &&
+           signature_ == rhs.signature_;
+  }
+
+}
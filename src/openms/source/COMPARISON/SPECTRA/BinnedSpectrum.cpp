@@ -41,18 +41,19 @@ using namespace std;
 namespace OpenMS
 {
   BinnedSpectrum::BinnedSpectrum() :
-    MSSpectrum<>(), bin_spread_(1), bin_size_(2.0), bins_()
+    MSSpectrum<>(), bin_spread_(1), bin_size_(2.0), bins_(), filled_bins_(), filled_intensities_(), filled_bins_valid_(true)
   {
   }
 
   BinnedSpectrum::BinnedSpectrum(float size, UInt spread, PeakSpectrum ps) :
-    MSSpectrum<>(ps), bin_spread_(spread), bin_size_(size), bins_()
+    MSSpectrum<>(ps), bin_spread_(spread), bin_size_(size), bins_(), filled_bins_(), filled_intensities_(), filled_bins_valid_(false)
   {
     setBinning();
   }
 
   BinnedSpectrum::BinnedSpectrum(const BinnedSpectrum & source) :
-    MSSpectrum<>(source), bin_spread_(source.getBinSpread()), bin_size_(source.getBinSize()), bins_(source.getBins())
+    MSSpectrum<>(source), bin_spread_(source.getBinSpread()), bin_size_(source.getBinSize()), bins_(source.getBins()),
+    filled_bins_(source.filled_bins_), filled_intensities_(source.filled_intensities_), filled_bins_valid_(source.filled_bins_valid_)
   {
   }
 
@@ -103,9 +104,16 @@ namespace OpenMS
         }
       }
     }
+    updateFilledBins_();
 
   }
 
+  void BinnedSpectrum::updateFilledBins_() const
+  {
+    bins_.getNonSparseElements(filled_bins_, filled_intensities_);
+    filled_bins_valid_ = true;
+  }
+
   //yields false if given BinnedSpectrum size or spread differs from this one (comparing those might crash)
   bool BinnedSpectrum::checkCompliance(const BinnedSpectrum & bs) const
   {
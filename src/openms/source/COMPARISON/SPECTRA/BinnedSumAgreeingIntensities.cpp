@@ -94,11 +94,24 @@ namespace OpenMS
     double score(0), sharedBins(min(spec1.getBinNumber(), spec2.getBinNumber())), sum1(0), sum2(0), summax(0);
 
     // all bins at equal position and similar intensities contribute positively to score
-    for (Size i = 0; i < sharedBins; ++i)
+    // (merge of the filled bins in ascending order; empty bins add nothing)
+    const vector<UInt>& bins1 = spec1.getFilledBins();
+    const vector<UInt>& bins2 = spec2.getFilledBins();
+    const vector<float>& intensities1 = spec1.getFilledIntensities();
+    const vector<float>& intensities2 = spec2.getFilledIntensities();
+    Size i = 0, j = 0;
+    while (i < bins1.size() || j < bins2.size())
     {
-      sum1 += spec1.getBins()[i];
-      sum2 += spec2.getBins()[i];
-      summax += max((float)0, ((spec1.getBins()[i] + spec2.getBins()[i]) / 2) - fabs(spec1.getBins()[i] - spec2.getBins()[i]));
+      const UInt bin = (j == bins2.size() || (i < bins1.size() && bins1[i] < bins2[j])) ? bins1[i] : bins2[j];
+      if (bin >= sharedBins)
+      {
+        break;
+      }
+      const float value1 = (i < bins1.size() && bins1[i] == bin) ? intensities1[i++] : 0;
+      const float value2 = (j < bins2.size() && bins2[j] == bin) ? intensities2[j++] : 0;
+      sum1 += value1;
+      sum2 += value2;
+      summax += max((float)0, ((value1 + value2) / 2) - fabs(value1 - value2));
     }
 
     // resulting score normalized to interval [0,1]
@@ -118,12 +118,30 @@ namespace OpenMS
   {
     double score(0);
 
-    Size shared_bins = min(bin1.getBinNumber(), bin2.getBinNumber());
-    for (Size s = 0; s < shared_bins; ++s)
+    // merge of the filled bins, which are all below the respective bin number
+    const vector<UInt>& bins1 = bin1.getFilledBins();
+    const vector<UInt>& bins2 = bin2.getFilledBins();
+    const vector<float>& intensities1 = bin1.getFilledIntensities();
+    const vector<float>& intensities2 = bin2.getFilledIntensities();
+    Size i = 0, j = 0;
+    while (i < bins1.size() && j < bins2.size())
     {
-      if (bin1.getBins()[s] > 0 && bin2.getBins()[s] > 0)
+      if (bins1[i] < bins2[j])
+      {
+        ++i;
+      }
+      else if (bins2[j] < bins1[i])
+      {
+        ++j;
+      }
+      else
       {
-        score += (bin1.getBins()[s] * bin2.getBins()[s]);
+        if (intensities1[i] > 0 && intensities2[j] > 0)
+        {
+          score += (intensities1[i] * intensities2[j]);
+        }
+        ++i;
+        ++j;
       }
     }
 
@@ -179,12 +197,29 @@ namespace OpenMS
   {
     double numerator(0);
 
-    Size shared_bins = min(bin1.getBinNumber(), bin2.getBinNumber());
-    for (Size s = 0; s < shared_bins; ++s)
+    const vector<UInt>& bins1 = bin1.getFilledBins();
+    const vector<UInt>& bins2 = bin2.getFilledBins();
+    const vector<float>& intensities1 = bin1.getFilledIntensities();
+    const vector<float>& intensities2 = bin2.getFilledIntensities();
+    Size i = 0, j = 0;
+    while (i < bins1.size() && j < bins2.size())
     {
-      if (bin1.getBins()[s] > 0 && bin2.getBins()[s] > 0)
+      if (bins1[i] < bins2[j])
+      {
+        ++i;
+      }
+      else if (bins2[j] < bins1[i])
+      {
+        ++j;
+      }
+      else
       {
-        numerator += (pow(bin1.getBins()[s], 2) * pow(bin2.getBins()[s], 2));
+        if (intensities1[i] > 0 && intensities2[j] > 0)
+        {
+          numerator += (pow(intensities1[i], 2) * pow(intensities2[j], 2));
+        }
+        ++i;
+        ++j;
       }
     }
     numerator = sqrt(numerator);
@@ -5,6 +5,7 @@ set(directory source/COMPARISON/SPECTRA)
 set(sources_list
 BinnedSharedPeakCount.cpp
 BinnedSpectralContrastAngle.cpp
+BinnedSpectralLibrary.cpp
 BinnedSpectrum.cpp
 BinnedSpectrumCompareFunctor.cpp
 BinnedSumAgreeingIntensities.cpp
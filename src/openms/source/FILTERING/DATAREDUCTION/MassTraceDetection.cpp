@@ -46,6 +46,10 @@
 
 #include <boost/dynamic_bitset.hpp>
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 namespace OpenMS
 {
 MassTraceDetection::MassTraceDetection() :
@@ -81,7 +85,7 @@ MassTraceDetection::~MassTraceDetection()
 
 }
 
-void MassTraceDetection::updateIterativeWeightedMeanMZ(const double & added_mz, const double & added_int, double & centroid_mz, double & prev_counter, double & prev_denom)
+void MassTraceDetection::updateIterativeWeightedMeanMZ(const double & added_mz, const double & added_int, double & centroid_mz, double & prev_counter, double & prev_denom) const
 {
     double new_weight(added_int);
     double new_mz(added_mz);
@@ -198,36 +202,104 @@ double computeLoss(const double & x_t, const double & mean_t, const double & sd_
     return ((x_t - mean_t) * (x_t - mean_t)) / (2 * sd_t * sd_t) + 0.5 * std::log(sd_t * sd_t);
 }
 
+struct MassTraceDetection::PeakTable_
+{
+    /// m/z of all peaks, spectrum by spectrum (each sorted by m/z)
+    std::vector<double> mz;
+    /// intensity of all peaks
+    std::vector<Peak1D::IntensityType> intensity;
+    /// RT of each spectrum
+    std::vector<double> rt;
+    /// index of the first peak of each spectrum (plus the total number of peaks)
+    std::vector<Size> offsets;
+    /// peaks which are part of an accepted mass trace
+    boost::dynamic_bitset<> visited;
+
+    Size size() const
+    {
+        return rt.size();
+    }
+
+    bool empty(Size scan_idx) const
+    {
+        return offsets[scan_idx] == offsets[scan_idx + 1];
+    }
+
+    /// index of the peak nearest to @p mz in a non-empty spectrum (same as MSSpectrum::findNearest)
+    Size findNearest(Size scan_idx, double mz_value) const
+    {
+        std::vector<double>::const_iterator begin = mz.begin() + offsets[scan_idx];
+        std::vector<double>::const_iterator end = mz.begin() + offsets[scan_idx + 1];
+        std::vector<double>::const_iterator it = std::lower_bound(begin, end, mz_value);
+        if (it == begin)
+        {
+            return offsets[scan_idx];
+        }
+        if (it == end)
+        {
+            return offsets[scan_idx + 1] - 1;
+        }
+        std::vector<double>::const_iterator it2 = it - 1;
+        if (std::fabs(*it - mz_value) < std::fabs(*it2 - mz_value))
+        {
+            return it - mz.begin();
+        }
+        return it2 - mz.begin();
+    }
+};
+
+struct MassTraceDetection::TraceCandidate_
+{
+    /// whether the apex was extended at all
+    bool extended;
+    /// whether the trace meets the length and quality criteria
+    bool accepted;
+    /// the gathered peaks in order of RT
+    std::list<PeakType> trace;
+    /// the indices of the gathered peaks (in the peak table)
+    std::vector<Size> gathered_idx;
+
+    void clear()
+    {
+        extended = false;
+        accepted = false;
+        trace.clear();
+        gathered_idx.clear();
+    }
+};
+
+namespace
+{
+    /// a potential chromatographic apex
+    struct Apex
+    {
+        double intensity;
+        Size scan_idx;
+        Size peak_idx;
+
+        bool operator<(const Apex & rhs) const
+        {
+            return intensity < rhs.intensity;
+        }
+    };
+}
+
 void MassTraceDetection::run(const MSExperiment<Peak1D> & input_exp, std::vector<MassTrace> & found_masstraces)
 {
     // make sure the output vector is empty
     found_masstraces.clear();
 
     // gather all peaks that are potential chromatographic peak apeces
-    typedef std::multimap<double, std::pair<Size, Size> > MapIdxSortedByInt;
-    MSExperiment<Peak1D> work_exp;
-    MapIdxSortedByInt chrom_apeces;
-
-    Size peak_count(0);
-    std::vector<Size> spec_offsets;
-    spec_offsets.push_back(0);
+    PeakTable_ peaks;
+    std::vector<Apex> chrom_apeces;
+    peaks.offsets.push_back(0);
 
-    Size spectra_count(0);
-
-
-    // this->startProgress(0, input_exp.size(), "Detect potential chromatographic apeces...");
     for (Size scan_idx = 0; scan_idx < input_exp.size(); ++scan_idx)
     {
-        // this->setProgress(scan_idx);
-
         // check if this is a MS1 survey scan
         if (input_exp[scan_idx].getMSLevel() == 1)
         {
-            double scan_rt = input_exp[scan_idx].getRT();
-            MSSpectrum<Peak1D> tmp_spec;
-            Size spec_peak_idx = 0;
-
-            tmp_spec.setRT(scan_rt);
+            peaks.rt.push_back(input_exp[scan_idx].getRT());
 
             for (Size peak_idx = 0; peak_idx < input_exp[scan_idx].size(); ++peak_idx)
             {
@@ -235,50 +307,36 @@ void MassTraceDetection::run(const MSExperiment<Peak1D> & input_exp, std::vector
 
                 if (tmp_peak_int > noise_threshold_int_)
                 {
-                    tmp_spec.push_back(input_exp[scan_idx][peak_idx]);
-
                     if (tmp_peak_int > chrom_peak_snr_ * noise_threshold_int_)
                     {
-                        chrom_apeces.insert(std::make_pair(tmp_peak_int, std::make_pair(scan_idx, spec_peak_idx)));
+                        Apex apex;
+                        apex.intensity = tmp_peak_int;
+                        apex.scan_idx = peaks.rt.size() - 1;
+                        apex.peak_idx = peaks.mz.size();
+                        chrom_apeces.push_back(apex);
                     }
-                    ++peak_count;
-                    ++spec_peak_idx;
+                    peaks.mz.push_back(input_exp[scan_idx][peak_idx].getMZ());
+                    peaks.intensity.push_back(input_exp[scan_idx][peak_idx].getIntensity());
                 }
             }
-
-
-            work_exp.addSpectrum(tmp_spec);
-            spec_offsets.push_back(spec_offsets[spec_offsets.size() - 1] + tmp_spec.size());
-
-            ++spectra_count;
+            peaks.offsets.push_back(peaks.mz.size());
         }
     }
 
+    Size spectra_count(peaks.size());
     if (spectra_count < 3)
     {
         throw Exception::InvalidValue(__FILE__, __LINE__, __PRETTY_FUNCTION__, "Input map consists of too few spectra (less than 3!). Aborting...", String(spectra_count));
     }
 
-
-    Size min_fwhm_scans(3);
     double scan_time(std::fabs(input_exp[input_exp.size() - 1].getRT() - input_exp[0].getRT()) / input_exp.size());
 
-    // std::cout << "scan_time: " << scan_time << " " << min_trace_length_ << std::endl;
+    // process the apeces by decreasing intensity (equal intensities in reverse order of occurrence)
+    std::stable_sort(chrom_apeces.begin(), chrom_apeces.end());
+    std::reverse(chrom_apeces.begin(), chrom_apeces.end());
 
-    Size scan_nums(std::floor(min_trace_length_ / scan_time));
-
-    if (scan_nums > min_fwhm_scans)
-    {
-        min_fwhm_scans = scan_nums;
-    }
-
-
-    // Size min_flank_scans(3);
-
-    // discard last spectrum's offset
-    spec_offsets.pop_back();
-
-    boost::dynamic_bitset<> peak_visited(peak_count);
+    Size peak_count(peaks.mz.size());
+    peaks.visited.resize(peak_count);
 
     // start extending mass traces beginning with the apex peak
 
@@ -287,265 +345,253 @@ void MassTraceDetection::run(const MSExperiment<Peak1D> & input_exp, std::vector
     this->startProgress(0, peak_count, "mass trace detection");
     Size peaks_detected(0);
 
-    for (MapIdxSortedByInt::reverse_iterator m_it = chrom_apeces.rbegin(); m_it != chrom_apeces.rend(); ++m_it)
+    // The apeces of a block are extended in parallel using the peaks visited
+    // by the previous blocks. The candidates are then accepted in order of
+    // intensity; a candidate that gathered a peak which was taken by a more
+    // intense trace of the same block is extended again.
+    Size block_size(256);
+#ifdef _OPENMP
+    block_size *= omp_get_max_threads();
+#endif
+    std::vector<TraceCandidate_> candidates(std::min(block_size, chrom_apeces.size()));
+
+    for (Size block_start = 0; block_start < chrom_apeces.size(); block_start += block_size)
     {
-        Size apex_scan_idx(m_it->second.first);
-        Size apex_peak_idx(m_it->second.second);
+        SignedSize block_end = std::min(block_start + block_size, chrom_apeces.size());
 
-        if (peak_visited[spec_offsets[apex_scan_idx] + apex_peak_idx])
-            continue;
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 16)
+#endif
+        for (SignedSize i = block_start; i < block_end; ++i)
+        {
+            TraceCandidate_ & candidate = candidates[i - block_start];
+            candidate.clear();
+            if (!peaks.visited[chrom_apeces[i].peak_idx])
+            {
+                extendTrace_(peaks, chrom_apeces[i].scan_idx, chrom_apeces[i].peak_idx, candidate);
+            }
+        }
 
-        Peak2D apex_peak;
-        apex_peak.setRT(work_exp[apex_scan_idx].getRT());
-        apex_peak.setMZ(work_exp[apex_scan_idx][apex_peak_idx].getMZ());
-        apex_peak.setIntensity(work_exp[apex_scan_idx][apex_peak_idx].getIntensity());
+        for (SignedSize i = block_start; i < block_end; ++i)
+        {
+            TraceCandidate_ & candidate = candidates[i - block_start];
 
-        Size trace_up_idx(apex_scan_idx);
-        Size trace_down_idx(apex_scan_idx);
+            if (!candidate.extended || peaks.visited[chrom_apeces[i].peak_idx])
+                continue;
 
-        std::list<PeakType> current_trace;
-        current_trace.push_back(apex_peak);
+            // redo the extension if it used a peak taken in the meantime
+            for (Size j = 0; j < candidate.gathered_idx.size(); ++j)
+            {
+                if (peaks.visited[candidate.gathered_idx[j]])
+                {
+                    candidate.clear();
+                    extendTrace_(peaks, chrom_apeces[i].scan_idx, chrom_apeces[i].peak_idx, candidate);
+                    break;
+                }
+            }
 
-        // Initialization for the iterative version of weighted m/z mean calculation
-        double centroid_mz(apex_peak.getMZ());
-        double prev_counter(apex_peak.getIntensity() * apex_peak.getMZ());
-        double prev_denom(apex_peak.getIntensity());
+            if (!candidate.accepted)
+                continue;
 
-        updateIterativeWeightedMeanMZ(apex_peak.getMZ(), apex_peak.getIntensity(), centroid_mz, prev_counter, prev_denom);
+            // mark all peaks as visited
+            for (Size j = 0; j < candidate.gathered_idx.size(); ++j)
+            {
+                peaks.visited[candidate.gathered_idx[j]] = true;
+            }
 
-        std::vector<std::pair<Size, Size> > gathered_idx;
-        gathered_idx.push_back(std::make_pair(apex_scan_idx, apex_peak_idx));
+            // create new MassTrace object and store collected peaks from list current_trace
+            MassTrace new_trace(candidate.trace, scan_time);
+            new_trace.updateWeightedMeanRT();
+            new_trace.updateWeightedMeanMZ();
 
-        Size up_hitting_peak(0), down_hitting_peak(0);
-        Size up_scan_counter(0), down_scan_counter(0);
+            //new_trace.setCentroidSD(ftl_sd);
+            new_trace.updateWeightedMZsd();
 
-        bool toggle_up = true, toggle_down = true;
+            new_trace.setLabel("T" + String(trace_number));
 
-        Size conseq_missed_peak_up(0), conseq_missed_peak_down(0);
-        Size MAX_CONSEQ_MISSING(trace_termination_outliers_);
+            peaks_detected += new_trace.getSize();
+            this->setProgress(peaks_detected);
+            found_masstraces.push_back(new_trace);
+            ++trace_number;
+        }
+    }
 
-        double current_sample_rate(1.0);
-        // Size min_scans_to_consider(std::floor((min_sample_rate_ /2)*10));
-        Size min_scans_to_consider(5);
+    this->endProgress();
 
-        // double outlier_ratio(0.3);
+    return;
+} // end of MassTraceDetection::run
 
-        // double ftl_mean(centroid_mz);
-        double ftl_sd((centroid_mz / 1e6) * mass_error_ppm_);
-        double intensity_so_far(apex_peak.getIntensity());
+void MassTraceDetection::extendTrace_(const PeakTable_ & peaks, Size apex_scan_idx, Size apex_idx, TraceCandidate_ & candidate) const
+{
+    candidate.extended = true;
 
-        while (((trace_down_idx > 0) && toggle_down) || ((trace_up_idx < work_exp.size() - 1) && toggle_up))
-        {
+    Peak2D apex_peak;
+    apex_peak.setRT(peaks.rt[apex_scan_idx]);
+    apex_peak.setMZ(peaks.mz[apex_idx]);
+    apex_peak.setIntensity(peaks.intensity[apex_idx]);
 
-            // double centroid_mz = current_trace.getCentroidMZ();
+    Size trace_up_idx(apex_scan_idx);
+    Size trace_down_idx(apex_scan_idx);
 
-            // try to go downwards in RT
-            if (((trace_down_idx > 0) && toggle_down))
-            {
-                if (!work_exp[trace_down_idx - 1].empty())
-                {
-                    Size next_down_peak_idx = work_exp[trace_down_idx - 1].findNearest(centroid_mz);
-                    double next_down_peak_mz = work_exp[trace_down_idx - 1][next_down_peak_idx].getMZ();
-                    double next_down_peak_int = work_exp[trace_down_idx - 1][next_down_peak_idx].getIntensity();
+    std::list<PeakType> & current_trace = candidate.trace;
+    current_trace.push_back(apex_peak);
 
-                    double right_bound, left_bound;
+    // Initialization for the iterative version of weighted m/z mean calculation
+    double centroid_mz(apex_peak.getMZ());
+    double prev_counter(apex_peak.getIntensity() * apex_peak.getMZ());
+    double prev_denom(apex_peak.getIntensity());
 
-                    //                    right_bound = centroid_mz + (centroid_mz/1000000)*mass_error_ppm_;
-                    //                    left_bound = centroid_mz - (centroid_mz/1000000)*mass_error_ppm_;
+    updateIterativeWeightedMeanMZ(apex_peak.getMZ(), apex_peak.getIntensity(), centroid_mz, prev_counter, prev_denom);
 
-                    right_bound = centroid_mz + 3 * ftl_sd;
-                    left_bound = centroid_mz - 3 * ftl_sd;
+    std::vector<Size> & gathered_idx = candidate.gathered_idx;
+    gathered_idx.push_back(apex_idx);
 
-                    //                  std::cout << "down: " << centroid_mz << " "<<  ftl_sd << std::endl;
+    Size up_hitting_peak(0), down_hitting_peak(0);
+    Size up_scan_counter(0), down_scan_counter(0);
 
-                    // Size left_next_idx = work_exp[trace_down_idx - 1].findNearest(left_bound);
-                    // Size right_next_idx = work_exp[trace_down_idx - 1].findNearest(right_bound);
+    bool toggle_up = true, toggle_down = true;
 
-                    // double left_mz(work_exp[trace_down_idx - 1][left_next_idx].getMZ());
-                    // double right_mz(work_exp[trace_down_idx - 1][right_next_idx].getMZ());
+    Size conseq_missed_peak_up(0), conseq_missed_peak_down(0);
+    Size MAX_CONSEQ_MISSING(trace_termination_outliers_);
 
-                    // std::cout << "next: " << next_down_peak_mz << std::endl;
+    double current_sample_rate(1.0);
+    Size min_scans_to_consider(5);
 
-                    if ((next_down_peak_mz <= right_bound) && (next_down_peak_mz >= left_bound) && !peak_visited[spec_offsets[trace_down_idx - 1] + next_down_peak_idx])
-                    {
-                        Peak2D next_peak;
-                        next_peak.setRT(work_exp[trace_down_idx - 1].getRT());
-                        next_peak.setMZ(next_down_peak_mz);
-                        next_peak.setIntensity(next_down_peak_int);
+    double ftl_sd((centroid_mz / 1e6) * mass_error_ppm_);
+    double intensity_so_far(apex_peak.getIntensity());
 
-                        current_trace.push_front(next_peak);
+    while (((trace_down_idx > 0) && toggle_down) || ((trace_up_idx < peaks.size() - 1) && toggle_up))
+    {
+        // try to go downwards in RT
+        if (((trace_down_idx > 0) && toggle_down))
+        {
+            if (!peaks.empty(trace_down_idx - 1))
+            {
+                Size next_down_idx = peaks.findNearest(trace_down_idx - 1, centroid_mz);
+                double next_down_peak_mz = peaks.mz[next_down_idx];
+                double next_down_peak_int = peaks.intensity[next_down_idx];
 
-                        updateIterativeWeightedMeanMZ(next_down_peak_mz, next_down_peak_int, centroid_mz, prev_counter, prev_denom);
-                        gathered_idx.push_back(std::make_pair(trace_down_idx - 1, next_down_peak_idx));
+                double right_bound = centroid_mz + 3 * ftl_sd;
+                double left_bound = centroid_mz - 3 * ftl_sd;
 
+                if ((next_down_peak_mz <= right_bound) && (next_down_peak_mz >= left_bound) && !peaks.visited[next_down_idx])
+                {
+                    Peak2D next_peak;
+                    next_peak.setRT(peaks.rt[trace_down_idx - 1]);
+                    next_peak.setMZ(next_down_peak_mz);
+                    next_peak.setIntensity(next_down_peak_int);
 
+                    current_trace.push_front(next_peak);
 
-                        if (reestimate_mt_sd_) //  && (down_hitting_peak+1 > min_flank_scans))
-                        {
-                            // if (ftl_t > min_fwhm_scans)
-                            {
-                                updateWeightedSDEstimateRobust(next_peak, centroid_mz, ftl_sd, intensity_so_far);
-                            }
-                        }
+                    updateIterativeWeightedMeanMZ(next_down_peak_mz, next_down_peak_int, centroid_mz, prev_counter, prev_denom);
+                    gathered_idx.push_back(next_down_idx);
 
-                        ++down_hitting_peak;
-                        conseq_missed_peak_down = 0;
-                    }
-                    else
+                    if (reestimate_mt_sd_)
                     {
-                        ++conseq_missed_peak_down;
+                        updateWeightedSDEstimateRobust(next_peak, centroid_mz, ftl_sd, intensity_so_far);
                     }
 
-
+                    ++down_hitting_peak;
+                    conseq_missed_peak_down = 0;
                 }
-                --trace_down_idx;
-                ++down_scan_counter;
-
-
-                // trace termination criterion: max allowed number of consecutive outliers reached OR cancel extenstion if sampling_rate falls below min_sample_rate_
-                if (trace_termination_criterion_ == "outlier")
+                else
                 {
-                    if (conseq_missed_peak_down > MAX_CONSEQ_MISSING)
-                    {
-                        toggle_down = false;
-                    }
+                    ++conseq_missed_peak_down;
                 }
-                else if (trace_termination_criterion_ == "sample_rate")
-                {
-                    current_sample_rate = (double)(down_hitting_peak + up_hitting_peak + 1)/(double)(down_scan_counter + up_scan_counter + 1);
-
-                    if (down_scan_counter > min_scans_to_consider && current_sample_rate < min_sample_rate_)
-                    {
-                        // std::cout << "stopping down..." << std::endl;
-                        toggle_down = false;
-                    }
-
-                }
-
             }
+            --trace_down_idx;
+            ++down_scan_counter;
 
-            //}
-            // *********************************************************** //
-            // MOVE UP in RT dim
-            // *********************************************************** //
-
-            if (((trace_up_idx < work_exp.size() - 1) && toggle_up))
+            // trace termination criterion: max allowed number of consecutive outliers reached OR cancel extenstion if sampling_rate falls below min_sample_rate_
+            if (trace_termination_criterion_ == "outlier")
             {
-                if (!work_exp[trace_up_idx + 1].empty())
+                if (conseq_missed_peak_down > MAX_CONSEQ_MISSING)
                 {
-                    Size next_up_peak_idx = work_exp[trace_up_idx + 1].findNearest(centroid_mz);
-                    double next_up_peak_mz = work_exp[trace_up_idx + 1][next_up_peak_idx].getMZ();
-                    double next_up_peak_int = work_exp[trace_up_idx + 1][next_up_peak_idx].getIntensity();
-
-                    double right_bound, left_bound;
-
-                    //                    right_bound = centroid_mz + (centroid_mz/1000000)*mass_error_ppm_;
-                    //                    left_bound = centroid_mz - (centroid_mz/1000000)*mass_error_ppm_;
-
-
-                    right_bound = centroid_mz + 3 * ftl_sd;
-                    left_bound = centroid_mz - 3 * ftl_sd;
+                    toggle_down = false;
+                }
+            }
+            else if (trace_termination_criterion_ == "sample_rate")
+            {
+                current_sample_rate = (double)(down_hitting_peak + up_hitting_peak + 1)/(double)(down_scan_counter + up_scan_counter + 1);
 
+                if (down_scan_counter > min_scans_to_consider && current_sample_rate < min_sample_rate_)
+                {
+                    toggle_down = false;
+                }
+            }
+        }
 
-                    if ((next_up_peak_mz <= right_bound) && (next_up_peak_mz >= left_bound) && !peak_visited[spec_offsets[trace_up_idx + 1] + next_up_peak_idx])
-                    {
-                        Peak2D next_peak;
-                        next_peak.setRT(work_exp[trace_up_idx + 1].getRT());
-                        next_peak.setMZ(next_up_peak_mz);
-                        next_peak.setIntensity(next_up_peak_int);
+        // *********************************************************** //
+        // MOVE UP in RT dim
+        // *********************************************************** //
 
-                        current_trace.push_back(next_peak);
+        if (((trace_up_idx < peaks.size() - 1) && toggle_up))
+        {
+            if (!peaks.empty(trace_up_idx + 1))
+            {
+                Size next_up_idx = peaks.findNearest(trace_up_idx + 1, centroid_mz);
+                double next_up_peak_mz = peaks.mz[next_up_idx];
+                double next_up_peak_int = peaks.intensity[next_up_idx];
 
-                        updateIterativeWeightedMeanMZ(next_up_peak_mz, next_up_peak_int, centroid_mz, prev_counter, prev_denom);
-                        gathered_idx.push_back(std::make_pair(trace_up_idx + 1, next_up_peak_idx));
+                double right_bound = centroid_mz + 3 * ftl_sd;
+                double left_bound = centroid_mz - 3 * ftl_sd;
 
+                if ((next_up_peak_mz <= right_bound) && (next_up_peak_mz >= left_bound) && !peaks.visited[next_up_idx])
+                {
+                    Peak2D next_peak;
+                    next_peak.setRT(peaks.rt[trace_up_idx + 1]);
+                    next_peak.setMZ(next_up_peak_mz);
+                    next_peak.setIntensity(next_up_peak_int);
 
-                        if (reestimate_mt_sd_) //  && (up_hitting_peak+1 > min_flank_scans))
-                        {
-                            // if (ftl_t > min_fwhm_scans)
-                            {
-                                //computeWeightedSDEstimate(current_trace, centroid_mz, ftl_sd, lower_sd_bound);
-                                updateWeightedSDEstimateRobust(next_peak, centroid_mz, ftl_sd, intensity_so_far);
-                            }
-                        }
+                    current_trace.push_back(next_peak);
 
-                        ++up_hitting_peak;
-                        conseq_missed_peak_up = 0;
+                    updateIterativeWeightedMeanMZ(next_up_peak_mz, next_up_peak_int, centroid_mz, prev_counter, prev_denom);
+                    gathered_idx.push_back(next_up_idx);
 
-                    }
-                    else
+                    if (reestimate_mt_sd_)
                     {
-                        ++conseq_missed_peak_up;
+                        updateWeightedSDEstimateRobust(next_peak, centroid_mz, ftl_sd, intensity_so_far);
                     }
 
+                    ++up_hitting_peak;
+                    conseq_missed_peak_up = 0;
                 }
-
-                ++trace_up_idx;
-                ++up_scan_counter;
-
-                if (trace_termination_criterion_ == "outlier")
-                {
-                    if (conseq_missed_peak_up > MAX_CONSEQ_MISSING)
-                    {
-                        toggle_up = false;
-                    }
-                }
-                else if (trace_termination_criterion_ == "sample_rate")
+                else
                 {
-                    current_sample_rate = (double)(down_hitting_peak + up_hitting_peak + 1)/(double)(down_scan_counter + up_scan_counter + 1);
-
-                    if (up_scan_counter > min_scans_to_consider && current_sample_rate < min_sample_rate_)
-                    {
-                        // std::cout << "stopping up" << std::endl;
-                        toggle_up = false;
-                    }
+                    ++conseq_missed_peak_up;
                 }
-
-
             }
 
-        }
-
-        // std::cout << "current sr: " << current_sample_rate << std::endl;
-        double num_scans(down_scan_counter + up_scan_counter + 1 - conseq_missed_peak_down - conseq_missed_peak_up);
+            ++trace_up_idx;
+            ++up_scan_counter;
 
-        double mt_quality((double)current_trace.size() / (double)num_scans);
-        // std::cout << "mt quality: " << mt_quality << std::endl;
-        double rt_range(std::fabs(current_trace.rbegin()->getRT() - current_trace.begin()->getRT()));
-
-        // std::cout << num_scans << " " << mt_quality << " " << rt_range << std::endl;
-        // check if minimum length and quality of mass trace criteria are met
-        if (rt_range >= min_trace_length_ && rt_range < max_trace_length_ && mt_quality >= min_sample_rate_)
-        {
-            // std::cout << "T" << trace_number << "\t" << mt_quality << std::endl;
-
-            // mark all peaks as visited
-            for (Size i = 0; i < gathered_idx.size(); ++i)
+            if (trace_termination_criterion_ == "outlier")
             {
-                peak_visited[spec_offsets[gathered_idx[i].first] +  gathered_idx[i].second] = true;
+                if (conseq_missed_peak_up > MAX_CONSEQ_MISSING)
+                {
+                    toggle_up = false;
+                }
             }
+            else if (trace_termination_criterion_ == "sample_rate")
+            {
+                current_sample_rate = (double)(down_hitting_peak + up_hitting_peak + 1)/(double)(down_scan_counter + up_scan_counter + 1);
 
-            // create new MassTrace object and store collected peaks from list current_trace
-            MassTrace new_trace(current_trace, scan_time);
-            new_trace.updateWeightedMeanRT();
-            new_trace.updateWeightedMeanMZ();
-
-            //new_trace.setCentroidSD(ftl_sd);
-            new_trace.updateWeightedMZsd();
-
-            new_trace.setLabel("T" + String(trace_number));
-
-            peaks_detected += new_trace.getSize();
-            this->setProgress(peaks_detected);
-            found_masstraces.push_back(new_trace);
-            ++trace_number;
+                if (up_scan_counter > min_scans_to_consider && current_sample_rate < min_sample_rate_)
+                {
+                    toggle_up = false;
+                }
+            }
         }
     }
 
-    this->endProgress();
+    double num_scans(down_scan_counter + up_scan_counter + 1 - conseq_missed_peak_down - conseq_missed_peak_up);
 
-    return;
-} // end of MassTraceDetection::run
+    double mt_quality((double)current_trace.size() / (double)num_scans);
+    double rt_range(std::fabs(current_trace.rbegin()->getRT() - current_trace.begin()->getRT()));
+
+    // check if minimum length and quality of mass trace criteria are met
+    candidate.accepted = (rt_range >= min_trace_length_ && rt_range < max_trace_length_ && mt_quality >= min_sample_rate_);
+}
 
 void MassTraceDetection::updateMembers_()
 {
@@ -46,6 +46,128 @@ namespace OpenMS
   const char Base64::encoder_[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
   const char Base64::decoder_[] = "|$$$}rstuvwxyz{$$$$$$$>?@ABCDEFGHIJKLMNOPQRSTUVW$$$$$$XYZ[\\]^_`abcdefghijklmnopq";
 
+  namespace
+  {
+    // maps each character to its 6 bit value, padding ('=') to 64 and all
+    // other characters (whitespace, invalid characters) to 128
+    const unsigned char base64_decode_table[256] =
+    {
+    128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128,
+    128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128,
+    128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 62, 128, 128, 128, 63,
+    52, 53, 54, 55, 56, 57, 58, 59, 60, 61, 128, 128, 128, 64, 128, 128,
+    128, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14,
+    15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 128, 128, 128, 128, 128,
+    128, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35, 36, 37, 38, 39, 40,
+    41, 42, 43, 44, 45, 46, 47, 48, 49, 50, 51, 128, 128, 128, 128, 128,
+    128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128,
+    128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128,
+    128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128,
+    128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128,
+    128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128,
+    128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128,
+    128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128,
+    128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128
+    };
+  }
+
+  Size Base64::decodeBase64Raw_(const char* in, Size in_size, unsigned char* out)
+  {
+    const unsigned char* it = reinterpret_cast<const unsigned char*>(in);
+    const unsigned char* end = it + in_size;
+    unsigned char* to = out;
+
+    UInt int_24bit = 0;
+    Size nr_chars = 0;
+    bool padding = false;
+    while (it != end && !padding)
+    {
+      // fast path: decode complete groups of 4 characters without any special characters
+      while (end - it >= 4)
+      {
+        UInt a = base64_decode_table[it[0]];
+        UInt b = base64_decode_table[it[1]];
+        UInt c = base64_decode_table[it[2]];
+        UInt d = base64_decode_table[it[3]];
+        if ((a | b | c | d) & 0xC0)
+        {
+          break; // padding, whitespace or invalid character: continue with the slow path
+        }
+        int_24bit = (a << 18) | (b << 12) | (c << 6) | d;
+        to[0] = (unsigned char)(int_24bit >> 16);
+        to[1] = (unsigned char)(int_24bit >> 8);
+        to[2] = (unsigned char)int_24bit;
+        to += 3;
+        it += 4;
+      }
+      int_24bit = 0;
+
+      // slow path: skip characters outside of the alphabet and stop at the
+      // padding, return to the fast path after each complete group
+      for (; it != end; ++it)
+      {
+        UInt value = base64_decode_table[*it];
+        if (value & 0x80)
+        {
+          continue;
+        }
+        if (value & 0x40)
+        {
+          padding = true;
+          break;
+        }
+        int_24bit = (int_24bit << 6) | value;
+        if (++nr_chars == 4)
+        {
+          to[0] = (unsigned char)(int_24bit >> 16);
+          to[1] = (unsigned char)(int_24bit >> 8);
+          to[2] = (unsigned char)int_24bit;
+          to += 3;
+          int_24bit = 0;
+          nr_chars = 0;
+          ++it;
+          break;
+        }
+      }
+    }
+
+    // incomplete last group (a single remaining character carries no complete byte)
+    if (nr_chars == 2)
+    {
+      to[0] = (unsigned char)(int_24bit >> 4);
+      to += 1;
+    }
+    else if (nr_chars == 3)
+    {
+      to[0] = (unsigned char)(int_24bit >> 10);
+      to[1] = (unsigned char)(int_24bit >> 2);
+      to += 2;
+    }
+    return to - out;
+  }
+
+  void Base64::swapByteOrder_(unsigned char* data, Size count, Size element_size)
+  {
+    if (element_size == 4)
+    {
+      for (Size i = 0; i < count; ++i, data += 4)
+      {
+        std::swap(data[0], data[3]);
+        std::swap(data[1], data[2]);
+      }
+    }
+    else
+    {
+      for (Size i = 0; i < count; ++i, data += 8)
+      {
+        std::swap(data[0], data[7]);
+        std::swap(data[1], data[6]);
+        std::swap(data[2], data[5]);
+        std::swap(data[3], data[4]);
+      }
+    }
+  }
+
   Base64::Base64()
   {
   }
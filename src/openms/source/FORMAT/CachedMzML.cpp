@@ -34,10 +34,28 @@
 
 #include <OpenMS/FORMAT/CachedMzML.h>
 
+#include <OpenMS/MATH/MISC/MSNumpress.h>
+
+#include <boost/math/special_functions/fpclassify.hpp> // boost::math::isfinite
+#include <boost/static_assert.hpp>
+
+#include <cstring>
+
 namespace OpenMS
 {
 
-  CachedmzML::CachedmzML()
+  // the on-disk structures of format version 2 are written as raw memory
+  // blocks and need to have the same layout on all platforms
+  BOOST_STATIC_ASSERT(sizeof(CachedmzML::RecordHeader) == 40);
+  BOOST_STATIC_ASSERT(sizeof(CachedmzML::IndexEntry) == 24);
+  BOOST_STATIC_ASSERT(sizeof(CachedmzML::Trailer) == 32);
+
+  const std::string CachedmzML::NamesOfBinaryDataEncoding[] = {"float64", "float32", "numpress_linear", "numpress_slof", "numpress_pic"};
+
+  CachedmzML::CachedmzML() :
+    format_version_(1),
+    first_encoding_(ENCODING_FLOAT64),
+    intensity_encoding_(ENCODING_FLOAT64)
   {
   }
 
@@ -52,17 +70,52 @@ namespace OpenMS
 
     spectra_index_ = rhs.spectra_index_;
     chrom_index_ = rhs.chrom_index_;
+    spectra_rt_ = rhs.spectra_rt_;
+    spectra_ms_level_ = rhs.spectra_ms_level_;
+    format_version_ = rhs.format_version_;
+    first_encoding_ = rhs.first_encoding_;
+    intensity_encoding_ = rhs.intensity_encoding_;
 
     return *this;
   }
 
+  void CachedmzML::setFormatVersion(int version)
+  {
+    if (version != 1 && version != 2)
+    {
+      throw Exception::InvalidValue(__FILE__, __LINE__, __PRETTY_FUNCTION__,
+        "Only versions 1 and 2 of the cached mzML format are supported.", String(version));
+    }
+    format_version_ = version;
+  }
+
+  int CachedmzML::getFormatVersion() const
+  {
+    return format_version_;
+  }
+
+  void CachedmzML::setDataEncoding(BinaryDataEncoding first_encoding, BinaryDataEncoding intensity_encoding)
+  {
+    first_encoding_ = first_encoding;
+    intensity_encoding_ = intensity_encoding;
+  }
+
+  CachedmzML::BinaryDataEncoding CachedmzML::getFirstDataEncoding() const
+  {
+    return first_encoding_;
+  }
+
+  CachedmzML::BinaryDataEncoding CachedmzML::getIntensityDataEncoding() const
+  {
+    return intensity_encoding_;
+  }
+
   void CachedmzML::writeMemdump(MapType& exp, String out)
   {
     std::ofstream ofs(out.c_str(), std::ios::binary);
     Size exp_size = exp.size();
     Size chrom_size = exp.getChromatograms().size();
-    int file_identifier = CACHED_MZML_FILE_IDENTIFIER;
-    ofs.write((char*)&file_identifier, sizeof(file_identifier));
+    writeHeader_(ofs);
 
     startProgress(0, exp.size() + exp.getChromatograms().size(), "storing binary data");
     for (Size i = 0; i < exp.size(); i++)
@@ -77,8 +130,7 @@ namespace OpenMS
       writeChromatogram_(exp.getChromatograms()[i], ofs);
     }
 
-    ofs.write((char*)&exp_size, sizeof(exp_size));
-    ofs.write((char*)&chrom_size, sizeof(chrom_size));
+    writeFooter_(ofs, exp_size, chrom_size);
     ofs.close();
     endProgress();
   }
@@ -95,27 +147,46 @@ namespace OpenMS
     Peak1D current_peak;
 
     int file_identifier;
+    int format_version;
     ifs.read((char*)&file_identifier, sizeof(file_identifier));
-    if (file_identifier != CACHED_MZML_FILE_IDENTIFIER)
+    if (file_identifier == CACHED_MZML_FILE_IDENTIFIER)
+    {
+      format_version = 1;
+      ifs.seekg(0, ifs.end); // set file pointer to end
+      ifs.seekg(ifs.tellg(), ifs.beg); // set file pointer to end, in forward direction
+      ifs.seekg(- static_cast<int>(sizeof(exp_size) + sizeof(chrom_size)), ifs.cur); // move two fields to the left, start reading
+      ifs.read((char*)&exp_size, sizeof(exp_size));
+      ifs.read((char*)&chrom_size, sizeof(chrom_size));
+      ifs.seekg(sizeof(file_identifier), ifs.beg); // set file pointer to beginning (after identifier), start reading
+    }
+    else if (file_identifier == CACHED_MZML_FILE_IDENTIFIER_V2)
+    {
+      format_version = 2;
+      Trailer trailer;
+      ifs.seekg(- static_cast<int>(sizeof(trailer)), ifs.end);
+      ifs.read((char*)&trailer, sizeof(trailer));
+      if (!ifs || trailer.identifier != CACHED_MZML_FILE_IDENTIFIER_V2)
+      {
+        throw Exception::ParseError(__FILE__, __LINE__, __PRETTY_FUNCTION__,
+          "Cached mzML file has no valid index (file might be truncated). Aborting!", filename);
+      }
+      exp_size = trailer.nr_spectra;
+      chrom_size = trailer.nr_chromatograms;
+      ifs.seekg(2 * sizeof(file_identifier), ifs.beg); // set file pointer to beginning (after header), start reading
+    }
+    else
     {
       throw Exception::ParseError(__FILE__, __LINE__, __PRETTY_FUNCTION__, 
         "File might not be a cached mzML file (wrong file magic number). Aborting!", filename);
     }
 
-    ifs.seekg(0, ifs.end); // set file pointer to end
-    ifs.seekg(ifs.tellg(), ifs.beg); // set file pointer to end, in forward direction
-    ifs.seekg(- static_cast<int>(sizeof(exp_size) + sizeof(chrom_size)), ifs.cur); // move two fields to the left, start reading
-    ifs.read((char*)&exp_size, sizeof(exp_size));
-    ifs.read((char*)&chrom_size, sizeof(chrom_size));
-    ifs.seekg(sizeof(file_identifier), ifs.beg); // set file pointer to beginning (after identifier), start reading
-
     exp_reading.reserve(exp_size);
     startProgress(0, exp_size + chrom_size, "reading binary data");
     for (Size i = 0; i < exp_size; i++)
     {
       setProgress(i);
       SpectrumType spectrum;
-      readSpectrum_(spectrum, ifs);
+      readSpectrum_(spectrum, ifs, format_version);
       exp_reading.addSpectrum(spectrum);
     }
     std::vector<ChromatogramType> chromatograms;
@@ -123,7 +194,7 @@ namespace OpenMS
     {
       setProgress(i);
       ChromatogramType chromatogram;
-      readChromatogram_(chromatogram, ifs);
+      readChromatogram_(chromatogram, ifs, format_version);
       chromatograms.push_back(chromatogram);
     }
     exp_reading.setChromatograms(chromatograms);
@@ -142,6 +213,16 @@ namespace OpenMS
     return chrom_index_;
   }
 
+  const std::vector<double>& CachedmzML::getSpectraRT() const
+  {
+    return spectra_rt_;
+  }
+
+  const std::vector<int>& CachedmzML::getSpectraMSLevel() const
+  {
+    return spectra_ms_level_;
+  }
+
   void CachedmzML::createMemdumpIndex(String filename)
   {
     std::ifstream ifs(filename.c_str(), std::ios::binary);
@@ -156,16 +237,72 @@ namespace OpenMS
     ifs.seekg(0, ifs.beg); // set file pointer to beginning, start reading
     spectra_index_.clear();
     chrom_index_.clear();
+    spectra_rt_.clear();
+    spectra_ms_level_.clear();
     int file_identifier;
-    int extra_offset = sizeof(dbl_field_) + sizeof(int_field_);
     int chrom_offset = 0;
 
     ifs.read((char*)&file_identifier, sizeof(file_identifier));
+    if (file_identifier == CACHED_MZML_FILE_IDENTIFIER_V2)
+    {
+      // Version 2 stores the index at the end of the file, read the trailer
+      // to find it and then read the complete index in one go.
+      Trailer trailer;
+      ifs.seekg(- static_cast<int>(sizeof(trailer)), ifs.end);
+      const UInt64 trailer_pos = static_cast<UInt64>(static_cast<std::streamoff>(ifs.tellg()));
+      ifs.read((char*)&trailer, sizeof(trailer));
+      if (!ifs || trailer.identifier != CACHED_MZML_FILE_IDENTIFIER_V2)
+      {
+        throw Exception::ParseError(__FILE__, __LINE__, __PRETTY_FUNCTION__,
+          "Cached mzML file has no valid index (file might be truncated). Aborting!", filename);
+      }
+      // the index has to fit between its offset and the trailer (checked before
+      // allocating it, each count on its own such that nothing can overflow)
+      const UInt64 max_entries = (trailer.index_offset <= trailer_pos) ?
+        (trailer_pos - trailer.index_offset) / sizeof(IndexEntry) : 0;
+      if (trailer.index_offset > trailer_pos || trailer.nr_spectra > max_entries ||
+          trailer.nr_chromatograms > max_entries - trailer.nr_spectra)
+      {
+        throw Exception::ParseError(__FILE__, __LINE__, __PRETTY_FUNCTION__,
+          "Cached mzML file has an invalid index (file might be corrupt). Aborting!", filename);
+      }
+
+      std::vector<IndexEntry> index(trailer.nr_spectra + trailer.nr_chromatograms);
+      ifs.seekg(static_cast<std::streamoff>(trailer.index_offset), ifs.beg);
+      if (!index.empty())
+      {
+        ifs.read((char*)&index[0], index.size() * sizeof(IndexEntry));
+      }
+      if (!ifs)
+      {
+        throw Exception::ParseError(__FILE__, __LINE__, __PRETTY_FUNCTION__,
+          "Could not read the index of the cached mzML file. Aborting!", filename);
+      }
+
+      spectra_index_.reserve(trailer.nr_spectra);
+      spectra_rt_.reserve(trailer.nr_spectra);
+      spectra_ms_level_.reserve(trailer.nr_spectra);
+      for (Size i = 0; i < trailer.nr_spectra; i++)
+      {
+        spectra_index_.push_back(static_cast<std::streamoff>(index[i].offset));
+        spectra_rt_.push_back(index[i].rt);
+        spectra_ms_level_.push_back(index[i].ms_level);
+      }
+      chrom_index_.reserve(trailer.nr_chromatograms);
+      for (Size i = trailer.nr_spectra; i < index.size(); i++)
+      {
+        chrom_index_.push_back(static_cast<std::streamoff>(index[i].offset));
+      }
+      format_version_ = 2;
+      return;
+    }
+
     if (file_identifier != CACHED_MZML_FILE_IDENTIFIER)
     {
       throw Exception::ParseError(__FILE__, __LINE__, __PRETTY_FUNCTION__, 
           "File might not be a cached mzML file (wrong file magic number). Aborting!", filename);
     }
+    format_version_ = 1;
 
     // For spectra and chromatograms go through file, read the size of the
     // spectrum/chromatogram and record the starting index of the element, then
@@ -186,7 +323,11 @@ namespace OpenMS
       Size spec_size;
       spectra_index_.push_back(ifs.tellg());
       ifs.read((char*)&spec_size, sizeof(spec_size));
-      ifs.seekg(extra_offset + (sizeof(DatumSingleton)) * 2 * (spec_size), ifs.cur);
+      ifs.read((char*)&int_field_, sizeof(int_field_));
+      ifs.read((char*)&dbl_field_, sizeof(dbl_field_));
+      spectra_ms_level_.push_back(int_field_);
+      spectra_rt_.push_back(dbl_field_);
+      ifs.seekg((sizeof(DatumSingleton)) * 2 * (spec_size), ifs.cur);
     }
 
     for (Size i = 0; i < chrom_size; i++)
@@ -273,14 +414,21 @@ namespace OpenMS
     }
   }
 
-  void CachedmzML::readSpectrum_(SpectrumType& spectrum, std::ifstream& ifs) const
+  void CachedmzML::readSpectrum_(SpectrumType& spectrum, std::ifstream& ifs, int format_version) const
   {
     Datavector mz_data;
     Datavector int_data;
 
     int ms_level;
     double rt;
-    readSpectrum_(mz_data, int_data, ifs, ms_level, rt);
+    if (format_version == 2)
+    {
+      readRecordV2_(mz_data, int_data, ifs, ms_level, rt, "spectrum");
+    }
+    else
+    {
+      readSpectrum_(mz_data, int_data, ifs, ms_level, rt);
+    }
     spectrum.reserve(mz_data.size());
     spectrum.setMSLevel(ms_level);
     spectrum.setRT(rt);
@@ -295,11 +443,20 @@ namespace OpenMS
 
   }
 
-  void CachedmzML::readChromatogram_(ChromatogramType& chromatogram, std::ifstream& ifs) const
+  void CachedmzML::readChromatogram_(ChromatogramType& chromatogram, std::ifstream& ifs, int format_version) const
   {
     Datavector rt_data;
     Datavector int_data;
-    readChromatogram_(rt_data, int_data, ifs);
+    if (format_version == 2)
+    {
+      int ms_level;
+      double rt;
+      readRecordV2_(rt_data, int_data, ifs, ms_level, rt, "chromatogram");
+    }
+    else
+    {
+      readChromatogram_(rt_data, int_data, ifs);
+    }
     chromatogram.reserve(rt_data.size());
 
     for (Size j = 0; j < rt_data.size(); j++)
@@ -312,8 +469,298 @@ namespace OpenMS
 
   }
 
+  bool CachedmzML::fitsArray_(UInt64 bytes, UInt64 size, UInt64 remaining_bytes)
+  {
+    // no encoding needs more than 8 bytes per value plus 8 bytes of numpress header, or less than half
+    // a byte per value; compared without multiplying the number of values, which may overflow
+    return bytes <= remaining_bytes &&
+           (bytes <= 8 || (bytes - 9) / sizeof(DatumSingleton) < size) &&
+           size / 2 <= bytes;
+  }
+
+  void CachedmzML::readRecordV2_(Datavector& data1, Datavector& data2, std::ifstream& ifs, int& ms_level, double& rt, const char* item_name)
+  {
+    RecordHeader header;
+    ifs.read((char*)&header, sizeof(header));
+    // the arrays have to be within the file (checked before allocating anything for them)
+    UInt64 remaining_bytes = 0;
+    if (ifs)
+    {
+      const std::streampos data_pos = ifs.tellg();
+      ifs.seekg(0, ifs.end);
+      remaining_bytes = static_cast<UInt64>(static_cast<std::streamoff>(ifs.tellg() - data_pos));
+      ifs.seekg(data_pos);
+    }
+    if (!ifs ||
+        header.encoding_first >= SIZE_OF_BINARYDATAENCODING ||
+        header.encoding_second >= SIZE_OF_BINARYDATAENCODING ||
+        !fitsArray_(header.bytes_first, header.size, remaining_bytes) ||
+        !fitsArray_(header.bytes_second, header.size, remaining_bytes - header.bytes_first))
+    {
+      throw Exception::ParseError(__FILE__, __LINE__, __PRETTY_FUNCTION__, 
+        String("Read an invalid ") + item_name + " header, something is wrong here. Aborting.", "filestream");
+    }
+    ms_level = header.ms_level;
+    rt = header.rt;
+
+    Size padded_first = paddedSize(header.bytes_first);
+    Size padded_second = paddedSize(header.bytes_second);
+    std::vector<char> buffer(padded_first + padded_second);
+    if (!buffer.empty())
+    {
+      ifs.read(&buffer[0], buffer.size());
+      if (!ifs)
+      {
+        throw Exception::ParseError(__FILE__, __LINE__, __PRETTY_FUNCTION__, 
+          String("Could not read ") + item_name + " data, the file might be truncated. Aborting.", "filestream");
+      }
+    }
+
+    decodeBinaryData(buffer.empty() ? 0 : &buffer[0], header.bytes_first, header.size,
+        static_cast<BinaryDataEncoding>(header.encoding_first), data1);
+    decodeBinaryData(buffer.empty() ? 0 : &buffer[padded_first], header.bytes_second, header.size,
+        static_cast<BinaryDataEncoding>(header.encoding_second), data2);
+  }
+
+  void CachedmzML::encodeBinaryData(const Datavector& in, BinaryDataEncoding& encoding, std::vector<char>& out)
+  {
+    using namespace ms::numpress;
+
+    out.clear();
+    if (in.empty()) return;
+    Size n = in.size();
+
+    if (encoding == ENCODING_NUMPRESS_LINEAR || encoding == ENCODING_NUMPRESS_SLOF || encoding == ENCODING_NUMPRESS_PIC)
+    {
+      // numpress cannot represent non-finite values, SLOF and PIC also no negative values
+      bool encodable = true;
+      for (Size i = 0; i < n && encodable; i++)
+      {
+        encodable = boost::math::isfinite(in[i]) && (encoding == ENCODING_NUMPRESS_LINEAR || in[i] >= 0.0);
+      }
+
+      if (encodable)
+      {
+        try
+        {
+          // all numpress encodings need less than 8 bytes per value plus the fixed point
+          out.resize(n * sizeof(DatumSingleton) + 8);
+          unsigned char* result = reinterpret_cast<unsigned char*>(&out[0]);
+          size_t byte_count = 0;
+          if (encoding == ENCODING_NUMPRESS_LINEAR)
+          {
+            byte_count = MSNumpress::encodeLinear(&in[0], n, result, MSNumpress::optimalLinearFixedPoint(&in[0], n));
+          }
+          else if (encoding == ENCODING_NUMPRESS_SLOF)
+          {
+            byte_count = MSNumpress::encodeSlof(&in[0], n, result, MSNumpress::optimalSlofFixedPoint(&in[0], n));
+          }
+          else
+          {
+            byte_count = MSNumpress::encodePic(&in[0], n, result);
+          }
+          out.resize(byte_count);
+          return;
+        }
+        catch (...)
+        {
+          // fall through, store the data uncompressed
+        }
+      }
+      encoding = ENCODING_FLOAT64;
+    }
+
+    if (encoding == ENCODING_FLOAT32)
+    {
+      out.resize(n * sizeof(float));
+      for (Size i = 0; i < n; i++)
+      {
+        float value = static_cast<float>(in[i]);
+        std::memcpy(&out[i * sizeof(float)], &value, sizeof(float));
+      }
+      return;
+    }
+
+    encoding = ENCODING_FLOAT64;
+    out.resize(n * sizeof(DatumSingleton));
+    std::memcpy(&out[0], &in[0], n * sizeof(DatumSingleton));
+  }
+
+  void CachedmzML::decodeBinaryData(const char* in, Size in_bytes, Size size, BinaryDataEncoding encoding, Datavector& out)
+  {
+    using namespace ms::numpress;
+
+    if (size == 0)
+    {
+      out.clear();
+      return;
+    }
+
+    if (encoding == ENCODING_FLOAT64 || encoding == ENCODING_FLOAT32)
+    {
+      Size width = (encoding == ENCODING_FLOAT64) ? sizeof(double) : sizeof(float);
+      if (in_bytes != size * width)
+      {
+        throw Exception::ParseError(__FILE__, __LINE__, __PRETTY_FUNCTION__,
+          "Size of the binary data array does not match its length. Aborting.", "binary data");
+      }
+      out.resize(size);
+      if (encoding == ENCODING_FLOAT64)
+      {
+        std::memcpy(&out[0], in, size * sizeof(double));
+      }
+      else
+      {
+        for (Size i = 0; i < size; i++)
+        {
+          float value;
+          std::memcpy(&value, in + i * sizeof(float), sizeof(float));
+          out[i] = value;
+        }
+      }
+      return;
+    }
+
+    // the numpress decoders do not know the number of values in advance, make
+    // sure they cannot write past the end of the output
+    Size capacity = std::max(size, 2 * in_bytes);
+    out.resize(capacity);
+    size_t count = 0;
+    try
+    {
+      const unsigned char* data = reinterpret_cast<const unsigned char*>(in);
+      switch (encoding)
+      {
+      case ENCODING_NUMPRESS_LINEAR:
+        count = MSNumpress::decodeLinear(data, in_bytes, &out[0]);
+        break;
+
+      case ENCODING_NUMPRESS_SLOF:
+        count = MSNumpress::decodeSlof(data, in_bytes, &out[0]);
+        break;
+
+      case ENCODING_NUMPRESS_PIC:
+        count = MSNumpress::decodePic(data, in_bytes, &out[0]);
+        break;
+
+      default:
+        break;
+      }
+    }
+    catch (...)
+    {
+      count = 0;
+    }
+
+    if (count != size)
+    {
+      throw Exception::ParseError(__FILE__, __LINE__, __PRETTY_FUNCTION__,
+        "Could not decode numpress compressed binary data array. Aborting.", "binary data");
+    }
+    out.resize(size);
+  }
+
+  void CachedmzML::writeHeader_(std::ofstream& ofs)
+  {
+    if (format_version_ == 2)
+    {
+      // identifier plus 4 bytes padding, such that all data starts 8 byte aligned
+      int header[2] = {CACHED_MZML_FILE_IDENTIFIER_V2, 0};
+      ofs.write((char*)header, sizeof(header));
+      written_spectra_index_.clear();
+      written_chrom_index_.clear();
+    }
+    else
+    {
+      int file_identifier = CACHED_MZML_FILE_IDENTIFIER;
+      ofs.write((char*)&file_identifier, sizeof(file_identifier));
+    }
+  }
+
+  void CachedmzML::writeFooter_(std::ofstream& ofs, Size nr_spectra, Size nr_chromatograms)
+  {
+    if (format_version_ == 2)
+    {
+      Trailer trailer;
+      std::memset(&trailer, 0, sizeof(trailer));
+      trailer.index_offset = static_cast<UInt64>(static_cast<std::streamoff>(ofs.tellp()));
+      trailer.nr_spectra = written_spectra_index_.size();
+      trailer.nr_chromatograms = written_chrom_index_.size();
+      trailer.identifier = CACHED_MZML_FILE_IDENTIFIER_V2;
+
+      if (!written_spectra_index_.empty())
+      {
+        ofs.write((char*)&written_spectra_index_[0], written_spectra_index_.size() * sizeof(IndexEntry));
+      }
+      if (!written_chrom_index_.empty())
+      {
+        ofs.write((char*)&written_chrom_index_[0], written_chrom_index_.size() * sizeof(IndexEntry));
+      }
+      ofs.write((char*)&trailer, sizeof(trailer));
+    }
+    else
+    {
+      ofs.write((char*)&nr_spectra, sizeof(nr_spectra));
+      ofs.write((char*)&nr_chromatograms, sizeof(nr_chromatograms));
+    }
+  }
+
+  void CachedmzML::writeRecordV2_(const Datavector& data1, const Datavector& data2, double rt, int ms_level,
+                                  std::ofstream& ofs, std::vector<IndexEntry>& index)
+  {
+    IndexEntry entry;
+    std::memset(&entry, 0, sizeof(entry));
+    entry.offset = static_cast<UInt64>(static_cast<std::streamoff>(ofs.tellp()));
+    entry.rt = rt;
+    entry.ms_level = ms_level;
+    index.push_back(entry);
+
+    BinaryDataEncoding encoding_first = first_encoding_;
+    BinaryDataEncoding encoding_second = intensity_encoding_;
+    std::vector<char> encoded_first, encoded_second;
+    encodeBinaryData(data1, encoding_first, encoded_first);
+    encodeBinaryData(data2, encoding_second, encoded_second);
+
+    RecordHeader header;
+    std::memset(&header, 0, sizeof(header));
+    header.size = data1.size();
+    header.bytes_first = encoded_first.size();
+    header.bytes_second = encoded_second.size();
+    header.rt = rt;
+    header.ms_level = ms_level;
+    header.encoding_first = static_cast<Byte>(encoding_first);
+    header.encoding_second = static_cast<Byte>(encoding_second);
+    ofs.write((char*)&header, sizeof(header));
+
+    // write both arrays, each padded to a multiple of 8 bytes
+    const char padding[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+    if (!encoded_first.empty())
+    {
+      ofs.write(&encoded_first[0], encoded_first.size());
+    }
+    ofs.write(padding, paddedSize(encoded_first.size()) - encoded_first.size());
+    if (!encoded_second.empty())
+    {
+      ofs.write(&encoded_second[0], encoded_second.size());
+    }
+    ofs.write(padding, paddedSize(encoded_second.size()) - encoded_second.size());
+  }
+
   void CachedmzML::writeSpectrum_(const SpectrumType& spectrum, std::ofstream& ofs)
   {
+    if (format_version_ == 2)
+    {
+      Datavector mz_data(spectrum.size());
+      Datavector int_data(spectrum.size());
+      for (Size j = 0; j < spectrum.size(); j++)
+      {
+        mz_data[j] = spectrum[j].getMZ();
+        int_data[j] = spectrum[j].getIntensity();
+      }
+      writeRecordV2_(mz_data, int_data, spectrum.getRT(), spectrum.getMSLevel(), ofs, written_spectra_index_);
+      return;
+    }
+
     Size exp_size = spectrum.size();
     ofs.write((char*)&exp_size, sizeof(exp_size));
     int_field_ = spectrum.getMSLevel();
@@ -342,6 +789,19 @@ namespace OpenMS
 
   void CachedmzML::writeChromatogram_(const ChromatogramType& chromatogram, std::ofstream& ofs)
   {
+    if (format_version_ == 2)
+    {
+      Datavector rt_data(chromatogram.size());
+      Datavector int_data(chromatogram.size());
+      for (Size j = 0; j < chromatogram.size(); j++)
+      {
+        rt_data[j] = chromatogram[j].getRT();
+        int_data[j] = chromatogram[j].getIntensity();
+      }
+      writeRecordV2_(rt_data, int_data, -1.0, -1, ofs, written_chrom_index_);
+      return;
+    }
+
     Size exp_size = chromatogram.size();
     ofs.write((char*)&exp_size, sizeof(exp_size));
 
@@ -364,4 +824,3 @@ namespace OpenMS
   }
 
 }
-
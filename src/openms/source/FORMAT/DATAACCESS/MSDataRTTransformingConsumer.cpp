@@ -0,0 +1,101 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2013.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: Hannes Roest $
+// $Authors: Hannes Roest $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/FORMAT/DATAACCESS/MSDataRTTransformingConsumer.h>
+
+namespace OpenMS
+{
+
+  MSDataRTTransformingConsumer::MSDataRTTransformingConsumer(const TransformationDescription & trafo,
+      Interfaces::IMSDataConsumer<> * next_consumer) :
+    MSDataTransformingConsumer(),
+    trafo_(trafo),
+    next_consumer_(next_consumer)
+  {
+  }
+
+  MSDataRTTransformingConsumer::~MSDataRTTransformingConsumer()
+  {
+  }
+
+  void MSDataRTTransformingConsumer::setExpectedSize(Size expectedSpectra, Size expectedChromatograms)
+  {
+    if (next_consumer_ != 0)
+    {
+      next_consumer_->setExpectedSize(expectedSpectra, expectedChromatograms);
+    }
+  }
+
+  void MSDataRTTransformingConsumer::setExperimentalSettings(const ExperimentalSettings & exp)
+  {
+    if (next_consumer_ != 0)
+    {
+      next_consumer_->setExperimentalSettings(exp);
+    }
+  }
+
+  void MSDataRTTransformingConsumer::consumeSpectrum(SpectrumType & s)
+  {
+    s.setRT(trafo_.apply(s.getRT()));
+    MSDataTransformingConsumer::consumeSpectrum(s);
+    if (next_consumer_ != 0)
+    {
+      next_consumer_->consumeSpectrum(s);
+    }
+  }
+
+  void MSDataRTTransformingConsumer::consumeChromatogram(ChromatogramType & c)
+  {
+    rts_.resize(c.size());
+    for (Size i = 0; i < c.size(); ++i)
+    {
+      rts_[i] = c[i].getRT();
+    }
+    if (!rts_.empty())
+    {
+      trafo_.apply(&rts_[0], &rts_[0], rts_.size());
+    }
+    for (Size i = 0; i < c.size(); ++i)
+    {
+      c[i].setRT(rts_[i]);
+    }
+
+    MSDataTransformingConsumer::consumeChromatogram(c);
+    if (next_consumer_ != 0)
+    {
+      next_consumer_->consumeChromatogram(c);
+    }
+  }
+
+} // namespace OpenMS
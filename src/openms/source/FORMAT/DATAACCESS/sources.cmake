@@ -5,6 +5,7 @@ set(directory source/FORMAT/DATAACCESS)
 set(sources_list
   MSDataWritingConsumer.cpp
   MSDataTransformingConsumer.cpp
+  MSDataRTTransformingConsumer.cpp
   MSDataCachedConsumer.cpp
   NoopMSDataConsumer.cpp
   SwathFileConsumer.cpp
@@ -50,24 +50,63 @@ using namespace std;
 
 namespace OpenMS
 {
-  FASTAFile::FASTAFile()
+  typedef seqan::RecordReader<std::fstream, seqan::SinglePass<> > FASTARecordReader;
+
+  FASTAFile::FASTAFile() :
+    infile_(),
+    filename_(),
+    reader_(0),
+    entries_read_(0),
+    last_identifier_(),
+    size_read_(0)
   {
 
   }
 
-  FASTAFile::~FASTAFile()
+  FASTAFile::FASTAFile(const FASTAFile& /* source */) :
+    infile_(),
+    filename_(),
+    reader_(0),
+    entries_read_(0),
+    last_identifier_(),
+    size_read_(0)
   {
 
   }
 
-  void FASTAFile::load(const String& filename, vector<FASTAEntry>& data)
+  FASTAFile& FASTAFile::operator=(const FASTAFile& source)
   {
-    String temp = "";
-    string::size_type position = String::npos;
-    Size size_read(0);
+    if (&source != this)
+    {
+      readEnd_();
+    }
+    return *this;
+  }
 
+  FASTAFile::~FASTAFile()
+  {
+    readEnd_();
+  }
+
+  void FASTAFile::load(const String& filename, vector<FASTAEntry>& data)
+  {
     data.clear();
 
+    readStart(filename);
+
+    FASTAEntry entry;
+    while (readNext(entry))
+    {
+      data.push_back(entry);
+    }
+
+    return;
+  }
+
+  void FASTAFile::readStart(const String& filename)
+  {
+    readEnd_();
+
     if (!File::exists(filename))
     {
       throw Exception::FileNotFound(__FILE__, __LINE__, __PRETTY_FUNCTION__, filename);
@@ -78,53 +117,94 @@ namespace OpenMS
       throw Exception::FileNotReadable(__FILE__, __LINE__, __PRETTY_FUNCTION__, filename);
     }
 
+    infile_.clear();
+    infile_.open(filename.c_str(), std::ios::binary | std::ios::in);
+    reader_ = new FASTARecordReader(infile_);
+    filename_ = filename;
+    entries_read_ = 0;
+    last_identifier_ = "";
+    size_read_ = 0;
+  }
 
-    std::fstream in(filename.c_str(), std::ios::binary | std::ios::in);
-    seqan::RecordReader<std::fstream, seqan::SinglePass<> > reader(in);
+  bool FASTAFile::readNext(FASTAEntry& protein)
+  {
+    if (reader_ == 0)
+    {
+      return false;
+    }
+    FASTARecordReader& reader = *static_cast<FASTARecordReader*>(reader_);
 
-    String id, seq;
+    if (atEnd(reader))
+    {
+      // same check as for a whole file: an unread, non-empty file is suspicious
+      if (size_read_ > 0 && entries_read_ == 0)
+        LOG_WARN << "No entries from FASTA file read. Does the file have MacOS "
+                 << "line endings? Convert to Unix or Windows line endings to"
+                 << " fix!" << std::endl;
+      readEnd_();
+      return false;
+    }
 
-    while (!atEnd(reader))
+    String id, seq;
+    if (readRecord(id, seq, reader, seqan::Fasta()) != 0)
     {
-      if (readRecord(id, seq, reader, seqan::Fasta()) != 0)
-      {
-        String msg;
-        if (data.empty()) msg = "The first entry could not be read!";
-        else msg = "The last successfull FASTA record was: '>" + data.back().identifier + "'. The record after failed.";
-        throw Exception::ParseError(__FILE__, __LINE__, __PRETTY_FUNCTION__, "", "Error while parsing FASTA file '" + filename + "'! " + msg +  " Please check the file!");
-      }
+      String msg;
+      if (entries_read_ == 0) msg = "The first entry could not be read!";
+      else msg = "The last successfull FASTA record was: '>" + last_identifier_ + "'. The record after failed.";
+      const String filename = filename_;
+      readEnd_();
+      throw Exception::ParseError(__FILE__, __LINE__, __PRETTY_FUNCTION__, "", "Error while parsing FASTA file '" + filename + "'! " + msg +  " Please check the file!");
+    }
 
-      FASTAEntry newEntry;
-      newEntry.sequence = seq;
-      newEntry.sequence.removeWhitespaces();
+    protein.sequence = seq;
+    protein.sequence.removeWhitespaces();
 
-      // handle id
-      id = id.trim();
-      position = id.find_first_of(" \v\t");
-      if (position == String::npos)
-      {
-        newEntry.identifier = id;
-        newEntry.description = "";
-      }
-      else
-      {
-        newEntry.identifier = id.substr(0, position);
-        newEntry.description = id.suffix(id.size() - position - 1);
-      }
-      id.clear();
-      seq.clear();
-      data.push_back(newEntry);
-      size_read += newEntry.sequence.length();
+    // handle id
+    id = id.trim();
+    string::size_type position = id.find_first_of(" \v\t");
+    if (position == String::npos)
+    {
+      protein.identifier = id;
+      protein.description = "";
+    }
+    else
+    {
+      protein.identifier = id.substr(0, position);
+      protein.description = id.suffix(id.size() - position - 1);
     }
 
-    in.close();
+    last_identifier_ = protein.identifier;
+    ++entries_read_;
+    size_read_ += protein.sequence.length();
+    return true;
+  }
 
-    if (size_read > 0 && data.empty())
-      LOG_WARN << "No entries from FASTA file read. Does the file have MacOS "
-               << "line endings? Convert to Unix or Windows line endings to"
-               << " fix!" << std::endl;
+  bool FASTAFile::readNextChunk(vector<FASTAEntry>& chunk, Size max_entries)
+  {
+    chunk.resize(max_entries);
+    Size count(0);
+    while (count < max_entries && readNext(chunk[count]))
+    {
+      ++count;
+    }
+    chunk.resize(count);
+    return count > 0;
+  }
 
-    return;
+  Size FASTAFile::entriesRead() const
+  {
+    return entries_read_;
+  }
+
+  void FASTAFile::readEnd_()
+  {
+    delete static_cast<FASTARecordReader*>(reader_);
+    reader_ = 0;
+    if (infile_.is_open())
+    {
+      infile_.close();
+    }
+    // the counters stay valid until the next readStart()
   }
 
   void FASTAFile::store(const String& filename, const vector<FASTAEntry>& data) const
@@ -60,6 +60,27 @@ namespace OpenMS
     else parsing_success_ = false;
   }
 
+  void IndexedMzMLFile::readText_(std::streampos startidx, std::streampos endidx, std::string& text)
+  {
+    std::streampos readl = endidx - startidx;
+    text.resize(readl);
+    if (text.empty()) return;
+
+    // only the file access itself needs to be serialized, parsing and
+    // decoding of the text is done concurrently by the callers
+    std::streamsize bytes_read = 0;
+#ifdef _OPENMP
+#pragma omp critical (IndexedMzMLFile_filestream)
+#endif
+    {
+      filestream_.clear();
+      filestream_.seekg(startidx, filestream_.beg);
+      filestream_.read(&text[0], readl);
+      bytes_read = filestream_.gcount();
+    }
+    text.resize(bytes_read);
+  }
+
   IndexedMzMLFile::IndexedMzMLFile(String filename) 
   {
     openFile(filename);
@@ -144,13 +165,8 @@ namespace OpenMS
       endidx = spectra_offsets_[spectrumToGet + 1].second;
     }
 
-    std::streampos readl = endidx - startidx;
-    char* buffer = new char[readl + std::streampos(1)];
-    filestream_.seekg(startidx, filestream_.beg);
-    filestream_.read(buffer, readl);
-    buffer[readl] = '\0';
-    std::string text(buffer);
-    delete[] buffer;
+    std::string text;
+    readText_(startidx, endidx, text);
 
 #ifdef DEBUG_READER
     // print the full text we just read
@@ -205,13 +221,8 @@ namespace OpenMS
       endidx = chromatograms_offsets_[chromToGet + 1].second;
     }
 
-    std::streampos readl = endidx - startidx;
-    char* buffer = new char[readl + std::streampos(1)];
-    filestream_.seekg(startidx, filestream_.beg);
-    filestream_.read(buffer, readl);
-    buffer[readl] = '\0';
-    std::string text(buffer);
-    delete[] buffer;
+    std::string text;
+    readText_(startidx, endidx, text);
 
 #ifdef DEBUG_READER
     // print the full text we just read
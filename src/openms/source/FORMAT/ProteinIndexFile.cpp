@@ -0,0 +1,327 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2013.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: Chris Bielow $
+// $Authors: Chris Bielow $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/FORMAT/ProteinIndexFile.h>
+#include <OpenMS/FORMAT/FASTAFile.h>
+#include <OpenMS/SYSTEM/File.h>
+
+#include <QtCore/QDateTime>
+#include <QtCore/QFileInfo>
+
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+using namespace std;
+
+namespace OpenMS
+{
+  namespace
+  {
+    const char PROTEIN_INDEX_IDENTIFIER[8] = {'O', 'M', 'S', 'P', 'I', 'D', 'X', '\0'};
+    const UInt PROTEIN_INDEX_VERSION = 1;
+
+    /// writes zeros up to the next multiple of 8 bytes and returns the new position
+    UInt64 align8(ofstream& out, UInt64 pos)
+    {
+      static const char zeros[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+      const UInt64 padding = (8 - pos % 8) % 8;
+      out.write(zeros, padding);
+      return pos + padding;
+    }
+  }
+
+  ProteinIndexFile::ProteinIndexFile() :
+    filename_(),
+    data_(0),
+    data_size_(0)
+  {
+    std::memset(&header_, 0, sizeof(header_));
+  }
+
+  ProteinIndexFile::~ProteinIndexFile()
+  {
+    // the region needs to be unmapped before the file mapping is closed
+    region_.reset();
+    file_mapping_.reset();
+  }
+
+  void ProteinIndexFile::fingerprint_(const String& fasta_file, UInt64& size, Int64& time)
+  {
+    QFileInfo fi(fasta_file.toQString());
+    size = fi.size();
+    time = fi.lastModified().toTime_t();
+  }
+
+  void ProteinIndexFile::store(const String& filename, const String& fasta_file, UInt flag)
+  {
+    Header header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.identifier, PROTEIN_INDEX_IDENTIFIER, sizeof(header.identifier));
+    header.version = PROTEIN_INDEX_VERSION;
+    header.flag = flag;
+
+    // start reading before writing anything (throws if the FASTA file is missing)
+    FASTAFile fasta;
+    fasta.readStart(fasta_file);
+    fingerprint_(fasta_file, header.fasta_size, header.fasta_time);
+
+    // concurrent readers must never see a partially written index
+    const String tmp_filename = filename + "." + File::getUniqueName() + ".tmp";
+    ofstream out(tmp_filename.c_str(), ios::out | ios::binary | ios::trunc);
+    if (!out.good())
+    {
+      throw Exception::UnableToCreateFile(__FILE__, __LINE__, __PRETTY_FUNCTION__, tmp_filename);
+    }
+
+    // the header is rewritten once all positions are known
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    UInt64 pos = sizeof(header);
+
+    // sequences are written while streaming, accessions are collected
+    header.sequence_pos = pos;
+    vector<UInt64> sequence_offsets(1, 0);
+    vector<String> accessions;
+    vector<FASTAFile::FASTAEntry> chunk;
+    try
+    {
+      while (fasta.readNextChunk(chunk, 10000))
+      {
+        for (Size i = 0; i < chunk.size(); ++i)
+        {
+          const String& seq = chunk[i].sequence.remove('*');
+          out.write(seq.c_str(), seq.size());
+          sequence_offsets.push_back(sequence_offsets.back() + seq.size());
+          accessions.push_back(chunk[i].identifier);
+        }
+      }
+    }
+    catch (Exception::BaseException&)
+    {
+      out.close();
+      File::remove(tmp_filename);
+      throw;
+    }
+    pos += sequence_offsets.back();
+    header.protein_count = accessions.size();
+
+    header.accession_pos = pos;
+    vector<UInt64> accession_offsets(1, 0);
+    for (Size i = 0; i < accessions.size(); ++i)
+    {
+      out.write(accessions[i].c_str(), accessions[i].size());
+      accession_offsets.push_back(accession_offsets.back() + accessions[i].size());
+    }
+    pos += accession_offsets.back();
+
+    header.offset_pos = align8(out, pos);
+    out.write(reinterpret_cast<const char*>(&sequence_offsets[0]), sequence_offsets.size() * sizeof(UInt64));
+    out.write(reinterpret_cast<const char*>(&accession_offsets[0]), accession_offsets.size() * sizeof(UInt64));
+
+    out.seekp(0);
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.close();
+    if (!out)
+    {
+      File::remove(tmp_filename);
+      throw Exception::UnableToCreateFile(__FILE__, __LINE__, __PRETTY_FUNCTION__, tmp_filename);
+    }
+
+    // rename() replaces an existing index atomically on POSIX systems, elsewhere the old index has to go first
+    if (std::rename(tmp_filename.c_str(), filename.c_str()) != 0)
+    {
+      File::remove(filename);
+      if (std::rename(tmp_filename.c_str(), filename.c_str()) != 0)
+      {
+        File::remove(tmp_filename);
+        throw Exception::UnableToCreateFile(__FILE__, __LINE__, __PRETTY_FUNCTION__, filename);
+      }
+    }
+  }
+
+  void ProteinIndexFile::unload_()
+  {
+    // the region needs to be unmapped before the file mapping is closed
+    region_.reset();
+    file_mapping_.reset();
+    data_ = 0;
+    data_size_ = 0;
+    std::memset(&header_, 0, sizeof(header_));
+  }
+
+  void ProteinIndexFile::load(const String& filename)
+  {
+    unload_();
+    filename_ = filename;
+
+    // map the complete index read-only into memory
+    try
+    {
+      file_mapping_ = boost::shared_ptr<boost::interprocess::file_mapping>(
+        new boost::interprocess::file_mapping(filename_.c_str(), boost::interprocess::read_only));
+      region_ = boost::shared_ptr<boost::interprocess::mapped_region>(
+        new boost::interprocess::mapped_region(*file_mapping_, boost::interprocess::read_only));
+    }
+    catch (boost::interprocess::interprocess_exception& /* e */)
+    {
+      throw Exception::FileNotFound(__FILE__, __LINE__, __PRETTY_FUNCTION__, filename_);
+    }
+    data_ = static_cast<const char*>(region_->get_address());
+    data_size_ = region_->get_size();
+
+    // an invalid file leaves no index loaded
+    if (data_size_ < sizeof(header_))
+    {
+      unload_();
+      throw Exception::ParseError(__FILE__, __LINE__, __PRETTY_FUNCTION__, filename_,
+          "File is too small to be a protein index. Aborting!");
+    }
+    std::memcpy(&header_, data_, sizeof(header_));
+    if (std::memcmp(header_.identifier, PROTEIN_INDEX_IDENTIFIER, sizeof(header_.identifier)) != 0 ||
+        header_.version != PROTEIN_INDEX_VERSION)
+    {
+      unload_();
+      throw Exception::ParseError(__FILE__, __LINE__, __PRETTY_FUNCTION__, filename_,
+          "File is not a protein index of version " + String(PROTEIN_INDEX_VERSION) + ". Aborting!");
+    }
+    // the blocks have to follow each other and both offset tables (16 bytes per protein) have to be
+    // within the mapping; the count is checked first, such that the table size cannot overflow
+    bool valid = header_.protein_count <= data_size_ / (2 * sizeof(UInt64)) &&
+                 header_.sequence_pos >= sizeof(header_) && header_.sequence_pos <= header_.accession_pos &&
+                 header_.accession_pos <= header_.offset_pos && header_.offset_pos <= data_size_ &&
+                 header_.offset_pos % sizeof(UInt64) == 0;
+    const UInt64 table_bytes = (header_.protein_count + 1) * sizeof(UInt64);
+    valid = valid && 2 * table_bytes <= data_size_ - header_.offset_pos;
+    // all offsets have to start at 0, increase monotonically and stay within their block,
+    // otherwise getSequence()/getAccession() would read outside of the mapping
+    if (valid)
+    {
+      const UInt64 sequence_bytes = header_.accession_pos - header_.sequence_pos;
+      const UInt64 accession_bytes = header_.offset_pos - header_.accession_pos;
+      UInt64 sequence_end = offset_(header_.offset_pos, 0);
+      UInt64 accession_end = offset_(header_.offset_pos + table_bytes, 0);
+      valid = sequence_end == 0 && accession_end == 0;
+      for (Size i = 1; valid && i <= header_.protein_count; ++i)
+      {
+        const UInt64 sequence_next = offset_(header_.offset_pos, i);
+        const UInt64 accession_next = offset_(header_.offset_pos + table_bytes, i);
+        valid = sequence_next >= sequence_end && sequence_next <= sequence_bytes &&
+                accession_next >= accession_end && accession_next <= accession_bytes;
+        sequence_end = sequence_next;
+        accession_end = accession_next;
+      }
+    }
+    if (!valid)
+    {
+      unload_();
+      throw Exception::ParseError(__FILE__, __LINE__, __PRETTY_FUNCTION__, filename_,
+          "Protein index has no valid offset tables (file might be truncated or corrupt). Aborting!");
+    }
+
+    // sequences and accessions are accessed in database order
+    region_->advise(boost::interprocess::mapped_region::advice_sequential);
+  }
+
+  bool ProteinIndexFile::isUpToDate(const String& fasta_file, UInt flag) const
+  {
+    if (data_ == 0 || header_.flag != flag || !File::exists(fasta_file))
+    {
+      return false;
+    }
+    UInt64 size;
+    Int64 time;
+    fingerprint_(fasta_file, size, time);
+    return size == header_.fasta_size && time == header_.fasta_time;
+  }
+
+  String ProteinIndexFile::getStamp() const
+  {
+    if (data_ == 0)
+    {
+      return "";
+    }
+    return String(header_.fasta_size) + "_" + String(header_.fasta_time) + "_" + String(header_.flag);
+  }
+
+  Size ProteinIndexFile::size() const
+  {
+    return header_.protein_count;
+  }
+
+  UInt ProteinIndexFile::getFlag() const
+  {
+    return header_.flag;
+  }
+
+  UInt64 ProteinIndexFile::offset_(UInt64 table_pos, Size index) const
+  {
+    // the table is 8 byte aligned inside the page aligned mapping
+    return reinterpret_cast<const UInt64*>(data_ + table_pos)[index];
+  }
+
+  String ProteinIndexFile::getAccession(Size index) const
+  {
+    if (index >= size())
+    {
+      throw Exception::IndexOverflow(__FILE__, __LINE__, __PRETTY_FUNCTION__, index, size());
+    }
+    const UInt64 table_pos = header_.offset_pos + (header_.protein_count + 1) * sizeof(UInt64);
+    const UInt64 begin = offset_(table_pos, index);
+    const UInt64 end = offset_(table_pos, index + 1);
+    return String(std::string(data_ + header_.accession_pos + begin, end - begin));
+  }
+
+  const char* ProteinIndexFile::getSequence(Size index, Size& length) const
+  {
+    if (index >= size())
+    {
+      throw Exception::IndexOverflow(__FILE__, __LINE__, __PRETTY_FUNCTION__, index, size());
+    }
+    const UInt64 begin = offset_(header_.offset_pos, index);
+    length = offset_(header_.offset_pos, index + 1) - begin;
+    return data_ + header_.sequence_pos + begin;
+  }
+
+  String ProteinIndexFile::getSequence(Size index) const
+  {
+    Size length;
+    const char* sequence = getSequence(index, length);
+    return String(std::string(sequence, length));
+  }
+
+} // namespace OpenMS
@@ -44,6 +44,7 @@
 #include <xercesc/sax2/XMLReaderFactory.hpp>
 #include <fstream>
 #include <iomanip> // setprecision etc.
+#include <vector>
 
 using namespace std;
 
@@ -171,8 +172,14 @@ private:
 
     void XMLFile::save_(const String & filename, XMLHandler * handler) const
     {
+      // use a large output buffer, handlers write many small pieces
+      // (the buffer has to be set before the file is opened)
+      std::vector<char> buffer(1 << 20);
+      std::ofstream os;
+      os.rdbuf()->pubsetbuf(&buffer[0], buffer.size());
+
       // open file in binary mode to avoid any line ending conversions
-      std::ofstream os(filename.c_str(), std::ios::out | std::ios::binary);
+      os.open(filename.c_str(), std::ios::out | std::ios::binary);
 
       //set high precision for writing of floating point numbers
       os.precision(writtenDigits(double()));
@@ -54,6 +54,7 @@ PepNovoInfile.cpp
 PepNovoOutfile.cpp
 PepXMLFile.cpp
 PepXMLFileMascot.cpp
+ProteinIndexFile.cpp
 ProtXMLFile.cpp
 SequestInfile.cpp
 SequestOutfile.cpp
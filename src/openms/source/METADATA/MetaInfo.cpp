@@ -34,11 +34,27 @@
 
 #include <OpenMS/METADATA/MetaInfo.h>
 
+#include <algorithm>
+
 using namespace std;
 
 namespace OpenMS
 {
 
+  namespace
+  {
+    typedef vector<pair<UInt, DataValue> > ValueVector;
+
+    // compares a stored value to an index (for binary search)
+    struct IndexLess
+    {
+      bool operator()(const pair<UInt, DataValue> & value, UInt index) const
+      {
+        return value.first < index;
+      }
+    };
+  }
+
   MetaInfoRegistry MetaInfo::registry_ = MetaInfoRegistry();
 
   MetaInfo::MetaInfo()
@@ -78,18 +94,13 @@ namespace OpenMS
 
   const DataValue & MetaInfo::getValue(const String & name) const
   {
-    map<UInt, DataValue>::const_iterator it = index_to_value_.find(registry_.getIndex(name));
-    if (it != index_to_value_.end())
-    {
-      return it->second;
-    }
-    return DataValue::EMPTY;
+    return getValue(registry_.getIndex(name));
   }
 
   const DataValue & MetaInfo::getValue(UInt index) const
   {
-    map<UInt, DataValue>::const_iterator it = index_to_value_.find(index);
-    if (it != index_to_value_.end())
+    ValueVector::const_iterator it = std::lower_bound(index_to_value_.begin(), index_to_value_.end(), index, IndexLess());
+    if (it != index_to_value_.end() && it->first == index)
     {
       return it->second;
     }
@@ -98,12 +109,30 @@ namespace OpenMS
 
   void MetaInfo::setValue(const String & name, const DataValue & value)
   {
-    index_to_value_[registry_.getIndex(name)] = value;
+    setValue(registry_.getIndex(name), value);
   }
 
   void MetaInfo::setValue(UInt index, const DataValue & value)
   {
-    index_to_value_[index] = value;
+    ValueVector::iterator it = std::lower_bound(index_to_value_.begin(), index_to_value_.end(), index, IndexLess());
+    if (it != index_to_value_.end() && it->first == index)
+    {
+      it->second = value;
+    }
+    else if (index_to_value_.size() < index_to_value_.capacity() || index_to_value_.size() >= 16)
+    {
+      index_to_value_.insert(it, std::make_pair(index, value));
+    }
+    else
+    {
+      // grow by a single element: most objects only carry a few meta values
+      ValueVector tmp;
+      tmp.reserve(index_to_value_.size() + 1);
+      tmp.insert(tmp.end(), index_to_value_.begin(), it);
+      tmp.push_back(std::make_pair(index, value));
+      tmp.insert(tmp.end(), it, index_to_value_.end());
+      index_to_value_.swap(tmp);
+    }
   }
 
   MetaInfoRegistry & MetaInfo::registry()
@@ -115,40 +144,29 @@ namespace OpenMS
   {
     try
     {
-      if (index_to_value_.find(registry_.getIndex(name)) == index_to_value_.end())
-      {
-        return false;
-      }
+      return exists(registry_.getIndex(name));
     }
     catch (Exception::InvalidValue)
     {
       return false;
     }
-    return true;
   }
 
   bool MetaInfo::exists(UInt index) const
   {
-    if (index_to_value_.find(index) == index_to_value_.end())
-    {
-      return false;
-    }
-    return true;
+    ValueVector::const_iterator it = std::lower_bound(index_to_value_.begin(), index_to_value_.end(), index, IndexLess());
+    return it != index_to_value_.end() && it->first == index;
   }
 
   void MetaInfo::removeValue(const String & name)
   {
-    map<UInt, DataValue>::iterator it = index_to_value_.find(registry_.getIndex(name));
-    if (it != index_to_value_.end())
-    {
-      index_to_value_.erase(it);
-    }
+    removeValue(registry_.getIndex(name));
   }
 
   void MetaInfo::removeValue(UInt index)
   {
-    map<UInt, DataValue>::iterator it = index_to_value_.find(index);
-    if (it != index_to_value_.end())
+    ValueVector::iterator it = std::lower_bound(index_to_value_.begin(), index_to_value_.end(), index, IndexLess());
+    if (it != index_to_value_.end() && it->first == index)
     {
       index_to_value_.erase(it);
     }
@@ -157,20 +175,18 @@ namespace OpenMS
   void MetaInfo::getKeys(vector<String> & keys) const
   {
     keys.resize(index_to_value_.size());
-    UInt i = 0;
-    for (map<UInt, DataValue>::const_iterator it = index_to_value_.begin(); it != index_to_value_.end(); ++it)
+    for (Size i = 0; i < index_to_value_.size(); ++i)
     {
-      keys[i++] = registry_.getName(it->first);
+      keys[i] = registry_.getName(index_to_value_[i].first);
     }
   }
 
   void MetaInfo::getKeys(vector<UInt> & keys) const
   {
     keys.resize(index_to_value_.size());
-    UInt i = 0;
-    for (map<UInt, DataValue>::const_iterator it = index_to_value_.begin(); it != index_to_value_.end(); ++it)
+    for (Size i = 0; i < index_to_value_.size(); ++i)
     {
-      keys[i++] = it->first;
+      keys[i] = index_to_value_[i].first;
     }
   }
 
@@ -181,7 +197,7 @@ namespace OpenMS
 
   void MetaInfo::clear()
   {
-    index_to_value_.clear();
+    ValueVector().swap(index_to_value_);
   }
 
 } //namespace
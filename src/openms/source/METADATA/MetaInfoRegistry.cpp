@@ -45,69 +45,58 @@ namespace OpenMS
     next_index_(1024), name_to_index_(), index_to_name_(), index_to_description_(), index_to_unit_()
   {
     name_to_index_["isotopic_range"] = 1;
-    index_to_name_[1] = "isotopic_range";
     index_to_description_[1] = "consecutive numbering of the peaks in an isotope pattern. 0 is the monoisotopic peak";
     index_to_unit_[1] = "";
 
     name_to_index_["cluster_id"] = 2;
-    index_to_name_[2] = "cluster_id";
     index_to_description_[2] = "consecutive numbering of isotope clusters in a spectrum";
     index_to_unit_[2] = "";
 
     name_to_index_["label"] = 3;
-    index_to_name_[3] = "label";
     index_to_description_[3] = "label e.g. shown in visialization";
     index_to_unit_[3] = "";
 
     name_to_index_["icon"] = 4;
-    index_to_name_[4] = "icon";
     index_to_description_[4] = "icon shown in visialization";
     index_to_unit_[4] = "";
 
     name_to_index_["color"] = 5;
-    index_to_name_[5] = "color";
     index_to_description_[5] = "color used for visialization e.g. #FF00FF for purple";
     index_to_unit_[5] = "";
 
     name_to_index_["RT"] = 6;
-    index_to_name_[6] = "RT";
     index_to_description_[6] = "the retention time of an identification";
     index_to_unit_[6] = "";
 
     name_to_index_["MZ"] = 7;
-    index_to_name_[7] = "MZ";
     index_to_description_[7] = "the MZ of an identification";
     index_to_unit_[7] = "";
 
     name_to_index_["predicted_RT"] = 8;
-    index_to_name_[8] = "predicted_RT";
     index_to_description_[8] = "the predicted retention time of a peptide hit";
     index_to_unit_[8] = "";
 
     name_to_index_["predicted_RT_p_value"] = 9;
-    index_to_name_[9] = "predicted_RT_p_value";
     index_to_description_[9] = "the predicted RT p-value of a peptide hit";
     index_to_unit_[9] = "";
 
     name_to_index_["spectrum_reference"] = 10;
-    index_to_name_[10] = "spectrum_reference";
     index_to_description_[10] = "Refenference to a spectrum or feature number";
     index_to_unit_[10] = "";
 
     name_to_index_["ID"] = 11;
-    index_to_name_[11] = "ID";
     index_to_description_[11] = "Some type of identifier";
     index_to_unit_[11] = "";
 
     name_to_index_["low_quality"] = 12;
-    index_to_name_[12] = "low_quality";
     index_to_description_[12] = "Flag which indicatest that some entity has a low quality (e.g. a feature pair)";
     index_to_unit_[12] = "";
 
     name_to_index_["charge"] = 13;
-    index_to_name_[13] = "charge";
     index_to_description_[13] = "Charge of a feature or peak";
     index_to_unit_[13] = "";
+
+    rebuildIndexToName_();
   }
 
   MetaInfoRegistry::MetaInfoRegistry(const MetaInfoRegistry & rhs)
@@ -117,7 +106,6 @@ namespace OpenMS
 
   MetaInfoRegistry::~MetaInfoRegistry()
   {
-
   }
 
   MetaInfoRegistry & MetaInfoRegistry::operator=(const MetaInfoRegistry & rhs)
@@ -129,9 +117,10 @@ namespace OpenMS
     {
       next_index_ = rhs.next_index_;
       name_to_index_ = rhs.name_to_index_;
-      index_to_name_ = rhs.index_to_name_;
       index_to_description_ = rhs.index_to_description_;
       index_to_unit_ = rhs.index_to_unit_;
+      // the table points into our own name_to_index_
+      rebuildIndexToName_();
     }
     return *this;
   }
@@ -141,14 +130,10 @@ namespace OpenMS
     UInt rv;
 #pragma omp critical (MetaInfoRegistry)
     {
-      map<String, UInt>::iterator it = name_to_index_.find(name);
+      NameMap_::iterator it = name_to_index_.find(name);
       if (it == name_to_index_.end())
       {
-        name_to_index_[name] = next_index_;
-        index_to_name_[next_index_] = name;
-        index_to_description_[next_index_] = description;
-        index_to_unit_[next_index_] = unit;
-        rv = next_index_++;
+        rv = insertName_(name, next_index_++, description, unit);
       }
       else
       {
@@ -158,12 +143,43 @@ namespace OpenMS
     return rv;
   }
 
+  UInt MetaInfoRegistry::insertName_(const String & name, UInt index, const String & description, const String & unit) const
+  {
+    NameMap_::iterator it = name_to_index_.insert(make_pair(name, index)).first;
+    index_to_description_[index] = description;
+    index_to_unit_[index] = unit;
+    if (index_to_name_.size() <= index)
+    {
+      index_to_name_.resize(index + 1, 0);
+    }
+    index_to_name_[index] = &it->first;
+    return index;
+  }
+
+  void MetaInfoRegistry::rebuildIndexToName_() const
+  {
+    index_to_name_.clear();
+    for (NameMap_::const_iterator it = name_to_index_.begin(); it != name_to_index_.end(); ++it)
+    {
+      if (index_to_name_.size() <= it->second)
+      {
+        index_to_name_.resize(it->second + 1, 0);
+      }
+      index_to_name_[it->second] = &it->first;
+    }
+  }
+
+  const String * MetaInfoRegistry::findName_(UInt index) const
+  {
+    return (index < index_to_name_.size()) ? index_to_name_[index] : 0;
+  }
+
   void MetaInfoRegistry::setDescription(UInt index, const String & description)
   {
     bool found;
 #pragma omp critical (MetaInfoRegistry)
     {
-      found = (index_to_name_.find(index) != index_to_name_.end());
+      found = (findName_(index) != 0);
       if (found)
       {
         index_to_description_[index] = description;
@@ -198,7 +214,7 @@ namespace OpenMS
     bool found;
 #pragma omp critical (MetaInfoRegistry)
     {
-      found = (index_to_name_.end() != index_to_name_.find(index));
+      found = (findName_(index) != 0);
       if (found)
       {
         index_to_unit_[index] = unit;
@@ -230,23 +246,8 @@ namespace OpenMS
 
   UInt MetaInfoRegistry::getIndex(const String & name) const
   {
-    UInt rv;
-    bool found = false;
-#pragma omp critical (MetaInfoRegistry)
-    {
-      map<String, UInt>::const_iterator it = name_to_index_.find(name);
-      if (it != name_to_index_.end())
-      {
-        rv = it->second;
-        found = true;
-      }
-    }
-    if (!found)
-    {
-      registerName(name, String::EMPTY, String::EMPTY);
-      rv = getIndex(name);
-    }
-    return rv;
+    // registers the name if it is not registered yet
+    return registerName(name, String::EMPTY, String::EMPTY);
   }
 
   String MetaInfoRegistry::getDescription(UInt index) const
@@ -315,10 +316,10 @@ namespace OpenMS
     bool found = false;
 #pragma omp critical (MetaInfoRegistry)
     {
-      map<UInt, String>::const_iterator it = index_to_name_.find(index);
-      if (it != index_to_name_.end())
+      const String * name = findName_(index);
+      if (name != 0)
       {
-        rv = it->second;
+        rv = *name;
         found = true;
       }
     }
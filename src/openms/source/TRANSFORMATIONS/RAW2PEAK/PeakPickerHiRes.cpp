@@ -34,6 +34,10 @@
 
 #include <OpenMS/TRANSFORMATIONS/RAW2PEAK/PeakPickerHiRes.h>
 
+#include <OpenMS/CONCEPT/Exception.h>
+
+#include <cmath>
+#include <limits>
 #include <vector>
 
 using namespace std;
@@ -70,6 +74,284 @@ namespace OpenMS
   {
     signal_to_noise_ = param_.getValue("signal_to_noise");
     spacing_difference_ = param_.getValue("spacing_difference");
+    snt_param_ = param_.copy("SignalToNoise:", true);
+  }
+
+  void PeakPickerHiRes::pick(const std::vector<double> & mz_array, const std::vector<double> & int_array, std::vector<double> & mz_out, std::vector<double> & int_out, std::vector<PeakBoundary> & boundaries) const
+  {
+    boundaries.clear();
+    PickBuffers_ buffers;
+    pickArrays_(mz_array, int_array, mz_out, int_out, boundaries, buffers);
+  }
+
+  void PeakPickerHiRes::pickArrays_(const std::vector<double> & mz_array, const std::vector<double> & int_array, std::vector<double> & mz_out, std::vector<double> & int_out, std::vector<PeakBoundary> & boundaries, PickBuffers_ & buffers) const
+  {
+    if (mz_array.size() != int_array.size())
+    {
+      throw Exception::IllegalArgument(__FILE__, __LINE__, __PRETTY_FUNCTION__, "m/z and intensity arrays differ in size.");
+    }
+
+    mz_out.clear();
+    int_out.clear();
+
+    // don't pick a spectrum with less than 5 data points
+    Size size = mz_array.size();
+    if (size < 5) return;
+
+    // signal-to-noise estimation
+    SignalToNoiseEstimatorMedian<MSSpectrum<Peak1D> > snt;
+    const double * snt_values = 0;
+    if (signal_to_noise_ > 0.0)
+    {
+      MSSpectrum<Peak1D> & spectrum = buffers.snt_spectrum;
+      spectrum.resize(size);
+      for (Size i = 0; i < size; ++i)
+      {
+        spectrum[i].setMZ(mz_array[i]);
+        spectrum[i].setIntensity(int_array[i]);
+      }
+      snt.setParameters(snt_param_);
+      snt.init(spectrum);
+      // no estimates (e.g. no positive intensities) means S/N = 0 everywhere, so nothing is picked
+      if (snt.getSignalToNoiseEstimates().size() != size) return;
+      snt_values = &snt.getSignalToNoiseEstimates()[0];
+    }
+
+    pickKernel_(&mz_array[0], &int_array[0], snt_values, size, mz_out, int_out, boundaries, buffers);
+  }
+
+  void PeakPickerHiRes::pickKernel_(const double * mz, const double * intensity, const double * snt, Size size, std::vector<double> & mz_out, std::vector<double> & int_out, std::vector<PeakBoundary> & boundaries, PickBuffers_ & buffers) const
+  {
+    if (size < 5) return;
+
+    const double eps = std::numeric_limits<double>::epsilon();
+
+    // flag local maxima whose neighbours are not zero-data-points (we do not
+    // interpolate then); no branches and no dependencies between iterations,
+    // so the compiler can vectorize this loop
+    std::vector<unsigned char> & is_max = buffers.is_max;
+    is_max.assign(size, 0);
+    for (Size i = 2; i < size - 2; ++i)
+    {
+      is_max[i] = (intensity[i] > intensity[i - 1])
+                  & (intensity[i] > intensity[i + 1])
+                  & (std::fabs(intensity[i - 1]) >= eps)
+                  & (std::fabs(intensity[i + 1]) >= eps);
+    }
+
+    std::vector<double> & left_mz = buffers.left_mz;
+    std::vector<double> & left_int = buffers.left_int;
+    std::vector<double> & right_mz = buffers.right_mz;
+    std::vector<double> & right_int = buffers.right_int;
+
+    for (Size i = 2; i < size - 2; ++i)
+    {
+      if (!is_max[i]) continue;
+
+      double central_peak_mz = mz[i], central_peak_int = intensity[i];
+      double left_neighbor_mz = mz[i - 1], left_neighbor_int = intensity[i - 1];
+      double right_neighbor_mz = mz[i + 1], right_neighbor_int = intensity[i + 1];
+
+      // MZ spacing sanity checks
+      double left_to_central = std::fabs(central_peak_mz - left_neighbor_mz);
+      double central_to_right = std::fabs(right_neighbor_mz - central_peak_mz);
+      double min_spacing = (left_to_central < central_to_right) ? left_to_central : central_to_right;
+
+      double act_snt = 0.0, act_snt_l1 = 0.0, act_snt_r1 = 0.0;
+
+      if (snt)
+      {
+        act_snt = snt[i];
+        act_snt_l1 = snt[i - 1];
+        act_snt_r1 = snt[i + 1];
+      }
+
+      // look for peak cores meeting MZ and SNT criteria (intensities were checked above)
+      if (act_snt >= signal_to_noise_
+         && left_to_central < spacing_difference_ * min_spacing
+         && act_snt_l1 >= signal_to_noise_
+         && central_to_right < spacing_difference_ * min_spacing
+         && act_snt_r1 >= signal_to_noise_)
+      {
+        // special case: if a peak core is surrounded by more intense
+        // satellite peaks (indicates oscillation rather than
+        // real peaks) -> remove
+
+        double act_snt_l2 = 0.0, act_snt_r2 = 0.0;
+
+        if (snt)
+        {
+          act_snt_l2 = snt[i - 2];
+          act_snt_r2 = snt[i + 2];
+        }
+
+        //checking signal-to-noise?
+        if (std::fabs(left_neighbor_mz - mz[i - 2]) < spacing_difference_ * min_spacing
+            && left_neighbor_int < intensity[i - 2]
+            && act_snt_l2 >= signal_to_noise_
+            && std::fabs(mz[i + 2] - right_neighbor_mz) < spacing_difference_ * min_spacing
+            && right_neighbor_int < intensity[i + 2]
+            && act_snt_r2 >= signal_to_noise_)
+        {
+          ++i;
+          continue;
+        }
+
+        // peak core found, now extend it; the outermost data points of the
+        // peak are always at the back of the left and right arrays (points
+        // at the same position replace each other)
+        left_mz.assign(1, left_neighbor_mz);
+        left_int.assign(1, left_neighbor_int);
+        right_mz.assign(1, right_neighbor_mz);
+        right_int.assign(1, right_neighbor_int);
+
+        // to the left
+        Size k = 2;
+
+        bool previous_zero_left(false);    // no need to extend peak if previous intensity was zero
+        Size missing_left(0);
+        Size left_boundary(i - 1);    // index of the left boundary for the spline interpolation
+
+        while (k <= i    //prevent underflow
+              && (i - k + 1) > 0
+              && (missing_left < 2)
+              && !previous_zero_left
+              && intensity[i - k] <= left_int.back())
+        {
+          double act_snt_lk = 0.0;
+
+          if (snt)
+          {
+            act_snt_lk = snt[i - k];
+          }
+
+          if (!(act_snt_lk >= signal_to_noise_ && std::fabs(mz[i - k] - left_mz.back()) < spacing_difference_ * min_spacing))
+          {
+            ++missing_left;
+          }
+
+          if (mz[i - k] == left_mz.back())
+          {
+            left_int.back() = intensity[i - k];
+          }
+          else
+          {
+            left_mz.push_back(mz[i - k]);
+            left_int.push_back(intensity[i - k]);
+          }
+
+          previous_zero_left = (intensity[i - k] == 0);
+
+          left_boundary = i - k;
+          ++k;
+        }
+
+        // to the right
+        k = 2;
+
+        bool previous_zero_right(false);    // no need to extend peak if previous intensity was zero
+        Size missing_right(0);
+        Size right_boundary(i + 1);    // index of the right boundary for the spline interpolation
+
+        while ((i + k) < size
+              && (missing_right < 2)
+              && !previous_zero_right
+              && intensity[i + k] <= right_int.back())
+        {
+          double act_snt_rk = 0.0;
+
+          if (snt)
+          {
+            act_snt_rk = snt[i + k];
+          }
+
+          if (!(act_snt_rk >= signal_to_noise_ && std::fabs(mz[i + k] - right_mz.back()) < spacing_difference_ * min_spacing))
+          {
+            ++missing_right;
+          }
+
+          if (mz[i + k] == right_mz.back())
+          {
+            right_int.back() = intensity[i + k];
+          }
+          else
+          {
+            right_mz.push_back(mz[i + k]);
+            right_int.push_back(intensity[i + k]);
+          }
+
+          previous_zero_right = (intensity[i + k] == 0);
+
+          right_boundary = i + k;
+          ++k;
+        }
+
+        //skip if the minimal number of 3 points for fitting is not reached
+        if (left_mz.size() + 1 + right_mz.size() < 4)
+          continue;
+
+        std::vector<double> & peak_mz = buffers.peak_mz;
+        std::vector<double> & peak_int = buffers.peak_int;
+        peak_mz.assign(left_mz.rbegin(), left_mz.rend());
+        peak_int.assign(left_int.rbegin(), left_int.rend());
+        peak_mz.push_back(central_peak_mz);
+        peak_int.push_back(central_peak_int);
+        peak_mz.insert(peak_mz.end(), right_mz.begin(), right_mz.end());
+        peak_int.insert(peak_int.end(), right_int.begin(), right_int.end());
+
+        CubicSpline2d peak_spline(peak_mz, peak_int);
+
+        // calculate maximum by evaluating the spline's 1st derivative
+        // (bisection method)
+        double max_peak_mz = central_peak_mz;
+        double max_peak_int = central_peak_int;
+        double threshold = 0.000001;
+        double lefthand = left_neighbor_mz;
+        double righthand = right_neighbor_mz;
+
+        bool lefthand_sign = 1;
+
+        // bisection
+        do
+        {
+          double mid = (lefthand + righthand) / 2;
+          double midpoint_deriv_val = peak_spline.derivatives(mid, 1);
+
+          // if deriv nearly zero then maximum already found
+          if (!(std::fabs(midpoint_deriv_val) > eps))
+          {
+            break;
+          }
+
+          bool midpoint_sign = (midpoint_deriv_val < 0.0) ? 0 : 1;
+
+          if (lefthand_sign ^ midpoint_sign)
+          {
+            righthand = mid;
+          }
+          else
+          {
+            lefthand = mid;
+          }
+        }
+        while (std::fabs(lefthand - righthand) > threshold);
+
+        // sanity check?
+        max_peak_mz = (lefthand + righthand) / 2;
+        max_peak_int = peak_spline.eval(max_peak_mz);
+
+        // save picked peak
+        PeakBoundary peak_boundary;
+        peak_boundary.mz_min = mz[left_boundary];
+        peak_boundary.mz_max = mz[right_boundary];
+        mz_out.push_back(max_peak_mz);
+        int_out.push_back(max_peak_int);
+        boundaries.push_back(peak_boundary);
+
+        // jump over raw data points that have been considered already
+        i = i + k - 1;
+      }
+    }
   }
 
 }
@@ -80,8 +80,8 @@ public:
     ///Type definitions
     //@{
     /// Cross Correlation array
-    typedef std::map<int, double> XCorrArrayType;
-    /// Cross Correlation matrix
+    typedef Scoring::XCorrArrayType XCorrArrayType;
+    /// Cross Correlation matrix (only the upper triangle is filled)
     typedef std::vector<std::vector<XCorrArrayType> > XCorrMatrixType;
 
     typedef std::string String;
@@ -102,7 +102,7 @@ public:
 
     /** @name Scores */
     //@{
-    /// Initialize the scoring object and building the cross-correlation matrix
+    /// Initialize the scoring object and building the cross-correlation matrix (every trace is standardized only once)
     void initializeXCorrMatrix(OpenSwath::IMRMFeature* mrmfeature, std::vector<String> native_ids);
 
     /// calculate the cross-correlation score
@@ -35,6 +35,7 @@
 #ifndef OPENMS_ANALYSIS_OPENSWATH_OPENSWATHALGO_ALGO_SCORING_H
 #define OPENMS_ANALYSIS_OPENSWATH_OPENSWATHALGO_ALGO_SCORING_H
 
+#include <algorithm>
 #include <numeric>
 #include <map>
 #include <vector>
@@ -53,8 +54,44 @@ namespace OpenSwath
   {
     /** @name Type defs */
     //@{
-    /// Cross Correlation array
-    typedef std::map<int, double> XCorrArrayType;
+    /**
+      @brief Cross Correlation array
+
+      Contains the (lag, value) pairs of a cross-correlation in contiguous
+      memory, sorted by lag.
+    */
+    struct XCorrArrayType
+    {
+      typedef std::vector<std::pair<int, double> >::iterator iterator;
+      typedef std::vector<std::pair<int, double> >::const_iterator const_iterator;
+
+      /// the (lag, value) pairs
+      std::vector<std::pair<int, double> > data;
+
+      iterator begin() {return data.begin(); }
+      const_iterator begin() const {return data.begin(); }
+      iterator end() {return data.end(); }
+      const_iterator end() const {return data.end(); }
+      std::size_t size() const {return data.size(); }
+      bool empty() const {return data.empty(); }
+
+      /// returns the entry of a lag (or end() if there is none)
+      iterator find(int lag)
+      {
+        iterator it = std::lower_bound(data.begin(), data.end(), lag, lagLess_);
+        return (it != data.end() && it->first == lag) ? it : data.end();
+      }
+
+      /// returns the entry of a lag (or end() if there is none)
+      const_iterator find(int lag) const
+      {
+        const_iterator it = std::lower_bound(data.begin(), data.end(), lag, lagLess_);
+        return (it != data.end() && it->first == lag) ? it : data.end();
+      }
+
+private:
+      static bool lagLess_(const std::pair<int, double> & entry, int lag) {return entry.first < lag; }
+    };
     //@}
 
     /** @name Helper functions */
@@ -102,7 +139,12 @@ namespace OpenSwath
     OPENSWATHALGO_DLLAPI XCorrArrayType normalizedCrossCorrelation(std::vector<double>& data1,
                                                             std::vector<double>& data2, int maxdelay, int lag);
 
-    /// Calculate crosscorrelation on std::vector data without normalization
+    /**
+      @brief Calculate crosscorrelation on std::vector data without normalization
+
+      For long data vectors with many lags, the cross-correlation is computed
+      via the fast Fourier transform (O(n log n) instead of O(n * lags)).
+    */
     OPENSWATHALGO_DLLAPI XCorrArrayType calculateCrossCorrelation(std::vector<double>& data1,
                                                       std::vector<double>& data2, int maxdelay, int lag);
 
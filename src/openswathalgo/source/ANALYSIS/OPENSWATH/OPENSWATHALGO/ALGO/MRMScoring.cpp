@@ -34,7 +34,6 @@
 
 //#define MRMSCORING_TESTING
 #include <algorithm>
-#include <algorithm>
 #include <iterator>
 #include <iostream>
 
@@ -61,23 +60,29 @@ namespace OpenSwath
 
   void MRMScoring::initializeXCorrMatrix(OpenSwath::IMRMFeature* mrmfeature, std::vector<String> native_ids)
   {
-    std::vector<double> intensityi, intensityj;
+    // get and standardize all traces once
+    std::vector<std::vector<double> > intensities(native_ids.size());
+    for (std::size_t i = 0; i < native_ids.size(); i++)
+    {
+      FeatureType fi = mrmfeature->getFeature(native_ids[i]);
+      fi->getIntensity(intensities[i]);
+      Scoring::standardize_data(intensities[i]);
+    }
+
+    // compute the normalized cross correlation of each pair (upper triangle only)
+    xcorr_matrix_.clear();
     xcorr_matrix_.resize(native_ids.size());
     for (std::size_t i = 0; i < native_ids.size(); i++)
     {
-      String native_id = native_ids[i];
-      FeatureType fi = mrmfeature->getFeature(native_id);
       xcorr_matrix_[i].resize(native_ids.size());
-      intensityi.clear();
-      fi->getIntensity(intensityi);
       for (std::size_t j = i; j < native_ids.size(); j++)
       {
-        String native_id2 = native_ids[j];
-        FeatureType fj = mrmfeature->getFeature(native_id2);
-        intensityj.clear();
-        fj->getIntensity(intensityj);
-        // compute normalized cross correlation
-        xcorr_matrix_[i][j] = Scoring::normalizedCrossCorrelation(intensityi, intensityj, boost::numeric_cast<int>(intensityi.size()), 1);
+        XCorrArrayType & xcorr = xcorr_matrix_[i][j];
+        xcorr = Scoring::calculateCrossCorrelation(intensities[i], intensities[j], boost::numeric_cast<int>(intensities[i].size()), 1);
+        for (XCorrArrayType::iterator it = xcorr.begin(); it != xcorr.end(); ++it)
+        {
+          it->second = it->second / intensities[i].size();
+        }
       }
     }
   }
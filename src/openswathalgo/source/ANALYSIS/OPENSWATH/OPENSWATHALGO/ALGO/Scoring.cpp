@@ -34,6 +34,7 @@
 
 #include "OpenMS/ANALYSIS/OPENSWATH/OPENSWATHALGO/ALGO/Scoring.h"
 #include <cmath>
+#include <complex>
 #include <boost/numeric/conversion/cast.hpp>
 
 #ifdef OPENMS_ASSERTIONS
@@ -49,6 +50,93 @@ namespace OpenSwath
   namespace Scoring
   {
 
+    namespace
+    {
+      /// In-place iterative radix-2 FFT (the size of @p a must be a power of two)
+      void fft_(std::vector<std::complex<double> > & a, bool inverse)
+      {
+        const std::size_t n = a.size();
+
+        // bit-reversal permutation
+        for (std::size_t i = 1, j = 0; i < n; ++i)
+        {
+          std::size_t bit = n >> 1;
+          for (; j & bit; bit >>= 1)
+          {
+            j ^= bit;
+          }
+          j ^= bit;
+          if (i < j)
+          {
+            std::swap(a[i], a[j]);
+          }
+        }
+
+        for (std::size_t len = 2; len <= n; len <<= 1)
+        {
+          double angle = 2 * 3.14159265358979323846 / len * (inverse ? 1 : -1);
+          std::complex<double> wlen(std::cos(angle), std::sin(angle));
+          for (std::size_t i = 0; i < n; i += len)
+          {
+            std::complex<double> w(1.0);
+            for (std::size_t k = 0; k < len / 2; ++k)
+            {
+              std::complex<double> u = a[i + k];
+              std::complex<double> v = a[i + k + len / 2] * w;
+              a[i + k] = u + v;
+              a[i + k + len / 2] = u - v;
+              w *= wlen;
+            }
+          }
+        }
+
+        if (inverse)
+        {
+          for (std::size_t i = 0; i < n; ++i)
+          {
+            a[i] /= (double)n;
+          }
+        }
+      }
+
+      /**
+        @brief Computes sum_i data1[i] * data2[i + delay] for all delays via FFT
+
+        @returns The correlation at index delay (for delay >= 0) or fft_size + delay (for delay < 0)
+      */
+      std::vector<double> fftCrossCorrelation_(const std::vector<double> & data1,
+        const std::vector<double> & data2, std::size_t fft_size)
+      {
+        // both (real) data vectors are transformed at once, as the real and
+        // the imaginary part of a single complex vector
+        std::vector<std::complex<double> > z(fft_size);
+        for (std::size_t i = 0; i < data1.size(); ++i)
+        {
+          z[i] = std::complex<double>(data1[i], data2[i]);
+        }
+        fft_(z, false);
+
+        // separate the transforms X and Y and compute conj(X) * Y
+        std::vector<std::complex<double> > prod(fft_size);
+        for (std::size_t k = 0; k < fft_size; ++k)
+        {
+          std::complex<double> zk = z[k];
+          std::complex<double> zn = std::conj(z[(fft_size - k) % fft_size]);
+          std::complex<double> x = (zk + zn) * 0.5;
+          std::complex<double> y = (zk - zn) * std::complex<double>(0.0, -0.5);
+          prod[k] = std::conj(x) * y;
+        }
+        fft_(prod, true);
+
+        std::vector<double> result(fft_size);
+        for (std::size_t k = 0; k < fft_size; ++k)
+        {
+          result[k] = prod[k].real();
+        }
+        return result;
+      }
+    }
+
     void normalize_sum(double x[], unsigned int n)
     {
       double sumx = std::accumulate(&x[0], &x[0] + n, 0.0);
@@ -152,8 +240,8 @@ namespace OpenSwath
       // normalize the data
       standardize_data(data1);
       standardize_data(data2);
-      std::map<int, double> result = calculateCrossCorrelation(data1, data2, maxdelay, lag);
-      for (std::map<int, double>::iterator it = result.begin(); it != result.end(); ++it)
+      XCorrArrayType result = calculateCrossCorrelation(data1, data2, maxdelay, lag);
+      for (XCorrArrayType::iterator it = result.begin(); it != result.end(); ++it)
       {
         it->second = it->second / data1.size();
       }
@@ -169,19 +257,44 @@ namespace OpenSwath
       int datasize = boost::numeric_cast<int>(data1.size());
       int i, j, delay;
 
-      for (delay = -maxdelay; delay <= maxdelay; delay = delay + lag)
+      result.data.reserve(2 * maxdelay / lag + 1);
+
+      // use the FFT if it is (estimated to be) cheaper than the direct computation
+      std::size_t fft_size = 1, log_fft_size = 0;
+      while (fft_size < 2 * data1.size())
       {
-        double sxy = 0;
-        for (i = 0; i < datasize; ++i)
+        fft_size <<= 1;
+        ++log_fft_size;
+      }
+      double direct_cost = (2.0 * maxdelay / lag + 1) * datasize;
+      double fft_cost = 24.0 * fft_size * log_fft_size;
+
+      if (fft_cost < direct_cost)
+      {
+        std::vector<double> xcorr = fftCrossCorrelation_(data1, data2, fft_size);
+        for (delay = -maxdelay; delay <= maxdelay; delay = delay + lag)
         {
-          j = i + delay;
-          if (j < 0 || j >= datasize)
+          double sxy = 0;
+          if (delay > -datasize && delay < datasize)
           {
-            continue;
+            sxy = xcorr[delay >= 0 ? delay : fft_size + delay];
           }
+          result.data.push_back(std::make_pair(delay, sxy));
+        }
+        return result;
+      }
+
+      for (delay = -maxdelay; delay <= maxdelay; delay = delay + lag)
+      {
+        double sxy = 0;
+        // only the range where both i and j = i + delay are valid indices
+        int start = std::max(0, -delay);
+        int end = std::min(datasize, datasize - delay);
+        for (i = start, j = start + delay; i < end; ++i, ++j)
+        {
           sxy += (data1[i]) * (data2[j]);
         }
-        result[delay] = sxy;
+        result.data.push_back(std::make_pair(delay, sxy));
       }
       return result;
     }
@@ -240,12 +353,12 @@ namespace OpenSwath
 
         if (denominator > 0)
         {
-          result[delay] = sxy / denominator;
+          result.data.push_back(std::make_pair(delay, sxy / denominator));
         }
         else
         {
           // e.g. if all datapoints are zero
-          result[delay] = 0;
+          result.data.push_back(std::make_pair(delay, 0.0));
         }
       }
       return result;
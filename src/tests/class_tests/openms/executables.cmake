@@ -188,6 +188,7 @@ set(format_executables_list
   PepXMLFileMascot_test
   PepXMLFile_test
   ProtXMLFile_test
+  ProteinIndexFile_test
   SVOutStream_test
   SemanticValidator_test
   SequestInfile_test
@@ -208,6 +209,7 @@ set(format_executables_list
   # DATAACCESS
   MSDataCachedConsumer_test
   MSDataTransformingConsumer_test
+  MSDataRTTransformingConsumer_test
 )
 
 set(math_executables_list
@@ -286,6 +288,7 @@ set(comparison_executables_list
   AverageLinkage_test
   BinnedSharedPeakCount_test
   BinnedSpectralContrastAngle_test
+  BinnedSpectralLibrary_test
   BinnedSpectrumCompareFunctor_test
   BinnedSpectrum_test
   BinnedSumAgreeingIntensities_test
@@ -531,6 +534,7 @@ if(NOT DISABLE_OPENSWATH)
     OpenSwathMRMFeatureAccessOpenMS_test
     SpectrumAddition_test
     OpenSwathSpectrumAccessOpenMS_test
+    OpenSwathSpectrumAccessOpenMSCachedMmap_test
     OpenSwathDataAccessHelper_test
     MRMFeatureScoring_test
     MRMFeatureFinderScoring_test
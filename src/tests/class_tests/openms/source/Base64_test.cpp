@@ -216,6 +216,43 @@ START_SECTION([EXTRA] zlib functionality)
 	
 END_SECTION
 
+START_SECTION([EXTRA] decoding of large arrays and malformed input)
+	TOLERANCE_ABSOLUTE(0.001)
+	Base64 b64;
+	String str;
+	std::vector<double> data_double, res_double;
+
+	// large, well compressible array (output buffer has to grow while inflating)
+	for (Size i = 0; i < 20000; ++i)
+	{
+		data_double.push_back(i % 10 + 0.5);
+	}
+	std::vector<double> data_copy = data_double;
+	b64.encode(data_double, Base64::BYTEORDER_LITTLEENDIAN, str, true);
+	b64.decode(str, Base64::BYTEORDER_LITTLEENDIAN, res_double, true);
+	TEST_EQUAL(res_double.size(), 20000)
+	TEST_EQUAL(res_double == data_copy, true)
+
+	// the same decoder can be reused for differently sized arrays
+	data_double.assign(data_copy.begin(), data_copy.begin() + 3);
+	b64.encode(data_double, Base64::BYTEORDER_BIGENDIAN, str, true);
+	b64.decode(str, Base64::BYTEORDER_BIGENDIAN, res_double, true);
+	TEST_EQUAL(res_double.size(), 3)
+	TEST_REAL_SIMILAR(res_double[2], 2.5)
+
+	// whitespace and line breaks inside the Base64 data are ignored
+	b64.decode("QHLCZmZm\nZmZAcv/3 ztkWh0Bz\r\nCZmZmZma\n", Base64::BYTEORDER_BIGENDIAN, res_double);
+	TEST_EQUAL(res_double.size(), 3)
+	TEST_REAL_SIMILAR(res_double[0], 300.15)
+	TEST_REAL_SIMILAR(res_double[1], 303.998)
+	TEST_REAL_SIMILAR(res_double[2], 304.6)
+
+	// truncated or corrupt compressed data
+	b64.encode(data_copy, Base64::BYTEORDER_LITTLEENDIAN, str, true);
+	TEST_EXCEPTION(Exception::ConversionError, b64.decode(str.substr(0, str.size() / 2), Base64::BYTEORDER_LITTLEENDIAN, res_double, true))
+	TEST_EXCEPTION(Exception::ConversionError, b64.decode("QHLCZmZmZmZAcv/3ztkWh0BzCZmZmZma", Base64::BYTEORDER_LITTLEENDIAN, res_double, true))
+END_SECTION
+
 START_SECTION(( void encodeStrings(const std::vector<String> & in, String & out, bool zlib_compression = false, bool append_zero_byte = true)))
 	Base64 b64;
 	String src,str;
@@ -0,0 +1,254 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2013.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: David Wojnar $
+// $Authors: David Wojnar $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/CONCEPT/ClassTest.h>
+#include <OpenMS/test_config.h>
+
+///////////////////////////
+#include <OpenMS/COMPARISON/SPECTRA/BinnedSpectralLibrary.h>
+///////////////////////////
+
+#include <OpenMS/COMPARISON/SPECTRA/SpectraSTSimilarityScore.h>
+
+#include <fstream>
+
+using namespace OpenMS;
+using namespace std;
+
+PeakSpectrum makeSpectrum(double first_mz, Size peaks)
+{
+  PeakSpectrum spec;
+  for (Size i = 0; i < peaks; ++i)
+  {
+    Peak1D peak;
+    peak.setMZ(first_mz + 7.3 * i);
+    peak.setIntensity(10.0 + (i * 37) % 11);
+    spec.push_back(peak);
+  }
+  return spec;
+}
+
+START_TEST(BinnedSpectralLibrary, "$Id$")
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+
+BinnedSpectralLibrary* ptr = 0;
+BinnedSpectralLibrary* nullPointer = 0;
+START_SECTION(BinnedSpectralLibrary())
+  ptr = new BinnedSpectralLibrary();
+  TEST_NOT_EQUAL(ptr, nullPointer)
+  TEST_EQUAL(ptr->size(), 0)
+END_SECTION
+
+START_SECTION(virtual ~BinnedSpectralLibrary())
+  delete ptr;
+END_SECTION
+
+PeakSpectrum s1 = makeSpectrum(100.2, 20);
+PeakSpectrum s2 = makeSpectrum(102.7, 25);
+PeakSpectrum s3 = makeSpectrum(400.5, 10);
+
+BinnedSpectralLibrary lib;
+lib.addSpectrum(s1, 500.0);
+lib.addSpectrum(s2, 450.0);
+lib.addSpectrum(s3, 500.0);
+lib.addSpectrum(PeakSpectrum(), 300.0);
+
+START_SECTION(void addSpectrum(const PeakSpectrum& spec, double precursor_mz))
+  TEST_EQUAL(lib.size(), 4)
+  TEST_REAL_SIMILAR(lib.getPrecursorMZ(0), 500.0)
+  TEST_REAL_SIMILAR(lib.getPrecursorMZ(1), 450.0)
+  TEST_EQUAL(lib.getSpectrumIndex(3), 3)
+END_SECTION
+
+START_SECTION(Size size() const)
+  TEST_EQUAL(BinnedSpectralLibrary().size(), 0)
+  TEST_EQUAL(lib.size(), 4)
+END_SECTION
+
+START_SECTION(double getPrecursorMZ(Size entry) const)
+  TEST_REAL_SIMILAR(lib.getPrecursorMZ(3), 300.0)
+  TEST_EXCEPTION(Exception::IndexOverflow, lib.getPrecursorMZ(4))
+END_SECTION
+
+START_SECTION(Size getSpectrumIndex(Size entry) const)
+  TEST_EQUAL(lib.getSpectrumIndex(0), 0)
+  TEST_EXCEPTION(Exception::IndexOverflow, lib.getSpectrumIndex(4))
+END_SECTION
+
+START_SECTION(void sortByPrecursorMZ())
+  lib.sortByPrecursorMZ();
+  TEST_EQUAL(lib.size(), 4)
+  TEST_REAL_SIMILAR(lib.getPrecursorMZ(0), 300.0)
+  TEST_REAL_SIMILAR(lib.getPrecursorMZ(1), 450.0)
+  TEST_REAL_SIMILAR(lib.getPrecursorMZ(2), 500.0)
+  TEST_REAL_SIMILAR(lib.getPrecursorMZ(3), 500.0)
+  // spectra with the same precursor keep their order
+  TEST_EQUAL(lib.getSpectrumIndex(0), 3)
+  TEST_EQUAL(lib.getSpectrumIndex(1), 1)
+  TEST_EQUAL(lib.getSpectrumIndex(2), 0)
+  TEST_EQUAL(lib.getSpectrumIndex(3), 2)
+END_SECTION
+
+START_SECTION((std::pair<Size, Size> findRange(double min_mz, double max_mz) const))
+  pair<Size, Size> range = lib.findRange(449.0, 501.0);
+  TEST_EQUAL(range.first, 1)
+  TEST_EQUAL(range.second, 4)
+  range = lib.findRange(500.0, 500.0);
+  TEST_EQUAL(range.first, 2)
+  TEST_EQUAL(range.second, 4)
+  range = lib.findRange(460.0, 470.0);
+  TEST_EQUAL(range.first, range.second)
+  range = lib.findRange(0.0, 1000.0);
+  TEST_EQUAL(range.first, 0)
+  TEST_EQUAL(range.second, 4)
+END_SECTION
+
+START_SECTION(static void transformQuery(const PeakSpectrum& spec, std::vector<float>& query))
+  vector<float> query;
+  BinnedSpectralLibrary::transformQuery(s1, query);
+  SpectraSTSimilarityScore sp;
+  BinnedSpectrum binned = sp.transform(s1);
+  TEST_EQUAL(query.size(), binned.getBinNumber())
+  for (Size b = 0; b < query.size(); ++b)
+  {
+    TEST_REAL_SIMILAR(query[b], binned.getBins().at(b))
+  }
+  BinnedSpectralLibrary::transformQuery(PeakSpectrum(), query);
+  TEST_EQUAL(query.size(), 0)
+END_SECTION
+
+START_SECTION(double dotProduct(Size entry, const std::vector<float>& query) const)
+  SpectraSTSimilarityScore sp;
+  vector<float> query;
+  BinnedSpectralLibrary::transformQuery(s1, query);
+  // entry 2 is s1, entry 1 is s2, entry 3 is s3
+  TEST_REAL_SIMILAR(lib.dotProduct(2, query), 1.0)
+  TEST_EQUAL(lib.dotProduct(2, query), sp(s1, s1))
+  TEST_EQUAL(lib.dotProduct(1, query), sp(s2, s1))
+  TEST_EQUAL(lib.dotProduct(3, query), sp(s3, s1))
+  TEST_EQUAL(lib.dotProduct(0, query), 0.0)
+END_SECTION
+
+START_SECTION(double dotBias(Size entry, const std::vector<float>& query, double dot_product) const)
+  SpectraSTSimilarityScore sp;
+  vector<float> query;
+  BinnedSpectralLibrary::transformQuery(s2, query);
+  BinnedSpectrum bin1 = sp.transform(s2);
+  BinnedSpectrum bin2 = sp.transform(s1);
+  double dot = sp(bin1, bin2);
+  TEST_REAL_SIMILAR(lib.dotBias(2, query, dot), sp.dot_bias(bin1, bin2, dot))
+  TEST_REAL_SIMILAR(lib.dotBias(2, query, 0), lib.dotBias(2, query, lib.dotProduct(2, query)))
+END_SECTION
+
+START_SECTION((void score(const std::vector<float>& query, Size first, Size last, std::vector<double>& dot_products, std::vector<double>& dot_biases) const))
+  vector<float> query;
+  BinnedSpectralLibrary::transformQuery(s2, query);
+  vector<double> dots, biases;
+  lib.score(query, 1, 4, dots, biases);
+  TEST_EQUAL(dots.size(), 3)
+  TEST_EQUAL(biases.size(), 3)
+  for (Size i = 0; i < dots.size(); ++i)
+  {
+    TEST_EQUAL(dots[i], lib.dotProduct(i + 1, query))
+    TEST_EQUAL(biases[i], lib.dotBias(i + 1, query, dots[i]))
+  }
+  lib.score(query, 2, 2, dots, biases);
+  TEST_EQUAL(dots.size(), 0)
+  TEST_EXCEPTION(Exception::IndexOverflow, lib.score(query, 2, 5, dots, biases))
+END_SECTION
+
+START_SECTION(void setSignature(const String& signature))
+  lib.setSignature("threshold=2.01");
+  TEST_EQUAL(lib.getSignature(), "threshold=2.01")
+END_SECTION
+
+START_SECTION(const String& getSignature() const)
+  TEST_EQUAL(BinnedSpectralLibrary().getSignature(), "")
+END_SECTION
+
+START_SECTION(void store(const String& filename) const)
+  String filename;
+  NEW_TMP_FILE(filename)
+  lib.store(filename);
+  BinnedSpectralLibrary loaded;
+  loaded.load(filename);
+  TEST_EQUAL(loaded == lib, true)
+  TEST_EXCEPTION(Exception::UnableToCreateFile, lib.store("/does/not/exist/lib.bin"))
+END_SECTION
+
+START_SECTION(void load(const String& filename))
+  String filename;
+  NEW_TMP_FILE(filename)
+  lib.store(filename);
+  BinnedSpectralLibrary loaded;
+  loaded.addSpectrum(s3, 123.0);
+  loaded.load(filename);
+  TEST_EQUAL(loaded.size(), 4)
+  TEST_EQUAL(loaded.getSignature(), "threshold=2.01")
+  vector<float> query;
+  BinnedSpectralLibrary::transformQuery(s1, query);
+  TEST_EQUAL(loaded.dotProduct(2, query), lib.dotProduct(2, query))
+
+  TEST_EXCEPTION(Exception::FileNotFound, loaded.load("does_not_exist.bin"))
+  String invalid;
+  NEW_TMP_FILE(invalid)
+  {
+    ofstream out(invalid.c_str());
+    out << "no library";
+  }
+  TEST_EXCEPTION(Exception::ParseError, loaded.load(invalid))
+  // a failed load leaves the library unchanged
+  TEST_EQUAL(loaded == lib, true)
+END_SECTION
+
+START_SECTION(void clear())
+  BinnedSpectralLibrary copy(lib);
+  copy.clear();
+  TEST_EQUAL(copy.size(), 0)
+  TEST_EQUAL(copy.getSignature(), "")
+  TEST_EQUAL(copy == BinnedSpectralLibrary(), true)
+END_SECTION
+
+START_SECTION(bool operator==(const BinnedSpectralLibrary& rhs) const)
+  BinnedSpectralLibrary copy(lib);
+  TEST_EQUAL(copy == lib, true)
+  copy.setSignature("other");
+  TEST_EQUAL(copy == lib, false)
+END_SECTION
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+END_TEST
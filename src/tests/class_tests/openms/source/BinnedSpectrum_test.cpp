@@ -168,6 +168,37 @@ START_SECTION((SparseVector<float>& getBins()))
 }
 END_SECTION
 
+START_SECTION((const std::vector<UInt>& getFilledBins() const))
+{
+	const BinnedSpectrum& bs = *bs1;
+	TEST_EQUAL(bs.getFilledBins().size(), 347)
+	for (Size i = 1; i < bs.getFilledBins().size(); ++i)
+	{
+		TEST_EQUAL(bs.getFilledBins()[i - 1] < bs.getFilledBins()[i], true)
+	}
+	TEST_EXCEPTION(BinnedSpectrum::NoSpectrumIntegrated, BinnedSpectrum().getFilledBins())
+}
+END_SECTION
+
+START_SECTION((const std::vector<float>& getFilledIntensities() const))
+{
+	const BinnedSpectrum& bs = *bs1;
+	TEST_EQUAL(bs.getFilledIntensities().size(), bs.getFilledBins().size())
+	for (Size i = 0; i < bs.getFilledBins().size(); ++i)
+	{
+		TEST_EQUAL(bs.getFilledIntensities()[i], bs.getBins().at(bs.getFilledBins()[i]))
+	}
+
+	// modifications of the bins are picked up
+	BinnedSpectrum copy(bs);
+	copy.getBins()[bs.getFilledBins()[0]] = 2.0f;
+	const BinnedSpectrum& const_copy = copy;
+	TEST_EQUAL(const_copy.getFilledIntensities()[0], 2.0f)
+	TEST_EQUAL(const_copy.getFilledBins().size(), 347)
+	TEST_EXCEPTION(BinnedSpectrum::NoSpectrumIntegrated, BinnedSpectrum().getFilledIntensities())
+}
+END_SECTION
+
 START_SECTION((const_bin_iterator begin() const ))
 {
 	UInt c(0);
@@ -39,6 +39,10 @@
 #include <OpenMS/FORMAT/CachedMzML.h>
 ///////////////////////////
 
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
 using namespace OpenMS;
 using namespace std;
 
@@ -258,7 +262,7 @@ START_SECTION(( const std::vector<std::streampos>& getChromatogramIndex() const
 }
 END_SECTION
 
-START_SECTION(static inline void readSpectrumFast(OpenSwath::BinaryDataArrayPtr data1, OpenSwath::BinaryDataArrayPtr data2, std::ifstream& ifs, int& ms_level, double& rt))
+START_SECTION(static inline void readSpectrumFast(OpenSwath::BinaryDataArrayPtr data1, OpenSwath::BinaryDataArrayPtr data2, std::ifstream& ifs, int& ms_level, double& rt, int format_version = 1))
 {
 
   // Check whether spectra were written to disk correctly...
@@ -317,7 +321,7 @@ START_SECTION(static inline void readSpectrumFast(OpenSwath::BinaryDataArrayPtr
 }
 END_SECTION
 
-START_SECTION( static inline void readChromatogramFast(OpenSwath::BinaryDataArrayPtr data1, OpenSwath::BinaryDataArrayPtr data2, std::ifstream& ifs) )
+START_SECTION( static inline void readChromatogramFast(OpenSwath::BinaryDataArrayPtr data1, OpenSwath::BinaryDataArrayPtr data2, std::ifstream& ifs, int format_version = 1) )
 {
   // Check whether chromatograms were written to disk correctly...
   {
@@ -368,6 +372,241 @@ START_SECTION( static inline void readChromatogramFast(OpenSwath::BinaryDataArra
 }
 END_SECTION
 
+START_SECTION(( void setFormatVersion(int version) ))
+{
+  CachedmzML cache;
+  cache.setFormatVersion(2);
+  TEST_EQUAL(cache.getFormatVersion(), 2)
+  cache.setFormatVersion(1);
+  TEST_EQUAL(cache.getFormatVersion(), 1)
+  TEST_EXCEPTION(Exception::InvalidValue, cache.setFormatVersion(3))
+}
+END_SECTION
+
+START_SECTION(( int getFormatVersion() const ))
+{
+  CachedmzML cache;
+  TEST_EQUAL(cache.getFormatVersion(), 1)
+  // reading an index sets the version of the file
+  TEST_EQUAL(cache_.getFormatVersion(), 1)
+}
+END_SECTION
+
+START_SECTION(( void setDataEncoding(BinaryDataEncoding first_encoding, BinaryDataEncoding intensity_encoding) ))
+{
+  CachedmzML cache;
+  cache.setDataEncoding(CachedmzML::ENCODING_NUMPRESS_LINEAR, CachedmzML::ENCODING_FLOAT32);
+  TEST_EQUAL(cache.getFirstDataEncoding(), CachedmzML::ENCODING_NUMPRESS_LINEAR)
+  TEST_EQUAL(cache.getIntensityDataEncoding(), CachedmzML::ENCODING_FLOAT32)
+}
+END_SECTION
+
+START_SECTION(( BinaryDataEncoding getFirstDataEncoding() const ))
+{
+  CachedmzML cache;
+  TEST_EQUAL(cache.getFirstDataEncoding(), CachedmzML::ENCODING_FLOAT64)
+}
+END_SECTION
+
+START_SECTION(( BinaryDataEncoding getIntensityDataEncoding() const ))
+{
+  CachedmzML cache;
+  TEST_EQUAL(cache.getIntensityDataEncoding(), CachedmzML::ENCODING_FLOAT64)
+}
+END_SECTION
+
+START_SECTION(( const std::vector<double>& getSpectraRT() const ))
+{
+  TEST_EQUAL(cache_.getSpectraRT().size(), 4)
+  TEST_REAL_SIMILAR(cache_.getSpectraRT()[0], 5.1)
+}
+END_SECTION
+
+START_SECTION(( const std::vector<int>& getSpectraMSLevel() const ))
+{
+  TEST_EQUAL(cache_.getSpectraMSLevel().size(), 4)
+  TEST_EQUAL(cache_.getSpectraMSLevel()[0], 1)
+}
+END_SECTION
+
+START_SECTION(( static Size paddedSize(Size bytes) ))
+{
+  TEST_EQUAL(CachedmzML::paddedSize(0), 0)
+  TEST_EQUAL(CachedmzML::paddedSize(1), 8)
+  TEST_EQUAL(CachedmzML::paddedSize(8), 8)
+  TEST_EQUAL(CachedmzML::paddedSize(13), 16)
+}
+END_SECTION
+
+START_SECTION(( static void encodeBinaryData(const Datavector& in, BinaryDataEncoding& encoding, std::vector<char>& out) ))
+{
+  CachedmzML::Datavector data;
+  data.push_back(100.0);
+  data.push_back(200.5);
+  data.push_back(300.25);
+  std::vector<char> out;
+
+  CachedmzML::BinaryDataEncoding encoding = CachedmzML::ENCODING_FLOAT64;
+  CachedmzML::encodeBinaryData(data, encoding, out);
+  TEST_EQUAL(encoding, CachedmzML::ENCODING_FLOAT64)
+  TEST_EQUAL(out.size(), 3 * sizeof(double))
+
+  encoding = CachedmzML::ENCODING_FLOAT32;
+  CachedmzML::encodeBinaryData(data, encoding, out);
+  TEST_EQUAL(encoding, CachedmzML::ENCODING_FLOAT32)
+  TEST_EQUAL(out.size(), 3 * sizeof(float))
+
+  encoding = CachedmzML::ENCODING_NUMPRESS_LINEAR;
+  CachedmzML::encodeBinaryData(data, encoding, out);
+  TEST_EQUAL(encoding, CachedmzML::ENCODING_NUMPRESS_LINEAR)
+  TEST_EQUAL(out.size() < 3 * sizeof(double) + 8, true)
+
+  // negative values cannot be stored with SLOF, fall back to uncompressed data
+  data.push_back(-1.0);
+  encoding = CachedmzML::ENCODING_NUMPRESS_SLOF;
+  CachedmzML::encodeBinaryData(data, encoding, out);
+  TEST_EQUAL(encoding, CachedmzML::ENCODING_FLOAT64)
+  TEST_EQUAL(out.size(), 4 * sizeof(double))
+}
+END_SECTION
+
+START_SECTION(( static void decodeBinaryData(const char* in, Size in_bytes, Size size, BinaryDataEncoding encoding, Datavector& out) ))
+{
+  CachedmzML::Datavector data;
+  data.push_back(100.0);
+  data.push_back(200.5);
+  data.push_back(300.25);
+  std::vector<char> encoded;
+  CachedmzML::Datavector decoded;
+
+  for (int e = 0; e < CachedmzML::SIZE_OF_BINARYDATAENCODING; e++)
+  {
+    CachedmzML::BinaryDataEncoding encoding = static_cast<CachedmzML::BinaryDataEncoding>(e);
+    CachedmzML::encodeBinaryData(data, encoding, encoded);
+    TEST_EQUAL(encoding, static_cast<CachedmzML::BinaryDataEncoding>(e))
+    CachedmzML::decodeBinaryData(&encoded[0], encoded.size(), data.size(), encoding, decoded);
+    TEST_EQUAL(decoded.size(), data.size())
+    TOLERANCE_RELATIVE(1.01)
+    for (Size i = 0; i < data.size(); i++)
+    {
+      TEST_REAL_SIMILAR(decoded[i], data[i])
+    }
+    TOLERANCE_RELATIVE(1.00001)
+  }
+
+  // wrong size of the data
+  TEST_EXCEPTION(Exception::ParseError, CachedmzML::decodeBinaryData(&encoded[0], encoded.size(), data.size() + 5, CachedmzML::ENCODING_FLOAT64, decoded))
+}
+END_SECTION
+
+START_SECTION(( [EXTRA] testCaching format version 2))
+{
+  std::string tmp_filename;
+  NEW_TMP_FILE(tmp_filename);
+
+  MSExperiment<> exp;
+  MzMLFile().load(OPENMS_GET_TEST_DATA_PATH("MzMLFile_1.mzML"), exp);
+
+  CachedmzML cache;
+  cache.setFormatVersion(2);
+  cache.setDataEncoding(CachedmzML::ENCODING_NUMPRESS_LINEAR, CachedmzML::ENCODING_FLOAT32);
+  cache.writeMemdump(exp, tmp_filename);
+
+  // the index is read from the end of the file
+  CachedmzML cache_v2;
+  cache_v2.createMemdumpIndex(tmp_filename);
+  TEST_EQUAL(cache_v2.getFormatVersion(), 2)
+  TEST_EQUAL(cache_v2.getSpectraIndex().size(), 4)
+  TEST_EQUAL(cache_v2.getChromatogramIndex().size(), 2)
+  TEST_EQUAL(cache_v2.getSpectraRT().size(), 4)
+  TEST_REAL_SIMILAR(cache_v2.getSpectraRT()[0], 5.1)
+  TEST_EQUAL(cache_v2.getSpectraMSLevel()[0], 1)
+
+  std::ifstream ifs_(tmp_filename.c_str(), std::ios::binary);
+  OpenSwath::BinaryDataArrayPtr data1(new OpenSwath::BinaryDataArray);
+  OpenSwath::BinaryDataArrayPtr data2(new OpenSwath::BinaryDataArray);
+  TOLERANCE_RELATIVE(1.0001)
+  for (Size k = 0; k < 4; k++)
+  {
+    int ms_level = -1;
+    double rt = -1.0;
+    ifs_.seekg(cache_v2.getSpectraIndex()[k]);
+    CachedmzML::readSpectrumFast(data1, data2, ifs_, ms_level, rt, 2);
+    TEST_EQUAL(data1->data.size(), exp.getSpectrum(k).size())
+    TEST_EQUAL(ms_level, exp.getSpectrum(k).getMSLevel())
+    TEST_REAL_SIMILAR(rt, exp.getSpectrum(k).getRT())
+    for (Size i = 0; i < data1->data.size(); i++)
+    {
+      TEST_REAL_SIMILAR(data1->data[i], exp.getSpectrum(k)[i].getMZ())
+      TEST_REAL_SIMILAR(data2->data[i], exp.getSpectrum(k)[i].getIntensity())
+    }
+  }
+  for (Size k = 0; k < 2; k++)
+  {
+    ifs_.seekg(cache_v2.getChromatogramIndex()[k]);
+    CachedmzML::readChromatogramFast(data1, data2, ifs_, 2);
+    TEST_EQUAL(data1->data.size(), exp.getChromatogram(k).size())
+    for (Size i = 0; i < data1->data.size(); i++)
+    {
+      TEST_REAL_SIMILAR(data1->data[i], exp.getChromatogram(k)[i].getRT())
+      TEST_REAL_SIMILAR(data2->data[i], exp.getChromatogram(k)[i].getIntensity())
+    }
+  }
+
+  // read the complete file
+  MSExperiment<> exp_new;
+  cache_v2.readMemdump(exp_new, tmp_filename);
+  TEST_EQUAL(exp_new.size(), exp.size())
+  TEST_EQUAL(exp_new.getChromatograms().size(), exp.getChromatograms().size())
+  TEST_EQUAL(exp_new[1].size(), exp[1].size())
+  TEST_REAL_SIMILAR(exp_new[1].getRT(), exp[1].getRT())
+  TOLERANCE_RELATIVE(1.00001)
+}
+END_SECTION
+
+START_SECTION(( [EXTRA] corrupt files of format version 2))
+{
+  std::string tmp_filename;
+  NEW_TMP_FILE(tmp_filename);
+
+  MSExperiment<> exp;
+  MzMLFile().load(OPENMS_GET_TEST_DATA_PATH("MzMLFile_1.mzML"), exp);
+  CachedmzML cache;
+  cache.setFormatVersion(2);
+  cache.writeMemdump(exp, tmp_filename);
+  cache.createMemdumpIndex(tmp_filename);
+  const Size record_pos = cache.getSpectraIndex()[0];
+
+  std::ifstream in(tmp_filename.c_str(), std::ios::binary);
+  const std::string content((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+  in.close();
+  const UInt64 huge = UInt64(1) << 61;
+
+  // the number of index entries does not fit into the file
+  std::string corrupt_index = content;
+  std::memcpy(&corrupt_index[content.size() - sizeof(CachedmzML::Trailer) + 8], &huge, sizeof(UInt64)); // nr_spectra
+  std::string corrupt_index_file;
+  NEW_TMP_FILE(corrupt_index_file);
+  std::ofstream(corrupt_index_file.c_str(), std::ios::binary).write(corrupt_index.data(), corrupt_index.size());
+  TEST_EXCEPTION(Exception::ParseError, CachedmzML().createMemdumpIndex(corrupt_index_file))
+
+  // the arrays of a spectrum do not fit into the file
+  std::string corrupt_record = content;
+  std::memcpy(&corrupt_record[record_pos], &huge, sizeof(UInt64)); // size
+  std::memcpy(&corrupt_record[record_pos + 8], &huge, sizeof(UInt64)); // bytes_first
+  std::string corrupt_record_file;
+  NEW_TMP_FILE(corrupt_record_file);
+  std::ofstream(corrupt_record_file.c_str(), std::ios::binary).write(corrupt_record.data(), corrupt_record.size());
+  std::ifstream ifs_(corrupt_record_file.c_str(), std::ios::binary);
+  ifs_.seekg(record_pos);
+  OpenSwath::BinaryDataArrayPtr data1(new OpenSwath::BinaryDataArray);
+  OpenSwath::BinaryDataArrayPtr data2(new OpenSwath::BinaryDataArray);
+  int ms_level;
+  double rt;
+  TEST_EXCEPTION(Exception::ParseError, CachedmzML::readSpectrumFast(data1, data2, ifs_, ms_level, rt, 2))
+}
+END_SECTION
+
 /////////////////////////////////////////////////////////////
 /////////////////////////////////////////////////////////////
 END_TEST
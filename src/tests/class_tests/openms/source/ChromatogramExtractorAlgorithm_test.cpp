@@ -151,6 +151,87 @@ START_SECTION(void extractChromatograms(const OpenSwath::SpectrumAccessPtr input
 }
 END_SECTION
 
+START_SECTION([EXTRA] void extractChromatograms with RT windows and filters)
+{
+  boost::shared_ptr<MSExperiment<Peak1D> > exp(new MSExperiment<Peak1D>);
+  MzMLFile().load(OPENMS_GET_TEST_DATA_PATH("ChromatogramExtractor_input.mzML"), *exp);
+  OpenSwath::SpectrumAccessPtr expptr = SimpleOpenMSSpectraFactory::getSpectrumAccessOpenMSPtr(exp);
+  ChromatogramExtractorAlgorithm extractor;
+
+  // the same transition, once over the whole RT range and once restricted in RT
+  std::vector< ChromatogramExtractorAlgorithm::ExtractionCoordinates > coordinates;
+  ChromatogramExtractorAlgorithm::ExtractionCoordinates coord;
+  coord.mz = 618.31; coord.rt_start = 0; coord.rt_end = -1; coord.id = "full";
+  coordinates.push_back(coord);
+  coord.mz = 618.31; coord.rt_start = 3050; coord.rt_end = 3150; coord.id = "restricted";
+  coordinates.push_back(coord);
+  coord.mz = 628.45; coord.rt_start = 10000; coord.rt_end = 20000; coord.id = "outside";
+  coordinates.push_back(coord);
+
+  std::vector< OpenSwath::ChromatogramPtr > out_exp;
+  for (Size i = 0; i < coordinates.size(); i++)
+  {
+    OpenSwath::ChromatogramPtr s(new OpenSwath::Chromatogram);
+    out_exp.push_back(s);
+  }
+  extractor.extractChromatograms(expptr, out_exp, coordinates, 0.05, false, "tophat");
+
+  TEST_EQUAL(out_exp[0]->getTimeArray()->data.size(), 59)
+  TEST_EQUAL(out_exp[2]->getTimeArray()->data.size(), 0)
+
+  // the restricted chromatogram has to be the corresponding part of the full one
+  std::vector<double> expected_rt, expected_int;
+  for (Size i = 0; i < out_exp[0]->getTimeArray()->data.size(); i++)
+  {
+    double rt = out_exp[0]->getTimeArray()->data[i];
+    if (rt >= 3050 && rt <= 3150)
+    {
+      expected_rt.push_back(rt);
+      expected_int.push_back(out_exp[0]->getIntensityArray()->data[i]);
+    }
+  }
+  TEST_EQUAL(expected_rt.empty(), false)
+  TEST_EQUAL(out_exp[1]->getTimeArray()->data.size(), expected_rt.size())
+  for (Size i = 0; i < std::min(expected_rt.size(), out_exp[1]->getTimeArray()->data.size()); i++)
+  {
+    TEST_REAL_SIMILAR(out_exp[1]->getTimeArray()->data[i], expected_rt[i])
+    TEST_REAL_SIMILAR(out_exp[1]->getIntensityArray()->data[i], expected_int[i])
+  }
+
+  // a window lying strictly between two spectra contains no spectrum, so nothing is extracted
+  {
+    double rt_before = out_exp[0]->getTimeArray()->data[10];
+    double rt_after = out_exp[0]->getTimeArray()->data[11];
+    std::vector< ChromatogramExtractorAlgorithm::ExtractionCoordinates > between;
+    coord.mz = 618.31; coord.id = "between";
+    coord.rt_start = rt_before + 0.25 * (rt_after - rt_before);
+    coord.rt_end = rt_before + 0.75 * (rt_after - rt_before);
+    between.push_back(coord);
+    std::vector< OpenSwath::ChromatogramPtr > out_between(1, OpenSwath::ChromatogramPtr(new OpenSwath::Chromatogram));
+    extractor.extractChromatograms(expptr, out_between, between, 0.05, false, "tophat");
+    TEST_EQUAL(out_between[0]->getTimeArray()->data.size(), 0)
+    TEST_EQUAL(out_between[0]->getIntensityArray()->data.size(), 0)
+  }
+
+  // unknown filters are rejected, weighted filters give less signal than the tophat
+  TEST_EXCEPTION(Exception::IllegalArgument, extractor.extractChromatograms(expptr, out_exp, coordinates, 0.05, false, "unknown"))
+  std::vector< OpenSwath::ChromatogramPtr > out_gauss;
+  for (Size i = 0; i < coordinates.size(); i++)
+  {
+    OpenSwath::ChromatogramPtr s(new OpenSwath::Chromatogram);
+    out_gauss.push_back(s);
+  }
+  extractor.extractChromatograms(expptr, out_gauss, coordinates, 0.05, false, "gaussian");
+  TEST_EQUAL(out_gauss[0]->getIntensityArray()->data.size(), 59)
+  bool all_smaller = true;
+  for (Size i = 0; i < out_gauss[0]->getIntensityArray()->data.size(); i++)
+  {
+    if (out_gauss[0]->getIntensityArray()->data[i] > out_exp[0]->getIntensityArray()->data[i] + 1e-8) all_smaller = false;
+  }
+  TEST_EQUAL(all_smaller, true)
+}
+END_SECTION
+
 ///////////////////////////////////////////////////////////////////////////
 /// Private functions
 ///////////////////////////////////////////////////////////////////////////
@@ -275,6 +356,70 @@ START_SECTION(void extract_value_tophat(const std::vector< double >::const_itera
 }
 END_SECTION
 
+START_SECTION(void extractValues(const std::vector<double>& mz_arr, const std::vector<double>& int_arr, const std::vector<ExtractionCoordinates>& extraction_coordinates, std::vector<double>& integrated_intensities, double mz_extraction_window, bool ppm, String filter))
+{
+  std::vector<double> mz (mz_arr, mz_arr + sizeof(mz_arr) / sizeof(mz_arr[0]) );
+  std::vector<double> intensities (int_arr, int_arr + sizeof(int_arr) / sizeof(int_arr[0]) );
+
+  std::vector< ChromatogramExtractorAlgorithm::ExtractionCoordinates > coordinates;
+  ChromatogramExtractorAlgorithm::ExtractionCoordinates coord;
+  coord.rt_start = 0; coord.rt_end = -1;
+  coord.mz = 399.91; coordinates.push_back(coord);
+  coord.mz = 400.0; coordinates.push_back(coord);
+  coord.mz = 400.05; coordinates.push_back(coord);
+  coord.mz = 400.1; coordinates.push_back(coord);
+  coord.mz = 400.28; coordinates.push_back(coord);
+  coord.mz = 500.0; coordinates.push_back(coord);
+
+  ChromatogramExtractorAlgorithm extractor;
+  std::vector<double> result;
+
+  // same results as extracting the values one by one
+  extractor.extractValues(mz, intensities, coordinates, result, 0.2, false, "tophat");
+  TEST_EQUAL(result.size(), 6)
+  TEST_REAL_SIMILAR(result[0], 100.0)
+  TEST_REAL_SIMILAR(result[1], 4500.0)
+  TEST_REAL_SIMILAR(result[2], 8400.0)
+  TEST_REAL_SIMILAR(result[3], 9000.0)
+  TEST_REAL_SIMILAR(result[4], 100.0)
+  TEST_REAL_SIMILAR(result[5], 10.0)
+
+  // overlapping windows are all extracted (500 ppm == 0.2 Da @ 400 m/z)
+  extractor.extractValues(mz, intensities, coordinates, result, 500, true, "tophat");
+  TEST_REAL_SIMILAR(result[0], 0.0)
+  TEST_REAL_SIMILAR(result[1], 4500.0)
+  TEST_REAL_SIMILAR(result[2], 8400.0)
+  TEST_REAL_SIMILAR(result[3], 9000.0)
+
+  // bartlett: weight 1 - |d| / 0.1
+  extractor.extractValues(mz, intensities, coordinates, result, 0.2, false, "bartlett");
+  TOLERANCE_ABSOLUTE(1e-6)
+  TEST_REAL_SIMILAR(result[0], 0.0)
+  TEST_REAL_SIMILAR(result[1], 1650.0)
+  TEST_REAL_SIMILAR(result[2], 4650.0)
+  TEST_REAL_SIMILAR(result[3], 6150.0)
+  TEST_REAL_SIMILAR(result[5], 10.0)
+
+  // gaussian: sigma = 0.05
+  extractor.extractValues(mz, intensities, coordinates, result, 0.2, false, "gaussian");
+  TEST_REAL_SIMILAR(result[0], 13.5335283)
+  TEST_REAL_SIMILAR(result[1], 2082.2569370)
+  TEST_REAL_SIMILAR(result[2], 5482.6372790)
+  TEST_REAL_SIMILAR(result[3], 7013.0882622)
+  TEST_REAL_SIMILAR(result[5], 10.0)
+
+  // empty spectrum
+  std::vector<double> empty;
+  extractor.extractValues(empty, empty, coordinates, result, 0.2, false, "tophat");
+  TEST_EQUAL(result.size(), 6)
+  TEST_REAL_SIMILAR(result[3], 0.0)
+
+  // unsorted coordinates
+  std::reverse(coordinates.begin(), coordinates.end());
+  TEST_EXCEPTION(Exception::IllegalArgument, extractor.extractValues(mz, intensities, coordinates, result, 0.2, false, "tophat"))
+}
+END_SECTION
+
 START_SECTION( [ChromatogramExtractorAlgorithm::ExtractionCoordinates] static bool SortExtractionCoordinatesByMZ(const ChromatogramExtractorAlgorithm::ExtractionCoordinates &left, const ChromatogramExtractorAlgorithm::ExtractionCoordinates &right))    
 {
   NOT_TESTABLE
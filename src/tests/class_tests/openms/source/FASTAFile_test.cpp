@@ -66,6 +66,23 @@ START_SECTION((~FASTAFile()))
   delete(ptr);
 END_SECTION
 
+START_SECTION((FASTAFile(const FASTAFile& source)))
+  FASTAFile file;
+  file.readStart(OPENMS_GET_TEST_DATA_PATH("FASTAFile_test.fasta"));
+  FASTAFile copy(file);
+  FASTAFile::FASTAEntry entry;
+  TEST_EQUAL(copy.readNext(entry), false) // the open file is not shared
+  TEST_EQUAL(file.readNext(entry), true)
+END_SECTION
+
+START_SECTION((FASTAFile& operator=(const FASTAFile& source)))
+  FASTAFile file, other;
+  file.readStart(OPENMS_GET_TEST_DATA_PATH("FASTAFile_test.fasta"));
+  file = other;
+  FASTAFile::FASTAEntry entry;
+  TEST_EQUAL(file.readNext(entry), false)
+END_SECTION
+
 FASTAFile file;
 vector< FASTAFile::FASTAEntry > sequences;
 vector< FASTAFile::FASTAEntry >::const_iterator sequences_iterator;
@@ -168,6 +185,66 @@ START_SECTION((void load(const String& filename, std::vector< FASTAEntry > &data
 
 END_SECTION
 
+START_SECTION((void readStart(const String& filename)))
+  FASTAFile file;
+  TEST_EXCEPTION(Exception::FileNotFound, file.readStart("FASTAFile_test_this_file_does_not_exist"))
+  file.readStart(OPENMS_GET_TEST_DATA_PATH("FASTAFile_test.fasta"));
+  TEST_EQUAL(file.entriesRead(), 0)
+END_SECTION
+
+START_SECTION((bool readNext(FASTAEntry& protein)))
+  vector<FASTAFile::FASTAEntry> data;
+  FASTAFile file;
+  file.load(OPENMS_GET_TEST_DATA_PATH("FASTAFile_test.fasta"), data);
+
+  FASTAFile::FASTAEntry entry;
+  TEST_EQUAL(file.readNext(entry), false) // nothing opened
+
+  file.readStart(OPENMS_GET_TEST_DATA_PATH("FASTAFile_test.fasta"));
+  for (Size i = 0; i < data.size(); ++i)
+  {
+    TEST_EQUAL(file.readNext(entry), true)
+    TEST_EQUAL(entry == data[i], true)
+  }
+  TEST_EQUAL(file.readNext(entry), false)
+  TEST_EQUAL(file.readNext(entry), false)
+  TEST_EQUAL(file.entriesRead(), data.size())
+
+  // streaming can be restarted
+  file.readStart(OPENMS_GET_TEST_DATA_PATH("FASTAFile_test.fasta"));
+  TEST_EQUAL(file.readNext(entry), true)
+  TEST_EQUAL(entry == data[0], true)
+END_SECTION
+
+START_SECTION((bool readNextChunk(std::vector<FASTAEntry>& chunk, Size max_entries)))
+  vector<FASTAFile::FASTAEntry> data, chunk, streamed;
+  FASTAFile file;
+  file.load(OPENMS_GET_TEST_DATA_PATH("FASTAFile_test.fasta"), data);
+
+  file.readStart(OPENMS_GET_TEST_DATA_PATH("FASTAFile_test.fasta"));
+  TEST_EQUAL(file.readNextChunk(chunk, 2), true)
+  TEST_EQUAL(chunk.size(), 2)
+  streamed.insert(streamed.end(), chunk.begin(), chunk.end());
+  TEST_EQUAL(file.readNextChunk(chunk, 2), true)
+  TEST_EQUAL(chunk.size(), 2)
+  streamed.insert(streamed.end(), chunk.begin(), chunk.end());
+  TEST_EQUAL(file.readNextChunk(chunk, 2), true)
+  TEST_EQUAL(chunk.size(), 1) // the last, incomplete chunk
+  streamed.insert(streamed.end(), chunk.begin(), chunk.end());
+  TEST_EQUAL(file.readNextChunk(chunk, 2), false)
+  TEST_EQUAL(chunk.size(), 0)
+  TEST_EQUAL(streamed == data, true)
+END_SECTION
+
+START_SECTION((Size entriesRead() const))
+  FASTAFile file;
+  TEST_EQUAL(file.entriesRead(), 0)
+  vector<FASTAFile::FASTAEntry> chunk;
+  file.readStart(OPENMS_GET_TEST_DATA_PATH("FASTAFile_test.fasta"));
+  file.readNextChunk(chunk, 3);
+  TEST_EQUAL(file.entriesRead(), 3)
+END_SECTION
+
 START_SECTION((void store(const String& filename, const std::vector< FASTAEntry > &data) const))
   vector<FASTAFile::FASTAEntry> data, data2;
   String tmp_filename;
@@ -130,6 +130,51 @@ START_SECTION((virtual void run()))
 	
 END_SECTION
 
+START_SECTION([EXTRA] run() gives the same features for any number of threads)
+{
+  MSExperiment<> input;
+  MzDataFile mzdata_file;
+  mzdata_file.getOptions().addMSLevel(1);
+  mzdata_file.load(OPENMS_GET_TEST_DATA_PATH("FeatureFinderAlgorithmPicked.mzData"),input);
+  input.updateRanges(1);
+
+  Param param;
+  ParamXMLFile().load(OPENMS_GET_TEST_DATA_PATH("FeatureFinderAlgorithmPicked.ini"), param);
+  param = param.copy("FeatureFinder:1:algorithm:",true);
+  FeatureFinder ff;
+
+  FeatureMap<> output;
+  FFPP ffpp;
+  ffpp.setParameters(param);
+  ffpp.setData(input, output, ff);
+  ffpp.run();
+
+  FeatureMap<> output_serial;
+#ifdef _OPENMP
+  int threads = omp_get_max_threads();
+  omp_set_num_threads(1);
+#endif
+  FFPP ffpp_serial;
+  ffpp_serial.setParameters(param);
+  ffpp_serial.setData(input, output_serial, ff);
+  ffpp_serial.run();
+#ifdef _OPENMP
+  omp_set_num_threads(threads);
+#endif
+
+  TEST_EQUAL(output.size(), output_serial.size())
+  ABORT_IF(output.size() != output_serial.size())
+  for (Size i = 0; i < output.size(); ++i)
+  {
+    TEST_EQUAL(output[i].getRT(), output_serial[i].getRT())
+    TEST_EQUAL(output[i].getMZ(), output_serial[i].getMZ())
+    TEST_EQUAL(output[i].getIntensity(), output_serial[i].getIntensity())
+    TEST_EQUAL(output[i].getCharge(), output_serial[i].getCharge())
+    TEST_EQUAL(output[i].getSubordinates().size(), output_serial[i].getSubordinates().size())
+  }
+}
+END_SECTION
+
 /////////////////////////////////////////////////////////////
 /////////////////////////////////////////////////////////////
 
@@ -474,6 +474,65 @@ START_SECTION((void annotate(ConsensusMap& map, const std::vector<PeptideIdentif
 }
 END_SECTION
 
+START_SECTION([EXTRA] void annotate(ConsensusMap& map, const std::vector<PeptideIdentification>& ids, const std::vector<ProteinIdentification>& protein_ids, bool measure_from_subelements=false))
+{
+  IDMapper mapper;
+  Param p = mapper.getParameters();
+  p.setValue("mz_tolerance", 0.01);
+  p.setValue("mz_measure","Da");
+  p.setValue("ignore_charge", "true");
+  mapper.setParameters(p);
+
+  ConsensusMap cm;
+  cm.resize(3);
+  cm[0].setRT(100.0);
+  cm[0].setMZ(500.0);
+  cm[1].setRT(102.0);
+  cm[1].setMZ(500.005);
+  cm[2].setRT(100.0);
+  cm[2].setMZ(600.0);
+  Peak2D sub;
+  sub.setRT(100.0);
+  sub.setMZ(700.0);
+  cm[2].insert(0, sub, 0);
+
+  std::vector<ProteinIdentification> protein_ids;
+  std::vector<PeptideIdentification> peptide_ids(5);
+  double positions[5][2] = {{101.0, 500.002}, {100.0, 600.0}, {200.0, 500.0}, {101.0, 500.003}, {100.0, 700.0}};
+  for (Size i = 0; i < peptide_ids.size(); ++i)
+  {
+    peptide_ids[i].setRT(positions[i][0]);
+    peptide_ids[i].setMZ(positions[i][1]);
+    peptide_ids[i].setHits(std::vector<PeptideHit>(1));
+    peptide_ids[i].setIdentifier(String(i));
+  }
+
+  ConsensusMap cm_centroid = cm;
+  mapper.annotate(cm_centroid, peptide_ids, protein_ids);
+  // IDs are annotated to all matching features, in input order
+  TEST_EQUAL(cm_centroid[0].getPeptideIdentifications().size(), 2)
+  TEST_EQUAL(cm_centroid[0].getPeptideIdentifications()[0].getIdentifier(), "0")
+  TEST_EQUAL(cm_centroid[0].getPeptideIdentifications()[1].getIdentifier(), "3")
+  TEST_EQUAL(cm_centroid[1].getPeptideIdentifications().size(), 2)
+  TEST_EQUAL(cm_centroid[1].getPeptideIdentifications()[0].getIdentifier(), "0")
+  TEST_EQUAL(cm_centroid[1].getPeptideIdentifications()[1].getIdentifier(), "3")
+  TEST_EQUAL(cm_centroid[2].getPeptideIdentifications().size(), 1)
+  TEST_EQUAL(cm_centroid[2].getPeptideIdentifications()[0].getIdentifier(), "1")
+  TEST_EQUAL(cm_centroid.getUnassignedPeptideIdentifications().size(), 2)
+  TEST_EQUAL(cm_centroid.getUnassignedPeptideIdentifications()[0].getIdentifier(), "2")
+  TEST_EQUAL(cm_centroid.getUnassignedPeptideIdentifications()[1].getIdentifier(), "4")
+
+  // sub-features are matched instead of the centroids
+  ConsensusMap cm_sub = cm;
+  mapper.annotate(cm_sub, peptide_ids, protein_ids, true);
+  TEST_EQUAL(cm_sub[0].getPeptideIdentifications().size(), 0)
+  TEST_EQUAL(cm_sub[1].getPeptideIdentifications().size(), 0)
+  TEST_EQUAL(cm_sub[2].getPeptideIdentifications().size(), 1)
+  TEST_EQUAL(cm_sub[2].getPeptideIdentifications()[0].getIdentifier(), "4")
+  TEST_EQUAL(cm_sub.getUnassignedPeptideIdentifications().size(), 4)
+}
+END_SECTION
+
 START_SECTION([EXTRA] double getAbsoluteMZTolerance_(const double mz) const)
   IDMapper2 mapper;
   Param p = mapper.getParameters();
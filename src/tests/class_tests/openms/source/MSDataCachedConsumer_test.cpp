@@ -108,6 +108,40 @@ START_SECTION((void consumeSpectrum(SpectrumType & s)))
 }
 END_SECTION
 
+START_SECTION(([EXTRA] consumeSpectrum with format version 2))
+{
+  std::string tmp_filename;
+  NEW_TMP_FILE(tmp_filename);
+  MSDataCachedConsumer * cached_consumer = new MSDataCachedConsumer(tmp_filename, false, 2);
+  cached_consumer->setDataEncoding(CachedmzML::ENCODING_NUMPRESS_LINEAR, CachedmzML::ENCODING_NUMPRESS_SLOF);
+
+  MSExperiment<> exp;
+  MzMLFile().load(OPENMS_GET_TEST_DATA_PATH("MzMLFile_1.mzML"), exp);
+
+  cached_consumer->consumeSpectrum(exp.getSpectrum(0));
+  cached_consumer->consumeSpectrum(exp.getSpectrum(1));
+  cached_consumer->consumeChromatogram(exp.getChromatogram(0));
+  delete cached_consumer;
+
+  CachedmzML cache;
+  cache.createMemdumpIndex(tmp_filename);
+  TEST_EQUAL(cache.getFormatVersion(), 2)
+  TEST_EQUAL(cache.getSpectraIndex().size(), 2)
+  TEST_EQUAL(cache.getChromatogramIndex().size(), 1)
+
+  std::ifstream ifs_(tmp_filename.c_str(), std::ios::binary);
+  OpenSwath::BinaryDataArrayPtr mz_array(new OpenSwath::BinaryDataArray);
+  OpenSwath::BinaryDataArrayPtr intensity_array(new OpenSwath::BinaryDataArray);
+  int ms_level = -1;
+  double rt = -1.0;
+  ifs_.seekg(cache.getSpectraIndex()[1]);
+  CachedmzML::readSpectrumFast(mz_array, intensity_array, ifs_, ms_level, rt, 2);
+  TEST_EQUAL(mz_array->data.size(), exp.getSpectrum(1).size())
+  TEST_EQUAL(intensity_array->data.size(), exp.getSpectrum(1).size())
+  TEST_REAL_SIMILAR(rt, exp.getSpectrum(1).getRT())
+}
+END_SECTION
+
 START_SECTION((void consumeChromatogram(ChromatogramType & c)))
 {
   std::string tmp_filename;
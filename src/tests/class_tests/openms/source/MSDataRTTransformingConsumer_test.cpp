@@ -0,0 +1,158 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2013.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: Hannes Roest $
+// $Authors: Hannes Roest $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/CONCEPT/ClassTest.h>
+#include <OpenMS/test_config.h>
+
+///////////////////////////
+
+#include <OpenMS/FORMAT/DATAACCESS/MSDataRTTransformingConsumer.h>
+
+///////////////////////////
+
+#include <OpenMS/FORMAT/DATAACCESS/MSDataWritingConsumer.h>
+#include <OpenMS/FORMAT/MzMLFile.h>
+#include <OpenMS/ANALYSIS/MAPMATCHING/MapAlignmentTransformer.h>
+
+START_TEST(MSDataRTTransformingConsumer, "$Id$")
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+
+using namespace OpenMS;
+
+// f(x) = 2 * x + 1
+TransformationDescription trafo;
+Param params;
+params.setValue("slope", 2.0);
+params.setValue("intercept", 1.0);
+trafo.fitModel("linear", params);
+
+MSDataRTTransformingConsumer* transforming_consumer_ptr = 0;
+MSDataRTTransformingConsumer* transforming_consumer_nullPointer = 0;
+
+START_SECTION((MSDataRTTransformingConsumer(const TransformationDescription & trafo, Interfaces::IMSDataConsumer<> * next_consumer = 0)))
+  transforming_consumer_ptr = new MSDataRTTransformingConsumer(trafo);
+  TEST_NOT_EQUAL(transforming_consumer_ptr, transforming_consumer_nullPointer)
+END_SECTION
+
+START_SECTION((~MSDataRTTransformingConsumer()))
+  delete transforming_consumer_ptr;
+END_SECTION
+
+START_SECTION((void consumeSpectrum(SpectrumType & s)))
+{
+  MSExperiment<> exp;
+  MzMLFile().load(OPENMS_GET_TEST_DATA_PATH("MzMLFile_1.mzML"), exp);
+  TEST_EQUAL(exp.getNrSpectra() > 0, true)
+  MSSpectrum<> first_spectrum = exp.getSpectrum(0);
+
+  MSDataRTTransformingConsumer transforming_consumer(trafo);
+  transforming_consumer.setExpectedSize(2, 0);
+  transforming_consumer.consumeSpectrum(exp.getSpectrum(0));
+  TEST_REAL_SIMILAR(exp.getSpectrum(0).getRT(), 2 * first_spectrum.getRT() + 1)
+  TEST_EQUAL(exp.getSpectrum(0).size(), first_spectrum.size())
+
+  // the transformed spectrum is passed on:
+  MSDataRTTransformingConsumer next_consumer(trafo);
+  MSDataRTTransformingConsumer chained_consumer(trafo, &next_consumer);
+  exp.getSpectrum(1) = first_spectrum;
+  chained_consumer.consumeSpectrum(exp.getSpectrum(1));
+  TEST_REAL_SIMILAR(exp.getSpectrum(1).getRT(), 2 * (2 * first_spectrum.getRT() + 1) + 1)
+}
+END_SECTION
+
+START_SECTION((void consumeChromatogram(ChromatogramType & c)))
+{
+  MSExperiment<> exp;
+  MzMLFile().load(OPENMS_GET_TEST_DATA_PATH("MzMLFile_1.mzML"), exp);
+  TEST_EQUAL(exp.getNrChromatograms() > 0, true)
+  MSChromatogram<> first_chromatogram = exp.getChromatogram(0);
+  TEST_EQUAL(first_chromatogram.size() > 0, true)
+
+  MSDataRTTransformingConsumer transforming_consumer(trafo);
+  transforming_consumer.setExpectedSize(0, 1);
+  transforming_consumer.consumeChromatogram(exp.getChromatogram(0));
+  TEST_EQUAL(exp.getChromatogram(0).size(), first_chromatogram.size())
+  for (Size i = 0; i < first_chromatogram.size(); ++i)
+  {
+    TEST_REAL_SIMILAR(exp.getChromatogram(0)[i].getRT(), 2 * first_chromatogram[i].getRT() + 1)
+    TEST_REAL_SIMILAR(exp.getChromatogram(0)[i].getIntensity(), first_chromatogram[i].getIntensity())
+  }
+}
+END_SECTION
+
+START_SECTION((void setExpectedSize(Size expectedSpectra, Size expectedChromatograms)))
+  NOT_TESTABLE // tested above
+END_SECTION
+
+START_SECTION((void setExperimentalSettings(const ExperimentalSettings & exp)))
+  NOT_TESTABLE // tested below
+END_SECTION
+
+START_SECTION(([EXTRA] transforming a file while streaming))
+{
+  std::string tmp_filename;
+  NEW_TMP_FILE(tmp_filename);
+  {
+    PlainMSDataWritingConsumer writer(tmp_filename);
+    MSDataRTTransformingConsumer transforming_consumer(trafo, &writer);
+    MzMLFile().transform(OPENMS_GET_TEST_DATA_PATH("MzMLFile_1.mzML"), &transforming_consumer);
+  }
+
+  MSExperiment<> expected, streamed;
+  MzMLFile().load(OPENMS_GET_TEST_DATA_PATH("MzMLFile_1.mzML"), expected);
+  MapAlignmentTransformer::transformSinglePeakMap(expected, trafo);
+  MzMLFile().load(tmp_filename, streamed);
+
+  TEST_EQUAL(streamed.size(), expected.size())
+  for (Size i = 0; i < std::min(streamed.size(), expected.size()); ++i)
+  {
+    TEST_REAL_SIMILAR(streamed[i].getRT(), expected[i].getRT())
+  }
+  TEST_EQUAL(streamed.getChromatograms().size(), expected.getChromatograms().size())
+  for (Size i = 0; i < std::min(streamed.getChromatograms().size(), expected.getChromatograms().size()); ++i)
+  {
+    TEST_EQUAL(streamed.getChromatograms()[i].size(), expected.getChromatograms()[i].size())
+    if (!expected.getChromatograms()[i].empty())
+    {
+      TEST_REAL_SIMILAR(streamed.getChromatograms()[i][0].getRT(), expected.getChromatograms()[i][0].getRT())
+    }
+  }
+}
+END_SECTION
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+END_TEST
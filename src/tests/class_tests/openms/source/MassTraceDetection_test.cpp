@@ -65,7 +65,7 @@ END_SECTION
 
 MassTraceDetection test_mtd;
 
-START_SECTION((void updateIterativeWeightedMeanMZ(const double &, const double &, double &, double &, double &)))
+START_SECTION((void updateIterativeWeightedMeanMZ(const double &, const double &, double &, double &, double &) const))
 {
     double centroid_mz(150.22), centroid_int(25000000);
     double new_mz1(150.34), new_int1(23043030);
@@ -138,6 +138,34 @@ START_SECTION((void run(const MSExperiment< Peak1D > &, std::vector< MassTrace >
 }
 END_SECTION
 
+START_SECTION([EXTRA] run with interleaved MS2 spectra)
+{
+    // MS2 spectra must neither contribute peaks nor shift the apex scans
+    MSExperiment<Peak1D> mixed;
+    for (Size i = 0; i < input.size(); ++i)
+    {
+        mixed.addSpectrum(input[i]);
+
+        MSSpectrum<Peak1D> ms2 = input[i];
+        ms2.setMSLevel(2);
+        ms2.setRT(input[i].getRT() + 0.01);
+        mixed.addSpectrum(ms2);
+    }
+
+    std::vector<MassTrace> mixed_mt;
+    test_mtd.run(mixed, mixed_mt);
+
+    TEST_EQUAL(mixed_mt.size(), 3);
+
+    for (Size i = 0; i < mixed_mt.size(); ++i)
+    {
+        TEST_EQUAL(mixed_mt[i].getSize(), exp_mt_lengths[i]);
+        TEST_REAL_SIMILAR(mixed_mt[i].getCentroidRT(), exp_mt_rts[i]);
+        TEST_REAL_SIMILAR(mixed_mt[i].getCentroidMZ(), exp_mt_mzs[i]);
+    }
+}
+END_SECTION
+
 std::vector<MassTrace> filt;
 
 //START_SECTION((void filterByPeakWidth(std::vector< MassTrace > &, std::vector< MassTrace > &)))
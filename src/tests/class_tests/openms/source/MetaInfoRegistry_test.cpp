@@ -38,6 +38,7 @@
 ///////////////////////////
 
 #include <OpenMS/METADATA/MetaInfoRegistry.h>
+#include <set>
 
 ///////////////////////////
 
@@ -209,6 +210,42 @@ START_SECTION((MetaInfoRegistry& operator = (const MetaInfoRegistry& rhs)))
 	TEST_EQUAL(mir2.getUnit("retention time"),string("sec"))
 END_SECTION
 
+START_SECTION(([EXTRA] concurrent lookup and registration))
+	MetaInfoRegistry mir3;
+	const SignedSize nr_names = 2000;
+	Size errors = 0;
+	// all threads register and look up the same names concurrently
+#ifdef _OPENMP
+#pragma omp parallel for reduction(+: errors)
+#endif
+	for (SignedSize i = 0; i < 4 * nr_names; ++i)
+	{
+		String name = String("concurrent_name_") + String(i % nr_names);
+		UInt index = mir3.getIndex(name);
+		if (mir3.getName(index) != name || mir3.getIndex(name) != index)
+		{
+			++errors;
+		}
+	}
+	TEST_EQUAL(errors, 0)
+
+	// every name got exactly one index
+	std::set<UInt> indices;
+	for (SignedSize i = 0; i < nr_names; ++i)
+	{
+		indices.insert(mir3.getIndex(String("concurrent_name_") + String(i)));
+	}
+	TEST_EQUAL(indices.size(), nr_names)
+	TEST_EQUAL(*indices.begin(), 1024)
+	TEST_EQUAL(*indices.rbegin(), 1024 + nr_names - 1)
+	TEST_EQUAL(mir3.getName(1), "isotopic_range")
+
+	// copies contain all names
+	MetaInfoRegistry mir4(mir3);
+	TEST_EQUAL(mir4.getIndex("concurrent_name_1999"), mir3.getIndex("concurrent_name_1999"))
+	TEST_EQUAL(mir4.getName(mir3.getIndex("concurrent_name_7")), "concurrent_name_7")
+END_SECTION
+
 /////////////////////////////////////////////////////////////
 /////////////////////////////////////////////////////////////
 END_TEST
@@ -243,6 +243,37 @@ START_SECTION((void removeValue(const String& name)))
 	i.removeValue("icon");
 END_SECTION
 
+START_SECTION(([EXTRA] values are independent of insertion order))
+	// insert more values than are stored with exact growth
+	MetaInfo forward, backward;
+	for (UInt index = 1; index <= 40; ++index)
+	{
+		forward.setValue(index, DataValue((Int)index));
+		backward.setValue(41 - index, DataValue((Int)(41 - index)));
+	}
+	TEST_EQUAL(forward == backward, true)
+
+	std::vector<UInt> keys;
+	backward.getKeys(keys);
+	TEST_EQUAL(keys.size(), 40)
+	TEST_EQUAL(keys[0], 1)
+	TEST_EQUAL(keys[39], 40)
+	for (UInt index = 1; index <= 40; ++index)
+	{
+		TEST_EQUAL((Int)backward.getValue(index), (Int)index)
+	}
+
+	// overwrite and remove in the middle
+	backward.setValue(20, DataValue(String("twenty")));
+	backward.removeValue(21);
+	TEST_EQUAL(backward.getValue(20), "twenty")
+	TEST_EQUAL(backward.exists(21), false)
+	TEST_EQUAL(backward.getValue(21).isEmpty(), true)
+	TEST_EQUAL((Int)backward.getValue(22), 22)
+	backward.getKeys(keys);
+	TEST_EQUAL(keys.size(), 39)
+END_SECTION
+
 /////////////////////////////////////////////////////////////
 /////////////////////////////////////////////////////////////
 END_TEST
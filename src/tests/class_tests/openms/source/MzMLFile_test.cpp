@@ -39,6 +39,7 @@
 
 #include <OpenMS/FORMAT/MzMLFile.h>
 #include <OpenMS/FORMAT/FileTypes.h>
+#include <OpenMS/FORMAT/IndexedMzMLFile.h>
 #include <OpenMS/KERNEL/MSExperiment.h>
 
 using namespace OpenMS;
@@ -46,6 +47,53 @@ using namespace std;
 
 ///////////////////////////
 
+// records the order in which spectra and chromatograms arrive
+class OrderRecordingConsumer :
+  public Interfaces::IMSDataConsumer<>
+{
+public:
+  std::vector<String> native_ids;
+  std::vector<Size> sizes;
+
+  void consumeSpectrum(SpectrumType & s)
+  {
+    native_ids.push_back(s.getNativeID());
+    sizes.push_back(s.size());
+  }
+
+  void consumeChromatogram(ChromatogramType & c)
+  {
+    native_ids.push_back(c.getNativeID());
+    sizes.push_back(c.size());
+  }
+
+  void setExpectedSize(Size, Size) {}
+  void setExperimentalSettings(const ExperimentalSettings&) {}
+};
+
+// fails on the n-th spectrum it receives
+class FailingConsumer :
+  public OrderRecordingConsumer
+{
+public:
+  explicit FailingConsumer(Size fail_at) :
+    fail_at_(fail_at)
+  {
+  }
+
+  void consumeSpectrum(SpectrumType & s)
+  {
+    if (native_ids.size() == fail_at_)
+    {
+      throw Exception::IllegalArgument(__FILE__, __LINE__, __PRETTY_FUNCTION__, "consumer failure");
+    }
+    OrderRecordingConsumer::consumeSpectrum(s);
+  }
+
+private:
+  Size fail_at_;
+};
+
 DRange<1> makeRange(double a, double b)
 {
 	DPosition<1> pa(a), pb(b);
@@ -862,6 +910,50 @@ START_SECTION([EXTRA] load intensity range)
 	TEST_EQUAL(exp[3].size(),0)
 END_SECTION
 
+START_SECTION([EXTRA] transform delivers decoded data in file order)
+{
+  MSExperiment<> exp;
+  MzMLFile().load(OPENMS_GET_TEST_DATA_PATH("MzMLFile_1.mzML"), exp);
+
+  // small work stacks, such that several batches are decoded in parallel
+  for (Size pool_size = 1; pool_size <= 3; ++pool_size)
+  {
+    MzMLFile file;
+    file.getOptions().setMaxDataPoolSize(pool_size);
+    OrderRecordingConsumer consumer;
+    file.transform(OPENMS_GET_TEST_DATA_PATH("MzMLFile_1.mzML"), &consumer);
+
+    TEST_EQUAL(consumer.native_ids.size(), exp.size() + exp.getChromatograms().size())
+    for (Size i = 0; i < exp.size(); ++i)
+    {
+      TEST_EQUAL(consumer.native_ids[i], exp[i].getNativeID())
+      TEST_EQUAL(consumer.sizes[i], exp[i].size())
+    }
+    for (Size i = 0; i < exp.getChromatograms().size(); ++i)
+    {
+      TEST_EQUAL(consumer.native_ids[exp.size() + i], exp.getChromatograms()[i].getNativeID())
+      TEST_EQUAL(consumer.sizes[exp.size() + i], exp.getChromatograms()[i].size())
+    }
+
+    MSExperiment<> exp_pool;
+    file.load(OPENMS_GET_TEST_DATA_PATH("MzMLFile_1.mzML"), exp_pool);
+    TEST_EQUAL(exp_pool == exp, true)
+  }
+}
+END_SECTION
+
+START_SECTION([EXTRA] transform rethrows exceptions of the consumer)
+{
+  MzMLFile file;
+  file.getOptions().setMaxDataPoolSize(3);
+  FailingConsumer consumer(1);
+  // the exception reaches the caller with its own type
+  TEST_EXCEPTION_WITH_MESSAGE(Exception::IllegalArgument, file.transform(OPENMS_GET_TEST_DATA_PATH("MzMLFile_1.mzML"), &consumer), "consumer failure")
+  // nothing is handed on after the failure
+  TEST_EQUAL(consumer.native_ids.size(), 1)
+}
+END_SECTION
+
 START_SECTION((Size loadSize(const String & filename, Size& scount, Size& ccount)))
 {
   MzMLFile file;
@@ -963,6 +1055,50 @@ START_SECTION((template <typename MapType> void store(const String& filename, co
 
 END_SECTION
 
+START_SECTION([EXTRA] store encodes data in parallel and writes a valid index)
+{
+  MSExperiment<> exp_original;
+  MzMLFile().load(OPENMS_GET_TEST_DATA_PATH("MzMLFile_1.mzML"), exp_original);
+
+  // serial reference output
+  MzMLFile file;
+  file.getOptions().setWriteIndex(true);
+  file.getOptions().setMaxDataPoolSize(1);
+  std::string serial_filename;
+  NEW_TMP_FILE(serial_filename);
+  file.store(serial_filename, exp_original);
+
+  for (Size pool_size = 2; pool_size <= 4; ++pool_size)
+  {
+    file.getOptions().setMaxDataPoolSize(pool_size);
+    std::string tmp_filename;
+    NEW_TMP_FILE(tmp_filename);
+    file.store(tmp_filename, exp_original);
+
+    // the output does not depend on the number of elements encoded in parallel
+    TEST_FILE_EQUAL(tmp_filename.c_str(), serial_filename.c_str())
+
+    MSExperiment<> exp;
+    file.load(tmp_filename, exp);
+    TEST_EQUAL(exp == exp_original, true)
+
+    // the index offsets point to the spectra and chromatograms
+    IndexedMzMLFile indexed(tmp_filename);
+    TEST_EQUAL(indexed.getParsingSuccess(), true)
+    TEST_EQUAL(indexed.getNrSpectra(), exp_original.size())
+    TEST_EQUAL(indexed.getNrChromatograms(), exp_original.getChromatograms().size())
+    for (Size i = 0; i < exp_original.size(); ++i)
+    {
+      TEST_EQUAL(indexed.getSpectrumById((int)i)->getMZArray()->data.size(), exp_original[i].size())
+    }
+    for (Size i = 0; i < exp_original.getChromatograms().size(); ++i)
+    {
+      TEST_EQUAL(indexed.getChromatogramById((int)i)->getTimeArray()->data.size(), exp_original.getChromatograms()[i].size())
+    }
+  }
+}
+END_SECTION
+
 START_SECTION(bool isValid(const String& filename, std::ostream& os = std::cerr))
 	std::string tmp_filename;
   MzMLFile file;
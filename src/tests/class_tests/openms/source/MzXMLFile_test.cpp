@@ -41,6 +41,13 @@
 #include <OpenMS/FORMAT/FileTypes.h>
 #include <OpenMS/KERNEL/MSExperiment.h>
 #include <OpenMS/KERNEL/StandardTypes.h>
+#include <OpenMS/FORMAT/Base64.h>
+
+#include <fstream>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 using namespace OpenMS;
 using namespace std;
@@ -332,6 +339,69 @@ START_SECTION((template<typename MapType> void load(const String& filename, MapT
 	TEST_EQUAL(zlib==none,true)
 END_SECTION
 
+START_SECTION(([EXTRA] load zlib compressed data with several threads))
+{
+	// many compressed scans, so that all threads decode concurrently
+	const Size scan_count = 200;
+	const Size peak_count = 500;
+	String filename;
+	NEW_TMP_FILE(filename)
+	{
+		ofstream out(filename.c_str());
+		out << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+		    << "<mzXML xmlns=\"http://sashimi.sourceforge.net/schema_revision/mzXML_2.1\">\n"
+		    << "<msRun>\n<parentFile fileSha1=\"\" fileType=\"\" fileName=\"\"/>\n"
+		    << "<dataProcessing><software type=\"\" name=\"\" version=\"\"/></dataProcessing>\n";
+		Base64 encoder;
+		for (Size s = 0; s < scan_count; ++s)
+		{
+			std::vector<float> data;
+			for (Size p = 0; p < peak_count; ++p)
+			{
+				data.push_back(100.0f + p);
+				data.push_back((float)(s * peak_count + p));
+			}
+			String encoded;
+			encoder.encode(data, Base64::BYTEORDER_BIGENDIAN, encoded, true);
+			out << "<scan num=\"" << s + 1 << "\" peaksCount=\"" << peak_count << "\" msLevel=\"1\">\n"
+			    << "<peaks precision=\"32\" byteOrder=\"network\" pairOrder=\"m/z-int\" compressionType=\"zlib\">" << encoded << "</peaks>\n"
+			    << "</scan>\n";
+		}
+		out << "</msRun>\n<indexOffset>0</indexOffset>\n</mzXML>\n";
+	}
+
+	MzXMLFile file;
+	MSExperiment<> exp;
+#ifdef _OPENMP
+	int threads = omp_get_max_threads();
+	omp_set_num_threads(std::max(threads, 4));
+#endif
+	file.load(filename, exp);
+#ifdef _OPENMP
+	omp_set_num_threads(threads);
+#endif
+
+	TEST_EQUAL(exp.size(), scan_count)
+	Size wrong_peaks = 0;
+	for (Size s = 0; s < exp.size(); ++s)
+	{
+		if (exp[s].size() != peak_count)
+		{
+			wrong_peaks += peak_count;
+			continue;
+		}
+		for (Size p = 0; p < peak_count; ++p)
+		{
+			if (exp[s][p].getMZ() != 100.0 + p || exp[s][p].getIntensity() != (float)(s * peak_count + p))
+			{
+				++wrong_peaks;
+			}
+		}
+	}
+	TEST_EQUAL(wrong_peaks, 0)
+}
+END_SECTION
+
 START_SECTION(([EXTRA] load with metadata only flag))
 	TOLERANCE_ABSOLUTE(0.01)
 
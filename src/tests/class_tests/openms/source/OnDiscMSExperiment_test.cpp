@@ -167,6 +167,19 @@ START_SECTION((boost::shared_ptr<const ExperimentalSettings> getExperimentalSett
 }
 END_SECTION
 
+START_SECTION((boost::shared_ptr<const MSExperiment<> > getMetaData() const))
+{
+  OnDiscMSExperiment<> tmp(OPENMS_GET_TEST_DATA_PATH("IndexedmzMLFile_1.mzML"));
+  boost::shared_ptr<const MSExperiment<> > meta = tmp.getMetaData();
+
+  TEST_EQUAL(meta->size(), tmp.size())
+  TEST_EQUAL(meta->getChromatograms().size(), tmp.getNrChromatograms())
+  // meta data only, no peaks are loaded
+  TEST_EQUAL((*meta)[0].size(), 0)
+  TEST_EQUAL((*meta)[0].getMSLevel(), tmp.getSpectrum(0).getMSLevel())
+}
+END_SECTION
+
 START_SECTION((MSSpectrum<PeakT> operator[] (Size n) const))
 {
   OnDiscMSExperiment<> tmp(OPENMS_GET_TEST_DATA_PATH("IndexedmzMLFile_1.mzML"));
@@ -222,6 +235,31 @@ START_SECTION(OpenMS::Interfaces::ChromatogramPtr getChromatogramById(Size id))
 }
 END_SECTION
 
+START_SECTION([EXTRA] concurrent access to spectra and chromatograms)
+{
+  OnDiscMSExperiment<> tmp(OPENMS_GET_TEST_DATA_PATH("IndexedmzMLFile_1.mzML"));
+
+  // read each item many times from multiple threads, all reads have to return the full data
+  const SignedSize nr_reads = 100;
+  std::vector<Size> spectrum_sizes(nr_reads, 0);
+  std::vector<Size> chromatogram_sizes(nr_reads, 0);
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+  for (SignedSize i = 0; i < nr_reads; ++i)
+  {
+    spectrum_sizes[i] = tmp.getSpectrum(i % tmp.size()).size();
+    chromatogram_sizes[i] = tmp.getChromatogramById(0)->getTimeArray()->data.size();
+  }
+
+  for (SignedSize i = 0; i < nr_reads; ++i)
+  {
+    TEST_EQUAL(spectrum_sizes[i], tmp.getSpectrum(i % tmp.size()).size())
+    TEST_EQUAL(chromatogram_sizes[i], 48)
+  }
+}
+END_SECTION
+
 
 /////////////////////////////////////////////////////////////
 /////////////////////////////////////////////////////////////
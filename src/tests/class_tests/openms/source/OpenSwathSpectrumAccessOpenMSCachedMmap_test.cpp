@@ -0,0 +1,260 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry               
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2013.
+// 
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution 
+//    may be used to endorse or promote products derived from this software 
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS. 
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING 
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, 
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, 
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; 
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, 
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR 
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF 
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+// 
+// --------------------------------------------------------------------------
+// $Maintainer: Hannes Roest $
+// $Authors: Hannes Roest $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/CONCEPT/ClassTest.h>
+#include <OpenMS/test_config.h>
+
+///////////////////////////
+#include <OpenMS/ANALYSIS/OPENSWATH/DATAACCESS/SpectrumAccessOpenMSCachedMmap.h>
+///////////////////////////
+
+#include <OpenMS/FORMAT/CachedMzML.h>
+#include <OpenMS/FORMAT/MzMLFile.h>
+
+using namespace OpenMS;
+using namespace std;
+
+START_TEST(SpectrumAccessOpenMSCachedMmap, "$Id$")
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+
+// Create a single cached file (meta data + binary data) and use it for all tests
+MSExperiment<> exp;
+MzMLFile().load(OPENMS_GET_TEST_DATA_PATH("MzMLFile_1.mzML"), exp);
+std::string tmp_filename;
+NEW_TMP_FILE(tmp_filename);
+{
+  CachedmzML cache;
+  cache.writeMemdump(exp, tmp_filename + ".cached");
+  cache.writeMetadata(exp, tmp_filename, true);
+}
+
+SpectrumAccessOpenMSCachedMmap* ptr = 0;
+SpectrumAccessOpenMSCachedMmap* nullPointer = 0;
+
+START_SECTION(SpectrumAccessOpenMSCachedMmap(String filename))
+{
+  ptr = new SpectrumAccessOpenMSCachedMmap(tmp_filename);
+  TEST_NOT_EQUAL(ptr, nullPointer)
+
+  std::string unused_tmp_filename;
+  NEW_TMP_FILE(unused_tmp_filename);
+  TEST_EXCEPTION(Exception::FileNotFound, SpectrumAccessOpenMSCachedMmap failing_access(unused_tmp_filename))
+
+  // the meta data file is not a cached file (wrong magic number)
+  std::string wrong_tmp_filename;
+  NEW_TMP_FILE(wrong_tmp_filename);
+  MzMLFile().store(wrong_tmp_filename + ".cached", exp);
+  TEST_EXCEPTION(Exception::ParseError, SpectrumAccessOpenMSCachedMmap failing_access(wrong_tmp_filename))
+}
+END_SECTION
+
+START_SECTION(~SpectrumAccessOpenMSCachedMmap())
+{
+  delete ptr;
+}
+END_SECTION
+
+SpectrumAccessOpenMSCachedMmap access(tmp_filename);
+
+START_SECTION(size_t getNrSpectra() const)
+{
+  TEST_EQUAL(access.getNrSpectra(), 4)
+}
+END_SECTION
+
+START_SECTION(size_t getNrChromatograms() const)
+{
+  TEST_EQUAL(access.getNrChromatograms(), 2)
+}
+END_SECTION
+
+START_SECTION(OpenSwath::SpectrumPtr getSpectrumById(int id))
+{
+  for (Size k = 0; k < exp.size(); k++)
+  {
+    OpenSwath::SpectrumPtr sptr = access.getSpectrumById(k);
+    TEST_EQUAL(sptr->getMZArray()->data.size(), exp[k].size())
+    TEST_EQUAL(sptr->getIntensityArray()->data.size(), exp[k].size())
+    for (Size i = 0; i < exp[k].size(); i++)
+    {
+      TEST_REAL_SIMILAR(sptr->getMZArray()->data[i], exp[k][i].getMZ())
+      TEST_REAL_SIMILAR(sptr->getIntensityArray()->data[i], exp[k][i].getIntensity())
+    }
+  }
+}
+END_SECTION
+
+START_SECTION(OpenSwath::ChromatogramPtr getChromatogramById(int id))
+{
+  for (Size k = 0; k < exp.getChromatograms().size(); k++)
+  {
+    OpenSwath::ChromatogramPtr cptr = access.getChromatogramById(k);
+    TEST_EQUAL(cptr->getTimeArray()->data.size(), exp.getChromatogram(k).size())
+    TEST_EQUAL(cptr->getIntensityArray()->data.size(), exp.getChromatogram(k).size())
+    for (Size i = 0; i < exp.getChromatogram(k).size(); i++)
+    {
+      TEST_REAL_SIMILAR(cptr->getTimeArray()->data[i], exp.getChromatogram(k)[i].getRT())
+      TEST_REAL_SIMILAR(cptr->getIntensityArray()->data[i], exp.getChromatogram(k)[i].getIntensity())
+    }
+  }
+}
+END_SECTION
+
+START_SECTION(DataView getSpectrumViewById(int id) const)
+{
+  SpectrumAccessOpenMSCachedMmap::DataView view = access.getSpectrumViewById(0);
+  TEST_EQUAL(view.size, exp[0].size())
+  TEST_EQUAL(view.ms_level, 1)
+  TEST_REAL_SIMILAR(view.rt, 5.1)
+  for (Size i = 0; i < view.size; i++)
+  {
+    TEST_REAL_SIMILAR(view.getFirst(i), exp[0][i].getMZ())
+    TEST_REAL_SIMILAR(view.getSecond(i), exp[0][i].getIntensity())
+  }
+
+  std::vector<double> mz, intensity;
+  view.copyTo(mz, intensity);
+  TEST_EQUAL(mz.size(), exp[0].size())
+  TEST_EQUAL(intensity.size(), exp[0].size())
+}
+END_SECTION
+
+START_SECTION(DataView getChromatogramViewById(int id) const)
+{
+  SpectrumAccessOpenMSCachedMmap::DataView view = access.getChromatogramViewById(1);
+  TEST_EQUAL(view.size, exp.getChromatogram(1).size())
+  TEST_EQUAL(view.ms_level, -1)
+  for (Size i = 0; i < view.size; i++)
+  {
+    TEST_REAL_SIMILAR(view.getFirst(i), exp.getChromatogram(1)[i].getRT())
+    TEST_REAL_SIMILAR(view.getSecond(i), exp.getChromatogram(1)[i].getIntensity())
+  }
+}
+END_SECTION
+
+START_SECTION([EXTRA] concurrent access)
+{
+  // all threads read all spectra at the same time, no synchronisation needed
+  std::vector<Size> sizes(100, 0);
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+  for (SignedSize k = 0; k < (SignedSize)sizes.size(); k++)
+  {
+    OpenSwath::SpectrumPtr sptr = access.getSpectrumById(k % 4);
+    sizes[k] = sptr->getMZArray()->data.size();
+  }
+  for (Size k = 0; k < sizes.size(); k++)
+  {
+    TEST_EQUAL(sizes[k], exp[k % 4].size())
+  }
+}
+END_SECTION
+
+START_SECTION([EXTRA] format version 2)
+{
+  std::string tmp_filename_v2;
+  NEW_TMP_FILE(tmp_filename_v2);
+  {
+    CachedmzML cache;
+    cache.setFormatVersion(2);
+    cache.setDataEncoding(CachedmzML::ENCODING_FLOAT64, CachedmzML::ENCODING_FLOAT32);
+    cache.writeMemdump(exp, tmp_filename_v2 + ".cached");
+    cache.writeMetadata(exp, tmp_filename_v2, true);
+  }
+
+  SpectrumAccessOpenMSCachedMmap access_v2(tmp_filename_v2);
+  TEST_EQUAL(access_v2.getNrSpectra(), 4)
+  TEST_EQUAL(access_v2.getNrChromatograms(), 2)
+
+  SpectrumAccessOpenMSCachedMmap::DataView view = access_v2.getSpectrumViewById(1);
+  TEST_EQUAL(view.size, exp[1].size())
+  TEST_EQUAL(view.encoding_first, CachedmzML::ENCODING_FLOAT64)
+  TEST_EQUAL(view.encoding_second, CachedmzML::ENCODING_FLOAT32)
+  TEST_REAL_SIMILAR(view.rt, exp[1].getRT())
+  for (Size i = 0; i < view.size; i++)
+  {
+    TEST_REAL_SIMILAR(view.getFirst(i), exp[1][i].getMZ())
+    TEST_REAL_SIMILAR(view.getSecond(i), exp[1][i].getIntensity())
+  }
+
+  OpenSwath::ChromatogramPtr cptr = access_v2.getChromatogramById(1);
+  TEST_EQUAL(cptr->getTimeArray()->data.size(), exp.getChromatogram(1).size())
+  for (Size i = 0; i < cptr->getTimeArray()->data.size(); i++)
+  {
+    TEST_REAL_SIMILAR(cptr->getTimeArray()->data[i], exp.getChromatogram(1)[i].getRT())
+  }
+}
+END_SECTION
+
+START_SECTION(OpenSwath::SpectrumMeta getSpectrumMetaById(int id) const)
+{
+  OpenSwath::SpectrumMeta meta = access.getSpectrumMetaById(0);
+  TEST_REAL_SIMILAR(meta.RT, 5.1)
+  TEST_EQUAL(meta.ms_level, 1)
+}
+END_SECTION
+
+START_SECTION(std::vector<std::size_t> getSpectraByRT(double RT, double deltaRT) const)
+{
+  std::vector<std::size_t> result = access.getSpectraByRT(5.1, 0.05);
+  TEST_EQUAL(result.size(), 1)
+  TEST_EQUAL(result[0], 0)
+  TEST_EQUAL(access.getSpectraByRT(1e6, 1.0).size(), 0)
+}
+END_SECTION
+
+START_SECTION(SpectrumSettings getSpectraMetaInfo(int id) const)
+{
+  TEST_EQUAL(access.getSpectraMetaInfo(0).getNativeID(), exp[0].getNativeID())
+}
+END_SECTION
+
+START_SECTION(ChromatogramSettings getChromatogramMetaInfo(int id) const)
+{
+  TEST_EQUAL(access.getChromatogramMetaInfo(0).getNativeID(), exp.getChromatogram(0).getNativeID())
+}
+END_SECTION
+
+START_SECTION(std::string getChromatogramNativeID(int id) const)
+{
+  TEST_EQUAL(access.getChromatogramNativeID(0), exp.getChromatogram(0).getNativeID())
+}
+END_SECTION
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+END_TEST
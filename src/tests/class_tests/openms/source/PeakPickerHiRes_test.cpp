@@ -35,6 +35,7 @@
 #include <OpenMS/CONCEPT/ClassTest.h>
 #include <OpenMS/test_config.h>
 #include <OpenMS/FORMAT/MzMLFile.h>
+#include <OpenMS/KERNEL/OnDiscMSExperiment.h>
 
 ///////////////////////////
 #include <OpenMS/TRANSFORMATIONS/RAW2PEAK/PeakPickerHiRes.h>
@@ -146,6 +147,81 @@ START_SECTION((template < typename PeakType > void pick(const MSSpectrum< PeakTy
 
 END_SECTION
 
+START_SECTION((void pick(const std::vector<double> & mz_array, const std::vector<double> & int_array, std::vector<double> & mz_out, std::vector<double> & int_out, std::vector<PeakBoundary> & boundaries) const))
+{
+  std::vector<double> mz_array, int_array;
+  for (Size i = 0; i < input[0].size(); ++i)
+  {
+    mz_array.push_back(input[0][i].getMZ());
+    int_array.push_back(input[0][i].getIntensity());
+  }
+
+  // same result as picking the spectrum
+  MSSpectrum<Peak1D> tmp_spec;
+  std::vector<PeakPickerHiRes::PeakBoundary> tmp_boundaries;
+  pp_hires.pick(input[0], tmp_spec, tmp_boundaries);
+
+  std::vector<double> mz_out, int_out;
+  std::vector<PeakPickerHiRes::PeakBoundary> boundaries;
+  pp_hires.pick(mz_array, int_array, mz_out, int_out, boundaries);
+  TEST_EQUAL(mz_out.size(), tmp_spec.size())
+  TEST_EQUAL(int_out.size(), tmp_spec.size())
+  TEST_EQUAL(boundaries.size(), tmp_boundaries.size())
+  for (Size peak_idx = 0; peak_idx < mz_out.size(); ++peak_idx)
+  {
+    TEST_EQUAL(mz_out[peak_idx], tmp_spec[peak_idx].getMZ())
+    TEST_EQUAL(int_out[peak_idx], tmp_spec[peak_idx].getIntensity())
+    TEST_EQUAL(boundaries[peak_idx].mz_min, tmp_boundaries[peak_idx].mz_min)
+    TEST_EQUAL(boundaries[peak_idx].mz_max, tmp_boundaries[peak_idx].mz_max)
+  }
+
+  // outputs are overwritten
+  pp_hires.pick(mz_array, int_array, mz_out, int_out, boundaries);
+  TEST_EQUAL(mz_out.size(), tmp_spec.size())
+  TEST_EQUAL(boundaries.size(), tmp_boundaries.size())
+
+  // too few data points
+  std::vector<double> few(4, 1.0);
+  pp_hires.pick(few, few, mz_out, int_out, boundaries);
+  TEST_EQUAL(mz_out.size(), 0)
+  TEST_EQUAL(boundaries.size(), 0)
+
+  int_array.pop_back();
+  TEST_EXCEPTION(Exception::IllegalArgument, pp_hires.pick(mz_array, int_array, mz_out, int_out, boundaries))
+}
+END_SECTION
+
+START_SECTION([EXTRA] pick without signal-to-noise estimates)
+{
+  // the S/N estimator gives no estimates for a negative maximal intensity (here: the 0th percentile),
+  // which means S/N = 0 for all data points, so nothing is picked
+  PeakPickerHiRes pp_no_snt;
+  Param p = pp_no_snt.getParameters();
+  p.setValue("signal_to_noise", 1.0);
+  p.setValue("SignalToNoise:auto_mode", 1);
+  p.setValue("SignalToNoise:auto_max_percentile", 0);
+  pp_no_snt.setParameters(p);
+
+  MSSpectrum<Peak1D> tmp_spec;
+  std::vector<PeakPickerHiRes::PeakBoundary> tmp_boundaries;
+  pp_no_snt.pick(input[0], tmp_spec, tmp_boundaries);
+  TEST_EQUAL(tmp_spec.size(), 0)
+  TEST_EQUAL(tmp_boundaries.size(), 0)
+  TEST_EQUAL(tmp_spec.getRT(), input[0].getRT())
+
+  std::vector<double> mz_array, int_array, mz_out, int_out;
+  for (Size i = 0; i < input[0].size(); ++i)
+  {
+    mz_array.push_back(input[0][i].getMZ());
+    int_array.push_back(input[0][i].getIntensity());
+  }
+  pp_no_snt.pick(mz_array, int_array, mz_out, int_out, tmp_boundaries);
+  TEST_EQUAL(mz_out.size(), 0)
+  TEST_EQUAL(int_out.size(), 0)
+  TEST_EQUAL(tmp_boundaries.size(), 0)
+}
+END_SECTION
+
 START_SECTION([EXTRA](template <typename PeakType> void pickExperiment(const MSExperiment<PeakType>& input, MSExperiment<PeakType>& output)))
     // does the same as pick method for spectra
     NOT_TESTABLE
@@ -381,6 +457,37 @@ END_SECTION
 inRich.clear(true);
 outRich.clear(true);
 
+START_SECTION((template < typename PeakType, typename ChromatogramPeakT > void pickExperiment(OnDiscMSExperiment< PeakType, ChromatogramPeakT > &input, MSExperiment< PeakType, ChromatogramPeakT > &output) const))
+{
+  // picking on disc (in parallel) has to give the same result as picking in memory
+  PeakPickerHiRes pp;
+  MSExperiment<Peak1D> in_memory, out_memory, out_disc;
+  MzMLFile().load(OPENMS_GET_TEST_DATA_PATH("IndexedmzMLFile_1.mzML"), in_memory);
+  pp.pickExperiment(in_memory, out_memory);
+
+  OnDiscMSExperiment<Peak1D, ChromatogramPeak> on_disc(OPENMS_GET_TEST_DATA_PATH("IndexedmzMLFile_1.mzML"));
+  pp.pickExperiment(on_disc, out_disc);
+
+  TEST_EQUAL(out_disc.size(), out_memory.size())
+  TEST_EQUAL(out_disc.getChromatograms().size(), out_memory.getChromatograms().size())
+  for (Size scan_idx = 0; scan_idx < out_disc.size(); ++scan_idx)
+  {
+    TEST_EQUAL(out_disc[scan_idx].getNativeID(), out_memory[scan_idx].getNativeID())
+    TEST_EQUAL(out_disc[scan_idx].size(), out_memory[scan_idx].size())
+    for (Size peak_idx = 0; peak_idx < out_disc[scan_idx].size(); ++peak_idx)
+    {
+      TEST_REAL_SIMILAR(out_disc[scan_idx][peak_idx].getMZ(), out_memory[scan_idx][peak_idx].getMZ())
+      TEST_REAL_SIMILAR(out_disc[scan_idx][peak_idx].getIntensity(), out_memory[scan_idx][peak_idx].getIntensity())
+    }
+  }
+  for (Size chrom_idx = 0; chrom_idx < out_disc.getChromatograms().size(); ++chrom_idx)
+  {
+    TEST_EQUAL(out_disc.getChromatograms()[chrom_idx].getNativeID(), out_memory.getChromatograms()[chrom_idx].getNativeID())
+    TEST_EQUAL(out_disc.getChromatograms()[chrom_idx].size(), out_memory.getChromatograms()[chrom_idx].size())
+  }
+}
+END_SECTION
+
 /////////////////////////////////////////////////////////////
 /////////////////////////////////////////////////////////////
 
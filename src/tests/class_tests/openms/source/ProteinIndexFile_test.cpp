@@ -0,0 +1,192 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2013.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: Chris Bielow $
+// $Authors: Chris Bielow $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/CONCEPT/ClassTest.h>
+#include <OpenMS/test_config.h>
+
+///////////////////////////
+#include <OpenMS/FORMAT/ProteinIndexFile.h>
+///////////////////////////
+
+#include <OpenMS/FORMAT/FASTAFile.h>
+#include <OpenMS/SYSTEM/File.h>
+
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <vector>
+
+using namespace OpenMS;
+using namespace std;
+
+START_TEST(ProteinIndexFile, "$Id$")
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+
+ProteinIndexFile* ptr = 0;
+ProteinIndexFile* nullPointer = 0;
+START_SECTION((ProteinIndexFile()))
+  ptr = new ProteinIndexFile();
+  TEST_NOT_EQUAL(ptr, nullPointer)
+  TEST_EQUAL(ptr->size(), 0)
+END_SECTION
+
+START_SECTION((~ProteinIndexFile()))
+  delete ptr;
+END_SECTION
+
+const String fasta_file = OPENMS_GET_TEST_DATA_PATH("FASTAFile_test.fasta");
+vector<FASTAFile::FASTAEntry> proteins;
+FASTAFile().load(fasta_file, proteins);
+
+String index_file;
+NEW_TMP_FILE(index_file);
+
+START_SECTION((static void store(const String& filename, const String& fasta_file, UInt flag = 0)))
+  TEST_EXCEPTION(Exception::FileNotFound, ProteinIndexFile::store(index_file, "ProteinIndexFile_test_this_file_does_not_exist"))
+  TEST_EXCEPTION(Exception::UnableToCreateFile, ProteinIndexFile::store("/bla/bluff/blblb/sdfhsdjf/test.idx", fasta_file))
+  ProteinIndexFile::store(index_file, fasta_file, 1);
+  TEST_EQUAL(File::exists(index_file), true)
+END_SECTION
+
+START_SECTION((void load(const String& filename)))
+  ProteinIndexFile index;
+  TEST_EXCEPTION(Exception::FileNotFound, index.load("ProteinIndexFile_test_this_file_does_not_exist"))
+  TEST_EXCEPTION(Exception::ParseError, index.load(fasta_file))
+  index.load(index_file);
+  TEST_EQUAL(index.size(), proteins.size())
+
+  // a failed load leaves no index loaded
+  TEST_EXCEPTION(Exception::ParseError, index.load(fasta_file))
+  TEST_EQUAL(index.size(), 0)
+  TEST_EQUAL(index.isUpToDate(fasta_file, 1), false)
+
+  // corrupt indices are rejected on loading, not when accessing proteins
+  ifstream in(index_file.c_str(), ios::binary);
+  const string content((istreambuf_iterator<char>(in)), istreambuf_iterator<char>());
+  in.close();
+  UInt64 offset_pos;
+  memcpy(&offset_pos, content.data() + 56, sizeof(UInt64));
+
+  string corrupt_count = content;
+  const UInt64 huge_count = UInt64(1) << 61; // the table size overflows to 8 bytes
+  memcpy(&corrupt_count[32], &huge_count, sizeof(UInt64));
+
+  string corrupt_offset = content;
+  const UInt64 huge_offset = ~UInt64(0);
+  memcpy(&corrupt_offset[offset_pos + sizeof(UInt64)], &huge_offset, sizeof(UInt64)); // end of the first sequence
+
+  const string corrupt[2] = {corrupt_count, corrupt_offset};
+  for (Size i = 0; i < 2; ++i)
+  {
+    String corrupt_file;
+    NEW_TMP_FILE(corrupt_file);
+    ofstream out(corrupt_file.c_str(), ios::binary);
+    out.write(corrupt[i].data(), corrupt[i].size());
+    out.close();
+    TEST_EXCEPTION(Exception::ParseError, index.load(corrupt_file))
+    TEST_EQUAL(index.size(), 0)
+  }
+END_SECTION
+
+START_SECTION((String getStamp() const))
+  ProteinIndexFile index;
+  TEST_EQUAL(index.getStamp(), "")
+  index.load(index_file);
+  String stamp = index.getStamp();
+  TEST_EQUAL(stamp.hasSuffix("_1"), true)
+  String other_index;
+  NEW_TMP_FILE(other_index);
+  ProteinIndexFile::store(other_index, fasta_file, 0);
+  ProteinIndexFile other;
+  other.load(other_index);
+  TEST_NOT_EQUAL(other.getStamp(), stamp)
+END_SECTION
+
+START_SECTION((Size size() const))
+  NOT_TESTABLE // tested above
+END_SECTION
+
+START_SECTION((UInt getFlag() const))
+  ProteinIndexFile index;
+  index.load(index_file);
+  TEST_EQUAL(index.getFlag(), 1)
+END_SECTION
+
+START_SECTION((bool isUpToDate(const String& fasta_file, UInt flag = 0) const))
+  ProteinIndexFile index;
+  TEST_EQUAL(index.isUpToDate(fasta_file, 1), false) // nothing loaded
+  index.load(index_file);
+  TEST_EQUAL(index.isUpToDate(fasta_file, 1), true)
+  TEST_EQUAL(index.isUpToDate(fasta_file, 0), false)
+  TEST_EQUAL(index.isUpToDate(OPENMS_GET_TEST_DATA_PATH("FASTAFile_test_this_file_does_not_exist"), 1), false)
+END_SECTION
+
+START_SECTION((String getAccession(Size index) const))
+  ProteinIndexFile index;
+  index.load(index_file);
+  for (Size i = 0; i < proteins.size(); ++i)
+  {
+    TEST_EQUAL(index.getAccession(i), proteins[i].identifier)
+  }
+  TEST_EXCEPTION(Exception::IndexOverflow, index.getAccession(proteins.size()))
+END_SECTION
+
+START_SECTION((String getSequence(Size index) const))
+  ProteinIndexFile index;
+  index.load(index_file);
+  for (Size i = 0; i < proteins.size(); ++i)
+  {
+    TEST_EQUAL(index.getSequence(i), proteins[i].sequence.remove('*'))
+  }
+  TEST_EXCEPTION(Exception::IndexOverflow, index.getSequence(proteins.size()))
+END_SECTION
+
+START_SECTION((const char* getSequence(Size index, Size& length) const))
+  ProteinIndexFile index;
+  index.load(index_file);
+  Size length(0);
+  const char* sequence = index.getSequence(0, length);
+  TEST_EQUAL(length, proteins[0].sequence.size())
+  TEST_EQUAL(String(std::string(sequence, length)), proteins[0].sequence)
+  // a second index on the same file maps the same content
+  ProteinIndexFile index2;
+  index2.load(index_file);
+  TEST_EQUAL(index2.getSequence(proteins.size() - 1), index.getSequence(proteins.size() - 1))
+END_SECTION
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+END_TEST
@@ -37,6 +37,8 @@
 #include <OpenMS/KERNEL/StandardTypes.h>
 #include <OpenMS/KERNEL/ConsensusMap.h>
 
+#include <set>
+
 ///////////////////////////
 #include <OpenMS/ANALYSIS/MAPMATCHING/QTClusterFinder.h>
 ///////////////////////////
@@ -251,6 +253,51 @@ START_SECTION((void run(const std::vector<FeatureMap<> >& input_maps, ConsensusM
 }
 END_SECTION
 
+START_SECTION(([EXTRA] void run(const std::vector<FeatureMap<> >& input_maps, ConsensusMap& result_map)))
+{
+  // many overlapping clusters: every feature must be linked exactly once and
+  // the clusters must be extracted in the order of their quality
+  vector<FeatureMap<> > input(4);
+  for (Size map_index = 0; map_index < input.size(); ++map_index)
+  {
+    for (Size i = 0; i < 300; ++i)
+    {
+      Feature feat;
+      feat.setRT(2.0 * i + 0.3 * map_index + 0.1 * (i % 3));
+      feat.setMZ(400.0 + 0.01 * (i % 7) + 0.02 * map_index);
+      feat.setIntensity(1000.0 + 10.0 * i);
+      feat.setUniqueId(i);
+      input[map_index].push_back(feat);
+    }
+    input[map_index].updateRanges();
+  }
+
+  QTClusterFinder finder;
+  Param param = finder.getDefaults();
+  param.setValue("distance_RT:max_difference", 5.0);
+  param.setValue("distance_MZ:max_difference", 0.1);
+  finder.setParameters(param);
+  ConsensusMap result;
+  finder.run(input, result);
+
+  Size num_handles = 0;
+  set<pair<UInt64, UInt64> > linked;
+  bool sorted = true;
+  for (Size i = 0; i < result.size(); ++i)
+  {
+    if (i > 0 && result[i].getQuality() > result[i - 1].getQuality()) sorted = false;
+    for (ConsensusFeature::HandleSetType::const_iterator it = result[i].begin(); it != result[i].end(); ++it)
+    {
+      linked.insert(make_pair(it->getMapIndex(), it->getUniqueId()));
+      ++num_handles;
+    }
+  }
+  TEST_EQUAL(num_handles, 1200)
+  TEST_EQUAL(linked.size(), 1200)
+  TEST_EQUAL(sorted, true)
+}
+END_SECTION
+
 START_SECTION((void run(const std::vector<ConsensusMap>& input_maps, ConsensusMap& result_map)))
 {
 	NOT_TESTABLE; // same as "run" for feature maps (tested above)
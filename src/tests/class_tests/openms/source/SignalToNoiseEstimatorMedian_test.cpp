@@ -114,6 +114,40 @@ START_SECTION([EXTRA](virtual void init(const PeakIterator& it_begin, const Peak
 
 END_SECTION
 
+START_SECTION([EXTRA](double getSignalToNoiseAt(Size index)))
+{
+  MSSpectrum < > raw_data;
+  DTAFile dta_file;
+  dta_file.load(OPENMS_GET_TEST_DATA_PATH("SignalToNoiseEstimator_test.dta"), raw_data);
+
+  SignalToNoiseEstimatorMedian< MSSpectrum < > > sne;
+  Param p;
+  p.setValue("win_len", 40.0);
+  p.setValue("noise_for_empty_window", 2.0);
+  p.setValue("min_required_elements", 10);
+  sne.setParameters(p);
+  sne.init(raw_data);
+
+  MSSpectrum < > stn_data;
+  dta_file.load(OPENMS_GET_TEST_DATA_PATH("SignalToNoiseEstimatorMedian_test.out"), stn_data);
+  TEST_EQUAL(sne.getSignalToNoiseEstimates().size(), raw_data.size())
+  for (Size i = 0; i < raw_data.size(); ++i)
+  {
+    TEST_REAL_SIMILAR(sne.getSignalToNoiseAt(i), stn_data[i].getIntensity())
+    TEST_REAL_SIMILAR(sne.getSignalToNoise(raw_data[i]), stn_data[i].getIntensity())
+    // a copy of the peak is found by its position
+    Peak1D copy = raw_data[i];
+    TEST_REAL_SIMILAR(sne.getSignalToNoise(copy), stn_data[i].getIntensity())
+  }
+  TEST_EQUAL(sne.getSignalToNoiseAt(raw_data.size()), 0.0)
+
+  // estimating again with the same object reuses the buffers and gives the same result
+  sne.init(raw_data);
+  TEST_EQUAL(sne.getSignalToNoiseEstimates().size(), raw_data.size())
+  TEST_REAL_SIMILAR(sne.getSignalToNoiseAt(0), stn_data[0].getIntensity())
+}
+END_SECTION
+
 
 /////////////////////////////////////////////////////////////
 /////////////////////////////////////////////////////////////
@@ -164,6 +164,29 @@ START_SECTION((size_type nonzero_size() const ))
 }
 END_SECTION
 
+START_SECTION((template <typename PositionType> void getNonSparseElements(std::vector<PositionType>& positions, std::vector<Value>& values) const))
+{
+	SparseVector<float> sv(10, 0, 0);
+	sv[7] = 2.5;
+	sv[1] = 1.5;
+	sv[4] = 0;
+	vector<UInt> positions(3, 99);
+	vector<float> values;
+	sv.getNonSparseElements(positions, values);
+	TEST_EQUAL(positions.size(), 2)
+	TEST_EQUAL(values.size(), 2)
+	TEST_EQUAL(positions[0], 1)
+	TEST_EQUAL(positions[1], 7)
+	TEST_REAL_SIMILAR(values[0], 1.5)
+	TEST_REAL_SIMILAR(values[1], 2.5)
+
+	SparseVector<float> empty;
+	empty.getNonSparseElements(positions, values);
+	TEST_EQUAL(positions.size(), 0)
+	TEST_EQUAL(values.size(), 0)
+}
+END_SECTION
+
 START_SECTION((void clear()))
 {
 	sv2.clear();
@@ -174,6 +174,63 @@ START_SECTION(void getSpectrum(RichPeakSpectrum& spec, const AASequence& peptide
 
 END_SECTION
 
+START_SECTION(void getSpectra(std::vector<RichPeakSpectrum>& spectra, const std::vector<AASequence>& peptides, Int charge = 1) const)
+{
+  vector<AASequence> peptides;
+  peptides.push_back(peptide);
+  peptides.push_back(AASequence::fromString("PEPTIDEK"));
+  peptides.push_back(AASequence::fromString("M(Oxidation)CDEFGHIK"));
+  peptides.push_back(AASequence::fromString("A"));
+
+  vector<RichPeakSpectrum> spectra(1);
+  ptr->getSpectra(spectra, peptides, 2);
+  TEST_EQUAL(spectra.size(), peptides.size())
+  for (Size i = 0; i < peptides.size(); ++i)
+  {
+    RichPeakSpectrum spec;
+    ptr->getSpectrum(spec, peptides[i], 2);
+    TEST_EQUAL(spectra[i].size(), spec.size())
+    for (Size j = 0; j < spec.size(); ++j)
+    {
+      TEST_REAL_SIMILAR(spectra[i][j].getMZ(), spec[j].getMZ())
+    }
+  }
+}
+END_SECTION
+
+START_SECTION(([EXTRA] ion series from cumulative residue masses))
+{
+  // all ion types incl. modifications, compared with the sum formulas of prefixes/suffixes
+  AASequence seq = AASequence::fromString("M(Oxidation)PEPTIDEK");
+  TheoreticalSpectrumGenerator t_gen;
+  Param params;
+  params.setValue("add_metainfo", "true");
+  params.setValue("add_first_prefix_ion", "true");
+  t_gen.setParameters(params);
+
+  TOLERANCE_ABSOLUTE(1e-6)
+  Residue::ResidueType types[] = {Residue::AIon, Residue::BIon, Residue::CIon, Residue::XIon, Residue::YIon, Residue::ZIon};
+  String letters("abcxyz");
+  for (Size t = 0; t < 6; ++t)
+  {
+    for (Int charge = 1; charge <= 2; ++charge)
+    {
+      RichPeakSpectrum spec;
+      t_gen.addPeaks(spec, seq, types[t], charge);
+      TEST_EQUAL(spec.size(), seq.size() - 1)
+      for (Size i = 0; i < spec.size(); ++i)
+      {
+        // ions of one series are in increasing order of m/z
+        Size length = i + 1;
+        AASequence ion = (t < 3) ? seq.getPrefix(length) : seq.getSuffix(length);
+        TEST_REAL_SIMILAR(spec[i].getMZ(), ion.getMonoWeight(types[t], charge) / (double)charge)
+        TEST_EQUAL((String)spec[i].getMetaValue("IonName"), String(letters[t]) + String(length) + String(charge, '+'))
+      }
+    }
+  }
+}
+END_SECTION
+
 START_SECTION(([EXTRA] bugfix test where losses lead to formulae with negative element frequencies))
 {
   AASequence tmp_aa = AASequence::fromString("RDAGGPALKK");
@@ -114,6 +114,88 @@ START_SECTION((double apply(double value) const))
 }
 END_SECTION
 
+START_SECTION((void apply(const double* values, double* results, Size size) const))
+{
+	TransformationDescription td(data);
+	td.fitModel("linear", Param());
+	// enough values to be processed in several chunks
+	std::vector<double> values(10000), results(10000);
+	for (Size i = 0; i < values.size(); ++i)
+	{
+		values[i] = -1.0 + 0.0003 * i;
+	}
+	td.apply(&values[0], &results[0], values.size());
+	TEST_REAL_SIMILAR(results[0], td.apply(values[0]));
+	TEST_REAL_SIMILAR(results[5000], td.apply(values[5000]));
+	TEST_REAL_SIMILAR(results[9999], td.apply(values[9999]));
+
+	// in place:
+	td.apply(&values[0], &values[0], values.size());
+	TEST_REAL_SIMILAR(values[0], results[0]);
+	TEST_REAL_SIMILAR(values[9999], results[9999]);
+}
+END_SECTION
+
+START_SECTION((void buildLookupTable(double min_value, double max_value, double max_error = 1e-4, Size max_size = 1 << 20)))
+{
+	TransformationDescription td(data);
+	td.fitModel("interpolated", Param());
+	TEST_EXCEPTION(Exception::IllegalArgument, td.buildLookupTable(1.0, 1.0));
+	TEST_EXCEPTION(Exception::IllegalArgument, td.buildLookupTable(0.0, 1.0, 0.0));
+	TEST_EQUAL(td.hasLookupTable(), false);
+
+	double values[7] = {-0.5, 0.0, 0.1, 0.3, 0.77, 1.0, 2.0};
+	double expected[7];
+	for (Size i = 0; i < 7; ++i)
+	{
+		expected[i] = td.apply(values[i]);
+	}
+
+	td.buildLookupTable(0.0, 1.0, 1e-6);
+	TEST_EQUAL(td.hasLookupTable(), true);
+	double results[7];
+	td.apply(values, results, 7);
+	for (Size i = 0; i < 7; ++i)
+	{
+		TEST_REAL_SIMILAR(td.apply(values[i]), expected[i]);
+		TEST_REAL_SIMILAR(results[i], expected[i]);
+	}
+	// outside of the table, the model is evaluated:
+	TEST_EQUAL(td.apply(-0.5), expected[0]);
+	TEST_EQUAL(td.apply(2.0), expected[6]);
+
+	// the table is copied with the model...
+	TransformationDescription td2 = td;
+	TEST_EQUAL(td2.hasLookupTable(), true);
+	TEST_REAL_SIMILAR(td2.apply(0.3), expected[3]);
+	// ... and removed when the model changes:
+	td.fitModel("linear", Param());
+	TEST_EQUAL(td.hasLookupTable(), false);
+	td2.invert();
+	TEST_EQUAL(td2.hasLookupTable(), false);
+}
+END_SECTION
+
+START_SECTION((void clearLookupTable()))
+{
+	TransformationDescription td(data);
+	td.fitModel("linear", Param());
+	td.buildLookupTable(0.0, 1.0);
+	TEST_EQUAL(td.hasLookupTable(), true);
+	td.clearLookupTable();
+	TEST_EQUAL(td.hasLookupTable(), false);
+	TEST_REAL_SIMILAR(td.apply(0.5), 2.0);
+}
+END_SECTION
+
+START_SECTION((bool hasLookupTable() const))
+{
+	TransformationDescription td;
+	TEST_EQUAL(td.hasLookupTable(), false);
+	// further tested above
+}
+END_SECTION
+
 START_SECTION((const String& getModelType() const))
 {
 	TransformationDescription td;
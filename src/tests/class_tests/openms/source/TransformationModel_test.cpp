@@ -103,6 +103,35 @@ START_SECTION((virtual double evaluate(const double value) const))
 }
 END_SECTION
 
+START_SECTION((virtual void evaluate(const double* values, double* results, Size size) const))
+{
+	double values[6] = {-1.0, 0.0, 0.5, 1.0, 1.5, 3.0};
+	double results[6];
+
+	TransformationModel tm;
+	tm.evaluate(values, results, 6);
+	for (Size i = 0; i < 6; ++i)
+	{
+		TEST_EQUAL(results[i], values[i]);
+	}
+
+	TransformationModelLinear lm(data, Param());
+	lm.evaluate(values, results, 6);
+	for (Size i = 0; i < 6; ++i)
+	{
+		TEST_REAL_SIMILAR(results[i], lm.evaluate(values[i]));
+	}
+
+	// interpolation and extrapolation:
+	TransformationModelInterpolated im(data, Param());
+	im.evaluate(values, results, 6);
+	for (Size i = 0; i < 6; ++i)
+	{
+		TEST_REAL_SIMILAR(results[i], im.evaluate(values[i]));
+	}
+}
+END_SECTION
+
 START_SECTION((void getParameters(Param& params) const))
 {
 	Param p_in;
@@ -168,7 +168,7 @@ BOOST_AUTO_TEST_CASE(initializeXCorrMatrix)
   TEST_EQUAL(mrmscore.getXCorrMatrix()[0][0].size(), 23)
 
   // test auto-correlation = xcorrmatrix_0_0
-  const std::map<int, double> auto_correlation =
+  const MRMScoring::XCorrArrayType auto_correlation =
       mrmscore.getXCorrMatrix()[0][0];
   TEST_REAL_SIMILAR(auto_correlation.find(0)->second, 1)
   TEST_REAL_SIMILAR(auto_correlation.find(1)->second, -0.227352707759245)
@@ -177,7 +177,7 @@ BOOST_AUTO_TEST_CASE(initializeXCorrMatrix)
   TEST_REAL_SIMILAR(auto_correlation.find(-2)->second, -0.07501116)
 
   // test cross-correlation = xcorrmatrix_0_1
-  const std::map<int, double> cross_correlation =
+  const MRMScoring::XCorrArrayType cross_correlation =
       mrmscore.getXCorrMatrix()[0][1];
   TEST_REAL_SIMILAR(cross_correlation.find(2)->second, -0.31165141)
   TEST_REAL_SIMILAR(cross_correlation.find(1)->second, -0.35036919)
@@ -35,6 +35,7 @@
 #include "OpenMS/ANALYSIS/OPENSWATH/OPENSWATHALGO/OpenSwathAlgoConfig.h"
 
 #include "OpenMS/ANALYSIS/OPENSWATH/OPENSWATHALGO/ALGO/Scoring.h"
+#include <cmath>
 
 #ifdef USE_BOOST_UNIT_TEST
 
@@ -200,8 +201,8 @@ BOOST_AUTO_TEST_CASE(test_calculateCrossCorrelation)
   Scoring::standardize_data(data1);
   Scoring::standardize_data(data2);
 
-  std::map<int, double> result = Scoring::calculateCrossCorrelation(data1, data2, 2, 1);
-  for(std::map<int, double>::iterator it = result.begin(); it != result.end(); it++)
+  Scoring::XCorrArrayType result = Scoring::calculateCrossCorrelation(data1, data2, 2, 1);
+  for(Scoring::XCorrArrayType::iterator it = result.begin(); it != result.end(); it++)
   {
     it->second = it->second / 6.0;
   }
@@ -215,6 +216,32 @@ BOOST_AUTO_TEST_CASE(test_calculateCrossCorrelation)
 }
 END_SECTION
 
+BOOST_AUTO_TEST_CASE(test_calculateCrossCorrelation_long)
+{
+  // long traces with all lags are correlated via FFT, few lags directly
+  std::vector<double> data1, data2;
+  for (int i = 0; i < 1000; i++)
+  {
+    data1.push_back(std::sin(i * 0.05) + (i % 7) * 0.1);
+    data2.push_back(std::cos(i * 0.03) + (i % 5) * 0.2);
+  }
+  Scoring::standardize_data(data1);
+  Scoring::standardize_data(data2);
+
+  Scoring::XCorrArrayType all_lags = Scoring::calculateCrossCorrelation(data1, data2, 1000, 1);
+  Scoring::XCorrArrayType few_lags = Scoring::calculateCrossCorrelation(data1, data2, 5, 1);
+  TEST_EQUAL(all_lags.size(), 2001)
+  TEST_EQUAL(few_lags.size(), 11)
+  TEST_EQUAL(all_lags.begin()->first, -1000)
+  TEST_REAL_SIMILAR(all_lags.find(-1000)->second, 0.0)
+  for (Scoring::XCorrArrayType::iterator it = few_lags.begin(); it != few_lags.end(); ++it)
+  {
+    TEST_REAL_SIMILAR(all_lags.find(it->first)->second, it->second)
+  }
+  TEST_EQUAL(all_lags.find(1001) == all_lags.end(), true)
+}
+END_SECTION
+
 BOOST_AUTO_TEST_CASE(test_MRMFeatureScoring_normalizedCrossCorrelation)
 //START_SECTION((MRMFeatureScoring::XCorrArrayType MRMFeatureScoring::normalizedCrossCorrelation(std::vector<double>& data1, std::vector<double>& data2, int maxdelay, int lag)))
 {
@@ -231,7 +258,7 @@ BOOST_AUTO_TEST_CASE(test_MRMFeatureScoring_normalizedCrossCorrelation)
   std::vector<double> data1 (arr1, arr1 + sizeof(arr1) / sizeof(arr1[0]) );
   std::vector<double> data2 (arr2, arr2 + sizeof(arr2) / sizeof(arr2[0]) );
 
-  std::map<int, double> result = Scoring::normalizedCrossCorrelation(data1, data2, 2, 1);
+  Scoring::XCorrArrayType result = Scoring::normalizedCrossCorrelation(data1, data2, 2, 1);
 
   TEST_REAL_SIMILAR (result.find( 2)->second, -0.7374631);
   TEST_REAL_SIMILAR (result.find( 1)->second, -0.567846);
@@ -251,7 +278,7 @@ BOOST_AUTO_TEST_CASE(test_MRMFeatureScoring_calcxcorr_legacy_mquest_)
   std::vector<double> data1 (arr1, arr1 + sizeof(arr1) / sizeof(arr1[0]) );
   std::vector<double> data2 (arr2, arr2 + sizeof(arr2) / sizeof(arr2[0]) );
 
-  std::map<int, double> result = Scoring::calcxcorr_legacy_mquest_(data1, data2, true);
+  Scoring::XCorrArrayType result = Scoring::calcxcorr_legacy_mquest_(data1, data2, true);
 
   TEST_REAL_SIMILAR (result.find( 2)->second, -0.7374631);
   TEST_REAL_SIMILAR (result.find( 1)->second, -0.567846);
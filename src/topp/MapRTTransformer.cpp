@@ -33,6 +33,8 @@
 // --------------------------------------------------------------------------
 
 #include <OpenMS/APPLICATIONS/MapAlignerBase.h>
+#include <OpenMS/FORMAT/DATAACCESS/MSDataRTTransformingConsumer.h>
+#include <OpenMS/FORMAT/DATAACCESS/MSDataWritingConsumer.h>
 
 using namespace OpenMS;
 using namespace std;
@@ -78,6 +80,8 @@ using namespace std;
 
     @note As output options, either 'out' or 'trafo_out' has to be provided. They can be used together.
 
+    Input files are processed in parallel. With @p processOption set to "lowmemory", mzML files are transformed while they are read and written, without loading them into memory.
+
     <B>The command line parameters of this tool are:</B> @n
     @verbinclude TOPP_MapRTTransformer.cli
     <B>INI file documentation of this tool:</B>
@@ -111,6 +115,8 @@ protected:
     registerOutputFileList_("trafo_out", "<files>", StringList(), "Transformation output files separated by blanks. Either this option or 'out' have to be provided. They can be used together.", false);
     setValidFormats_("trafo_out", ListUtils::create<String>("trafoXML"));
     registerFlag_("invert", "Invert transformations (approximatively) before applying them");
+    registerStringOption_("processOption", "<name>", "inmemory", "Whether to load mzML files into memory before transforming them, or to transform them on the fly (lowmemory) without loading the whole file into memory first", false, true);
+    setValidStrings_("processOption", ListUtils::create<String>("inmemory,lowmemory"));
     addEmptyLine_();
 
     registerSubsection_("model", "Options to control the modeling of retention time transformations from data");
@@ -133,6 +139,8 @@ protected:
     Param model_params = getParam_().copy("model:", true);
     String model_type = model_params.getValue("type");
     model_params = model_params.copy(model_type + ":", true);
+    bool low_memory = getStringOption_("processOption") == "lowmemory";
+    bool invert = getFlag_("invert");
 
     ProgressLogger progresslogger;
     progresslogger.setLogType(log_type_);
@@ -169,75 +177,164 @@ protected:
     //-------------------------------------------------------------
     progresslogger.startProgress(0, trafo_ins.size(),
                                  "applying RT transformations");
-    for (Size i = 0; i < trafo_ins.size(); ++i)
+    Size progress(0); // thread-safe progress
+    // exceptions must not leave the parallel loop; the first error is reported after it
+    ExitCodes error_code(EXECUTION_OK);
+    String error_message;
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 1)
+#endif
+    for (SignedSize i = 0; i < (SignedSize)trafo_ins.size(); ++i)
     {
-      TransformationXMLFile trafoxml;
-      TransformationDescription trafo;
-      trafoxml.load(trafo_ins[i], trafo);
-      if (model_type != "none")
+      bool failed;
+#ifdef _OPENMP
+#pragma omp critical (MapRTTransformer_error)
+#endif
+      failed = error_code != EXECUTION_OK;
+      if (failed) continue; // no need to process further files
+
+      try
+      {
+        transformFile_(trafo_ins[i], ins.empty() ? String() : ins[i],
+                       outs.empty() ? String() : outs[i],
+                       trafo_outs.empty() ? String() : trafo_outs[i],
+                       model_type, model_params, invert, low_memory);
+      }
+      catch (Exception::UnableToCreateFile& e)
+      {
+        recordError_(CANNOT_WRITE_OUTPUT_FILE, String("Unable to write file (") + e.what() + ")", error_code, error_message);
+      }
+      catch (Exception::FileNotFound& e)
       {
-        trafo.fitModel(model_type, model_params);
+        recordError_(INPUT_FILE_NOT_FOUND, String("File not found (") + e.what() + ")", error_code, error_message);
       }
-      if (getFlag_("invert"))
+      catch (Exception::FileNotReadable& e)
       {
-        trafo.invert();
+        recordError_(INPUT_FILE_NOT_READABLE, String("File not readable (") + e.what() + ")", error_code, error_message);
       }
-      if (!trafo_outs.empty())
+      catch (Exception::FileEmpty& e)
       {
-        trafoxml.store(trafo_outs[i], trafo);
+        recordError_(INPUT_FILE_EMPTY, String("File empty (") + e.what() + ")", error_code, error_message);
       }
-      if (!ins.empty())       // load input
+      catch (Exception::ParseError& e)
       {
-        String in_file = ins[i];
-        FileTypes::Type in_type = FileHandler::getType(in_file);
-        if (in_type == FileTypes::MZML)
-        {
-          MzMLFile file;
-          MSExperiment<> map;
-          file.load(in_file, map);
-          MapAlignmentTransformer::transformSinglePeakMap(map, trafo);
-          addDataProcessing_(map,
-                             getProcessingInfo_(DataProcessing::ALIGNMENT));
-          file.store(outs[i], map);
-        }
-        else if (in_type == FileTypes::FEATUREXML)
-        {
-          FeatureXMLFile file;
-          FeatureMap<> map;
-          file.load(in_file, map);
-          MapAlignmentTransformer::transformSingleFeatureMap(map, trafo);
-          addDataProcessing_(map,
-                             getProcessingInfo_(DataProcessing::ALIGNMENT));
-          file.store(outs[i], map);
-        }
-        else if (in_type == FileTypes::CONSENSUSXML)
-        {
-          ConsensusXMLFile file;
-          ConsensusMap map;
-          file.load(in_file, map);
-          MapAlignmentTransformer::transformSingleConsensusMap(map, trafo);
-          addDataProcessing_(map,
-                             getProcessingInfo_(DataProcessing::ALIGNMENT));
-          file.store(outs[i], map);
-        }
-        else if (in_type == FileTypes::IDXML)
-        {
-          IdXMLFile file;
-          vector<ProteinIdentification> proteins;
-          vector<PeptideIdentification> peptides;
-          file.load(in_file, proteins, peptides);
-          MapAlignmentTransformer::transformSinglePeptideIdentification(peptides,
-                                                                        trafo);
-          // no "data processing" section in idXML
-          file.store(outs[i], proteins, peptides);
-        }
+        recordError_(INPUT_FILE_CORRUPT, String("Unable to read file (") + e.what() + ")", error_code, error_message);
       }
-      progresslogger.setProgress(i);
+      catch (std::exception& e)
+      {
+        recordError_(UNKNOWN_ERROR, String("Unexpected internal error (") + e.what() + ")", error_code, error_message);
+      }
+      catch (...)
+      {
+        recordError_(UNKNOWN_ERROR, "Unexpected internal error", error_code, error_message);
+      }
+
+#ifdef _OPENMP
+#pragma omp critical (MapRTTransformer_progress)
+#endif
+      progresslogger.setProgress(++progress);
     }
     progresslogger.endProgress();
+
+    if (error_code != EXECUTION_OK)
+    {
+      writeLog_("Error: " + error_message);
+      return error_code;
+    }
     return EXECUTION_OK;
   }
 
+  /// Record the first error that occurs in the parallel loop of main_()
+  void recordError_(ExitCodes code, const String& message, ExitCodes& error_code, String& error_message) const
+  {
+#ifdef _OPENMP
+#pragma omp critical (MapRTTransformer_error)
+#endif
+    {
+      if (error_code == EXECUTION_OK)
+      {
+        error_code = code;
+        error_message = message;
+      }
+    }
+  }
+
+  /// Apply a transformation: store it (if @p trafo_out is given) and transform @p in_file into @p out_file (if given)
+  void transformFile_(const String& trafo_in, const String& in_file,
+                      const String& out_file, const String& trafo_out,
+                      const String& model_type, const Param& model_params,
+                      bool invert, bool low_memory)
+  {
+    TransformationXMLFile trafoxml;
+    TransformationDescription trafo;
+    trafoxml.load(trafo_in, trafo);
+    if (model_type != "none")
+    {
+      trafo.fitModel(model_type, model_params);
+    }
+    if (invert)
+    {
+      trafo.invert();
+    }
+    if (!trafo_out.empty())
+    {
+      trafoxml.store(trafo_out, trafo);
+    }
+    if (!in_file.empty())       // load input
+    {
+      FileTypes::Type in_type = FileHandler::getType(in_file);
+      if ((in_type == FileTypes::MZML) && low_memory)
+      {
+        // transform spectra and chromatograms while streaming them to disk
+        PlainMSDataWritingConsumer writer(out_file);
+        writer.addDataProcessing(getProcessingInfo_(DataProcessing::ALIGNMENT));
+        MSDataRTTransformingConsumer consumer(trafo, &writer);
+        MzMLFile().transform(in_file, &consumer);
+      }
+      else if (in_type == FileTypes::MZML)
+      {
+        MzMLFile file;
+        MSExperiment<> map;
+        file.load(in_file, map);
+        MapAlignmentTransformer::transformSinglePeakMap(map, trafo);
+        addDataProcessing_(map,
+                           getProcessingInfo_(DataProcessing::ALIGNMENT));
+        file.store(out_file, map);
+      }
+      else if (in_type == FileTypes::FEATUREXML)
+      {
+        FeatureXMLFile file;
+        FeatureMap<> map;
+        file.load(in_file, map);
+        MapAlignmentTransformer::transformSingleFeatureMap(map, trafo);
+        addDataProcessing_(map,
+                           getProcessingInfo_(DataProcessing::ALIGNMENT));
+        file.store(out_file, map);
+      }
+      else if (in_type == FileTypes::CONSENSUSXML)
+      {
+        ConsensusXMLFile file;
+        ConsensusMap map;
+        file.load(in_file, map);
+        MapAlignmentTransformer::transformSingleConsensusMap(map, trafo);
+        addDataProcessing_(map,
+                           getProcessingInfo_(DataProcessing::ALIGNMENT));
+        file.store(out_file, map);
+      }
+      else if (in_type == FileTypes::IDXML)
+      {
+        IdXMLFile file;
+        vector<ProteinIdentification> proteins;
+        vector<PeptideIdentification> peptides;
+        file.load(in_file, proteins, peptides);
+        MapAlignmentTransformer::transformSinglePeptideIdentification(peptides,
+                                                                      trafo);
+        // no "data processing" section in idXML
+        file.store(out_file, proteins, peptides);
+      }
+    }
+  }
+
 };
 
 
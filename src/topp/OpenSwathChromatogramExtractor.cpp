@@ -97,10 +97,10 @@ using namespace OpenMS;
   input file per SWATH window). The module will then only extract transitions
   whose precursors fall into the corresponding isolation window.
 
-  For the extraction method, two convolution functions are available: top-hat
-  and bartlett. While top-hat will just sum up the signal within a quadratic
-  window, bartlett will weigh the signal in the center of the window more than
-  the signal on the edge.
+  For the extraction method, three convolution functions are available:
+  top-hat, bartlett and gaussian. While top-hat will just sum up the signal
+  within a quadratic window, bartlett (triangular) and gaussian will weigh the
+  signal in the center of the window more than the signal on the edge.
 
   [1] Gillet LC, Navarro P, Tate S, Röst H, Selevsek N, Reiter L, Bonner R, Aebersold R. \n
   <a href="http://dx.doi.org/10.1074/mcp.O111.016717"> Targeted data extraction of the MS/MS spectra generated by data-independent
@@ -159,6 +159,7 @@ protected:
     StringList model_types;
     model_types.push_back("tophat");
     model_types.push_back("bartlett"); // bartlett if we use zeros at the end
+    model_types.push_back("gaussian");
     setValidStrings_("extraction_function", model_types);
 
     registerModelOptions_("linear");
@@ -37,10 +37,19 @@
 #include <OpenMS/DATASTRUCTURES/SeqanIncludeWrapper.h>
 #include <OpenMS/FORMAT/IdXMLFile.h>
 #include <OpenMS/FORMAT/FASTAFile.h>
+#include <OpenMS/FORMAT/ProteinIndexFile.h>
 #include <OpenMS/METADATA/ProteinIdentification.h>
 #include <OpenMS/SYSTEM/File.h>
 
 #include <algorithm>
+#include <cstdio>
+#include <map>
+#include <string>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 using namespace OpenMS;
 using namespace std;
@@ -100,6 +109,10 @@ using namespace std;
 
   The exact mode is much faster (about 10 times) and consumes less memory (about 2.5 times), but might fail to report a few protein hits with ambiguous amino acids for some peptides. Usually these proteins are putative, however.
   The exact mode also supports usage of multiple threads (@p threads option) to speed up computation even further, at the cost of some memory. This is only for the exact search (Aho-Corasick algorithm), however. If tolerant searching needs to be done for unassigned peptides, the latter will consume the major share of the runtime.
+  The database is read in chunks of proteins, so for exact search only the protein accessions (and sequences, if @p write_protein_sequence is set) of the whole database are kept in memory. Tolerant search needs the complete database, which is read a second time then.
+
+  If the same database is used many times, a prebuilt protein index can be given via @p index (see ProteinIndexFile). It is built on first use (and rebuilt whenever the FASTA file or @p IL_equivalent changes) and is then
+  memory mapped instead of parsing the FASTA file, so concurrent runs share it through the page cache. The suffix tree needed for tolerant search is stored next to the index the first time it is required and loaded by later runs.
 
   Further complications can arise due to the presence of the isobaric amino acids isoleucine ('I') and leucine ('L') in protein sequences. Since the two have the exact same chemical composition and mass, they generally cannot be distinguished by mass spectrometry. If a peptide containing 'I' was reported as a match for a spectrum, a peptide containing 'L' instead would be an equally good match (and vice versa). To account for this inherent ambiguity, setting the flag @p IL_equivalent causes 'I' and 'L' to be considered as indistinguishable.@n
   For example, if the sequence "PEPTIDE" (matching "Protein1") was identified as a search hit, but the database additionally contained "PEPTLDE" (matching "Protein2"), running PeptideIndexer with the @p IL_equivalent option would report both "Protein1" and "Protein2" as accessions for "PEPTIDE". (This is independent of the error-tolerant search controlled by @p full_tolerant_search and @p aaa_max.)
@@ -191,6 +204,36 @@ namespace seqan
       }
     }
 
+    /// like addHit(), for all peptides @p idx_peps sharing the same sequence of length @p pep_length
+    void addHits(const std::vector<OpenMS::Size>& idx_peps, OpenMS::Size idx_prot,
+                 OpenMS::Size pep_length, const AASequence& protein,
+                 OpenMS::Size position)
+    {
+      if (enzyme_.isValidProduct(protein, position, pep_length))
+      {
+        for (OpenMS::Size i = 0; i < idx_peps.size(); ++i)
+        {
+          pep_to_prot[idx_peps[i]].insert(idx_prot);
+        }
+        filter_passed += idx_peps.size();
+      }
+      else
+      {
+        filter_rejected += idx_peps.size();
+      }
+    }
+
+    /// adds the hits and counts of @p rhs
+    void merge(const FoundProteinFunctor& rhs)
+    {
+      filter_passed += rhs.filter_passed;
+      filter_rejected += rhs.filter_rejected;
+      for (MapType::const_iterator it = rhs.pep_to_prot.begin(); it != rhs.pep_to_prot.end(); ++it)
+      {
+        pep_to_prot[it->first].insert(it->second.begin(), it->second.end());
+      }
+    }
+
     bool operator==(const FoundProteinFunctor& rhs) const
     {
       if (pep_to_prot.size() != rhs.pep_to_prot.size())
@@ -234,6 +277,186 @@ namespace seqan
 
   };
 
+  /**
+    @brief Aho-Corasick automaton for the exact search of many peptides in proteins
+
+    In contrast to seqan's Pattern<..., AhoCorasick>, which stores the state of
+    the search and thus has to be constructed by every thread, the automaton is
+    immutable after construction and can be shared by all threads.
+
+    Sequences are passed as strings of alphabet ranks (see encode()). The trie
+    is stored as first-child/next-sibling lists to keep it small for millions
+    of peptides.
+  */
+  class PeptideAhoCorasick
+  {
+  public:
+    /// Converts a seqan sequence into a string of alphabet ranks
+    template <typename TSequence>
+    static void encode(const TSequence& sequence, std::string& encoded)
+    {
+      encoded.resize(length(sequence));
+      for (OpenMS::Size i = 0; i < encoded.size(); ++i)
+      {
+        encoded[i] = (char)ordValue(sequence[i]);
+      }
+    }
+
+    /// Builds the automaton for unique @p keywords (empty keywords are ignored)
+    explicit PeptideAhoCorasick(const std::vector<std::string>& keywords) :
+      keyword_length_(keywords.size())
+    {
+      // insert the keywords in lexicographical order: every keyword then
+      // shares a prefix only with the path of the previous one, and new
+      // children can be appended to the sibling lists
+      std::vector<OpenMS::Size> order(keywords.size());
+      for (OpenMS::Size k = 0; k < order.size(); ++k)
+      {
+        order[k] = k;
+      }
+      std::sort(order.begin(), order.end(), KeywordLess_(keywords));
+
+      std::vector<unsigned> last_child;
+      addNode_(0, last_child); // root
+      std::vector<unsigned> path(1, 0); // nodes on the path of the previous keyword
+      const std::string* previous = 0;
+      for (OpenMS::Size o = 0; o < order.size(); ++o)
+      {
+        const std::string& keyword = keywords[order[o]];
+        keyword_length_[order[o]] = keyword.size();
+        if (keyword.empty()) continue;
+
+        OpenMS::Size prefix = 0;
+        if (previous != 0)
+        {
+          while (prefix < keyword.size() && prefix < previous->size() && keyword[prefix] == (*previous)[prefix]) ++prefix;
+        }
+        path.resize(prefix + 1);
+        for (OpenMS::Size d = prefix; d < keyword.size(); ++d)
+        {
+          unsigned parent = path[d];
+          unsigned node = addNode_(keyword[d], last_child);
+          if (first_child_[parent] == NONE) first_child_[parent] = node;
+          else next_sibling_[last_child[parent]] = node;
+          last_child[parent] = node;
+          path.push_back(node);
+        }
+        keyword_[path.back()] = (int)order[o];
+        previous = &keyword;
+      }
+
+      // failure links (longest proper suffix in the trie) and output links
+      // (next node with a keyword on the failure chain), in breadth-first order
+      fail_.assign(symbol_.size(), 0);
+      output_.assign(symbol_.size(), NONE);
+      std::vector<unsigned> queue;
+      queue.reserve(symbol_.size());
+      for (unsigned c = first_child_[0]; c != NONE; c = next_sibling_[c])
+      {
+        queue.push_back(c);
+      }
+      for (OpenMS::Size q = 0; q < queue.size(); ++q)
+      {
+        unsigned node = queue[q];
+        unsigned f = fail_[node];
+        output_[node] = (keyword_[f] >= 0) ? f : output_[f];
+        for (unsigned c = first_child_[node]; c != NONE; c = next_sibling_[c])
+        {
+          unsigned state = f;
+          unsigned next = child_(state, symbol_[c]);
+          while (next == NONE && state != 0)
+          {
+            state = fail_[state];
+            next = child_(state, symbol_[c]);
+          }
+          fail_[c] = (next == NONE) ? 0 : next;
+          queue.push_back(c);
+        }
+      }
+    }
+
+    /// Appends all occurrences in @p text as pairs of keyword index and start position to @p hits
+    void find(const std::string& text, std::vector<std::pair<OpenMS::Size, OpenMS::Size> >& hits) const
+    {
+      unsigned state = 0;
+      for (OpenMS::Size i = 0; i < text.size(); ++i)
+      {
+        unsigned next = child_(state, text[i]);
+        while (next == NONE && state != 0)
+        {
+          state = fail_[state];
+          next = child_(state, text[i]);
+        }
+        state = (next == NONE) ? 0 : next;
+        for (unsigned node = (keyword_[state] >= 0) ? state : output_[state]; node != NONE; node = output_[node])
+        {
+          OpenMS::Size keyword = keyword_[node];
+          hits.push_back(std::make_pair(keyword, i + 1 - keyword_length_[keyword]));
+        }
+      }
+    }
+
+    /// Number of nodes of the trie
+    OpenMS::Size size() const
+    {
+      return symbol_.size();
+    }
+
+  private:
+    enum { NONE = 0xFFFFFFFFu }; ///< marks a missing node
+
+    /// orders keyword indices by their keywords
+    struct KeywordLess_
+    {
+      explicit KeywordLess_(const std::vector<std::string>& keywords) :
+        keywords_(keywords)
+      {
+      }
+
+      bool operator()(OpenMS::Size a, OpenMS::Size b) const
+      {
+        return keywords_[a] < keywords_[b];
+      }
+
+      const std::vector<std::string>& keywords_;
+    };
+
+    unsigned addNode_(char symbol, std::vector<unsigned>& last_child)
+    {
+      symbol_.push_back(symbol);
+      first_child_.push_back(NONE);
+      next_sibling_.push_back(NONE);
+      keyword_.push_back(-1);
+      last_child.push_back(NONE);
+      return (unsigned)(symbol_.size() - 1);
+    }
+
+    /// child of @p node with symbol @p symbol, or NONE
+    unsigned child_(unsigned node, char symbol) const
+    {
+      for (unsigned c = first_child_[node]; c != NONE; c = next_sibling_[c])
+      {
+        if (symbol_[c] == symbol) return c;
+      }
+      return NONE;
+    }
+
+    /// symbol on the edge to each node
+    std::vector<char> symbol_;
+    /// first child of each node (NONE for leaves)
+    std::vector<unsigned> first_child_;
+    /// next sibling of each node (NONE for the last child)
+    std::vector<unsigned> next_sibling_;
+    /// index of the keyword ending at each node (-1 if none)
+    std::vector<int> keyword_;
+    /// failure link of each node
+    std::vector<unsigned> fail_;
+    /// next node with a keyword on the failure chain of each node (NONE if none)
+    std::vector<unsigned> output_;
+    /// length of each keyword
+    std::vector<OpenMS::Size> keyword_length_;
+  };
+
 
   // saving some memory for the SA
   template <>
@@ -432,6 +655,86 @@ protected:
     registerIntOption_("aaa_max", "<AA count>", 4, "Maximal number of ambiguous amino acids (AAA) allowed when matching to a protein DB with AAA's. AAA's are 'B', 'Z' and 'X'", false);
     setMinInt_("aaa_max", 0);
     registerFlag_("IL_equivalent", "Treat the isobaric amino acids isoleucine ('I') and leucine ('L') as equivalent (indistinguishable)");
+    registerStringOption_("index", "<file>", "", "Prebuilt protein index of the FASTA database. It is read instead of the FASTA file, which is much faster for large databases. If the index does not exist or does not match the current FASTA file, it is (re)built. The suffix tree for tolerant search is stored next to it ('<file>.tree.*') when first needed.", false, true);
+  }
+
+  /// reads the proteins of the database chunk by chunk, either from the FASTA file or from a loaded ProteinIndexFile
+  class ProteinReader
+  {
+public:
+    ProteinReader(const String& db_name, const ProteinIndexFile* index) :
+      db_name_(db_name),
+      index_(index),
+      index_pos_(0)
+    {
+      restart();
+    }
+
+    /// start again at the first protein
+    void restart()
+    {
+      if (index_ == 0)
+      {
+        fasta_.readStart(db_name_);
+      }
+      index_pos_ = 0;
+    }
+
+    /// like FASTAFile::readNextChunk(); proteins from the index have no description
+    bool readNextChunk(vector<FASTAFile::FASTAEntry>& chunk, Size max_entries)
+    {
+      if (index_ == 0)
+      {
+        return fasta_.readNextChunk(chunk, max_entries);
+      }
+      chunk.resize(std::min(max_entries, index_->size() - index_pos_));
+      for (Size i = 0; i < chunk.size(); ++i, ++index_pos_)
+      {
+        chunk[i].identifier = index_->getAccession(index_pos_);
+        chunk[i].description = "";
+        chunk[i].sequence = index_->getSequence(index_pos_);
+      }
+      return !chunk.empty();
+    }
+
+private:
+    String db_name_;
+    const ProteinIndexFile* index_;
+    FASTAFile fasta_;
+    Size index_pos_;
+  };
+
+  /// remembers the accession (and the sequence, if @p write_protein_sequence is set) of the proteins in @p chunk, which continues the proteins seen so far
+  void registerProteins_(const vector<FASTAFile::FASTAEntry>& chunk, bool write_protein_sequence, Map<String, Size>& acc_to_prot, vector<String>& protein_accessions, vector<String>& protein_sequences)
+  {
+    for (Size i = 0; i < chunk.size(); ++i)
+    {
+      // consistency check
+      const String& acc = chunk[i].identifier;
+      if (acc_to_prot.has(acc))
+      {
+        writeLog_(String("PeptideIndexer: error, identifiers of proteins should be unique to a database, identifier '") + acc + String("' found multipe times."));
+      }
+      acc_to_prot[acc] = protein_accessions.size();
+      protein_accessions.push_back(acc);
+      if (write_protein_sequence)
+      {
+        protein_sequences.push_back(String(chunk[i].sequence).remove('*'));
+      }
+    }
+  }
+
+  /// converts the sequences in @p chunk into the form which is searched
+  static void prepareProteins_(vector<FASTAFile::FASTAEntry>& chunk, bool il_equivalent)
+  {
+    for (Size i = 0; i < chunk.size(); ++i)
+    {
+      String& seq = chunk[i].sequence.remove('*');
+      if (il_equivalent)
+      {
+        seq.substitute('I', 'J').substitute('L', 'J');
+      }
+    }
   }
 
   ExitCodes main_(int, const char**)
@@ -469,14 +772,55 @@ protected:
     enzyme.setEnzyme(enzyme.getEnzymeByName(getStringOption_("enzyme:name")));
     enzyme.setSpecificity(enzyme.getSpecificityByName(getStringOption_("enzyme:specificity")));
 
+    String index_name = getStringOption_("index");
+
 
     //-------------------------------------------------------------
     // reading input
     //-------------------------------------------------------------
 
-    // we stream the Fasta file
-    vector<FASTAFile::FASTAEntry> proteins;
-    FASTAFile().load(db_name, proteins);
+    // a prebuilt index replaces the Fasta file; the flag marks whether the tree stored with it is for I/L equivalence
+    ProteinIndexFile index;
+    const bool use_index = !index_name.empty();
+    if (use_index)
+    {
+      if (File::exists(index_name))
+      {
+        try
+        {
+          index.load(index_name);
+        }
+        catch (Exception::ParseError& e)
+        {
+          // corrupt or of an older version; rebuilt below
+          writeLog_(String("Protein index '") + index_name + "' is invalid (" + e.getMessage() + "). Rebuilding it.");
+        }
+      }
+      if (!index.isUpToDate(db_name, il_equivalent))
+      {
+        StopWatch sw;
+        sw.start();
+        // a tree stored with the earlier index is of no use anymore (trees of other indices carry another stamp)
+        const String old_stamp = index.getStamp();
+        if (!old_stamp.empty())
+        {
+          File::remove(index_name + ".tree." + old_stamp + ".sa");
+          File::remove(index_name + ".tree." + old_stamp + ".dir");
+        }
+        ProteinIndexFile::store(index_name, db_name, il_equivalent);
+        index.load(index_name);
+        sw.stop();
+        writeLog_(String("Built protein index '") + index_name + "' (time: " + sw.getClockTime() + " s).");
+      }
+      writeDebug_(String("Using protein index '") + index_name + "' with " + index.size() + " proteins.", 1);
+    }
+
+    // we stream the Fasta file (or the index) in chunks of proteins, so memory
+    // does not grow with the size of the database (except for tolerant search, see below)
+    const Size chunk_size = 10000;
+    ProteinReader fasta(db_name, use_index ? &index : 0);
+    vector<FASTAFile::FASTAEntry> proteins; // the current chunk
+    fasta.readNextChunk(proteins, chunk_size);
 
     vector<ProteinIdentification> prot_ids;
     vector<PeptideIdentification> pep_ids;
@@ -507,33 +851,11 @@ protected:
 
     seqan::FoundProteinFunctor func(enzyme); // stores the matches (need to survive local scope which follows)
     Map<String, Size> acc_to_prot; // build map: accessions to proteins
+    vector<String> protein_accessions; // accession of each protein of the database
+    vector<String> protein_sequences; // sequence of each protein of the database (only with 'write_protein_sequence')
 
     { // new scope - forget data after search
 
-      /**
-       BUILD Protein DB
-      */
-      seqan::StringSet<seqan::Peptide> prot_DB;
-
-      for (Size i = 0; i != proteins.size(); ++i)
-      {
-        // build protein DB
-        String seq = proteins[i].sequence.remove('*');
-        if (il_equivalent)
-        {
-          seq.substitute('I', 'J').substitute('L', 'J');
-        }
-        seqan::appendValue(prot_DB, seq.c_str());
-
-        // consistency check
-        String acc = proteins[i].identifier;
-        if (acc_to_prot.has(acc))
-        {
-          writeLog_(String("PeptideIndexer: error, identifiers of proteins should be unique to a database, identifier '") + acc + String("' found multipe times."));
-        }
-        acc_to_prot[acc] = i;
-      }
-
       /**
         BUILD Peptide DB
       */
@@ -553,7 +875,7 @@ protected:
         }
       }
 
-      writeLog_(String("Mapping ") + length(pep_DB) + " peptides to " + length(prot_DB) + " proteins.");
+      writeLog_(String("Mapping ") + length(pep_DB) + " peptides to the proteins of '" + db_name + "'.");
 
       /** first, try Aho Corasick (fast) -- using exact matching only */
       bool SA_only = getFlag_("full_tolerant_search");
@@ -561,51 +883,92 @@ protected:
       {
         StopWatch sw;
         sw.start();
-        SignedSize protDB_length = (SignedSize) length(prot_DB);
-#ifdef _OPENMP
-#pragma omp parallel
-#endif
-        {
-          seqan::Pattern<seqan::StringSet<seqan::Peptide>, seqan::AhoCorasick> pattern(pep_DB);
-          seqan::FoundProteinFunctor func_threads(enzyme);
-          writeDebug_("Finding peptide/protein matches...", 1);
 
-#pragma omp for
-          for (SignedSize i = 0; i < protDB_length; ++i)
+        // one automaton over the unique peptide sequences, shared by all threads
+        std::vector<std::string> unique_peptides;
+        std::vector<std::vector<Size> > unique_to_pep; // indices in pep_DB of each unique sequence
+        {
+          std::map<std::string, Size> sequence_to_unique;
+          std::string encoded;
+          for (Size p = 0; p < length(pep_DB); ++p)
           {
-            seqan::Finder<seqan::Peptide> finder(prot_DB[i]);
-            while (find(finder, pattern))
+            seqan::PeptideAhoCorasick::encode(pep_DB[p], encoded);
+            std::map<std::string, Size>::iterator it = sequence_to_unique.find(encoded);
+            if (it == sequence_to_unique.end())
             {
-              //seqan::appendValue(pat_hits, seqan::Pair<Size, Size>(position(pattern), position(finder)));
-
-              //func_threads.pep_to_prot[position(pattern)].insert(i);
-              // String(seqan::String<char, seqan::CStyle>(prot_DB[i])), position(finder))
-              // target.assign(begin(source, Standard()), end(source, Standard()));
-              const seqan::Peptide& tmp_pep = pep_DB[position(pattern)];
-              const seqan::Peptide& tmp_prot = prot_DB[i];
-
-              func_threads.addHit(position(pattern), i, String(begin(tmp_pep), end(tmp_pep)), String(begin(tmp_prot), end(tmp_prot)), position(finder));
+              it = sequence_to_unique.insert(std::make_pair(encoded, unique_peptides.size())).first;
+              unique_peptides.push_back(encoded);
+              unique_to_pep.push_back(std::vector<Size>());
             }
+            unique_to_pep[it->second].push_back(p);
           }
+        }
+        const seqan::PeptideAhoCorasick automaton(unique_peptides);
+        writeDebug_(String("Aho-Corasick automaton for ") + unique_peptides.size() + " unique peptides has " + automaton.size() + " nodes.", 1);
+
+        // hits are collected per thread without locking and joined afterwards
+#ifdef _OPENMP
+        std::vector<seqan::FoundProteinFunctor> func_threads(omp_get_max_threads(), seqan::FoundProteinFunctor(enzyme));
+#else
+        std::vector<seqan::FoundProteinFunctor> func_threads(1, seqan::FoundProteinFunctor(enzyme));
+#endif
+
+        writeDebug_("Finding peptide/protein matches...", 1);
+
+        // the chunks are read one after the other, the proteins of a chunk are searched by all threads
+        do
+        {
+          const Size chunk_offset = protein_accessions.size(); // database index of the first protein in the chunk
+          registerProteins_(proteins, write_protein_sequence, acc_to_prot, protein_accessions, protein_sequences);
+          prepareProteins_(proteins, il_equivalent);
+          const SignedSize chunk_length = (SignedSize) proteins.size();
 
-          // join results again
 #ifdef _OPENMP
-#pragma omp critical(PeptideIndexer_joinAC)
+#pragma omp parallel
 #endif
           {
-            func.filter_passed += func_threads.filter_passed;
-            func.filter_rejected += func_threads.filter_rejected;
-            for (seqan::FoundProteinFunctor::MapType::const_iterator it = func_threads.pep_to_prot.begin(); it != func_threads.pep_to_prot.end(); ++it)
+#ifdef _OPENMP
+            const int current_thread = omp_get_thread_num();
+#else
+            const int current_thread(0);
+#endif
+            seqan::FoundProteinFunctor& func_thread = func_threads[current_thread];
+            std::string encoded_protein;
+            std::vector<std::pair<Size, Size> > hits; // unique peptide, position
+
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic, 100)
+#endif
+            for (SignedSize i = 0; i < chunk_length; ++i)
             {
-              func.pep_to_prot[it->first].insert(func_threads.pep_to_prot[it->first].begin(), func_threads.pep_to_prot[it->first].end());
+              const seqan::Peptide tmp_prot(proteins[i].sequence.c_str());
+              seqan::PeptideAhoCorasick::encode(tmp_prot, encoded_protein);
+              hits.clear();
+              automaton.find(encoded_protein, hits);
+              if (hits.empty()) continue;
+
+              // the protein is converted only once for all of its hits
+              const AASequence protein = AASequence::fromString(String(begin(tmp_prot), end(tmp_prot)));
+              for (Size h = 0; h < hits.size(); ++h)
+              {
+                func_thread.addHits(unique_to_pep[hits[h].first], chunk_offset + i, unique_peptides[hits[h].first].size(), protein, hits[h].second);
+              }
             }
+          } // end parallel
+        }
+        while (fasta.readNextChunk(proteins, chunk_size));
 
-          }
-        } // end parallel
+        // join results again
+        for (Size t = 0; t < func_threads.size(); ++t)
+        {
+          func.merge(func_threads[t]);
+        }
 
         sw.stop();
 
+        const double proteins_per_second = (sw.getClockTime() > 0 ? protein_accessions.size() / sw.getClockTime() : 0.0);
         writeLog_(String("Aho-Corasick done. Found ") + func.filter_passed + " hits in " + func.pep_to_prot.size() + " of " + length(pep_DB) + " peptides (time: " + sw.getClockTime() + " s (wall), " + sw.getCPUTime() + " s (CPU)).");
+        writeLog_(String("Searched ") + protein_accessions.size() + " proteins in chunks of " + chunk_size + " (" + String(proteins_per_second) + " proteins/s).");
       }
 
       /// check if every peptide was found:
@@ -614,6 +977,32 @@ protected:
         /** search using SA, which supports mismatches (introduced by resolving ambiguous AA's by, e.g. Mascot) -- expensive! */
         writeLog_(String("Using SA to find ambiguous matches ..."));
 
+        /**
+         BUILD Protein DB
+        */
+        // the suffix array needs the whole database, which is read (again) for this purpose
+        seqan::StringSet<seqan::Peptide> prot_DB;
+        const bool registered = !protein_accessions.empty(); // accessions are known from the exact search
+        if (registered)
+        {
+          fasta.restart();
+          fasta.readNextChunk(proteins, chunk_size);
+        }
+        do
+        {
+          if (!registered)
+          {
+            registerProteins_(proteins, write_protein_sequence, acc_to_prot, protein_accessions, protein_sequences);
+          }
+          prepareProteins_(proteins, il_equivalent);
+          for (Size i = 0; i < proteins.size(); ++i)
+          {
+            seqan::appendValue(prot_DB, proteins[i].sequence.c_str());
+          }
+        }
+        while (fasta.readNextChunk(proteins, chunk_size));
+        proteins.clear();
+
         // search peptides which remained unidentified during Aho-Corasick (might be all if 'full_tolerant_search' is enabled)
         seqan::StringSet<seqan::Peptide> pep_DB_SA;
         Map<Size, Size> missed_pep;
@@ -626,7 +1015,7 @@ protected:
           }
         }
 
-        writeLog_(String("    for ") + length(pep_DB_SA) + " peptides.");
+        writeLog_(String("    for ") + length(pep_DB_SA) + " peptides and " + length(prot_DB) + " proteins.");
 
         seqan::FoundProteinFunctor func_SA(enzyme);
 
@@ -645,8 +1034,26 @@ protected:
 
         typedef seqan::Iterator<TIndex, seqan::TopDown<seqan::PreorderEmptyEdges> >::Type TTreeIter;
 
-        //seqan::open(indexSA(prot_Index), "c:\\tmp\\prot_Index.sa");
-        //seqan::open(indexDir(prot_Index), "c:\\tmp\\prot_Index.dir");
+        // the suffix tree of the database is reused, if it was stored with the index before;
+        // its name carries the stamp of the index (FASTA size, modification time and I/L flag),
+        // so a tree is only ever read for the very text it was built from. Trees stored by
+        // concurrent runs under the same stamp are built from the same text and thus identical,
+        // so pairing '.sa' and '.dir' of two such runs is safe.
+        const String tree_name = index_name + ".tree." + (use_index ? index.getStamp() : String());
+        bool tree_loaded(false);
+        if (use_index && index.getFlag() == (UInt)il_equivalent &&
+            File::exists(tree_name + ".sa") && File::exists(tree_name + ".dir"))
+        {
+          tree_loaded = seqan::open(indexSA(prot_Index), (tree_name + ".sa").c_str())
+                        && seqan::open(indexDir(prot_Index), (tree_name + ".dir").c_str())
+                        && length(indexSA(prot_Index)) == lengthSum(prot_DB); // one entry per suffix
+          if (!tree_loaded)
+          {
+            writeLog_(String("Stored suffix tree '") + tree_name + "' does not match the index. Building it again.");
+            clear(indexSA(prot_Index));
+            clear(indexDir(prot_Index));
+          }
+        }
 
         TTreeIter prot_Iter(prot_Index);
         TTreeIter pep_Iter(pep_Index);
@@ -654,8 +1061,28 @@ protected:
         UInt max_aaa = getIntOption_("aaa_max");
         seqan::_approximateAminoAcidTreeSearch<true, true>(func_SA, pep_Iter, 0u, prot_Iter, 0u, 0u, max_aaa);
 
-        //seqan::save(indexSA(prot_Index), "c:\\tmp\\prot_Index.sa");
-        //seqan::save(indexDir(prot_Index), "c:\\tmp\\prot_Index.dir");
+        // the tree is built lazily during the search; evaluate the rest of it and store it for the next runs
+        if (use_index && !tree_loaded)
+        {
+          typedef seqan::Iterator<TIndex, seqan::TopDown<seqan::ParentLinks<seqan::Preorder> > >::Type TFullIter;
+          for (TFullIter it(prot_Index); !atEnd(it); goNext(it)) {}
+
+          // write to temporary files first, concurrent runs must not read incomplete trees
+          const String tmp_name = tree_name + "." + File::getUniqueName();
+          if (seqan::save(indexSA(prot_Index), (tmp_name + ".sa").c_str())
+              && seqan::save(indexDir(prot_Index), (tmp_name + ".dir").c_str())
+              && std::rename((tmp_name + ".sa").c_str(), (tree_name + ".sa").c_str()) == 0
+              && std::rename((tmp_name + ".dir").c_str(), (tree_name + ".dir").c_str()) == 0)
+          {
+            writeLog_(String("Stored suffix tree for tolerant search as '") + tree_name + ".*'.");
+          }
+          else
+          {
+            writeLog_(String("Warning: could not store the suffix tree for tolerant search as '") + tree_name + ".*'.");
+            File::remove(tmp_name + ".sa");
+            File::remove(tmp_name + ".dir");
+          }
+        }
 
         // augment results with SA hits
         func.filter_passed += func_SA.filter_passed;
@@ -714,13 +1141,13 @@ protected:
              it_i != func.pep_to_prot[pep_idx].end();
              ++it_i)
         {
-          it2->addProteinAccession(proteins[*it_i].identifier);
+          it2->addProteinAccession(protein_accessions[*it_i]);
 
           runidx_to_protidx[run_idx].insert(*it_i); // fill protein hits
 
           /*
           /// STATS
-          String acc = proteins[*it_i].identifier;
+          String acc = protein_accessions[*it_i];
           // is the mapped protein in this run?
           if (accession_to_runidxs[acc].find(run_idx) ==
               accession_to_runidxs[acc].end())
@@ -841,7 +1268,7 @@ protected:
         { // this accession was there already
           new_protein_hits.push_back(*p_hit);
           String seq;
-          if (write_protein_sequence) seq = proteins[acc_to_prot[acc]].sequence;
+          if (write_protein_sequence) seq = protein_sequences[acc_to_prot[acc]];
           else seq = "";
           new_protein_hits.back().setSequence(seq);
           masterset.erase(acc_to_prot[acc]); // remove from master (at the end only new proteins remain)
@@ -859,8 +1286,8 @@ protected:
            ++it)
       {
         ProteinHit hit;
-        hit.setAccession(proteins[*it].identifier);
-        if (write_protein_sequence) hit.setSequence(proteins[*it].sequence);
+        hit.setAccession(protein_accessions[*it]);
+        if (write_protein_sequence) hit.setSequence(protein_sequences[*it]);
         new_protein_hits.push_back(hit);
         ++stats_new_proteins;
       }
@@ -38,15 +38,20 @@
 #include <OpenMS/CONCEPT/Factory.h>
 #include <OpenMS/FORMAT/MSPFile.h>
 #include <OpenMS/FORMAT/IdXMLFile.h>
+#include <OpenMS/COMPARISON/SPECTRA/BinnedSpectralLibrary.h>
 #include <OpenMS/COMPARISON/SPECTRA/BinnedSpectrum.h>
 #include <OpenMS/COMPARISON/SPECTRA/SpectraSTSimilarityScore.h>
 #include <OpenMS/COMPARISON/SPECTRA/ZhangSimilarityScore.h>
 #include <OpenMS/CHEMISTRY/ModificationsDB.h>
 #include <OpenMS/MATH/MISC/MathFunctions.h>
+#include <OpenMS/SYSTEM/File.h>
 
+#include <QtCore/QDateTime>
+#include <QtCore/QFileInfo>
+
+#include <algorithm>
 #include <ctime>
 #include <vector>
-#include <map>
 #include <cmath>
 using namespace OpenMS;
 using namespace std;
@@ -76,6 +81,12 @@ using namespace std;
 
     @experimental This TOPP-tool is not well tested and not all features might be properly implemented and tested.
 
+    For the SpectraSTSimilarityScore, every library spectrum is binned and normalized only once, and the
+    library spectra are kept in precursor order in a compact binned representation (see BinnedSpectralLibrary).
+    Each query spectrum is then scored against all library spectra of its precursor window in parallel.
+    With the advanced option @p lib_index, this binned library is stored to disk and reused by later
+    searches with the same library and settings.
+
     <B>The command line parameters of this tool are:</B>
     @verbinclude TOPP_SpecLibSearcher.cli
     <B>INI file documentation of this tool:</B>
@@ -119,6 +130,7 @@ protected:
     PeakSpectrumCompareFunctor::registerChildren();
     setValidStrings_("compare_function", Factory<PeakSpectrumCompareFunctor>::registeredProducts());
     registerIntOption_("top_hits", "<number>", 10, "save the first <number> top hits. For all type -1", false);
+    registerStringOption_("lib_index", "<file>", "", "Binned library for the SpectraSTSimilarityScore. It is loaded instead of binning the library spectra again. If the file does not exist or does not match the library and settings, it is (re)built.", false, true);
 
     addEmptyLine_();
     registerTOPPSubsection_("filter", "Filtering options. Most are especially useful when the query spectra are raw.");
@@ -158,6 +170,7 @@ protected:
     StringList fixed_modifications = getStringList_("fixed_modifications");
     StringList variable_modifications = getStringList_("variable_modifications");
     Int top_hits  = getIntOption_("top_hits");
+    String lib_index = getStringOption_("lib_index");
     if (top_hits < -1)
     {
       writeLog_("top_hits (should be  >= -1 )");
@@ -188,18 +201,14 @@ protected:
     vector<PeptideIdentification> ids;
     spectral_library.load(in_lib, ids, library);
 
-    map<Size, vector<PeakSpectrum> > MSLibrary;
+    // library spectra in the order of the MSP file
+    vector<PeakSpectrum> library_spectra;
     {
       RichPeakMap::iterator s;
       vector<PeptideIdentification>::iterator i;
       ModificationsDB* mdb = ModificationsDB::getInstance();
       for (s = library.begin(), i = ids.begin(); s < library.end(); ++s, ++i)
       {
-        double precursor_MZ = (*s).getPrecursors()[0].getMZ();
-        Size MZ_multi = (Size)precursor_MZ * precursor_mass_multiplier;
-        map<Size, vector<PeakSpectrum> >::iterator found;
-        found = MSLibrary.find(MZ_multi);
-
         PeakSpectrum librar;
         bool variable_modifications_ok = true;
         bool fixed_modifications_ok = true;
@@ -265,17 +274,84 @@ protected:
               librar.push_back(peak);
             }
           }
-          if (found != MSLibrary.end())
-          {
-            found->second.push_back(librar);
-          }
-          else
+          library_spectra.push_back(librar);
+        }
+      }
+    }
+
+    // sort the library by precursor m/z, so the candidates of a query form one contiguous range
+    vector<Size> library_order; // position of each spectrum in 'library_spectra'
+    vector<double> library_MZ;
+    {
+      vector<pair<double, Size> > order;
+      order.reserve(library_spectra.size());
+      for (Size k = 0; k < library_spectra.size(); ++k)
+      {
+        order.push_back(make_pair(library_spectra[k].getPrecursors()[0].getMZ(), k));
+      }
+      sort(order.begin(), order.end());
+      library_order.reserve(order.size());
+      library_MZ.reserve(order.size());
+      for (Size k = 0; k < order.size(); ++k)
+      {
+        library_MZ.push_back(order[k].first);
+        library_order.push_back(order[k].second);
+      }
+    }
+
+    //binned library for the SpectraST score, in the order of 'library_MZ'
+    const bool spectrast = (compare_function == "SpectraSTSimilarityScore");
+    BinnedSpectralLibrary binned_library;
+    if (spectrast)
+    {
+      // everything the binned spectra depend on
+      QFileInfo fi(in_lib.toQString());
+      String signature = String("lib_size=") + String((UInt64)fi.size()) + ";lib_time=" + String((Int64)fi.lastModified().toTime_t()) +
+                         ";threshold=" + remove_peaks_below_threshold +
+                         ";fixed=" + ListUtils::concatenate(fixed_modifications, ",") +
+                         ";variable=" + ListUtils::concatenate(variable_modifications, ",");
+
+      bool loaded = false;
+      if (lib_index != "" && File::exists(lib_index))
+      {
+        try
+        {
+          binned_library.load(lib_index);
+          loaded = (binned_library.getSignature() == signature && binned_library.size() == library_MZ.size());
+          for (Size k = 0; loaded && k < library_MZ.size(); ++k)
           {
-            vector<PeakSpectrum> tmp;
-            tmp.push_back(librar);
-            MSLibrary.insert(make_pair(MZ_multi, tmp));
+            loaded = (binned_library.getPrecursorMZ(k) == library_MZ[k]);
           }
         }
+        catch (Exception::BaseException& e)
+        {
+          writeDebug_(String("Binned library '") + lib_index + "' could not be read: " + e.what(), 1);
+          loaded = false;
+        }
+        if (!loaded)
+        {
+          writeLog_(String("Binned library '") + lib_index + "' does not match the spectral library or settings. It is rebuilt.");
+        }
+      }
+
+      if (!loaded)
+      {
+        binned_library.clear();
+        for (Size k = 0; k < library_order.size(); ++k)
+        {
+          binned_library.addSpectrum(library_spectra[library_order[k]], library_MZ[k]);
+        }
+        binned_library.setSignature(signature);
+        if (lib_index != "")
+        {
+          binned_library.store(lib_index);
+        }
+      }
+
+      // only the meta data of the library spectra is needed from now on
+      for (Size k = 0; k < library_spectra.size(); ++k)
+      {
+        library_spectra[k].clear(false);
       }
     }
     time_t end_build_time = time(NULL);
@@ -371,50 +447,66 @@ protected:
           }
           float min_MZ = (query_MZ - precursor_mass_tolerance) * precursor_mass_multiplier;
           float max_MZ = (query_MZ + precursor_mass_tolerance) * precursor_mass_multiplier;
-          for (Size mz = (Size)min_MZ; mz <= ((Size)max_MZ) + 1; ++mz)
+
+          // all library spectra passing the checks below are in this range (the margin absorbs rounding)
+          Size first = 0, last = library_MZ.size();
+          if (precursor_mass_multiplier > 0)
+          {
+            first = lower_bound(library_MZ.begin(), library_MZ.end(), query_MZ - precursor_mass_tolerance - 1.0) - library_MZ.begin();
+            last = upper_bound(library_MZ.begin() + first, library_MZ.end(), query_MZ + precursor_mass_tolerance + 1.0) - library_MZ.begin();
+          }
+
+          // candidates ordered by precursor bucket and library order, as hits with equal scores are reported in this order
+          vector<pair<pair<Size, Size>, Size> > candidates;
+          for (Size k = first; k < last; ++k)
           {
-            map<Size, vector<PeakSpectrum> >::iterator found;
-            found = MSLibrary.find(mz);
-            if (found != MSLibrary.end())
+            const PeakSpectrum& librar = library_spectra[library_order[k]];
+            Size MZ_multi = (Size)library_MZ[k] * precursor_mass_multiplier;
+            float this_MZ  = library_MZ[k] * precursor_mass_multiplier;
+            if (MZ_multi >= (Size)min_MZ && MZ_multi <= ((Size)max_MZ) + 1 &&
+                this_MZ >= min_MZ && max_MZ >= this_MZ && ((charge_one == true && librar.getPeptideIdentifications()[0].getHits()[0].getCharge() == 1) || charge_one == false))
             {
-              vector<PeakSpectrum>& library = found->second;
-              for (Size i = 0; i < library.size(); ++i)
-              {
-                float this_MZ  = library[i].getPrecursors()[0].getMZ() * precursor_mass_multiplier;
-                if (this_MZ >= min_MZ && max_MZ >= this_MZ && ((charge_one == true && library[i].getPeptideIdentifications()[0].getHits()[0].getCharge() == 1) || charge_one == false))
-                {
-                  PeptideHit hit = library[i].getPeptideIdentifications()[0].getHits()[0];
-                  PeakSpectrum& librar = library[i];
-                  //Special treatment for SpectraST score as it computes a score based on the whole library
-                  if (compare_function == "SpectraSTSimilarityScore")
-                  {
-                    SpectraSTSimilarityScore* sp = static_cast<SpectraSTSimilarityScore*>(comparor);
-                    BinnedSpectrum quer_bin = sp->transform(quer);
-                    BinnedSpectrum librar_bin = sp->transform(librar);
-                    score = (* sp)(quer, librar); //(*sp)(quer_bin,librar_bin);
-                    double dot_bias = sp->dot_bias(quer_bin, librar_bin, score);
-                    hit.setMetaValue("DOTBIAS", dot_bias);
-                  }
-                  else
-                  {
-                    score = (* comparor)(quer, librar);
-                  }
-
-                  DataValue RT(library[i].getRT());
-                  DataValue MZ(library[i].getPrecursors()[0].getMZ());
-                  hit.setMetaValue("RT", RT);
-                  hit.setMetaValue("MZ", MZ);
-                  hit.setScore(score);
-                  hit.addProteinAccession(pr_hit.getAccession());
-                  pid.insertHit(hit);
-                }
-              }
+              candidates.push_back(make_pair(make_pair(MZ_multi, library_order[k]), k));
             }
           }
+          sort(candidates.begin(), candidates.end());
+
+          //Special treatment for SpectraST score as it computes a score based on the whole library
+          vector<double> dot_products, dot_biases;
+          if (spectrast && !candidates.empty())
+          {
+            vector<float> quer_bins;
+            BinnedSpectralLibrary::transformQuery(quer, quer_bins);
+            binned_library.score(quer_bins, first, last, dot_products, dot_biases);
+          }
+
+          for (Size c = 0; c < candidates.size(); ++c)
+          {
+            const Size k = candidates[c].second;
+            const PeakSpectrum& librar = library_spectra[library_order[k]];
+            PeptideHit hit = librar.getPeptideIdentifications()[0].getHits()[0];
+            if (spectrast)
+            {
+              score = dot_products[k - first];
+              hit.setMetaValue("DOTBIAS", dot_biases[k - first]);
+            }
+            else
+            {
+              score = (* comparor)(quer, librar);
+            }
+
+            DataValue RT(librar.getRT());
+            DataValue MZ(librar.getPrecursors()[0].getMZ());
+            hit.setMetaValue("RT", RT);
+            hit.setMetaValue("MZ", MZ);
+            hit.setScore(score);
+            hit.addProteinAccession(pr_hit.getAccession());
+            pid.insertHit(hit);
+          }
         }
         pid.setHigherScoreBetter(true);
         pid.sort();
-        if (compare_function == "SpectraSTSimilarityScore")
+        if (spectrast)
         {
           if (!pid.empty() && !pid.getHits().empty())
           {
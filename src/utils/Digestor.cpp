@@ -38,6 +38,7 @@
 #include <OpenMS/METADATA/ProteinIdentification.h>
 #include <OpenMS/APPLICATIONS/TOPPBase.h>
 #include <OpenMS/CHEMISTRY/EnzymaticDigestion.h>
+#include <OpenMS/SYSTEM/StopWatch.h>
 
 #include <map>
 
@@ -153,8 +154,11 @@ protected:
     //-------------------------------------------------------------
     // reading input
     //-------------------------------------------------------------
-    std::vector<FASTAFile::FASTAEntry> protein_data;
-    FASTAFile().load(inputfile_name, protein_data);
+    // the database is streamed in chunks of proteins, which are digested in parallel
+    const Size chunk_size = 10000;
+    FASTAFile fasta;
+    fasta.readStart(inputfile_name);
+    std::vector<FASTAFile::FASTAEntry> protein_data; // the current chunk
     //-------------------------------------------------------------
     // calculations
     //-------------------------------------------------------------
@@ -191,53 +195,90 @@ protected:
 
     Size dropped_bylength(0);   // stats for removing candidates
 
-    for (Size i = 0; i < protein_data.size(); ++i)
+    std::vector<std::vector<AASequence> > chunk_peptides; // digestion products of each protein of the chunk
+    std::vector<char> chunk_failed; // set if a protein sequence could not be parsed
+    Size protein_count(0);
+    StopWatch sw;
+    sw.start();
+
+    while (fasta.readNextChunk(protein_data, chunk_size))
     {
-      if (!has_FASTA_output)
+      const SignedSize chunk_length = (SignedSize) protein_data.size();
+      chunk_peptides.resize(protein_data.size());
+      chunk_failed.assign(protein_data.size(), 0);
+
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 100)
+#endif
+      for (SignedSize i = 0; i < chunk_length; ++i)
       {
-        protein_accessions[0] = protein_data[i].identifier;
-        ProteinHit temp_protein_hit;
-        temp_protein_hit.setSequence(protein_data[i].sequence);
-        temp_protein_hit.setAccession(protein_accessions[0]);
-        protein_identifications[0].insertHit(temp_protein_hit);
-        temp_peptide_hit.setProteinAccessions(protein_accessions);
+        chunk_peptides[i].clear();
+        try
+        {
+          if (enzyme == "none")
+          {
+            chunk_peptides[i].push_back(AASequence::fromString(protein_data[i].sequence));
+          }
+          else
+          {
+            digestor.digest(AASequence::fromString(protein_data[i].sequence), chunk_peptides[i]);
+          }
+        }
+        catch (Exception::BaseException&)
+        {
+          chunk_failed[i] = 1; // exceptions must not leave the parallel region; parsed again below
+        }
       }
 
-      vector<AASequence> temp_peptides;
-      if (enzyme == "none")
-      {
-        temp_peptides.push_back(AASequence::fromString(protein_data[i].sequence));
-      }
-      else
+      // the results are collected in the order of the database
+      for (Size i = 0; i < protein_data.size(); ++i)
       {
-        digestor.digest(AASequence::fromString(protein_data[i].sequence), temp_peptides);
-      }
+        if (chunk_failed[i])
+        {
+          AASequence::fromString(protein_data[i].sequence); // throws the parse error
+        }
 
-      for (Size j = 0; j < temp_peptides.size(); ++j)
-      {
-        if ((temp_peptides[j].size() >= min_size) &&
-            (temp_peptides[j].size() <= max_size))
+        if (!has_FASTA_output)
+        {
+          protein_accessions[0] = protein_data[i].identifier;
+          ProteinHit temp_protein_hit;
+          temp_protein_hit.setSequence(protein_data[i].sequence);
+          temp_protein_hit.setAccession(protein_accessions[0]);
+          protein_identifications[0].insertHit(temp_protein_hit);
+          temp_peptide_hit.setProteinAccessions(protein_accessions);
+        }
+
+        const vector<AASequence>& temp_peptides = chunk_peptides[i];
+        for (Size j = 0; j < temp_peptides.size(); ++j)
         {
-          if (!has_FASTA_output)
+          if ((temp_peptides[j].size() >= min_size) &&
+              (temp_peptides[j].size() <= max_size))
           {
-            temp_peptide_hit.setSequence(temp_peptides[j]);
-            peptide_identification.insertHit(temp_peptide_hit);
-            identifications.push_back(peptide_identification);
-            peptide_identification.setHits(std::vector<PeptideHit>());   // clear
+            if (!has_FASTA_output)
+            {
+              temp_peptide_hit.setSequence(temp_peptides[j]);
+              peptide_identification.insertHit(temp_peptide_hit);
+              identifications.push_back(peptide_identification);
+              peptide_identification.setHits(std::vector<PeptideHit>());   // clear
+            }
+            else   // for FASTA file output
+            {
+              FASTAFile::FASTAEntry pep(protein_data[i].identifier, protein_data[i].description, temp_peptides[j].toString());
+              all_peptides.push_back(pep);
+            }
           }
-          else   // for FASTA file output
+          else
           {
-            FASTAFile::FASTAEntry pep(protein_data[i].identifier, protein_data[i].description, temp_peptides[j].toString());
-            all_peptides.push_back(pep);
+            ++dropped_bylength;
           }
         }
-        else
-        {
-          ++dropped_bylength;
-        }
       }
+      protein_count += protein_data.size();
     }
 
+    sw.stop();
+    writeLog_(String("Digested ") + protein_count + " proteins in " + sw.getClockTime() + " s (" + String(sw.getClockTime() > 0 ? protein_count / sw.getClockTime() : 0.0) + " proteins/s).");
+
     //-------------------------------------------------------------
     // writing output
     //-------------------------------------------------------------
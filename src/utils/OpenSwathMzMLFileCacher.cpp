@@ -62,6 +62,12 @@ using namespace std;
   - read only an index (read_memdump_idx) of the spectra and chromatograms and then use
     random-access to retrieve a specific spectra from the disk (read_memdump_spectra)
 
+  Two versions of the cached format can be written (see CachedmzML). Version 2
+  stores an index at the end of the file which allows fast random access and
+  supports compact encodings of the data (4 byte floats or MS-Numpress
+  compression), set with the @p mz_encoding and @p intensity_encoding
+  options. Both versions are read automatically.
+
   @note This tool is experimental!
 
   <B>The command line parameters of this tool are:</B>
@@ -100,6 +106,29 @@ class TOPPOpenSwathMzMLFileCacher
 
     registerFlag_("convert_back", "Convert back to mzML");
 
+    registerIntOption_("format_version", "<version>", 1, "Version of the cached file format to write (version 2 contains an index and supports compact encodings)", false, true);
+    setMinInt_("format_version", 1);
+    setMaxInt_("format_version", 2);
+
+    std::vector<String> encodings(CachedmzML::NamesOfBinaryDataEncoding, CachedmzML::NamesOfBinaryDataEncoding + CachedmzML::SIZE_OF_BINARYDATAENCODING);
+    registerStringOption_("mz_encoding", "<encoding>", "float64", "Encoding of m/z and RT values (format version 2 only)", false, true);
+    setValidStrings_("mz_encoding", encodings);
+    registerStringOption_("intensity_encoding", "<encoding>", "float64", "Encoding of intensity values (format version 2 only)", false, true);
+    setValidStrings_("intensity_encoding", encodings);
+
+  }
+
+  CachedmzML::BinaryDataEncoding getEncoding_(const String& option) const
+  {
+    String name = getStringOption_(option);
+    for (Size i = 0; i < CachedmzML::SIZE_OF_BINARYDATAENCODING; ++i)
+    {
+      if (name == CachedmzML::NamesOfBinaryDataEncoding[i])
+      {
+        return static_cast<CachedmzML::BinaryDataEncoding>(i);
+      }
+    }
+    return CachedmzML::ENCODING_FLOAT64;
   }
 
   ExitCodes main_(int , const char**)
@@ -119,6 +148,9 @@ class TOPPOpenSwathMzMLFileCacher
       cacher.setLogType(log_type_);
       f.setLogType(log_type_);
 
+      cacher.setFormatVersion(getIntOption_("format_version"));
+      cacher.setDataEncoding(getEncoding_("mz_encoding"), getEncoding_("intensity_encoding"));
+
       f.load(in,exp);
       cacher.writeMemdump(exp, out_cached);
 
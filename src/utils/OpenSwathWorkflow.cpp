@@ -70,6 +70,11 @@
 #include <OpenMS/ANALYSIS/OPENSWATH/MRMTransitionGroupPicker.h>
 
 #include <assert.h>
+#include <deque>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 using namespace OpenMS;
 
@@ -218,13 +223,233 @@ namespace OpenMS
       return result;
     }
 
-    void writeLines(std::vector<String> to_output)
+    void writeLines(const std::vector<String> & to_output)
     {
       for (Size i = 0; i < to_output.size(); i++) { ofs << to_output[i]; }
     }
 
   };
 
+  /**
+   * @brief Collects the results of OpenSwathWorkflow::performExtraction and writes them in SWATH order
+   *
+   * Worker threads hand over the results of each batch with push() (which
+   * only swaps them into a queue) and mark a SWATH map as done with
+   * finishSwath(). Results are written to the chromatogram consumer, the
+   * output FeatureMap and the TSV writer strictly in the order of the SWATH
+   * maps (and batches within a map), independent of the thread scheduling.
+   *
+   * Writing is done by whichever thread manages to acquire the writer role;
+   * all other threads return immediately instead of waiting for the output,
+   * the pending results are then picked up by the current writer.
+   *
+   */
+  class OpenSwathResultSink
+  {
+  public:
+
+    /// The results of a single batch
+    struct BatchResult
+    {
+      std::vector< OpenMS::MSChromatogram<> > chromatograms;
+      FeatureMap<> features;
+      std::vector<String> tsv_lines;
+
+      void swap(BatchResult & other)
+      {
+        chromatograms.swap(other.chromatograms);
+        features.swap(other.features);
+        tsv_lines.swap(other.tsv_lines);
+      }
+    };
+
+    OpenSwathResultSink(Size nr_swaths, Interfaces::IMSDataConsumer<> * chrom_consumer,
+        OpenSwathTSVWriter & tsv_writer, FeatureMap<> & out_features, bool store_features) :
+      pending_(nr_swaths),
+      finished_(nr_swaths, false),
+      next_swath_(0),
+      chrom_consumer_(chrom_consumer),
+      tsv_writer_(tsv_writer),
+      out_features_(out_features),
+      store_features_(store_features)
+    {
+#ifdef _OPENMP
+      omp_init_lock(&queue_lock_);
+      omp_init_lock(&writer_lock_);
+#endif
+    }
+
+    ~OpenSwathResultSink()
+    {
+#ifdef _OPENMP
+      omp_destroy_lock(&queue_lock_);
+      omp_destroy_lock(&writer_lock_);
+#endif
+    }
+
+    /// Add the results of the next batch of SWATH map @p swath_idx (result is empty afterwards)
+    void push(Size swath_idx, BatchResult & result)
+    {
+      lockQueue_();
+      pending_[swath_idx].push_back(BatchResult());
+      pending_[swath_idx].back().swap(result);
+      unlockQueue_();
+      tryWrite_();
+    }
+
+    /// Mark SWATH map @p swath_idx as done (no more results will be pushed for it)
+    void finishSwath(Size swath_idx)
+    {
+      lockQueue_();
+      finished_[swath_idx] = true;
+      unlockQueue_();
+      tryWrite_();
+    }
+
+    /// Write all remaining results (waits for a concurrent writer to finish)
+    void flush()
+    {
+#ifdef _OPENMP
+      omp_set_lock(&writer_lock_);
+#endif
+      writePending_();
+#ifdef _OPENMP
+      omp_unset_lock(&writer_lock_);
+#endif
+    }
+
+  private:
+
+    /// Forbidden copy constructor and assignment operator
+    OpenSwathResultSink(const OpenSwathResultSink &);
+    OpenSwathResultSink & operator=(const OpenSwathResultSink &);
+
+    void lockQueue_()
+    {
+#ifdef _OPENMP
+      omp_set_lock(&queue_lock_);
+#endif
+    }
+
+    void unlockQueue_()
+    {
+#ifdef _OPENMP
+      omp_unset_lock(&queue_lock_);
+#endif
+    }
+
+    /// Write pending results if no other thread is currently writing
+    void tryWrite_()
+    {
+#ifdef _OPENMP
+      // Results added while another thread held the writer role are picked up
+      // by that thread after it released the role (it checks again below).
+      do
+      {
+        if (!omp_test_lock(&writer_lock_))
+        {
+          return;
+        }
+        writePending_();
+        omp_unset_lock(&writer_lock_);
+      }
+      while (hasWritable_());
+#else
+      writePending_();
+#endif
+    }
+
+    /// Whether the next result in SWATH order is available
+    bool hasWritable_()
+    {
+      lockQueue_();
+      bool writable = next_swath_ < pending_.size() &&
+                      (!pending_[next_swath_].empty() || finished_[next_swath_]);
+      unlockQueue_();
+      return writable;
+    }
+
+    /// Write all results which are next in SWATH order (caller holds the writer role)
+    void writePending_()
+    {
+      BatchResult result;
+      while (true)
+      {
+        bool have_result = false;
+        lockQueue_();
+        while (next_swath_ < pending_.size())
+        {
+          if (!pending_[next_swath_].empty())
+          {
+            pending_[next_swath_].front().swap(result);
+            pending_[next_swath_].pop_front();
+            have_result = true;
+            break;
+          }
+          else if (finished_[next_swath_])
+          {
+            ++next_swath_;
+          }
+          else
+          {
+            break;
+          }
+        }
+        unlockQueue_();
+
+        if (!have_result)
+        {
+          return;
+        }
+        write_(result);
+      }
+    }
+
+    void write_(BatchResult & result)
+    {
+      // write chromatograms to output if so desired
+      for (Size i = 0; i < result.chromatograms.size(); i++)
+      {
+        chrom_consumer_->consumeChromatogram(result.chromatograms[i]);
+      }
+      // write features to output if so desired
+      if (store_features_)
+      {
+        for (FeatureMap<Feature>::iterator feature_it = result.features.begin();
+             feature_it != result.features.end(); ++feature_it)
+        {
+          out_features_.push_back(*feature_it);
+        }
+        out_features_.getProteinIdentifications().insert(out_features_.getProteinIdentifications().end(),
+            result.features.getProteinIdentifications().begin(), result.features.getProteinIdentifications().end());
+      }
+      if (tsv_writer_.isActive())
+      {
+        tsv_writer_.writeLines(result.tsv_lines);
+      }
+      BatchResult().swap(result);
+    }
+
+    /// Results not yet written, per SWATH map in order of the batches
+    std::vector< std::deque<BatchResult> > pending_;
+    /// Whether all results of a SWATH map have been pushed
+    std::vector<bool> finished_;
+    /// The SWATH map whose results are written next
+    Size next_swath_;
+
+    Interfaces::IMSDataConsumer<> * chrom_consumer_;
+    OpenSwathTSVWriter & tsv_writer_;
+    FeatureMap<> & out_features_;
+    bool store_features_;
+
+#ifdef _OPENMP
+    /// Protects pending_, finished_ and next_swath_ (held only briefly)
+    omp_lock_t queue_lock_;
+    /// Held by the thread which currently writes the output
+    omp_lock_t writer_lock_;
+#endif
+  };
+
   /**
    * @brief Class to execute an OpenSwath Workflow
    *
@@ -307,6 +532,10 @@ namespace OpenMS
       int progress = 0;
       this->startProgress(0, swath_maps.size(), "Extracting and scoring transitions");
 
+      // All output goes through the result sink which writes it in the order
+      // of the SWATH maps, without making the worker threads wait.
+      OpenSwathResultSink sink(swath_maps.size(), chromConsumer, tsv_writer, out_featureFile, !out.empty());
+
       // We set dynamic scheduling such that the maps are worked on in the order
       // in which they were given to the program / acquired. This gives much
       // better load balancing than static allocation.
@@ -374,52 +603,33 @@ namespace OpenMS
           extractor.extractChromatograms(swath_maps[i].sptr, chrom_list, coordinates, cp.mz_extraction_window,
               cp.ppm, cp.extraction_function);
 
-          // Step 2.3: convert chromatograms back and write to output
-          std::vector< OpenMS::MSChromatogram<> > chromatograms;
-          extractor.return_chromatogram(chrom_list, coordinates, transition_exp_used,  SpectrumSettings(), chromatograms, false);
-          chrom_exp->setChromatograms(chromatograms);
+          // Step 2.3: convert chromatograms back
+          OpenSwathResultSink::BatchResult result;
+          extractor.return_chromatogram(chrom_list, coordinates, transition_exp_used,  SpectrumSettings(), result.chromatograms, false);
+          chrom_exp->setChromatograms(result.chromatograms);
           OpenSwath::SpectrumAccessPtr chromatogram_ptr = OpenSwath::SpectrumAccessPtr(new OpenMS::SpectrumAccessOpenMS(chrom_exp));
 
           // Step 3: score these extracted transitions
-          FeatureMap<> featureFile;
           scoreAllChromatograms(chromatogram_ptr, swath_maps[i].sptr, transition_exp_used,
-              feature_finder_param, trafo, cp.rt_extraction_window, featureFile, tsv_writer);
+              feature_finder_param, trafo, cp.rt_extraction_window, result.features, tsv_writer, result.tsv_lines);
 
-          // Step 4: write all chromatograms and features out into an output object / file
-          // (this needs to be done in a critical section since we only have one
-          // output file and one output map).
-#ifdef _OPENMP
-#pragma omp critical (featureFinder)
-#endif
-          {
-            // write chromatograms to output if so desired
-            for (Size j = 0; j < chromatograms.size(); j++)
-            {
-              chromConsumer->consumeChromatogram(chromatograms[j]);
-            }
-            // write features to output if so desired
-            if (!out.empty())
-            {
-              for (FeatureMap<Feature>::iterator feature_it = featureFile.begin();
-                   feature_it != featureFile.end(); ++feature_it)
-              {
-                out_featureFile.push_back(*feature_it);
-              }
-              for (std::vector<ProteinIdentification>::iterator protid_it =
-                     featureFile.getProteinIdentifications().begin();
-                   protid_it != featureFile.getProteinIdentifications().end();
-                   ++protid_it)
-              {
-                out_featureFile.getProteinIdentifications().push_back(*protid_it);
-              }
-              this->setProgress(progress++);
-            }
-          }
+          // Step 4: hand all chromatograms and features over to the output
+          sink.push(i, result);
         }
 
       } // continue 2
       } // continue 1
+
+        // no more results for this SWATH map, allows the sink to proceed to the next one
+        sink.finishSwath(i);
+#ifdef _OPENMP
+#pragma omp critical (OpenSwathWorkflow_progress)
+#endif
+        {
+          this->setProgress(++progress);
+        }
       }
+      sink.flush();
       this->endProgress();
     }
 
@@ -599,6 +809,8 @@ namespace OpenMS
     /// Helper function to score a set of chromatograms
     /// Will iterate over all assays contained in transition_exp and for each
     /// assay fetch the corresponding chromatograms and find peakgroups.
+    /// If the tsv_writer is active, the TSV lines are appended to to_output
+    /// (the caller is responsible for writing them).
     ///
     void scoreAllChromatograms(
         const OpenSwath::SpectrumAccessPtr input,
@@ -606,7 +818,7 @@ namespace OpenMS
         OpenSwath::LightTargetedExperiment& transition_exp,
         const Param& feature_finder_param,
         TransformationDescription trafo, const double rt_extraction_window,
-        FeatureMap<Feature>& output, OpenSwathTSVWriter & tsv_writer)
+        FeatureMap<Feature>& output, OpenSwathTSVWriter & tsv_writer, std::vector<String> & to_output)
     {
       typedef OpenSwath::LightTransition TransitionType;
       // a transition group holds the MSSpectra with the Chromatogram peaks from above
@@ -644,7 +856,6 @@ namespace OpenMS
         assay_map[transition_exp.getTransitions()[i].getPeptideRef()].push_back(&transition_exp.getTransitions()[i]);
       }
 
-      std::vector<String> to_output;
       // Iterating over all the assays
       for (AssayMapT::iterator assay_it = assay_map.begin(); assay_it != assay_map.end(); ++assay_it)
       {
@@ -700,16 +911,6 @@ namespace OpenMS
         }
       }
 
-      // Only write at the very end since this is a step needs a barrier
-      if (tsv_writer.isActive())
-      {
-#ifdef _OPENMP
-#pragma omp critical (scoreAll)
-#endif
-        {
-          tsv_writer.writeLines(to_output);
-        }
-      }
     }
 
     void prepare_coordinates(std::vector< OpenSwath::ChromatogramPtr > & output_chromatograms,
@@ -1030,7 +1231,7 @@ protected:
     registerStringOption_("tempDirectory", "<tmp>", "/tmp/", "Temporary directory to store cached files for example", false, true);
 
     registerStringOption_("extraction_function", "<name>", "tophat", "Function used to extract the signal", false, true);
-    setValidStrings_("extraction_function", ListUtils::create<String>("tophat,bartlett"));
+    setValidStrings_("extraction_function", ListUtils::create<String>("tophat,bartlett,gaussian"));
 
     registerIntOption_("batchSize", "<number>", 0, "The batch size of chromatograms to process (0 means to only have one batch, sensible values are around 500-1000)", false, true);
     setMinInt_("batchSize", 0);